@@ -34,6 +34,7 @@ LOCAL_STATIC_LIBRARIES := libcv libcxcore
 endif
 
 XCAM_XCORE_SRC_FILES := \
+    xcore/async_image_file.cpp \
     xcore/buffer_pool.cpp \
     xcore/calibration_parser.cpp \
     xcore/file.cpp \
@@ -44,9 +45,13 @@ XCAM_XCORE_SRC_FILES := \
     xcore/video_buffer.cpp \
     xcore/external_video_buffer_priv.cpp \
     xcore/worker.cpp \
+    xcore/work_stealing_pool.cpp \
     xcore/xcam_buffer.cpp \
     xcore/xcam_common.cpp \
+    xcore/xcam_metrics.cpp \
+    xcore/xcam_numa.cpp \
     xcore/xcam_thread.cpp \
+    xcore/xcam_trace.cpp \
     xcore/xcam_utils.cpp \
     xcore/interface/blender.cpp \
     xcore/interface/feature_match.cpp \
@@ -58,9 +63,11 @@ XCAM_SOFT_SRC_FILES := \
     modules/soft/soft_blender.cpp \
     modules/soft/soft_blender_tasks_priv.cpp \
     modules/soft/soft_copy_task.cpp \
+    modules/soft/soft_fastmap_task.cpp \
     modules/soft/soft_geo_mapper.cpp \
     modules/soft/soft_geo_tasks_priv.cpp \
     modules/soft/soft_handler.cpp \
+    modules/soft/soft_simd_priv.cpp \
     modules/soft/soft_stitcher.cpp \
     modules/soft/soft_video_buf_allocator.cpp \
     modules/soft/soft_worker.cpp \
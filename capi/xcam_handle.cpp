@@ -22,6 +22,7 @@
 #include "xcam_handle.h"
 #include "dma_video_buffer.h"
 #include "context_priv.h"
+#include "xcam_metrics.h"
 #include <stdarg.h>
 
 using namespace XCam;
@@ -90,6 +91,27 @@ xcam_handle_get_usage (XCamHandle *handle, char *usage_buf, int *usage_len)
     return XCAM_RETURN_NO_ERROR;
 }
 
+XCamReturn
+xcam_handle_get_stats (XCamHandle *handle, char *stats_buf, int *stats_len)
+{
+    ContextBase *context = CONTEXT_BASE_CAST (handle);
+    XCAM_FAIL_RETURN (
+        ERROR, context && stats_len, XCAM_RETURN_ERROR_PARAM,
+        "xcam_handle_get_stats failed, handle and stats length can NOT be NULL");
+
+    std::string stats = MetricsRegistry::instance ().dump ();
+    int len = (int) stats.size () + 1;
+    if (!stats_buf || *stats_len < len) {
+        *stats_len = len;
+        XCAM_LOG_DEBUG ("xcam_handle_get_stats needs buffer length:%d", len);
+        return XCAM_RETURN_ERROR_MEM;
+    }
+
+    memcpy (stats_buf, stats.c_str (), len);
+    *stats_len = len;
+    return XCAM_RETURN_NO_ERROR;
+}
+
 XCamReturn
 xcam_handle_set_parameters (XCamHandle *handle, const char *params)
 {
@@ -51,6 +51,22 @@ void xcam_destroy_handle (XCamHandle *handle);
  */
 XCamReturn xcam_handle_get_usage (XCamHandle *handle, char *usage_buf, int *usage_len);
 
+/*! \brief    xcam handle get runtime stats of buffer pools, thread pools and handlers
+ *
+ * stats are process-wide, they cover all handles and pipelines in the process, not only this handle.
+ * stats are text lines of "<name> <value>" for counters and
+ * "<name> count=.. mean=.. min=.. p50=.. p90=.. p99=.. max=.." for latency histograms in microseconds,
+ * objects sharing a name are listed as "<name>#<n>".
+ * if stats_buf is NULL or too small, nothing is copied, stats_len returns the required length
+ * including terminator and XCAM_RETURN_ERROR_MEM is returned.
+ *
+ * \params[in]        handle       xcam handle
+ * \params[out]       stats_buf    buffer to store stats, may be NULL to query length
+ * \params[in,out]    stats_len    buffer length
+ * \return            XCamReturn   XCAM_RETURN_NO_ERROR on sucess; others on errors.
+ */
+XCamReturn xcam_handle_get_stats (XCamHandle *handle, char *stats_buf, int *stats_len);
+
 /*! \brief set handle parameters before init
  *
  * \params[in]    handle       xcam handle
@@ -0,0 +1,224 @@
+/*
+ * dnn_batch_detection.cpp -  batch object detection of frames from several sources
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include <xcam_metrics.h>
+
+#include "dnn_batch_detection.h"
+
+namespace XCam {
+
+class DnnBatchThread
+    : public Thread
+{
+public:
+    explicit DnnBatchThread (DnnBatchDetector *batcher)
+        : Thread ("dnn-batch")
+        , _batcher (batcher)
+    {}
+
+protected:
+    virtual bool loop () {
+        return _batcher->batch_loop ();
+    }
+
+private:
+    DnnBatchDetector   *_batcher;
+};
+
+// detector keeps a reference of its callback, raw pointer breaks the cycle
+class DnnBatchInferCallback
+    : public DnnInferenceEngine::Callback
+{
+public:
+    explicit DnnBatchInferCallback (DnnBatchDetector *batcher)
+        : _batcher (batcher)
+    {}
+
+    virtual void infer_done (DnnInferenceEngine *engine, void *cookie, XCamReturn error) {
+        XCAM_UNUSED (engine);
+        _batcher->batch_done ((DnnBatchFrameList *)cookie, error);
+    }
+
+private:
+    DnnBatchDetector   *_batcher;
+};
+
+DnnBatchDetector::DnnBatchDetector (const SmartPtr<DnnObjectDetection> &detector, uint32_t deadline_us)
+    : _detector (detector)
+    , _deadline_us (deadline_us)
+    , _max_batch (0)
+    , _stopping (false)
+{
+    XCAM_ASSERT (detector.ptr ());
+}
+
+DnnBatchDetector::~DnnBatchDetector ()
+{
+    stop ();
+}
+
+XCamReturn
+DnnBatchDetector::start ()
+{
+    if (_thread.ptr ())
+        return XCAM_RETURN_NO_ERROR;
+
+    XCAM_FAIL_RETURN (
+        ERROR, _detector->ready_to_start (), XCAM_RETURN_ERROR_ORDER,
+        "DnnBatchDetector start failed, please load the model firstly");
+
+    size_t batch_size = _detector->get_batch_size ();
+    XCAM_FAIL_RETURN (
+        ERROR, batch_size > 0 && batch_size != (size_t)-1, XCAM_RETURN_ERROR_PARAM,
+        "DnnBatchDetector start failed, invalid model batch size");
+    _max_batch = (uint32_t)batch_size;
+
+    _detector->set_callback (new DnnBatchInferCallback (this));
+    _stopping = false;
+
+    _thread = new DnnBatchThread (this);
+    XCAM_FAIL_RETURN (
+        ERROR, _thread->start (), XCAM_RETURN_ERROR_THREAD,
+        "DnnBatchDetector start batch thread failed");
+
+    XCAM_LOG_DEBUG ("DnnBatchDetector started, max batch:%d deadline:%dus", _max_batch, _deadline_us);
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+DnnBatchDetector::stop ()
+{
+    if (!_thread.ptr ())
+        return XCAM_RETURN_NO_ERROR;
+
+    // thread exits once stopped, queued frames must be submitted before
+    {
+        SmartLock locker (_mutex);
+        _stopping = true;
+        _cond.broadcast ();
+        while (!_frames.empty ())
+            _cond.wait (_mutex);
+    }
+    _thread->stop ();
+    _thread.release ();
+
+    XCamReturn ret = _detector->wait_all ();
+    _detector->set_callback (SmartPtr<DnnInferenceEngine::Callback> ());
+    return ret;
+}
+
+XCamReturn
+DnnBatchDetector::push_frame (uint32_t source, const SmartPtr<VideoBuffer> &buf)
+{
+    XCAM_ASSERT (buf.ptr ());
+    XCAM_FAIL_RETURN (
+        ERROR, _thread.ptr (), XCAM_RETURN_ERROR_ORDER,
+        "DnnBatchDetector push frame failed, batch thread is not started");
+
+    DnnBatchFrame frame;
+    frame.source = source;
+    frame.queue_us = MetricsRegistry::now_us ();
+    frame.buf = buf;
+
+    SmartLock locker (_mutex);
+    XCAM_FAIL_RETURN (
+        ERROR, !_stopping, XCAM_RETURN_ERROR_ORDER,
+        "DnnBatchDetector push frame failed, batcher is stopping");
+    _frames.push_back (frame);
+    _cond.broadcast ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+bool
+DnnBatchDetector::batch_loop ()
+{
+    DnnBatchFrameList *batch = new DnnBatchFrameList;
+    {
+        SmartLock locker (_mutex);
+        while (!_stopping && _frames.empty ())
+            _cond.wait (_mutex);
+
+        // a full batch goes at once, a short one waits until the deadline of its oldest frame
+        while (!_stopping && _frames.size () < _max_batch) {
+            uint64_t waited = MetricsRegistry::now_us () - _frames.front ().queue_us;
+            if (waited >= _deadline_us)
+                break;
+            _cond.timedwait (_mutex, _deadline_us - (uint32_t)waited);
+        }
+
+        if (_frames.empty ()) {
+            delete batch;
+            return false;
+        }
+
+        while (!_frames.empty () && batch->size () < _max_batch) {
+            batch->push_back (_frames.front ());
+            _frames.pop_front ();
+        }
+        _cond.broadcast ();
+    }
+
+    VideoBufferList images;
+    for (DnnBatchFrameList::iterator i = batch->begin (); i != batch->end (); ++i)
+        images.push_back (i->buf);
+
+    // batch is owned by infer callback once submitted
+    XCamReturn ret = _detector->submit (images, batch);
+    if (ret != XCAM_RETURN_NO_ERROR) {
+        XCAM_LOG_WARNING ("DnnBatchDetector submit batch of %d frames failed", (uint32_t)batch->size ());
+        batch_done (batch, ret);
+    }
+
+    return true;
+}
+
+void
+DnnBatchDetector::batch_done (DnnBatchFrameList *batch, XCamReturn error)
+{
+    XCAM_ASSERT (batch);
+
+    std::vector<float*> result_ptr;
+    if (error == XCAM_RETURN_NO_ERROR) {
+        uint32_t blob_size = 0;
+        for (uint32_t output_idx = 0; output_idx < _detector->get_output_size (); output_idx ++) {
+            result_ptr.push_back ((float*)_detector->get_inference_results (output_idx, blob_size));
+        }
+    }
+
+    uint32_t batch_idx = 0;
+    for (DnnBatchFrameList::iterator i = batch->begin (); i != batch->end (); ++i, ++batch_idx) {
+        DnnDetectResult result;
+        result.source = i->source;
+        result.timestamp = i->buf->get_timestamp ();
+        result.buf = i->buf;
+
+        XCamReturn ret = error;
+        if (ret == XCAM_RETURN_NO_ERROR)
+            ret = _detector->get_bounding_boxes (result_ptr, batch_idx, result.boxes, result.classes);
+
+        if (_callback.ptr ())
+            _callback->detected (this, result, ret);
+    }
+
+    delete batch;
+}
+
+}  // namespace XCam
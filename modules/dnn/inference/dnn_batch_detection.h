@@ -0,0 +1,125 @@
+/*
+ * dnn_batch_detection.h -  batch object detection of frames from several sources
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_DNN_BATCH_DETECTION_H
+#define XCAM_DNN_BATCH_DETECTION_H
+
+#pragma once
+
+#include <list>
+
+#include <xcam_std.h>
+#include <xcam_mutex.h>
+#include <xcam_thread.h>
+#include <vec_mat.h>
+#include "dnn_object_detection.h"
+
+#define DNN_BATCH_DEFAULT_DEADLINE_US 10000
+
+namespace XCam {
+
+struct DnnDetectResult {
+    uint32_t                source;
+    int64_t                 timestamp;
+    SmartPtr<VideoBuffer>   buf;
+    std::vector<Vec4i>      boxes;
+    std::vector<int32_t>    classes;
+
+    DnnDetectResult ()
+        : source (0)
+        , timestamp (InvalidTimestamp)
+    {}
+};
+
+struct DnnBatchFrame {
+    uint32_t                source;
+    uint64_t                queue_us;
+    SmartPtr<VideoBuffer>   buf;
+};
+
+typedef std::list<DnnBatchFrame> DnnBatchFrameList;
+
+class DnnBatchThread;
+class DnnBatchInferCallback;
+
+/*
+ * collects frames of several sources, e.g. inputs of a stitcher, into batches of one detection model.
+ * a batch is submitted once it holds max batch frames or its oldest frame waited for the deadline,
+ * results are scattered back per frame with source and timestamp of the frame.
+ * max batch is the model batch size, set it by set_batch_size before load_model,
+ * a short batch leaves the tail of the input tensor unused.
+ */
+class DnnBatchDetector
+{
+    friend class DnnBatchThread;
+    friend class DnnBatchInferCallback;
+
+public:
+    class Callback {
+    public:
+        Callback () {}
+        virtual ~Callback () {}
+        // runs on inference thread, batches may complete out of order with several infer requests
+        virtual void detected (DnnBatchDetector *detector, const DnnDetectResult &result, XCamReturn error) = 0;
+
+    private:
+        XCAM_DEAD_COPY (Callback);
+    };
+
+public:
+    explicit DnnBatchDetector (const SmartPtr<DnnObjectDetection> &detector, uint32_t deadline_us = DNN_BATCH_DEFAULT_DEADLINE_US);
+    virtual ~DnnBatchDetector ();
+
+    void set_callback (const SmartPtr<Callback> &callback) {
+        _callback = callback;
+    }
+    uint32_t get_max_batch () const {
+        return _max_batch;
+    }
+
+    // takes over callback of detector, model must be loaded
+    XCamReturn start ();
+    // queued frames are inferred and their results delivered before return
+    XCamReturn stop ();
+
+    XCamReturn push_frame (uint32_t source, const SmartPtr<VideoBuffer> &buf);
+
+private:
+    bool batch_loop ();
+    void batch_done (DnnBatchFrameList *batch, XCamReturn error);
+
+    XCAM_DEAD_COPY (DnnBatchDetector);
+
+private:
+    SmartPtr<DnnObjectDetection>    _detector;
+    SmartPtr<Callback>              _callback;
+    SmartPtr<Thread>                _thread;
+    uint32_t                        _deadline_us;
+    uint32_t                        _max_batch;
+
+    Mutex                           _mutex;
+    Cond                            _cond;
+    DnnBatchFrameList               _frames;
+    bool                            _stopping;
+};
+
+}  // namespace XCam
+
+#endif // XCAM_DNN_BATCH_DETECTION_H
@@ -34,9 +34,43 @@ using namespace ov;
 
 namespace XCam {
 
+struct DnnInferSlot {
+    DnnInferenceEngine      *engine;
+    ov::InferRequest         request;
+    void                    *cookie;
+    bool                     busy;
+    std::vector<uint32_t>    image_width;
+    std::vector<uint32_t>    image_height;
+
+    DnnInferSlot ()
+        : engine (NULL)
+        , cookie (NULL)
+        , busy (false)
+    {}
+};
+
+// slot whose frame is being submitted or reported on calling thread
+static thread_local DnnInferSlot *tls_slot = NULL;
+
+class DnnInferSlotBinder {
+public:
+    explicit DnnInferSlotBinder (DnnInferSlot *slot)
+        : _prev (tls_slot)
+    {
+        tls_slot = slot;
+    }
+    ~DnnInferSlotBinder () {
+        tls_slot = _prev;
+    }
+
+private:
+    DnnInferSlot  *_prev;
+};
+
 DnnInferenceEngine::DnnInferenceEngine (DnnInferConfig& config)
     : _model_loaded (false)
     , _model_type (config.model_type)
+    , _busy_slots (0)
 {
     XCAM_LOG_DEBUG ("DnnInferenceEngine::DnnInferenceEngine");
     _input_image_width.clear ();
@@ -59,7 +93,8 @@ DnnInferenceEngine::DnnInferenceEngine (DnnInferConfig& config)
 
 DnnInferenceEngine::~DnnInferenceEngine ()
 {
-
+    // derived engines wait in their destructors, callbacks call their methods
+    wait_all ();
 }
 
 std::vector<std::string>
@@ -126,9 +161,31 @@ DnnInferenceEngine::load_model (DnnInferConfig& config)
         return XCAM_RETURN_NO_ERROR;
     }
 
-    ov::CompiledModel execute_network = _ie->compile_model (_network, config.device_name);
+    uint32_t request_count = XCAM_MAX (config.infer_requests, 1u);
+    ov::CompiledModel execute_network;
+    if (request_count > 1) {
+        // plugin may run up to one stream per request
+        execute_network = _ie->compile_model (
+                              _network, config.device_name,
+                              ov::hint::performance_mode (ov::hint::PerformanceMode::THROUGHPUT),
+                              ov::hint::num_requests (request_count));
+    } else {
+        execute_network = _ie->compile_model (_network, config.device_name);
+    }
 
-    _infer_request = execute_network.create_infer_request ();
+    _slots.clear ();
+    for (uint32_t i = 0; i < request_count; i++) {
+        SmartPtr<DnnInferSlot> slot = new DnnInferSlot;
+        DnnInferSlot *slot_ptr = slot.ptr ();
+        slot->engine = this;
+        slot->request = execute_network.create_infer_request ();
+        slot->request.set_callback ([this, slot_ptr] (std::exception_ptr exception) {
+            infer_done (slot_ptr, exception);
+        });
+        _slots.push_back (slot);
+    }
+    _infer_request = _slots[0]->request;
+    XCAM_LOG_DEBUG ("created %d infer requests", request_count);
 
     _model_loaded = true;
 
@@ -183,16 +240,148 @@ DnnInferenceEngine::start (bool sync)
         return XCAM_RETURN_ERROR_ORDER;
     }
 
+    ov::InferRequest &request = get_infer_request ();
     if (sync) {
-        _infer_request.infer ();
+        request.infer ();
     } else {
-        _infer_request.start_async ();
-        _infer_request.wait ();
+        request.start_async ();
+        request.wait ();
     }
 
     return XCAM_RETURN_NO_ERROR;
 }
 
+XCamReturn
+DnnInferenceEngine::submit (const VideoBufferList& images, void *cookie)
+{
+    if (! _model_loaded) {
+        XCAM_LOG_ERROR ("Please load the model firstly!");
+        return XCAM_RETURN_ERROR_ORDER;
+    }
+
+    if (NULL == _callback.ptr ()) {
+        XCAM_LOG_ERROR ("Please set result callback firstly!");
+        return XCAM_RETURN_ERROR_ORDER;
+    }
+
+    SmartPtr<DnnInferSlot> slot;
+    {
+        SmartLock locker (_slot_mutex);
+        while (_busy_slots == _slots.size ())
+            _slot_cond.wait (_slot_mutex);
+
+        for (size_t i = 0; i < _slots.size (); i++) {
+            if (!_slots[i]->busy) {
+                slot = _slots[i];
+                break;
+            }
+        }
+        XCAM_ASSERT (slot.ptr ());
+        slot->busy = true;
+        ++_busy_slots;
+    }
+
+    // preprocessing fills this request while the others are inferring
+    XCamReturn ret = XCAM_RETURN_NO_ERROR;
+    {
+        DnnInferSlotBinder binder (slot.ptr ());
+        size_t first = _input_image_width.size ();
+        ret = set_inference_data (images);
+
+        slot->image_width.assign (_input_image_width.begin () + first, _input_image_width.end ());
+        slot->image_height.assign (_input_image_height.begin () + first, _input_image_height.end ());
+        _input_image_width.resize (first);
+        _input_image_height.resize (first);
+    }
+
+    if (ret != XCAM_RETURN_NO_ERROR) {
+        XCAM_LOG_ERROR ("set inference data of submitted frame failed");
+        release_slot (slot.ptr ());
+        return ret;
+    }
+
+    slot->cookie = cookie;
+    try {
+        slot->request.start_async ();
+    } catch (const std::exception &e) {
+        XCAM_LOG_ERROR ("start inference of submitted frame failed: %s", e.what ());
+        release_slot (slot.ptr ());
+        return XCAM_RETURN_ERROR_UNKNOWN;
+    }
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+DnnInferenceEngine::wait_all ()
+{
+    SmartLock locker (_slot_mutex);
+    while (_busy_slots)
+        _slot_cond.wait (_slot_mutex);
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+void
+DnnInferenceEngine::infer_done (DnnInferSlot *slot, std::exception_ptr exception)
+{
+    // requests started by start () are waited by caller
+    if (!slot->busy)
+        return;
+
+    XCamReturn error = XCAM_RETURN_NO_ERROR;
+    if (exception) {
+        try {
+            std::rethrow_exception (exception);
+        } catch (const std::exception &e) {
+            XCAM_LOG_ERROR ("inference of submitted frame failed: %s", e.what ());
+            error = XCAM_RETURN_ERROR_UNKNOWN;
+        }
+    }
+
+    if (_callback.ptr ()) {
+        DnnInferSlotBinder binder (slot);
+        _callback->infer_done (this, slot->cookie, error);
+    }
+
+    release_slot (slot);
+}
+
+void
+DnnInferenceEngine::release_slot (DnnInferSlot *slot)
+{
+    SmartLock locker (_slot_mutex);
+    slot->busy = false;
+    slot->cookie = NULL;
+    --_busy_slots;
+    _slot_cond.broadcast ();
+}
+
+ov::InferRequest &
+DnnInferenceEngine::get_infer_request ()
+{
+    if (tls_slot && tls_slot->engine == this)
+        return tls_slot->request;
+
+    return _infer_request;
+}
+
+uint32_t
+DnnInferenceEngine::get_input_image_height (uint32_t idx) const
+{
+    const std::vector<uint32_t> &heights =
+        (tls_slot && tls_slot->engine == this) ? tls_slot->image_height : _input_image_height;
+    return (idx >= heights.size ()) ? 0 : heights[idx];
+}
+
+uint32_t
+DnnInferenceEngine::get_input_image_width (uint32_t idx) const
+{
+    const std::vector<uint32_t> &widths =
+        (tls_slot && tls_slot->engine == this) ? tls_slot->image_width : _input_image_width;
+    return (idx >= widths.size ()) ? 0 : widths[idx];
+}
+
 size_t
 DnnInferenceEngine::get_input_size ()
 {
@@ -391,7 +580,7 @@ DnnInferenceEngine::set_input_tensor (uint32_t idx, DnnInferData& data)
         return XCAM_RETURN_ERROR_PARAM;
     }
 
-    ov::Tensor input_tensor = _infer_request.get_tensor (input_name);
+    ov::Tensor input_tensor = get_infer_request ().get_tensor (input_name);
     if (data.precision == DnnInferPrecisionFP32) {
         if (data.data_type == DnnInferDataTypeImage) {
             copy_image_to_input_tensor<element_type_traits<element::Type_t::f32>::value_type> (data, input_tensor, data.batch_idx);
@@ -409,6 +598,46 @@ DnnInferenceEngine::set_input_tensor (uint32_t idx, DnnInferData& data)
     return XCAM_RETURN_NO_ERROR;
 }
 
+XCamReturn
+DnnInferenceEngine::set_input_tensor (uint32_t idx, const SmartPtr<VideoBuffer>& image, const Rect& crop, uint32_t batch_idx)
+{
+    if (NULL == _ie.ptr ()) {
+        XCAM_LOG_ERROR ("Please create inference engine");
+        return XCAM_RETURN_ERROR_ORDER;
+    }
+
+    if (idx >= get_input_size ()) {
+        XCAM_LOG_ERROR ("Input is out of range");
+        return XCAM_RETURN_ERROR_PARAM;
+    }
+
+    std::string input_name = *(_network->input (idx).get_names ().begin ());
+    if (input_name.empty ()) {
+        XCAM_LOG_ERROR ("input name is empty!");
+        return XCAM_RETURN_ERROR_PARAM;
+    }
+
+    ov::Tensor input_tensor = get_infer_request ().get_tensor (input_name);
+    const ov::Shape shape = input_tensor.get_shape ();
+    if (shape.size () != 4 || shape[1] != 3 || batch_idx >= shape[0]) {
+        XCAM_LOG_ERROR ("Input tensor is not N x 3 x H x W or batch index %d is out of range", batch_idx);
+        return XCAM_RETURN_ERROR_PARAM;
+    }
+
+    const uint32_t width = shape[3];
+    const uint32_t height = shape[2];
+    const size_t batch_offset = (size_t)batch_idx * shape[1] * width * height;
+
+    if (input_tensor.get_element_type () == ov::element::f32) {
+        return XCamDNN::convert_to_BGR_planar (image, crop, input_tensor.data<float> () + batch_offset, width, height);
+    } else if (input_tensor.get_element_type () == ov::element::u8) {
+        return XCamDNN::convert_to_BGR_planar (image, crop, input_tensor.data<uint8_t> () + batch_offset, width, height);
+    }
+
+    XCAM_LOG_ERROR ("Input tensor precision is not supported for video buffer input");
+    return XCAM_RETURN_ERROR_PARAM;
+}
+
 XCamReturn
 DnnInferenceEngine::set_inference_data (std::vector<std::string> images)
 {
@@ -458,7 +687,8 @@ DnnInferenceEngine::set_inference_data (std::vector<std::string> images)
             image.precision = get_input_precision (idx);
             image.data_type = DnnInferDataTypeImage;
 
-            set_input_tensor (idx, image);
+            // images are batched into first input of model
+            set_input_tensor (0, image);
             idx ++;
         } else {
             XCAM_LOG_WARNING ("Valid input images were not found!");
@@ -495,13 +725,21 @@ DnnInferenceEngine::set_inference_data (const VideoBufferList& images)
             image_height = XCamDNN::convert_dim(_network->input (index).get_partial_shape ()[2]);
         }
 
+        if (buf_info.format == V4L2_PIX_FMT_NV12) {
+            // no intermediate BGR image, resized and converted into input tensor in one pass
+            if (!xcam_ret_is_ok (set_input_tensor (0, buf, Rect (0, 0, buf_info.width, buf_info.height), idx))) {
+                XCAM_LOG_WARNING ("NV12 image %d cannot be set to input tensor!", idx);
+                continue;
+            }
+            idx ++;
+            continue;
+        }
+
         float x_ratio = float(image_width) / float(buf_info.width);
         float y_ratio = float(image_height) / float(buf_info.height);
 
         uint8_t* data = NULL;
-        if (buf_info.format == V4L2_PIX_FMT_NV12) {
-            data = XCamDNN::convert_NV12_to_BGR (buf, x_ratio, y_ratio);
-        } else if (buf_info.format == V4L2_PIX_FMT_BGR24) {
+        if (buf_info.format == V4L2_PIX_FMT_BGR24) {
             data = XCamDNN::resize_BGR (buf, x_ratio, y_ratio);
         }
 
@@ -520,7 +758,8 @@ DnnInferenceEngine::set_inference_data (const VideoBufferList& images)
             image.precision = get_input_precision (idx);
             image.data_type = DnnInferDataTypeImage;
 
-            set_input_tensor (idx, image);
+            // images are batched into first input of model
+            set_input_tensor (0, image);
             idx ++;
         } else {
             XCAM_LOG_WARNING ("Valid input images were not found!");
@@ -535,6 +774,37 @@ DnnInferenceEngine::set_inference_data (const VideoBufferList& images)
     return XCAM_RETURN_NO_ERROR;
 }
 
+XCamReturn
+DnnInferenceEngine::set_inference_data (const SmartPtr<VideoBuffer>& image, const std::vector<Rect>& rects)
+{
+    if (NULL == _ie.ptr ()) {
+        XCAM_LOG_ERROR ("Please create inference engine");
+        return XCAM_RETURN_ERROR_ORDER;
+    }
+    XCAM_ASSERT (image.ptr ());
+
+    if (rects.empty () || rects.size () > get_batch_size ()) {
+        XCAM_LOG_ERROR ("Rects count %d is out of batch size %d", (uint32_t)rects.size (), (uint32_t)get_batch_size ());
+        return XCAM_RETURN_ERROR_PARAM;
+    }
+
+    // boxes of batch slot idx are scaled to its rect
+    _input_image_width.clear ();
+    _input_image_height.clear ();
+
+    for (uint32_t idx = 0; idx < rects.size (); idx++) {
+        XCamReturn ret = set_input_tensor (0, image, rects[idx], idx);
+        if (!xcam_ret_is_ok (ret)) {
+            XCAM_LOG_ERROR ("Rect %d (%d, %d, %d, %d) cannot be set to input tensor!",
+                            idx, rects[idx].pos_x, rects[idx].pos_y, rects[idx].width, rects[idx].height);
+            return ret;
+        }
+        _input_image_width.push_back (rects[idx].width);
+        _input_image_height.push_back (rects[idx].height);
+    }
+
+    return XCAM_RETURN_NO_ERROR;
+}
 
 std::shared_ptr<uint8_t>
 DnnInferenceEngine::read_input_image (std::string& image)
@@ -590,7 +860,7 @@ DnnInferenceEngine::save_output_image (const std::string& image_name, uint32_t i
         return XCAM_RETURN_ERROR_PARAM;
     }
 
-    const ov::Tensor output_tensor = _infer_request.get_tensor (output_name);
+    const ov::Tensor output_tensor = get_infer_request ().get_tensor (output_name);
     const auto output_data = static_cast<element_type_traits<element::Type_t::f32>::value_type*> (output_tensor.data ());
 
     size_t image_count = output_tensor.get_shape ()[0];
@@ -662,7 +932,7 @@ DnnInferenceEngine::get_inference_results (uint32_t idx, uint32_t& size)
         return NULL;
     }
 
-    const ov::Tensor output_tensor = _infer_request.get_tensor (output_name);
+    const ov::Tensor output_tensor = get_infer_request ().get_tensor (output_name);
     float* output_result = static_cast<element_type_traits<element::Type_t::f32>::value_type*> (output_tensor.data ());
 
     size = output_tensor.get_byte_size ();
@@ -29,6 +29,7 @@
 #include <openvino/openvino.hpp>
 
 #include <xcam_std.h>
+#include <xcam_mutex.h>
 #include <video_buffer.h>
 
 namespace XCam {
@@ -194,16 +195,36 @@ struct DnnInferConfig {
     std::string gna_ext;
     std::string model_filename;
 
+    // infer requests created by load_model, more than one lets submitted frames overlap
+    uint32_t infer_requests;
+
     DnnInferConfig () {
         target_id = DnnInferDeviceCPU;
         device_name = "CPU";
+        infer_requests = 1;
     };
 };
 
 typedef std::map<DnnInferModelType, const char*> DnnOutputLayerType;
 typedef std::map<std::string, ov_layout_value> OvLayoutType;
 
+struct DnnInferSlot;
+
 class DnnInferenceEngine {
+public:
+    class Callback {
+    public:
+        Callback () {}
+        virtual ~Callback () {}
+
+        // runs on inference thread, frames may complete out of submit order,
+        // results and input image sizes of the frame are read through engine during the call
+        virtual void infer_done (DnnInferenceEngine *engine, void *cookie, XCamReturn error) = 0;
+
+    private:
+        XCAM_DEAD_COPY (Callback);
+    };
+
 public:
     explicit DnnInferenceEngine (DnnInferConfig& config);
     virtual ~DnnInferenceEngine ();
@@ -223,8 +244,18 @@ public:
         return _model_loaded;
     };
 
+    // sync api on first infer request, do not mix with submit while frames are in flight
     XCamReturn start (bool sync = true);
 
+    void set_callback (const SmartPtr<Callback> &callback) {
+        _callback = callback;
+    }
+    // preprocesses images into a free infer request and starts it, blocks while all requests are busy
+    XCamReturn submit (const VideoBufferList& images, void *cookie);
+    // waits until callbacks of all submitted frames returned,
+    // derived engines call it in their destructors as callbacks use their methods
+    XCamReturn wait_all ();
+
     size_t get_input_size ();
     size_t get_output_size ();
 
@@ -238,12 +269,8 @@ public:
     XCamReturn set_input_layout (uint32_t idx, DnnInferLayoutType layout);
     XCamReturn set_output_layout (uint32_t idx, DnnInferLayoutType layout);
 
-    uint32_t get_input_image_height (uint32_t idx) const {
-        return (idx >= _input_image_height.size ()) ? 0 : _input_image_height[idx];
-    };
-    uint32_t get_input_image_width (uint32_t idx) const {
-        return (idx >= _input_image_width.size ()) ? 0 : _input_image_width[idx];
-    };
+    uint32_t get_input_image_height (uint32_t idx) const;
+    uint32_t get_input_image_width (uint32_t idx) const;
 
     virtual XCamReturn set_model_input_info (DnnInferInputOutputInfo& info) = 0;
     virtual XCamReturn get_model_input_info (DnnInferInputOutputInfo& info) = 0;
@@ -253,6 +280,8 @@ public:
 
     virtual XCamReturn set_inference_data (std::vector<std::string> images);
     virtual XCamReturn set_inference_data (const VideoBufferList& images);
+    // each rect of NV12 or BGR24 image fills one batch slot, input image sizes are replaced by rect sizes
+    virtual XCamReturn set_inference_data (const SmartPtr<VideoBuffer>& image, const std::vector<Rect>& rects);
 
     void* get_inference_results (uint32_t idx, uint32_t& size);
     std::shared_ptr<uint8_t> read_input_image (std::string& image);
@@ -273,8 +302,16 @@ protected:
     void print_performance_counts (const std::map<std::string, ov::ProfilingInfo>& performance_map);
 
     XCamReturn set_input_tensor (uint32_t idx, DnnInferData& data);
+    // crop of NV12 or BGR24 frame is resized and converted straight into memory of input tensor
+    XCamReturn set_input_tensor (uint32_t idx, const SmartPtr<VideoBuffer>& image, const Rect& crop, uint32_t batch_idx);
+
+    // request of the frame in callback or being submitted on calling thread, else first request
+    ov::InferRequest &get_infer_request ();
 
 private:
+    void infer_done (DnnInferSlot *slot, std::exception_ptr exception);
+    void release_slot (DnnInferSlot *slot);
+
     template <typename T> XCamReturn copy_image_to_input_tensor (const DnnInferData& data, ov::Tensor& input_tensor, int batch_index);
     template <typename T> XCamReturn copy_data_to_input_tensor (const DnnInferData& data, ov::Tensor& input_tensor, int batch_index);
 
@@ -293,6 +330,13 @@ protected:
 
     DnnOutputLayerType _output_layer_type;
     OvLayoutType layout_types;
+
+private:
+    std::vector<SmartPtr<DnnInferSlot> > _slots;
+    SmartPtr<Callback> _callback;
+    Mutex _slot_mutex;
+    Cond _slot_cond;
+    uint32_t _busy_slots;
 };
 
 }  // namespace XCam
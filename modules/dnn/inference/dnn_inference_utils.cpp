@@ -22,6 +22,10 @@
 #include <iomanip>
 #include <fstream>
 #include <limits>
+#include <cmath>
+
+#include <xcam_mutex.h>
+#include <work_stealing_pool.h>
 
 #include "dnn_inference_utils.h"
 
@@ -29,6 +33,14 @@
 #include "ocv/cv_std.h"
 #endif
 
+// same fixed point as cv::resize INTER_LINEAR and cv::cvtColor YUV2BGR
+#define XCAM_DNN_RESIZE_COEF_BITS 11
+#define XCAM_DNN_RESIZE_COEF_SCALE (1 << XCAM_DNN_RESIZE_COEF_BITS)
+#define XCAM_DNN_YUV_SHIFT 20
+
+// rows of one task, smaller bands cost more in dispatch than they save
+#define XCAM_DNN_PREPROCESS_MIN_ROWS 16
+
 using namespace std;
 using namespace XCam;
 
@@ -459,4 +471,310 @@ resize_BGR (SmartPtr<VideoBuffer>& bgr, float x_ratio, float y_ratio)
 #endif
 }
 
+// taps and weights of each destination column or row, taps are absolute in source image
+struct ResizeTable {
+    std::vector<int32_t> idx0;
+    std::vector<int32_t> idx1;
+    std::vector<int32_t> weight;
+
+    ResizeTable (uint32_t src_offset, uint32_t src_size, uint32_t dst_size);
+};
+
+ResizeTable::ResizeTable (uint32_t src_offset, uint32_t src_size, uint32_t dst_size)
+    : idx0 (dst_size)
+    , idx1 (dst_size)
+    , weight (dst_size)
+{
+    float scale = float(src_size) / float(dst_size);
+    for (uint32_t i = 0; i < dst_size; i++) {
+        // pixel centers aligned like cv::resize
+        float pos = (i + 0.5f) * scale - 0.5f;
+        int32_t i0 = (int32_t)floorf (pos);
+        float frac = pos - i0;
+        if (i0 < 0) {
+            i0 = 0;
+            frac = 0.0f;
+        } else if (i0 >= (int32_t)src_size - 1) {
+            i0 = src_size - 1;
+            frac = 0.0f;
+        }
+        idx0[i] = src_offset + i0;
+        idx1[i] = src_offset + XCAM_MIN (i0 + 1, (int32_t)src_size - 1);
+        weight[i] = (int32_t)roundf (frac * XCAM_DNN_RESIZE_COEF_SCALE);
+    }
+}
+
+// Y and UV planes of NV12, or the only plane of BGR24
+struct ImagePlanes {
+    uint32_t format;
+    const uint8_t *y;
+    const uint8_t *uv;
+    uint32_t y_stride;
+    uint32_t uv_stride;
+};
+
+static inline int32_t
+bilinear (int32_t p00, int32_t p01, int32_t p10, int32_t p11, int32_t wx, int32_t wy)
+{
+    int32_t top = p00 * (XCAM_DNN_RESIZE_COEF_SCALE - wx) + p01 * wx;
+    int32_t bottom = p10 * (XCAM_DNN_RESIZE_COEF_SCALE - wx) + p11 * wx;
+    int32_t value = top * (XCAM_DNN_RESIZE_COEF_SCALE - wy) + bottom * wy;
+    return (value + (1 << (XCAM_DNN_RESIZE_COEF_BITS * 2 - 1))) >> (XCAM_DNN_RESIZE_COEF_BITS * 2);
+}
+
+static inline uint8_t
+clamp_u8 (int32_t value)
+{
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// chroma is taken at the luma taps, same as nearest upsampling done by cvtColor before resize
+template <typename T> static void
+convert_nv12_rows (
+    const ImagePlanes &src, const ResizeTable &cols, const ResizeTable &rows,
+    T *dst, uint32_t dst_width, uint32_t dst_height, uint32_t row_begin, uint32_t row_end)
+{
+    // bt.601 limited range coefficients of cv::cvtColor
+    const int32_t cy = 1220542;
+    const int32_t cvr = 1673527;
+    const int32_t cvg = -852492;
+    const int32_t cug = -409993;
+    const int32_t cub = 2116026;
+    const int32_t half = 1 << (XCAM_DNN_YUV_SHIFT - 1);
+
+    const size_t plane_size = (size_t)dst_width * dst_height;
+
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        const uint8_t *y_row0 = src.y + (size_t)rows.idx0[y] * src.y_stride;
+        const uint8_t *y_row1 = src.y + (size_t)rows.idx1[y] * src.y_stride;
+        const uint8_t *uv_row0 = src.uv + (size_t)(rows.idx0[y] / 2) * src.uv_stride;
+        const uint8_t *uv_row1 = src.uv + (size_t)(rows.idx1[y] / 2) * src.uv_stride;
+        const int32_t wy = rows.weight[y];
+
+        T *b = dst + (size_t)y * dst_width;
+        T *g = b + plane_size;
+        T *r = g + plane_size;
+
+        for (uint32_t x = 0; x < dst_width; x++) {
+            const int32_t x0 = cols.idx0[x];
+            const int32_t x1 = cols.idx1[x];
+            const int32_t c0 = x0 & ~1;
+            const int32_t c1 = x1 & ~1;
+            const int32_t wx = cols.weight[x];
+
+            int32_t luma = bilinear (y_row0[x0], y_row0[x1], y_row1[x0], y_row1[x1], wx, wy);
+            int32_t u = bilinear (uv_row0[c0], uv_row0[c1], uv_row1[c0], uv_row1[c1], wx, wy) - 128;
+            int32_t v = bilinear (uv_row0[c0 + 1], uv_row0[c1 + 1], uv_row1[c0 + 1], uv_row1[c1 + 1], wx, wy) - 128;
+
+            luma = XCAM_MAX (luma - 16, 0) * cy;
+            b[x] = (T)clamp_u8 ((luma + cub * u + half) >> XCAM_DNN_YUV_SHIFT);
+            g[x] = (T)clamp_u8 ((luma + cvg * v + cug * u + half) >> XCAM_DNN_YUV_SHIFT);
+            r[x] = (T)clamp_u8 ((luma + cvr * v + half) >> XCAM_DNN_YUV_SHIFT);
+        }
+    }
+}
+
+template <typename T> static void
+resize_bgr_rows (
+    const ImagePlanes &src, const ResizeTable &cols, const ResizeTable &rows,
+    T *dst, uint32_t dst_width, uint32_t dst_height, uint32_t row_begin, uint32_t row_end)
+{
+    const size_t plane_size = (size_t)dst_width * dst_height;
+
+    for (uint32_t y = row_begin; y < row_end; y++) {
+        const uint8_t *row0 = src.y + (size_t)rows.idx0[y] * src.y_stride;
+        const uint8_t *row1 = src.y + (size_t)rows.idx1[y] * src.y_stride;
+        const int32_t wy = rows.weight[y];
+        T *out = dst + (size_t)y * dst_width;
+
+        for (uint32_t x = 0; x < dst_width; x++) {
+            const int32_t x0 = cols.idx0[x] * 3;
+            const int32_t x1 = cols.idx1[x] * 3;
+            const int32_t wx = cols.weight[x];
+            for (uint32_t ch = 0; ch < 3; ch++) {
+                out[plane_size * ch + x] =
+                    (T)bilinear (row0[x0 + ch], row0[x1 + ch], row1[x0 + ch], row1[x1 + ch], wx, wy);
+            }
+        }
+    }
+}
+
+template <typename T> static void
+convert_rows (
+    const ImagePlanes &src, const ResizeTable &cols, const ResizeTable &rows,
+    T *dst, uint32_t dst_width, uint32_t dst_height, uint32_t row_begin, uint32_t row_end)
+{
+    if (src.format == V4L2_PIX_FMT_NV12)
+        convert_nv12_rows (src, cols, rows, dst, dst_width, dst_height, row_begin, row_end);
+    else
+        resize_bgr_rows (src, cols, rows, dst, dst_width, dst_height, row_begin, row_end);
+}
+
+class PreprocessSync {
+public:
+    explicit PreprocessSync (uint32_t count)
+        : _count (count)
+    {}
+
+    void done () {
+        SmartLock locker (_mutex);
+        if (--_count == 0)
+            _cond.broadcast ();
+    }
+
+    void wait () {
+        SmartLock locker (_mutex);
+        while (_count)
+            _cond.wait (_mutex);
+    }
+
+private:
+    XCAM_DEAD_COPY (PreprocessSync);
+
+private:
+    Mutex       _mutex;
+    Cond        _cond;
+    uint32_t    _count;
+};
+
+template <typename T>
+class PlanarConvertTask
+    : public ThreadPool::UserData
+{
+public:
+    PlanarConvertTask (
+        const ImagePlanes &src, const ResizeTable &cols, const ResizeTable &rows,
+        T *dst, uint32_t dst_width, uint32_t dst_height,
+        uint32_t row_begin, uint32_t row_end, const SmartPtr<PreprocessSync> &sync)
+        : _src (src), _cols (cols), _rows (rows)
+        , _dst (dst), _dst_width (dst_width), _dst_height (dst_height)
+        , _row_begin (row_begin), _row_end (row_end), _sync (sync)
+    {}
+
+    virtual XCamReturn run () {
+        convert_rows (_src, _cols, _rows, _dst, _dst_width, _dst_height, _row_begin, _row_end);
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    virtual void done (XCamReturn) {
+        _sync->done ();
+    }
+
+private:
+    const ImagePlanes           _src;
+    const ResizeTable          &_cols;
+    const ResizeTable          &_rows;
+    T                          *_dst;
+    uint32_t                    _dst_width;
+    uint32_t                    _dst_height;
+    uint32_t                    _row_begin;
+    uint32_t                    _row_end;
+    SmartPtr<PreprocessSync>    _sync;
+};
+
+template <typename T> static XCamReturn
+convert_to_planar (
+    const SmartPtr<VideoBuffer>& image, const Rect &crop, T *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    XCAM_ASSERT (image.ptr () && dst);
+
+    const VideoBufferInfo &info = image->get_video_info ();
+    XCAM_FAIL_RETURN (
+        ERROR, (info.format == V4L2_PIX_FMT_NV12 || info.format == V4L2_PIX_FMT_BGR24) && dst_width && dst_height,
+        XCAM_RETURN_ERROR_PARAM,
+        "convert to BGR planar failed, format:%s dst size:%dx%d",
+        xcam_fourcc_to_string (info.format), dst_width, dst_height);
+    XCAM_FAIL_RETURN (
+        ERROR, crop.pos_x >= 0 && crop.pos_y >= 0 && crop.width > 0 && crop.height > 0 &&
+        crop.pos_x + crop.width <= (int32_t)info.width && crop.pos_y + crop.height <= (int32_t)info.height,
+        XCAM_RETURN_ERROR_PARAM,
+        "convert to BGR planar failed, crop(%d, %d, %d, %d) is out of %dx%d",
+        crop.pos_x, crop.pos_y, crop.width, crop.height, info.width, info.height);
+
+    uint8_t *memory = image->map ();
+    XCAM_FAIL_RETURN (
+        ERROR, memory, XCAM_RETURN_ERROR_MEM,
+        "convert to BGR planar failed, map buffer failed");
+
+    ImagePlanes src;
+    src.format = info.format;
+    src.y = memory + info.offsets[0];
+    src.uv = memory + info.offsets[1];
+    src.y_stride = info.strides[0];
+    src.uv_stride = info.strides[1];
+
+    ResizeTable cols (crop.pos_x, crop.width, dst_width);
+    ResizeTable rows (crop.pos_y, crop.height, dst_height);
+
+    SmartPtr<ThreadPool> pool = WorkStealingPool::get_shared_pool ();
+    SmartPtr<WorkStealingPool> stealing = pool.dynamic_cast_ptr<WorkStealingPool> ();
+
+    uint32_t tasks = 1;
+    // a pool thread waiting on its own pool could starve it, convert in place then
+    if (pool.ptr () && !(stealing.ptr () && stealing->is_pool_thread ()))
+        tasks = XCAM_MIN (pool->get_max_threads (), dst_height / XCAM_DNN_PREPROCESS_MIN_ROWS);
+
+    if (tasks <= 1) {
+        convert_rows (src, cols, rows, dst, dst_width, dst_height, 0, dst_height);
+        image->unmap ();
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    SmartPtr<PreprocessSync> sync = new PreprocessSync (tasks);
+    uint32_t queued = 0;
+    for (; queued < tasks; queued++) {
+        uint32_t begin = dst_height * queued / tasks;
+        uint32_t end = dst_height * (queued + 1) / tasks;
+        SmartPtr<ThreadPool::UserData> task =
+            new PlanarConvertTask<T> (src, cols, rows, dst, dst_width, dst_height, begin, end, sync);
+        if (!xcam_ret_is_ok (pool->queue (task)))
+            break;
+    }
+
+    // rows of tasks failed to queue are converted here
+    if (queued < tasks) {
+        XCAM_LOG_WARNING ("convert to BGR planar queued %d of %d tasks", queued, tasks);
+        convert_rows (src, cols, rows, dst, dst_width, dst_height, dst_height * queued / tasks, dst_height);
+        for (uint32_t i = queued; i < tasks; i++)
+            sync->done ();
+    }
+    sync->wait ();
+
+    image->unmap ();
+    return XCAM_RETURN_NO_ERROR;
+}
+
+static Rect
+get_full_rect (const SmartPtr<VideoBuffer>& image)
+{
+    const VideoBufferInfo &info = image->get_video_info ();
+    return Rect (0, 0, info.width, info.height);
+}
+
+XCamReturn
+convert_NV12_to_BGR_planar (const SmartPtr<VideoBuffer>& nv12, uint8_t *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    return convert_to_planar (nv12, get_full_rect (nv12), dst, dst_width, dst_height);
+}
+
+XCamReturn
+convert_NV12_to_BGR_planar (const SmartPtr<VideoBuffer>& nv12, float *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    return convert_to_planar (nv12, get_full_rect (nv12), dst, dst_width, dst_height);
+}
+
+XCamReturn
+convert_to_BGR_planar (
+    const SmartPtr<VideoBuffer>& image, const Rect &crop, uint8_t *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    return convert_to_planar (image, crop, dst, dst_width, dst_height);
+}
+
+XCamReturn
+convert_to_BGR_planar (
+    const SmartPtr<VideoBuffer>& image, const Rect &crop, float *dst, uint32_t dst_width, uint32_t dst_height)
+{
+    return convert_to_planar (image, crop, dst, dst_width, dst_height);
+}
+
 }  // namespace XCam
@@ -25,6 +25,7 @@
 #include <xcam_std.h>
 #include <video_buffer.h>
 #include <vec_mat.h>
+#include <interface/data_types.h>
 
 #include "dnn_inference_engine.h"
 
@@ -55,6 +56,27 @@ convert_NV12_to_BGR (XCam::SmartPtr<XCam::VideoBuffer>& nv12, float x_ratio, flo
 uint8_t*
 resize_BGR (XCam::SmartPtr<XCam::VideoBuffer>& bgr, float x_ratio, float y_ratio);
 
+// nv12 resized into B, G, R planes of dst_width x dst_height in one pass, rows are split over
+// shared threads. result matches cvtColor NV12 to BGR then bilinear resize within rounding
+XCamReturn
+convert_NV12_to_BGR_planar (
+    const XCam::SmartPtr<XCam::VideoBuffer>& nv12, uint8_t *dst, uint32_t dst_width, uint32_t dst_height);
+
+XCamReturn
+convert_NV12_to_BGR_planar (
+    const XCam::SmartPtr<XCam::VideoBuffer>& nv12, float *dst, uint32_t dst_width, uint32_t dst_height);
+
+// @crop of NV12 or BGR24 image resized into B, G, R planes of dst_width x dst_height, threaded as above
+XCamReturn
+convert_to_BGR_planar (
+    const XCam::SmartPtr<XCam::VideoBuffer>& image, const XCam::Rect &crop,
+    uint8_t *dst, uint32_t dst_width, uint32_t dst_height);
+
+XCamReturn
+convert_to_BGR_planar (
+    const XCam::SmartPtr<XCam::VideoBuffer>& image, const XCam::Rect &crop,
+    float *dst, uint32_t dst_width, uint32_t dst_height);
+
 }  // namespace XCamDNN
 
 #endif  //XCAM_DNN_INFERENCE_UTILS_H
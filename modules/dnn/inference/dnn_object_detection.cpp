@@ -38,7 +38,7 @@ DnnObjectDetection::DnnObjectDetection (DnnInferConfig& config)
 
 DnnObjectDetection::~DnnObjectDetection ()
 {
-
+    wait_all ();
 }
 
 XCamReturn
@@ -226,26 +226,22 @@ DnnObjectDetection::get_bounding_boxes (const std::vector<float*> result_ptr,
     uint32_t image_width = get_input_image_width (idx);
     uint32_t image_height = get_input_image_height (idx);
 
-    uint32_t max_proposal_count = (output_infos.object_size[0] == -1) ? _infer_request.get_output_tensor(0).get_shape ()[0] : output_infos.object_size[0];
     uint32_t channels = output_infos.channels[0];
+    if (get_output_size () == 1) {
+        // detections of all images of the batch share one list
+        uint32_t rows = get_infer_request ().get_output_tensor (0).get_size () / channels;
+        parse_detection_output (result_ptr[0], rows, channels, idx, image_width, image_height, boxes, classes);
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    uint32_t max_proposal_count = (output_infos.object_size[0] == -1) ? get_infer_request ().get_output_tensor(0).get_shape ()[0] : output_infos.object_size[0];
     uint32_t stride = max_proposal_count * channels;
 
     uint32_t box_count = 0;
     for (uint32_t cur_proposal = 0; cur_proposal < max_proposal_count; cur_proposal++) {
         float label = 0, confidence = 0, xmin = 0, ymin = 0, xmax = 0, ymax = 0;
 
-        if (get_output_size () == 1) {
-            float image_id = result_ptr[0][idx * stride + cur_proposal * channels + 0];
-            if (image_id < 0) {
-                break;
-            }
-            label = result_ptr[0][idx * stride + cur_proposal * channels + 1];
-            confidence = result_ptr[0][idx * stride + cur_proposal * channels + 2];
-            xmin = result_ptr[0][idx * stride + cur_proposal * channels + 3] * image_width;
-            ymin = result_ptr[0][idx * stride + cur_proposal * channels + 4] * image_height;
-            xmax = result_ptr[0][idx * stride + cur_proposal * channels + 5] * image_width;
-            ymax = result_ptr[0][idx * stride + cur_proposal * channels + 6] * image_height;
-        } else if (get_output_size () == 2) {
+        if (get_output_size () == 2) {
             label = result_ptr[1][idx * max_proposal_count + cur_proposal * channels + 0];
             confidence = result_ptr[0][idx * stride + cur_proposal * channels + 4];
             xmin = result_ptr[0][idx * stride + cur_proposal * channels + 0] * image_width;
@@ -274,4 +270,43 @@ DnnObjectDetection::get_bounding_boxes (const std::vector<float*> result_ptr,
     return XCAM_RETURN_NO_ERROR;
 }
 
+void
+DnnObjectDetection::parse_detection_output (const float *result, uint32_t rows, uint32_t channels,
+        uint32_t idx, uint32_t image_width, uint32_t image_height,
+        std::vector<Vec4i> &boxes,
+        std::vector<int32_t> &classes)
+{
+    XCAM_ASSERT (result && channels >= 7);
+
+    for (uint32_t cur_proposal = 0; cur_proposal < rows; cur_proposal++) {
+        const float *proposal = result + cur_proposal * channels;
+        float image_id = proposal[0];
+        if (image_id < 0) {
+            break;
+        }
+        if (static_cast<uint32_t>(image_id) != idx) {
+            continue;
+        }
+
+        float label = proposal[1];
+        float confidence = proposal[2];
+        float xmin = proposal[3] * image_width;
+        float ymin = proposal[4] * image_height;
+        float xmax = proposal[5] * image_width;
+        float ymax = proposal[6] * image_height;
+
+        if (confidence > 0.5) {
+            classes.push_back(static_cast<int32_t>(label));
+            boxes.push_back (Vec4i ( static_cast<int32_t>(xmin),
+                                     static_cast<int32_t>(ymin),
+                                     static_cast<int32_t>(xmax - xmin),
+                                     static_cast<int32_t>(ymax - ymin) ));
+
+            XCAM_LOG_DEBUG ("Image:%d proposal:%d label:%d confidence:%f", idx, cur_proposal, classes.back (), confidence);
+            XCAM_LOG_DEBUG ("Boxes {%d, %d, %d, %d}",
+                            boxes.back ()[0], boxes.back ()[1], boxes.back ()[2], boxes.back ()[3]);
+        }
+    }
+}
+
 }  // namespace XCam
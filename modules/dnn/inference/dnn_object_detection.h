@@ -50,6 +50,13 @@ public:
                                    std::vector<Vec4i> &boxes,
                                    std::vector<int32_t> &classes);
 
+    // boxes of image @idx from DetectionOutput list [1, 1, N * keep_top_k, 7] of a batch of N,
+    // rows of all images are in one list, image_id -1 terminates it
+    static void parse_detection_output (const float *result, uint32_t rows, uint32_t channels,
+                                        uint32_t idx, uint32_t image_width, uint32_t image_height,
+                                        std::vector<Vec4i> &boxes,
+                                        std::vector<int32_t> &classes);
+
 protected:
     virtual XCamReturn set_output_layer_type (const char* type);
 };
@@ -0,0 +1,395 @@
+/*
+ * dnn_roi_detection.cpp -  object detection on regions of interest of a frame
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "dnn_roi_detection.h"
+
+namespace XCam {
+
+static inline int64_t
+rect_area (const Rect &rect)
+{
+    return (int64_t)rect.width * rect.height;
+}
+
+static inline bool
+rects_overlap (const Rect &a, const Rect &b)
+{
+    return a.pos_x < b.pos_x + b.width && b.pos_x < a.pos_x + a.width &&
+           a.pos_y < b.pos_y + b.height && b.pos_y < a.pos_y + a.height;
+}
+
+static inline Rect
+union_rect (const Rect &a, const Rect &b)
+{
+    int32_t x0 = XCAM_MIN (a.pos_x, b.pos_x);
+    int32_t y0 = XCAM_MIN (a.pos_y, b.pos_y);
+    int32_t x1 = XCAM_MAX (a.pos_x + a.width, b.pos_x + b.width);
+    int32_t y1 = XCAM_MAX (a.pos_y + a.height, b.pos_y + b.height);
+    return Rect (x0, y0, x1 - x0, y1 - y0);
+}
+
+// grows rect by margin and up to min size around its center, then moves and clips it into frame
+static Rect
+expand_rect (const Rect &rect, int32_t margin, int32_t min_size, int32_t width, int32_t height)
+{
+    int32_t x = rect.pos_x - margin;
+    int32_t y = rect.pos_y - margin;
+    int32_t w = rect.width + margin * 2;
+    int32_t h = rect.height + margin * 2;
+
+    if (w < min_size) {
+        x -= (min_size - w) / 2;
+        w = min_size;
+    }
+    if (h < min_size) {
+        y -= (min_size - h) / 2;
+        h = min_size;
+    }
+
+    x = XCAM_CLAMP (x, 0, XCAM_MAX (width - w, 0));
+    y = XCAM_CLAMP (y, 0, XCAM_MAX (height - h, 0));
+    return Rect (x, y, XCAM_MIN (w, width - x), XCAM_MIN (h, height - y));
+}
+
+// overlapping rects are merged, then pairs of least extra area until count fits in one batch
+static void
+merge_rects (std::vector<Rect> &rects, uint32_t max_count)
+{
+    while (true) {
+        for (size_t i = 0; i < rects.size (); i++) {
+            for (size_t j = i + 1; j < rects.size (); ) {
+                if (rects_overlap (rects[i], rects[j])) {
+                    rects[i] = union_rect (rects[i], rects[j]);
+                    rects.erase (rects.begin () + j);
+                    j = i + 1;
+                } else {
+                    j++;
+                }
+            }
+        }
+
+        if (rects.size () <= max_count)
+            break;
+
+        size_t best_i = 0, best_j = 1;
+        int64_t best_cost = -1;
+        for (size_t i = 0; i < rects.size (); i++) {
+            for (size_t j = i + 1; j < rects.size (); j++) {
+                int64_t cost = rect_area (union_rect (rects[i], rects[j])) - rect_area (rects[i]) - rect_area (rects[j]);
+                if (best_cost < 0 || cost < best_cost) {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        rects[best_i] = union_rect (rects[best_i], rects[best_j]);
+        rects.erase (rects.begin () + best_j);
+    }
+}
+
+DnnRoiDetector::DnnRoiDetector (const SmartPtr<DnnObjectDetection> &detector, const DnnRoiConfig &config)
+    : _detector (detector)
+    , _config (config)
+    , _frame_count (0)
+    , _frame_width (0)
+    , _frame_height (0)
+    , _thumb_width (0)
+    , _thumb_height (0)
+{
+    XCAM_ASSERT (detector.ptr ());
+
+    _config.block_size = XCAM_ALIGN_UP (XCAM_MAX (_config.block_size, 8u), 4);
+}
+
+DnnRoiDetector::~DnnRoiDetector ()
+{
+}
+
+void
+DnnRoiDetector::reset ()
+{
+    _frame_count = 0;
+    _reference.clear ();
+    _rois.clear ();
+    _boxes.clear ();
+    _classes.clear ();
+}
+
+XCamReturn
+DnnRoiDetector::detect (
+    const SmartPtr<VideoBuffer> &frame,
+    std::vector<Vec4i> &boxes, std::vector<int32_t> &classes)
+{
+    XCAM_ASSERT (frame.ptr ());
+    XCAM_FAIL_RETURN (
+        ERROR, _detector->ready_to_start (), XCAM_RETURN_ERROR_ORDER,
+        "DnnRoiDetector detect failed, please load the model firstly");
+
+    size_t batch_size = _detector->get_batch_size ();
+    XCAM_FAIL_RETURN (
+        ERROR, batch_size > 0 && batch_size != (size_t)-1, XCAM_RETURN_ERROR_PARAM,
+        "DnnRoiDetector detect failed, invalid model batch size");
+
+    const VideoBufferInfo &info = frame->get_video_info ();
+    if (info.width != _frame_width || info.height != _frame_height) {
+        reset ();
+        _frame_width = info.width;
+        _frame_height = info.height;
+    }
+
+    XCamReturn ret = update_thumbnail (frame);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
+
+    bool full_frame = _reference.empty () ||
+                      (_config.refresh_interval && _frame_count % _config.refresh_interval == 0);
+    if (!full_frame)
+        full_frame = !find_rois (info.width, info.height, (uint32_t)batch_size);
+    if (full_frame) {
+        _rois.clear ();
+        _rois.push_back (Rect (0, 0, info.width, info.height));
+    }
+    _frame_count++;
+
+    if (!_rois.empty ()) {
+        ret = infer_rois (frame);
+        if (!xcam_ret_is_ok (ret)) {
+            // reference is dropped, next frame is detected on full frame
+            _reference.clear ();
+            return ret;
+        }
+    }
+
+    XCAM_LOG_DEBUG ("DnnRoiDetector frame:%d rois:%d boxes:%d %s",
+                    _frame_count, (uint32_t)_rois.size (), (uint32_t)_boxes.size (), full_frame ? "full frame" : "");
+
+    boxes = _boxes;
+    classes = _classes;
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+DnnRoiDetector::update_thumbnail (const SmartPtr<VideoBuffer> &frame)
+{
+    const VideoBufferInfo &info = frame->get_video_info ();
+    XCAM_FAIL_RETURN (
+        ERROR, info.format == V4L2_PIX_FMT_NV12 || info.format == V4L2_PIX_FMT_BGR24,
+        XCAM_RETURN_ERROR_PARAM,
+        "DnnRoiDetector unsupported frame format:%s", xcam_fourcc_to_string (info.format));
+
+    _thumb_width = info.width / 4;
+    _thumb_height = info.height / 4;
+    XCAM_FAIL_RETURN (
+        ERROR, _thumb_width && _thumb_height, XCAM_RETURN_ERROR_PARAM,
+        "DnnRoiDetector frame size(%dx%d) is too small", info.width, info.height);
+    _thumb.resize (_thumb_width * _thumb_height);
+
+    uint8_t *memory = frame->map ();
+    if (NULL == memory) {
+        XCAM_LOG_ERROR ("DnnRoiDetector map frame failed");
+        frame->unmap ();
+        return XCAM_RETURN_ERROR_MEM;
+    }
+
+    // luma of NV12 or (B + 2G + R) / 4 of BGR24
+    for (uint32_t ty = 0; ty < _thumb_height; ty++) {
+        const uint8_t *src = memory + info.offsets[0] + ty * 4 * info.strides[0];
+        uint8_t *dst = &_thumb[ty * _thumb_width];
+        if (info.format == V4L2_PIX_FMT_NV12) {
+            for (uint32_t tx = 0; tx < _thumb_width; tx++)
+                dst[tx] = src[tx * 4];
+        } else {
+            for (uint32_t tx = 0; tx < _thumb_width; tx++) {
+                const uint8_t *bgr = src + tx * 12;
+                dst[tx] = (uint8_t)((bgr[0] + bgr[1] * 2 + bgr[2]) >> 2);
+            }
+        }
+    }
+    frame->unmap ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+bool
+DnnRoiDetector::find_rois (uint32_t frame_width, uint32_t frame_height, uint32_t max_rois)
+{
+    uint32_t thumb_block = _config.block_size / 4;
+    uint32_t grid_width = (_thumb_width + thumb_block - 1) / thumb_block;
+    uint32_t grid_height = (_thumb_height + thumb_block - 1) / thumb_block;
+
+    std::vector<uint8_t> moving (grid_width * grid_height, 0);
+    for (uint32_t gy = 0; gy < grid_height; gy++) {
+        uint32_t y_end = XCAM_MIN ((gy + 1) * thumb_block, _thumb_height);
+        for (uint32_t gx = 0; gx < grid_width; gx++) {
+            uint32_t x_end = XCAM_MIN ((gx + 1) * thumb_block, _thumb_width);
+            uint32_t sum = 0, count = 0;
+            for (uint32_t y = gy * thumb_block; y < y_end; y++) {
+                const uint8_t *cur = &_thumb[y * _thumb_width];
+                const uint8_t *ref = &_reference[y * _thumb_width];
+                for (uint32_t x = gx * thumb_block; x < x_end; x++)
+                    sum += abs ((int32_t)cur[x] - (int32_t)ref[x]);
+                count += x_end - gx * thumb_block;
+            }
+            moving[gy * grid_width + gx] = (sum > _config.diff_threshold * count);
+        }
+    }
+
+    // 8-connected moving blocks form one roi, flags are cleared once visited
+    std::vector<Rect> rects;
+    std::vector<uint32_t> stack;
+    for (uint32_t start = 0; start < moving.size (); start++) {
+        if (!moving[start])
+            continue;
+
+        uint32_t x0 = start % grid_width, x1 = x0;
+        uint32_t y0 = start / grid_width, y1 = y0;
+        moving[start] = 0;
+        stack.push_back (start);
+        while (!stack.empty ()) {
+            uint32_t cur = stack.back ();
+            stack.pop_back ();
+            int32_t cx = cur % grid_width, cy = cur / grid_width;
+            x0 = XCAM_MIN (x0, (uint32_t)cx);
+            x1 = XCAM_MAX (x1, (uint32_t)cx);
+            y0 = XCAM_MIN (y0, (uint32_t)cy);
+            y1 = XCAM_MAX (y1, (uint32_t)cy);
+
+            for (int32_t ny = cy - 1; ny <= cy + 1; ny++) {
+                for (int32_t nx = cx - 1; nx <= cx + 1; nx++) {
+                    if (nx < 0 || ny < 0 || nx >= (int32_t)grid_width || ny >= (int32_t)grid_height)
+                        continue;
+                    uint32_t next = ny * grid_width + nx;
+                    if (moving[next]) {
+                        moving[next] = 0;
+                        stack.push_back (next);
+                    }
+                }
+            }
+        }
+
+        // scattered motion is cheaper on full frame
+        if (rects.size () >= DNN_ROI_MAX_REGIONS)
+            return false;
+
+        uint32_t block = _config.block_size;
+        Rect region (x0 * block, y0 * block, (x1 - x0 + 1) * block, (y1 - y0 + 1) * block);
+        rects.push_back (expand_rect (region, _config.margin, _config.min_size, frame_width, frame_height));
+    }
+
+    for (size_t i = 0; i < _fixed_rois.size (); i++)
+        rects.push_back (expand_rect (_fixed_rois[i], 0, 0, frame_width, frame_height));
+
+    merge_rects (rects, max_rois);
+
+    int64_t area = 0;
+    for (size_t i = 0; i < rects.size (); i++)
+        area += rect_area (rects[i]);
+    if (area > (int64_t)(_config.max_area * frame_width * frame_height))
+        return false;
+
+    _rois.swap (rects);
+    return true;
+}
+
+XCamReturn
+DnnRoiDetector::infer_rois (const SmartPtr<VideoBuffer> &frame)
+{
+    XCamReturn ret = _detector->set_inference_data (frame, _rois);
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "DnnRoiDetector set %d rois to detector failed", (uint32_t)_rois.size ());
+
+    ret = _detector->start (true);
+    XCAM_FAIL_RETURN (ERROR, xcam_ret_is_ok (ret), ret, "DnnRoiDetector inference failed");
+
+    std::vector<float*> result_ptr;
+    uint32_t blob_size = 0;
+    for (uint32_t output_idx = 0; output_idx < _detector->get_output_size (); output_idx ++) {
+        result_ptr.push_back ((float*)_detector->get_inference_results (output_idx, blob_size));
+    }
+
+    // cached boxes centered out of inferred rois are still valid
+    std::vector<Vec4i> boxes;
+    std::vector<int32_t> classes;
+    for (size_t i = 0; i < _boxes.size (); i++) {
+        int32_t cx = _boxes[i][0] + _boxes[i][2] / 2;
+        int32_t cy = _boxes[i][1] + _boxes[i][3] / 2;
+        bool inferred = false;
+        for (size_t r = 0; r < _rois.size () && !inferred; r++) {
+            inferred = cx >= _rois[r].pos_x && cx < _rois[r].pos_x + _rois[r].width &&
+                       cy >= _rois[r].pos_y && cy < _rois[r].pos_y + _rois[r].height;
+        }
+        if (!inferred) {
+            boxes.push_back (_boxes[i]);
+            classes.push_back (_classes[i]);
+        }
+    }
+
+    // rois fill leading batch slots, boxes are picked by image id so stale slots are skipped
+    for (uint32_t idx = 0; idx < _rois.size (); idx++) {
+        std::vector<Vec4i> roi_boxes;
+        std::vector<int32_t> roi_classes;
+        ret = _detector->get_bounding_boxes (result_ptr, idx, roi_boxes, roi_classes);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret), ret,
+            "DnnRoiDetector get bounding boxes of roi:%d failed", idx);
+
+        for (size_t i = 0; i < roi_boxes.size (); i++) {
+            Vec4i box = roi_boxes[i];
+            box[0] += _rois[idx].pos_x;
+            box[1] += _rois[idx].pos_y;
+            boxes.push_back (box);
+            classes.push_back (roi_classes[i]);
+        }
+    }
+
+    _boxes.swap (boxes);
+    _classes.swap (classes);
+    update_reference ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+void
+DnnRoiDetector::update_reference ()
+{
+    if (_reference.size () != _thumb.size ()) {
+        _reference = _thumb;
+        return;
+    }
+
+    // only inferred pixels move reference, slow changes elsewhere keep accumulating
+    for (size_t r = 0; r < _rois.size (); r++) {
+        const Rect &roi = _rois[r];
+        uint32_t x0 = roi.pos_x / 4;
+        uint32_t y0 = roi.pos_y / 4;
+        uint32_t x1 = XCAM_MIN ((uint32_t)(roi.pos_x + roi.width + 3) / 4, _thumb_width);
+        uint32_t y1 = XCAM_MIN ((uint32_t)(roi.pos_y + roi.height + 3) / 4, _thumb_height);
+        if (x0 >= x1)
+            continue;
+
+        for (uint32_t y = y0; y < y1; y++) {
+            memcpy (&_reference[y * _thumb_width + x0], &_thumb[y * _thumb_width + x0], x1 - x0);
+        }
+    }
+}
+
+}  // namespace XCam
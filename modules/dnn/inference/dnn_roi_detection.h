@@ -0,0 +1,122 @@
+/*
+ * dnn_roi_detection.h -  object detection on regions of interest of a frame
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_DNN_ROI_DETECTION_H
+#define XCAM_DNN_ROI_DETECTION_H
+
+#pragma once
+
+#include <xcam_std.h>
+#include <vec_mat.h>
+#include <interface/data_types.h>
+#include "dnn_object_detection.h"
+
+#define DNN_ROI_DEFAULT_REFRESH_INTERVAL 30
+#define DNN_ROI_DEFAULT_BLOCK_SIZE 32
+#define DNN_ROI_DEFAULT_DIFF_THRESHOLD 12
+#define DNN_ROI_DEFAULT_MARGIN 16
+#define DNN_ROI_DEFAULT_MIN_SIZE 128
+#define DNN_ROI_DEFAULT_MAX_AREA 0.5f
+#define DNN_ROI_MAX_REGIONS 32
+
+namespace XCam {
+
+struct DnnRoiConfig {
+    // full frame detection every refresh_interval frames, 0 detects full frame on first frame only
+    uint32_t    refresh_interval;
+    // motion block in pixels, multiple of 4
+    uint32_t    block_size;
+    // mean absolute luma difference of a moving block
+    uint32_t    diff_threshold;
+    uint32_t    margin;
+    uint32_t    min_size;
+    // rois covering more than max_area of frame fall back to full frame
+    float       max_area;
+
+    DnnRoiConfig ()
+        : refresh_interval (DNN_ROI_DEFAULT_REFRESH_INTERVAL)
+        , block_size (DNN_ROI_DEFAULT_BLOCK_SIZE)
+        , diff_threshold (DNN_ROI_DEFAULT_DIFF_THRESHOLD)
+        , margin (DNN_ROI_DEFAULT_MARGIN)
+        , min_size (DNN_ROI_DEFAULT_MIN_SIZE)
+        , max_area (DNN_ROI_DEFAULT_MAX_AREA)
+    {}
+};
+
+/*
+ * runs detection only on regions of a frame which changed since they were last inferred.
+ * changes are found by block difference of a 1/4 luma thumbnail against the reference one,
+ * moving blocks are grouped into rois which are cropped into batch slots of one inference,
+ * boxes are mapped back to frame coordinates and replace cached boxes centered in the rois.
+ * static frames return cached boxes without inference.
+ * frames are NV12 or BGR24, detector is used synchronously and must not be shared with submit.
+ */
+class DnnRoiDetector
+{
+public:
+    explicit DnnRoiDetector (const SmartPtr<DnnObjectDetection> &detector, const DnnRoiConfig &config = DnnRoiConfig ());
+    virtual ~DnnRoiDetector ();
+
+    // rois inferred on every frame besides moving ones, e.g. stitching seams, in frame coordinates
+    void set_fixed_rois (const std::vector<Rect> &rois) {
+        _fixed_rois = rois;
+    }
+    // rois inferred on last frame, one frame sized roi on full frame detection
+    const std::vector<Rect> &get_rois () const {
+        return _rois;
+    }
+
+    // drops cached boxes and reference, next frame is detected on full frame
+    void reset ();
+
+    XCamReturn detect (
+        const SmartPtr<VideoBuffer> &frame,
+        std::vector<Vec4i> &boxes, std::vector<int32_t> &classes);
+
+private:
+    XCamReturn update_thumbnail (const SmartPtr<VideoBuffer> &frame);
+    bool find_rois (uint32_t frame_width, uint32_t frame_height, uint32_t max_rois);
+    XCamReturn infer_rois (const SmartPtr<VideoBuffer> &frame);
+    void update_reference ();
+
+    XCAM_DEAD_COPY (DnnRoiDetector);
+
+private:
+    SmartPtr<DnnObjectDetection>    _detector;
+    DnnRoiConfig                    _config;
+    uint32_t                        _frame_count;
+    uint32_t                        _frame_width;
+    uint32_t                        _frame_height;
+
+    // luma of every 4th pixel, reference holds thumbnail of last inferred pixels
+    uint32_t                        _thumb_width;
+    uint32_t                        _thumb_height;
+    std::vector<uint8_t>            _thumb;
+    std::vector<uint8_t>            _reference;
+
+    std::vector<Rect>               _fixed_rois;
+    std::vector<Rect>               _rois;
+    std::vector<Vec4i>              _boxes;
+    std::vector<int32_t>            _classes;
+};
+
+}  // namespace XCam
+
+#endif // XCAM_DNN_ROI_DETECTION_H
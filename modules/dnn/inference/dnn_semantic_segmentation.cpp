@@ -38,7 +38,7 @@ DnnSemanticSegmentation::DnnSemanticSegmentation (DnnInferConfig& config)
 
 DnnSemanticSegmentation::~DnnSemanticSegmentation ()
 {
-
+    wait_all ();
 }
 
 XCamReturn
@@ -267,7 +267,7 @@ DnnSemanticSegmentation::get_segmentation_map (const std::vector<float*> result_
         uint32_t map_width = input_infos.width[0];
         uint32_t map_height = input_infos.height[0];
         uint32_t channels = output_infos.channels[1];
-        uint32_t max_proposal_count = _infer_request.get_output_tensor(0).get_shape ()[0];
+        uint32_t max_proposal_count = get_infer_request ().get_output_tensor(0).get_shape ()[0];
         uint32_t stride0 = max_proposal_count;
         uint32_t stride1 = max_proposal_count * channels;
         uint32_t stride2 = max_proposal_count * output_infos.width[2] * output_infos.height[2];
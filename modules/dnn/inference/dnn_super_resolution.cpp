@@ -19,6 +19,7 @@
  * Author: Ali Mansouri <ali.m.t1992@gmail.com>
  */
 
+#include <algorithm>
 #include <openvino/openvino.hpp>
 
 #include "dnn_super_resolution.h"
@@ -29,6 +30,140 @@ using namespace ov;
 
 namespace XCam {
 
+// tiles are spread evenly over @size, neighbours overlap by at least @overlap
+static void
+get_tile_positions (uint32_t size, uint32_t tile, uint32_t overlap, std::vector<uint32_t> &pos)
+{
+    uint32_t step = tile - overlap;
+    uint32_t count = (size <= tile) ? 1 : (size - overlap + step - 1) / step;
+
+    pos.resize (count);
+    for (uint32_t i = 0; i < count; i++)
+        pos[i] = (count == 1) ? 0 : (uint32_t)((uint64_t)(size - tile) * i / (count - 1));
+}
+
+// weight rises from tile edges over @ramp pixels, never zero so pixels covered by one tile keep their value
+static void
+get_feather_weights (uint32_t size, uint32_t ramp, std::vector<float> &weights)
+{
+    weights.resize (size);
+    for (uint32_t i = 0; i < size; i++) {
+        uint32_t dist = XCAM_MIN (XCAM_MIN (i, size - 1 - i), ramp);
+        weights[i] = (dist + 1.0f) / (ramp + 1.0f);
+    }
+}
+
+// BGR packed tile into B, G, R planes
+template <typename T> static void
+copy_tile_to_tensor (
+    const uint8_t *image, uint32_t stride, uint32_t x, uint32_t y,
+    uint32_t width, uint32_t height, T *tensor)
+{
+    const size_t plane_size = (size_t)width * height;
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *src = image + (size_t)(y + row) * stride + x * 3;
+        T *dst = tensor + (size_t)row * width;
+        for (uint32_t col = 0; col < width; col++) {
+            dst[col] = src[col * 3];
+            dst[plane_size + col] = src[col * 3 + 1];
+            dst[plane_size * 2 + col] = src[col * 3 + 2];
+        }
+    }
+}
+
+// bilinear upscaled tile for models taking an interpolated image as second input
+template <typename T> static void
+resize_tile_to_tensor (
+    const uint8_t *image, uint32_t stride, uint32_t x, uint32_t y,
+    uint32_t width, uint32_t height, T *tensor, uint32_t dst_width, uint32_t dst_height)
+{
+    const size_t plane_size = (size_t)dst_width * dst_height;
+    const float x_scale = float(width) / float(dst_width);
+    const float y_scale = float(height) / float(dst_height);
+
+    for (uint32_t row = 0; row < dst_height; row++) {
+        float sy = XCAM_CLAMP ((row + 0.5f) * y_scale - 0.5f, 0.0f, float(height - 1));
+        uint32_t y0 = (uint32_t)sy;
+        uint32_t y1 = XCAM_MIN (y0 + 1, height - 1);
+        float fy = sy - y0;
+        const uint8_t *src0 = image + (size_t)(y + y0) * stride + x * 3;
+        const uint8_t *src1 = image + (size_t)(y + y1) * stride + x * 3;
+        T *dst = tensor + (size_t)row * dst_width;
+
+        for (uint32_t col = 0; col < dst_width; col++) {
+            float sx = XCAM_CLAMP ((col + 0.5f) * x_scale - 0.5f, 0.0f, float(width - 1));
+            uint32_t x0 = (uint32_t)sx;
+            uint32_t x1 = XCAM_MIN (x0 + 1, width - 1);
+            float fx = sx - x0;
+            for (uint32_t ch = 0; ch < 3; ch++) {
+                float top = src0[x0 * 3 + ch] * (1.0f - fx) + src0[x1 * 3 + ch] * fx;
+                float bottom = src1[x0 * 3 + ch] * (1.0f - fx) + src1[x1 * 3 + ch] * fx;
+                dst[plane_size * ch + col] = (T)(top * (1.0f - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+}
+
+template <typename T> static void
+fill_input_tensor (
+    ov::Tensor &tensor, uint32_t batch_idx, const uint8_t *image, uint32_t stride,
+    uint32_t x, uint32_t y, uint32_t tile_width, uint32_t tile_height)
+{
+    const ov::Shape shape = tensor.get_shape ();
+    T *data = tensor.data<T> () + (size_t)batch_idx * shape[1] * shape[2] * shape[3];
+
+    if (shape[3] == tile_width && shape[2] == tile_height)
+        copy_tile_to_tensor (image, stride, x, y, tile_width, tile_height, data);
+    else
+        resize_tile_to_tensor (image, stride, x, y, tile_width, tile_height, data, shape[3], shape[2]);
+}
+
+static void
+fill_input_tensor (
+    ov::Tensor &tensor, uint32_t batch_idx, const uint8_t *image, uint32_t stride,
+    uint32_t x, uint32_t y, uint32_t tile_width, uint32_t tile_height)
+{
+    if (tensor.get_element_type () == ov::element::f32)
+        fill_input_tensor<float> (tensor, batch_idx, image, stride, x, y, tile_width, tile_height);
+    else
+        fill_input_tensor<uint8_t> (tensor, batch_idx, image, stride, x, y, tile_width, tile_height);
+}
+
+// band holds weighted B, G, R and weight sum of each pixel
+static void
+accumulate_tile (
+    const float *tile, uint32_t width, uint32_t height,
+    const std::vector<float> &x_weights, const std::vector<float> &y_weights,
+    float *band, uint32_t band_width, uint32_t x)
+{
+    const size_t plane_size = (size_t)width * height;
+    for (uint32_t row = 0; row < height; row++) {
+        const float *src = tile + (size_t)row * width;
+        float *dst = band + ((size_t)row * band_width + x) * 4;
+        for (uint32_t col = 0; col < width; col++, dst += 4) {
+            float weight = x_weights[col] * y_weights[row];
+            dst[0] += src[col] * weight;
+            dst[1] += src[plane_size + col] * weight;
+            dst[2] += src[plane_size * 2 + col] * weight;
+            dst[3] += weight;
+        }
+    }
+}
+
+static void
+flush_band_rows (const float *band, uint32_t width, uint32_t rows, uint8_t *out, uint32_t stride)
+{
+    for (uint32_t row = 0; row < rows; row++) {
+        const float *src = band + (size_t)row * width * 4;
+        uint8_t *dst = out + (size_t)row * stride;
+        for (uint32_t col = 0; col < width; col++, src += 4) {
+            float scale = 255.0f / src[3];
+            for (uint32_t ch = 0; ch < 3; ch++)
+                dst[col * 3 + ch] = (uint8_t)XCAM_CLAMP (src[ch] * scale + 0.5f, 0.0f, 255.0f);
+        }
+    }
+}
+
 DnnSuperResolution::DnnSuperResolution (DnnInferConfig& config)
     : DnnInferenceEngine (config)
 {
@@ -39,7 +174,7 @@ DnnSuperResolution::DnnSuperResolution (DnnInferConfig& config)
 
 DnnSuperResolution::~DnnSuperResolution ()
 {
-
+    wait_all ();
 }
 
 XCamReturn
@@ -178,4 +313,147 @@ DnnSuperResolution::set_model_output_info (DnnInferInputOutputInfo& info)
     return XCAM_RETURN_NO_ERROR;
 }
 
+uint32_t
+DnnSuperResolution::get_scale ()
+{
+    if (! _model_loaded)
+        return 0;
+
+    const ov::Shape in_shape = get_infer_request ().get_input_tensor (0).get_shape ();
+    const ov::Shape out_shape = get_infer_request ().get_output_tensor (0).get_shape ();
+    if (in_shape.size () != 4 || out_shape.size () != 4 || !in_shape[2])
+        return 0;
+
+    return out_shape[2] / in_shape[2];
+}
+
+XCamReturn
+DnnSuperResolution::process_tiled (
+    const SmartPtr<VideoBuffer> &input, const SmartPtr<VideoBuffer> &output, uint32_t overlap)
+{
+    if (! _model_loaded) {
+        XCAM_LOG_ERROR ("Please load the model firstly!");
+        return XCAM_RETURN_ERROR_ORDER;
+    }
+    XCAM_ASSERT (input.ptr () && output.ptr ());
+
+    ov::InferRequest &request = get_infer_request ();
+    ov::Tensor in_tensor = request.get_input_tensor (0);
+    ov::Tensor out_tensor = request.get_output_tensor (0);
+    const ov::Shape in_shape = in_tensor.get_shape ();
+    const ov::Shape out_shape = out_tensor.get_shape ();
+
+    XCAM_FAIL_RETURN (
+        ERROR, in_shape.size () == 4 && in_shape[1] == 3 && out_shape.size () == 4 && out_shape[1] == 3 &&
+        out_tensor.get_element_type () == ov::element::f32, XCAM_RETURN_ERROR_PARAM,
+        "DnnSuperResolution tiled mode needs N x 3 x H x W input and f32 output");
+
+    const uint32_t batch_size = in_shape[0];
+    const uint32_t tile_width = in_shape[3];
+    const uint32_t tile_height = in_shape[2];
+    const uint32_t scale = get_scale ();
+    const uint32_t out_tile_width = tile_width * scale;
+    const uint32_t out_tile_height = tile_height * scale;
+
+    XCAM_FAIL_RETURN (
+        ERROR, scale && out_shape[3] == out_tile_width && out_shape[2] == out_tile_height, XCAM_RETURN_ERROR_PARAM,
+        "DnnSuperResolution output %dx%d is not integer times of input %dx%d",
+        (uint32_t)out_shape[3], (uint32_t)out_shape[2], tile_width, tile_height);
+    XCAM_FAIL_RETURN (
+        ERROR, overlap < XCAM_MIN (tile_width, tile_height), XCAM_RETURN_ERROR_PARAM,
+        "DnnSuperResolution tile overlap %d is not smaller than tile %dx%d", overlap, tile_width, tile_height);
+
+    const VideoBufferInfo &in_info = input->get_video_info ();
+    const VideoBufferInfo &out_info = output->get_video_info ();
+    XCAM_FAIL_RETURN (
+        ERROR, in_info.format == V4L2_PIX_FMT_BGR24 && out_info.format == V4L2_PIX_FMT_BGR24 &&
+        in_info.width >= tile_width && in_info.height >= tile_height &&
+        out_info.width == in_info.width * scale && out_info.height == in_info.height * scale,
+        XCAM_RETURN_ERROR_PARAM,
+        "DnnSuperResolution tiled mode needs BGR24 input not smaller than %dx%d and output %d times of input",
+        tile_width, tile_height, scale);
+
+    // models like single-image-super-resolution also take the interpolated image
+    ov::Tensor up_tensor;
+    if (get_input_size () > 1) {
+        up_tensor = request.get_input_tensor (1);
+        const ov::Shape up_shape = up_tensor.get_shape ();
+        XCAM_FAIL_RETURN (
+            ERROR, up_shape.size () == 4 && up_shape[0] == batch_size && up_shape[1] == 3,
+            XCAM_RETURN_ERROR_PARAM, "DnnSuperResolution second input is not N x 3 x H x W");
+    }
+
+    std::vector<uint32_t> x_pos, y_pos;
+    get_tile_positions (in_info.width, tile_width, overlap, x_pos);
+    get_tile_positions (in_info.height, tile_height, overlap, y_pos);
+
+    std::vector<float> x_weights, y_weights;
+    get_feather_weights (out_tile_width, overlap * scale, x_weights);
+    get_feather_weights (out_tile_height, overlap * scale, y_weights);
+
+    // one upscaled row of tiles, rows overlapped by next tile row are carried over
+    const uint32_t out_width = out_info.width;
+    std::vector<float> band ((size_t)out_width * out_tile_height * 4, 0.0f);
+
+    XCAM_LOG_DEBUG ("DnnSuperResolution tiled %dx%d into %dx%d tiles of %dx%d, batch:%d",
+                    in_info.width, in_info.height, (uint32_t)x_pos.size (), (uint32_t)y_pos.size (),
+                    tile_width, tile_height, batch_size);
+
+    uint8_t *in_mem = input->map ();
+    uint8_t *out_mem = output->map ();
+    XCamReturn ret = XCAM_RETURN_NO_ERROR;
+    if (!in_mem || !out_mem) {
+        XCAM_LOG_ERROR ("DnnSuperResolution map buffer failed");
+        ret = XCAM_RETURN_ERROR_MEM;
+    }
+
+    const uint8_t *in_image = in_mem + in_info.offsets[0];
+    uint8_t *out_image = out_mem + out_info.offsets[0];
+    const float *out_data = out_tensor.data<float> ();
+    const size_t out_tile_size = (size_t)3 * out_tile_width * out_tile_height;
+
+    for (uint32_t row = 0; row < y_pos.size () && ret == XCAM_RETURN_NO_ERROR; row++) {
+        for (uint32_t first = 0; first < x_pos.size () && ret == XCAM_RETURN_NO_ERROR; first += batch_size) {
+            // a short batch leaves tail of tensors with stale tiles, their results are dropped
+            uint32_t count = XCAM_MIN (batch_size, (uint32_t)x_pos.size () - first);
+            for (uint32_t i = 0; i < count; i++) {
+                fill_input_tensor (in_tensor, i, in_image, in_info.strides[0],
+                                   x_pos[first + i], y_pos[row], tile_width, tile_height);
+                if (up_tensor)
+                    fill_input_tensor (up_tensor, i, in_image, in_info.strides[0],
+                                       x_pos[first + i], y_pos[row], tile_width, tile_height);
+            }
+
+            ret = start (true);
+            if (ret != XCAM_RETURN_NO_ERROR)
+                break;
+
+            for (uint32_t i = 0; i < count; i++) {
+                accumulate_tile (out_data + out_tile_size * i, out_tile_width, out_tile_height,
+                                 x_weights, y_weights, band.data (), out_width, x_pos[first + i] * scale);
+            }
+        }
+        if (ret != XCAM_RETURN_NO_ERROR)
+            break;
+
+        // rows above next tile row are final
+        uint32_t band_y = y_pos[row] * scale;
+        uint32_t next_y = (row + 1 < y_pos.size ()) ? y_pos[row + 1] * scale : out_info.height;
+        uint32_t done_rows = next_y - band_y;
+        flush_band_rows (band.data (), out_width, done_rows,
+                         out_image + (size_t)band_y * out_info.strides[0], out_info.strides[0]);
+
+        size_t row_floats = (size_t)out_width * 4;
+        std::copy (band.begin () + row_floats * done_rows, band.end (), band.begin ());
+        std::fill (band.end () - row_floats * done_rows, band.end (), 0.0f);
+    }
+
+    if (in_mem)
+        input->unmap ();
+    if (out_mem)
+        output->unmap ();
+
+    return ret;
+}
+
 }  // namespace XCam
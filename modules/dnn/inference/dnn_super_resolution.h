@@ -28,6 +28,8 @@
 #include <xcam_std.h>
 #include "dnn_inference_engine.h"
 
+#define DNN_SR_DEFAULT_TILE_OVERLAP 16
+
 namespace XCam {
 
 class DnnSuperResolution
@@ -43,6 +45,17 @@ public:
     virtual XCamReturn set_model_output_info (DnnInferInputOutputInfo& info);
     virtual XCamReturn get_model_output_info (DnnInferInputOutputInfo& info);
 
+    // output size over input size of model, 0 if model is not loaded
+    uint32_t get_scale ();
+
+    // BGR24 input not smaller than model input is split into tiles of model input size overlapping by
+    // @overlap pixels, tiles are inferred in batches of model batch size and upscaled tiles are
+    // feather blended into BGR24 output of scale times input size.
+    // blending goes row by row of tiles, so float memory is bounded to one upscaled tile row
+    XCamReturn process_tiled (
+        const SmartPtr<VideoBuffer> &input, const SmartPtr<VideoBuffer> &output,
+        uint32_t overlap = DNN_SR_DEFAULT_TILE_OVERLAP);
+
 protected:
     virtual XCamReturn set_output_layer_type (const char* type);
 };
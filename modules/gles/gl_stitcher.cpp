@@ -951,7 +951,7 @@ StitcherImpl::gen_geomap_table (
 
     dewarper->set_out_size (view_slice.width, view_slice.height);
     dewarper->set_table_size (table_width, table_height);
-    dewarper->gen_table (map_table);
+    dewarper->gen_table_cached (map_table, _stitcher->get_lut_cache_dir ());
 
     return XCAM_RETURN_NO_ERROR;
 }
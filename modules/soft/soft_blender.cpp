@@ -26,6 +26,7 @@
 #include "soft_blender_tasks_priv.h"
 #include "image_file.h"
 #include "soft_video_buf_allocator.h"
+#include "work_stealing_pool.h"
 #include <map>
 
 #define OVERLAP_POOL_SIZE 6
@@ -41,6 +42,7 @@ DECLARE_WORK_CALLBACK (CbGaussDownScale, SoftBlender, gauss_scale_done);
 DECLARE_WORK_CALLBACK (CbBlendTask, SoftBlender, blend_task_done);
 DECLARE_WORK_CALLBACK (CbReconstructTask, SoftBlender, reconstruct_done);
 DECLARE_WORK_CALLBACK (CbLapTask, SoftBlender, lap_done);
+DECLARE_WORK_CALLBACK (CbPyramidBandTask, SoftBlender, band_task_done);
 
 typedef std::map<void*, SmartPtr<BlendTask::Args>> MapBlendArgs;
 typedef std::map<void*, SmartPtr<ReconstructTask::Args>> MapReconsArgs;
@@ -76,6 +78,12 @@ public:
     SmartPtr<BufferPool>   first_lap_pool;
     SmartPtr<UcharImage>   orig_mask;
 
+    bool                   tiled;
+    uint32_t               band_rows;
+    bool                   fixed_point;
+    uint32_t               inflight_frames;
+    SmartPtr<PyramidBandTask> band_task;
+
     Mutex                  map_args_mutex;
     MapBlendArgs           blend_args;
 
@@ -85,26 +93,53 @@ private:
 public:
     BlenderPrivConfig (SoftBlender *blender, uint32_t level)
         : pyr_levels (level - 1)
+        , tiled (false)
+        , band_rows (XCAM_SOFT_BLENDER_BAND_ROWS)
+        , fixed_point (false)
+        , inflight_frames (1)
         , _blender (blender)
     {}
 
     XCamReturn init_first_masks (uint32_t width, uint32_t height);
     XCamReturn scale_down_masks (uint32_t level, uint32_t width, uint32_t height);
 
+    SmartPtr<GaussDownScale::Args> create_scaler_args (
+        const SmartPtr<ImageHandler::Parameters> &param,
+        const SmartPtr<VideoBuffer> &in_buf,
+        const uint32_t level, const SoftBlender::BufIdx idx);
     XCamReturn start_scaler (
         const SmartPtr<ImageHandler::Parameters> &param,
         const SmartPtr<VideoBuffer> &in_buf,
         const uint32_t level, const SoftBlender::BufIdx idx);
 
+    SmartPtr<LaplaceTask::Args> create_lap_args (
+        const SmartPtr<ImageHandler::Parameters> &param,
+        const uint32_t level, const SoftBlender::BufIdx idx,
+        const SmartPtr<GaussDownScale::Args> &scale_args);
     XCamReturn start_lap_task (
         const SmartPtr<ImageHandler::Parameters> &param,
         const uint32_t level, const SoftBlender::BufIdx idx,
         const SmartPtr<GaussDownScale::Args> &scale_args);
+
+    void set_blend_input (
+        const SmartPtr<BlendTask::Args> &args,
+        const SmartPtr<VideoBuffer> &buf,
+        const SoftBlender::BufIdx idx);
+    XCamReturn set_blend_output (const SmartPtr<BlendTask::Args> &args);
     XCamReturn start_blend_task (
         const SmartPtr<ImageHandler::Parameters> &param,
         const SmartPtr<VideoBuffer> &buf,
         const SoftBlender::BufIdx idx);
 
+    void set_reconstruct_gauss (
+        const SmartPtr<ReconstructTask::Args> &args,
+        const SmartPtr<VideoBuffer> &gauss);
+    void set_reconstruct_lap (
+        const SmartPtr<ReconstructTask::Args> &args,
+        const SmartPtr<VideoBuffer> &lap,
+        const SoftBlender::BufIdx idx);
+    XCamReturn set_reconstruct_output (const SmartPtr<ReconstructTask::Args> &args, const uint32_t level);
+
     XCamReturn start_reconstruct_task_by_lap (
         const SmartPtr<ImageHandler::Parameters> &param,
         const SmartPtr<VideoBuffer> &lap,
@@ -114,6 +149,8 @@ public:
         const SmartPtr<VideoBuffer> &gauss,
         const uint32_t level);
     XCamReturn start_reconstruct_task (const SmartPtr<ReconstructTask::Args> &args, const uint32_t level);
+
+    XCamReturn start_tiled_work (const SmartPtr<ImageHandler::Parameters> &param);
     XCamReturn stop ();
 };
 
@@ -194,6 +231,44 @@ SoftBlender::set_pyr_levels (uint32_t levels)
     return true;
 }
 
+bool
+SoftBlender::set_tiled_mode (bool enable, uint32_t band_rows)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, band_rows > 0 && band_rows % SOFT_BLENDER_ALIGNMENT_Y == 0, false,
+        "blender:%s set_tiled_mode failed, band_rows(%d) must be multiple of %d",
+        XCAM_STR (get_name ()), band_rows, SOFT_BLENDER_ALIGNMENT_Y);
+
+    _priv_config->tiled = enable;
+    _priv_config->band_rows = band_rows;
+    return true;
+}
+
+bool
+SoftBlender::set_fixed_point (bool enable)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !_priv_config->last_level_blend.ptr (), false,
+        "blender:%s set_fixed_point must be called before configure", XCAM_STR (get_name ()));
+
+    _priv_config->fixed_point = enable;
+    return true;
+}
+
+bool
+SoftBlender::set_inflight_frames (uint32_t frames)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, frames > 0, false,
+        "blender:%s set_inflight_frames failed, frames must be larger than 0", XCAM_STR (get_name ()));
+    XCAM_FAIL_RETURN (
+        ERROR, !_priv_config->last_level_blend.ptr (), false,
+        "blender:%s set_inflight_frames must be called before configure", XCAM_STR (get_name ()));
+
+    _priv_config->inflight_frames = frames;
+    return true;
+}
+
 XCamReturn
 SoftBlender::terminate ()
 {
@@ -250,20 +325,18 @@ SoftBlenderPriv::BlenderPrivConfig::stop ()
         last_level_blend.release ();
     }
 
+    if (band_task.ptr ()) {
+        band_task->stop ();
+        band_task.release ();
+    }
+
     return XCAM_RETURN_NO_ERROR;
 }
 
-XCamReturn
-SoftBlenderPriv::BlenderPrivConfig::init_first_masks (uint32_t width, uint32_t height)
+void
+gen_soft_blend_mask (uint32_t width, std::vector<uint8_t> &mask)
 {
-    uint32_t aligned_width = XCAM_ALIGN_UP (width, SOFT_BLENDER_ALIGNMENT_X);
-
-    orig_mask = new UcharImage (
-        width, height, aligned_width);
-    XCAM_ASSERT (orig_mask.ptr ());
-    XCAM_ASSERT (orig_mask->is_valid ());
     std::vector<float> gauss_table;
-    std::vector<Uchar> mask_line;
     uint32_t i = 0, j = 0;
 
     uint32_t quater = width / 4;
@@ -275,17 +348,31 @@ SoftBlenderPriv::BlenderPrivConfig::init_first_masks (uint32_t width, uint32_t h
         gauss_table[i] = value;
     }
 
-    mask_line.resize (aligned_width);
+    mask.resize (width);
     uint32_t gauss_start_pos = (width - gauss_table.size ()) / 2;
     for (i = 0; i < gauss_start_pos; ++i) {
-        mask_line[i] = 255;
+        mask[i] = 255;
     }
     for (j = 0; j < gauss_table.size (); ++i, ++j) {
-        mask_line[i] = (Uchar)gauss_table[j];
+        mask[i] = (uint8_t)gauss_table[j];
     }
-    for (; i < mask_line.size (); ++i) {
-        mask_line[i] = 0;
+    for (; i < mask.size (); ++i) {
+        mask[i] = 0;
     }
+}
+
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::init_first_masks (uint32_t width, uint32_t height)
+{
+    uint32_t aligned_width = XCAM_ALIGN_UP (width, SOFT_BLENDER_ALIGNMENT_X);
+
+    orig_mask = new UcharImage (
+        width, height, aligned_width);
+    XCAM_ASSERT (orig_mask.ptr ());
+    XCAM_ASSERT (orig_mask->is_valid ());
+    std::vector<uint8_t> mask_line;
+    gen_soft_blend_mask (width, mask_line);
+    mask_line.resize (aligned_width, 0);
 
     for (uint32_t h = 0; h < height; ++h) {
         Uchar *ptr = orig_mask->get_buf_ptr (0, h);
@@ -323,21 +410,45 @@ SoftBlenderPriv::BlenderPrivConfig::scale_down_masks (uint32_t level, uint32_t w
     return ret;
 }
 
-XCamReturn
-SoftBlenderPriv::BlenderPrivConfig::start_scaler (
+static WorkSize
+get_global_size (const SmartPtr<SoftWorker> &worker, const SmartPtr<UcharImage> &out_luma)
+{
+    WorkSize work_unit = worker->get_work_unit ();
+    return WorkSize (
+               xcam_ceil (out_luma->get_width (), work_unit.value[0]) / work_unit.value[0],
+               xcam_ceil (out_luma->get_height (), work_unit.value[1]) / work_unit.value[1]);
+}
+
+static XCamReturn
+start_task (
+    const SmartPtr<SoftWorker> &worker, const SmartPtr<Worker::Arguments> &args,
+    const SmartPtr<UcharImage> &out_luma)
+{
+    uint32_t thread_x = 4, thread_y = 4;
+    WorkSize global_size = get_global_size (worker, out_luma);
+    WorkSize local_size (
+        xcam_ceil (global_size.value[0], thread_x) / thread_x,
+        xcam_ceil (global_size.value[1], thread_y) / thread_y);
+
+    worker->set_local_size (local_size);
+    worker->set_global_size (global_size);
+
+    return worker->work (args);
+}
+
+SmartPtr<GaussDownScale::Args>
+SoftBlenderPriv::BlenderPrivConfig::create_scaler_args (
     const SmartPtr<ImageHandler::Parameters> &param,
     const SmartPtr<VideoBuffer> &in_buf,
     const uint32_t level, const SoftBlender::BufIdx idx)
 {
     XCAM_ASSERT (level < pyr_levels);
     XCAM_ASSERT (idx < SoftBlender::BufIdxCount);
-    SmartPtr<SoftWorker> worker = pyr_layer[level].scale_task[idx];
-    XCAM_ASSERT (worker.ptr ());
 
     XCAM_ASSERT (pyr_layer[level].overlap_pool.ptr ());
     SmartPtr<VideoBuffer> out_buf = pyr_layer[level].overlap_pool->get_buffer ();
     XCAM_FAIL_RETURN (
-        ERROR, out_buf.ptr (), XCAM_RETURN_ERROR_MEM,
+        ERROR, out_buf.ptr (), NULL,
         "blender:(%s) start_scaler failed, level(%d),idx(%d) get output buffer empty.",
         XCAM_STR (_blender->get_name ()), level, (int)idx);
 
@@ -394,23 +505,27 @@ SoftBlenderPriv::BlenderPrivConfig::start_scaler (
     }
     XCAM_ASSERT (out_buf->get_video_info ().width % 2 == 0 && out_buf->get_video_info ().height % 2 == 0);
 
-    uint32_t thread_x = 4, thread_y = 4;
-    WorkSize work_unit = worker->get_work_unit ();
-    WorkSize global_size (
-        xcam_ceil (args->out_luma->get_width (), work_unit.value[0]) / work_unit.value[0],
-        xcam_ceil (args->out_luma->get_height (), work_unit.value[1]) / work_unit.value[1]);
-    WorkSize local_size (
-        xcam_ceil(global_size.value[0], thread_x) / thread_x,
-        xcam_ceil(global_size.value[1], thread_y) / thread_y);
+    return args;
+}
 
-    worker->set_local_size (local_size);
-    worker->set_global_size (global_size);
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::start_scaler (
+    const SmartPtr<ImageHandler::Parameters> &param,
+    const SmartPtr<VideoBuffer> &in_buf,
+    const uint32_t level, const SoftBlender::BufIdx idx)
+{
+    SmartPtr<SoftWorker> worker = pyr_layer[level].scale_task[idx];
+    XCAM_ASSERT (worker.ptr ());
 
-    return worker->work (args);
+    SmartPtr<GaussDownScale::Args> args = create_scaler_args (param, in_buf, level, idx);
+    if (!args.ptr ())
+        return XCAM_RETURN_ERROR_MEM;
+
+    return start_task (worker, args, args->out_luma);
 }
 
-XCamReturn
-SoftBlenderPriv::BlenderPrivConfig::start_lap_task (
+SmartPtr<LaplaceTask::Args>
+SoftBlenderPriv::BlenderPrivConfig::create_lap_args (
     const SmartPtr<ImageHandler::Parameters> &param,
     const uint32_t level, const SoftBlender::BufIdx idx,
     const SmartPtr<GaussDownScale::Args> &scale_args)
@@ -430,7 +545,7 @@ SoftBlenderPriv::BlenderPrivConfig::start_lap_task (
     }
 
     XCAM_FAIL_RETURN (
-        ERROR, out_buf.ptr (), XCAM_RETURN_ERROR_MEM,
+        ERROR, out_buf.ptr (), NULL,
         "blender:(%s) start_lap_task failed, level(%d),idx(%d) get output buffer empty.",
         XCAM_STR (_blender->get_name ()), level, (int)idx);
 
@@ -455,22 +570,72 @@ SoftBlenderPriv::BlenderPrivConfig::start_lap_task (
         XCAM_LOG_ERROR ("laplace_task inupt gauss buffer pixel format:%d unsupported!", buf_info.format);
     }
 
+    return args;
+}
+
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::start_lap_task (
+    const SmartPtr<ImageHandler::Parameters> &param,
+    const uint32_t level, const SoftBlender::BufIdx idx,
+    const SmartPtr<GaussDownScale::Args> &scale_args)
+{
+    SmartPtr<LaplaceTask::Args> args = create_lap_args (param, level, idx, scale_args);
+    if (!args.ptr ())
+        return XCAM_RETURN_ERROR_MEM;
+
     SmartPtr<SoftWorker> worker = pyr_layer[level].lap_task[idx];
     XCAM_ASSERT (worker.ptr ());
 
-    uint32_t thread_x = 4, thread_y = 4;
-    WorkSize work_unit = worker->get_work_unit ();
-    WorkSize global_size (
-        xcam_ceil (args->out_luma->get_width (), work_unit.value[0]) / work_unit.value[0],
-        xcam_ceil (args->out_luma->get_height (), work_unit.value[1]) / work_unit.value[1]);
-    WorkSize local_size (
-        xcam_ceil(global_size.value[0], thread_x) / thread_x,
-        xcam_ceil(global_size.value[1], thread_y) / thread_y);
+    return start_task (worker, args, args->out_luma);
+}
 
-    worker->set_local_size (local_size);
-    worker->set_global_size (global_size);
+void
+SoftBlenderPriv::BlenderPrivConfig::set_blend_input (
+    const SmartPtr<BlendTask::Args> &args,
+    const SmartPtr<VideoBuffer> &buf,
+    const SoftBlender::BufIdx idx)
+{
+    const VideoBufferInfo &buf_info = buf->get_video_info ();
+    args->in_luma[idx] = new UcharImage (buf, 0);
 
-    return worker->work (args);
+    if (V4L2_PIX_FMT_NV12 == buf_info.format) {
+        args->in_uv[idx] = new Uchar2Image (buf, 1);
+    } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
+        args->in_u[idx] = new UcharImage (buf, 1);
+        args->in_v[idx] = new UcharImage (buf, 2);
+    } else {
+        XCAM_LOG_ERROR ("blend_task inupt buffer pixel format:%d unsupported!", buf_info.format);
+    }
+
+    XCAM_ASSERT (args->in_luma[idx].ptr () && (args->in_uv[idx].ptr () || (args->in_u[idx].ptr() && args->in_v[idx].ptr())));
+}
+
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::set_blend_output (const SmartPtr<BlendTask::Args> &args)
+{
+    uint32_t last_level = pyr_levels - 1;
+    XCAM_ASSERT (pyr_layer[last_level].overlap_pool.ptr ());
+    SmartPtr<VideoBuffer> out_buf = pyr_layer[last_level].overlap_pool->get_buffer ();
+    XCAM_FAIL_RETURN (
+        ERROR, out_buf.ptr (), XCAM_RETURN_ERROR_MEM,
+        "blender:(%s) start_blend_task failed, last level blend buffer empty.",
+        XCAM_STR (_blender->get_name ()));
+
+    const VideoBufferInfo &out_info = out_buf->get_video_info ();
+
+    args->out_luma = new UcharImage (out_buf, 0);
+
+    if (V4L2_PIX_FMT_NV12 == out_info.format) {
+        args->out_uv = new Uchar2Image (out_buf, 1);
+    }  else if (V4L2_PIX_FMT_YUV420 == out_info.format) {
+        args->out_u = new UcharImage (out_buf, 1);
+        args->out_v = new UcharImage (out_buf, 2);
+    } else {
+        XCAM_LOG_ERROR ("blend_task output buffer pixel format:%d unsupported!", out_info.format);
+    }
+    args->out_buf = out_buf;
+
+    return XCAM_RETURN_NO_ERROR;
 }
 
 XCamReturn
@@ -581,19 +746,7 @@ SoftBlenderPriv::BlenderPrivConfig::start_blend_task (
                 args = (*i).second;
             }
 
-            const VideoBufferInfo &buf_info = buf->get_video_info ();
-            args->in_luma[idx] = new UcharImage (buf, 0);
-
-            if (V4L2_PIX_FMT_NV12 == buf_info.format) {
-                args->in_uv[idx] = new Uchar2Image (buf, 1);
-            } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
-                args->in_u[idx] = new UcharImage (buf, 1);
-                args->in_v[idx] = new UcharImage (buf, 2);
-            } else {
-                XCAM_LOG_ERROR ("blend_task inupt buffer pixel format:%d unsupported!", buf_info.format);
-            }
-
-            XCAM_ASSERT (args->in_luma[idx].ptr () && (args->in_uv[idx].ptr () || (args->in_u[idx].ptr() && args->in_v[idx].ptr())));
+            set_blend_input (args, buf, idx);
 
             if (!args->in_luma[SoftBlender::Idx0].ptr () || !args->in_luma[SoftBlender::Idx1].ptr ())
                 return XCAM_RETURN_BYPASS;
@@ -604,27 +757,9 @@ SoftBlenderPriv::BlenderPrivConfig::start_blend_task (
         XCAM_ASSERT (args.ptr ());
         XCAM_ASSERT (args->in_luma[SoftBlender::Idx0]->get_width () == args->in_luma[SoftBlender::Idx1]->get_width ());
 
-        XCAM_ASSERT (pyr_layer[last_level].overlap_pool.ptr ());
-        SmartPtr<VideoBuffer> out_buf = pyr_layer[last_level].overlap_pool->get_buffer ();
-        XCAM_FAIL_RETURN (
-            ERROR, out_buf.ptr (), XCAM_RETURN_ERROR_MEM,
-            "blender:(%s) start_blend_task %d failed, last level blend buffer empty.",
-            XCAM_STR (_blender->get_name ()), (int)idx);
-
-        const VideoBufferInfo &out_info = out_buf->get_video_info ();
-
-        args->out_luma = new UcharImage (out_buf, 0);
-
-        if (V4L2_PIX_FMT_NV12 == out_info.format) {
-            args->out_uv = new Uchar2Image (out_buf, 1);
-        }  else if (V4L2_PIX_FMT_YUV420 == out_info.format) {
-            args->out_u = new UcharImage (out_buf, 1);
-            args->out_v = new UcharImage (out_buf, 2);
-        } else {
-            XCAM_LOG_ERROR ("blend_task output buffer pixel format:%d unsupported!", out_info.format);
-        }
-        args->out_buf = out_buf;
-
+        XCamReturn ret = set_blend_output (args);
+        if (!xcam_ret_is_ok (ret))
+            return ret;
     }
 
     XCAM_ASSERT (args->in_luma[idx].ptr () && (args->in_uv[idx].ptr () || (args->in_u[idx].ptr () && args->in_v[idx].ptr ())));
@@ -634,28 +769,14 @@ SoftBlenderPriv::BlenderPrivConfig::start_blend_task (
     SmartPtr<SoftWorker> worker = last_level_blend;
     XCAM_ASSERT (worker.ptr ());
 
-    uint32_t thread_x = 4, thread_y = 4;
-    WorkSize work_unit = worker->get_work_unit ();
-    WorkSize global_size (
-        xcam_ceil (args->out_luma->get_width (), work_unit.value[0]) / work_unit.value[0],
-        xcam_ceil (args->out_luma->get_height (), work_unit.value[1]) / work_unit.value[1]);
-    WorkSize local_size (
-        xcam_ceil (global_size.value[0], thread_x) / thread_x,
-        xcam_ceil (global_size.value[1], thread_y) / thread_y);
-
-    worker->set_local_size (local_size);
-    worker->set_global_size (global_size);
-
-    return worker->work (args);
+    return start_task (worker, args, args->out_luma);
 }
 
 XCamReturn
-SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task (
+SoftBlenderPriv::BlenderPrivConfig::set_reconstruct_output (
     const SmartPtr<ReconstructTask::Args> &args, const uint32_t level)
 {
     XCAM_ASSERT (args.ptr ());
-    XCAM_ASSERT (args->lap_luma[SoftBlender::Idx0].ptr () && args->lap_luma[SoftBlender::Idx1].ptr () && args->gauss_luma.ptr ());
-    XCAM_ASSERT (args->lap_luma[SoftBlender::Idx0]->get_width () == args->lap_luma[SoftBlender::Idx1]->get_width ());
     SmartPtr<VideoBuffer> out_buf;
 
     if (level == 0) {
@@ -711,23 +832,64 @@ SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task (
     XCAM_ASSERT (args->out_luma.ptr () && (args->out_uv.ptr () || (args->out_u.ptr () && args->out_v.ptr ())));
 
     args->out_buf = out_buf;
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task (
+    const SmartPtr<ReconstructTask::Args> &args, const uint32_t level)
+{
+    XCAM_ASSERT (args.ptr ());
+    XCAM_ASSERT (args->lap_luma[SoftBlender::Idx0].ptr () && args->lap_luma[SoftBlender::Idx1].ptr () && args->gauss_luma.ptr ());
+    XCAM_ASSERT (args->lap_luma[SoftBlender::Idx0]->get_width () == args->lap_luma[SoftBlender::Idx1]->get_width ());
+
+    XCamReturn ret = set_reconstruct_output (args, level);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
 
     SmartPtr<SoftWorker> worker = pyr_layer[level].recon_task;
     XCAM_ASSERT (worker.ptr ());
 
-    uint32_t thread_x = 4, thread_y = 4;
-    WorkSize work_unit = worker->get_work_unit ();
-    WorkSize global_size (
-        xcam_ceil (args->out_luma->get_width (), work_unit.value[0]) / work_unit.value[0],
-        xcam_ceil (args->out_luma->get_height (), work_unit.value[1]) / work_unit.value[1]);
-    WorkSize local_size (
-        xcam_ceil (global_size.value[0], thread_x) / thread_x,
-        xcam_ceil (global_size.value[1], thread_y) / thread_y);
+    return start_task (worker, args, args->out_luma);
+}
 
-    worker->set_local_size (local_size);
-    worker->set_global_size (global_size);
+void
+SoftBlenderPriv::BlenderPrivConfig::set_reconstruct_gauss (
+    const SmartPtr<ReconstructTask::Args> &args,
+    const SmartPtr<VideoBuffer> &gauss)
+{
+    args->gauss_luma = new UcharImage (gauss, 0);
 
-    return worker->work (args);
+    const VideoBufferInfo &buf_info = gauss->get_video_info ();
+    if (V4L2_PIX_FMT_NV12 == buf_info.format) {
+        args->gauss_uv = new Uchar2Image (gauss, 1);
+    } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
+        args->gauss_u = new UcharImage (gauss, 1);
+        args->gauss_v = new UcharImage (gauss, 2);
+    } else {
+        XCAM_LOG_ERROR ("reconstruct_task_by_gauss input buffer pixel format:%d unsupported!", buf_info.format);
+    }
+    XCAM_ASSERT (args->gauss_luma.ptr () && (args->gauss_uv.ptr () || (args->gauss_u.ptr () && args->gauss_v.ptr ())));
+}
+
+void
+SoftBlenderPriv::BlenderPrivConfig::set_reconstruct_lap (
+    const SmartPtr<ReconstructTask::Args> &args,
+    const SmartPtr<VideoBuffer> &lap,
+    const SoftBlender::BufIdx idx)
+{
+    args->lap_luma[idx] = new UcharImage (lap, 0);
+
+    const VideoBufferInfo &buf_info = lap->get_video_info ();
+    if (V4L2_PIX_FMT_NV12 == buf_info.format) {
+        args->lap_uv[idx] = new Uchar2Image (lap, 1);
+    } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
+        args->lap_u[idx] = new UcharImage (lap, 1);
+        args->lap_v[idx] = new UcharImage (lap, 2);
+    } else {
+        XCAM_LOG_ERROR ("reconstruct_task_by_lap input buffer pixel format:%d unsupported!", buf_info.format);
+    }
+    XCAM_ASSERT (args->lap_luma[idx].ptr () && (args->lap_uv[idx].ptr () || (args->lap_u[idx].ptr () && args->lap_v[idx].ptr ())));
 }
 
 XCamReturn
@@ -748,18 +910,7 @@ SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task_by_gauss (
         } else {
             args = (*i).second;
         }
-        args->gauss_luma = new UcharImage (gauss, 0);
-
-        const VideoBufferInfo &buf_info = gauss->get_video_info ();
-        if (V4L2_PIX_FMT_NV12 == buf_info.format) {
-            args->gauss_uv = new Uchar2Image (gauss, 1);
-        } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
-            args->gauss_u = new UcharImage (gauss, 1);
-            args->gauss_v = new UcharImage (gauss, 2);
-        } else {
-            XCAM_LOG_ERROR ("reconstruct_task_by_gauss input buffer pixel format:%d unsupported!", buf_info.format);
-        }
-        XCAM_ASSERT (args->gauss_luma.ptr () && (args->gauss_uv.ptr () || (args->gauss_u.ptr () && args->gauss_v.ptr ())));
+        set_reconstruct_gauss (args, gauss);
 
         if (!args->lap_luma[SoftBlender::Idx0].ptr () || !args->lap_luma[SoftBlender::Idx1].ptr ())
             return XCAM_RETURN_BYPASS;
@@ -789,18 +940,7 @@ SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task_by_lap (
         } else {
             args = (*i).second;
         }
-        args->lap_luma[idx] = new UcharImage (lap, 0);
-
-        const VideoBufferInfo &buf_info = lap->get_video_info ();
-        if (V4L2_PIX_FMT_NV12 == buf_info.format) {
-            args->lap_uv[idx] = new Uchar2Image (lap, 1);
-        } else if (V4L2_PIX_FMT_YUV420 == buf_info.format) {
-            args->lap_u[idx] = new UcharImage (lap, 1);
-            args->lap_v[idx] = new UcharImage (lap, 2);
-        } else {
-            XCAM_LOG_ERROR ("reconstruct_task_by_lap input buffer pixel format:%d unsupported!", buf_info.format);
-        }
-        XCAM_ASSERT (args->lap_luma[idx].ptr () && (args->lap_uv[idx].ptr () || (args->lap_u[idx].ptr () && args->lap_v[idx].ptr ())));
+        set_reconstruct_lap (args, lap, idx);
 
         if (!args->gauss_luma.ptr () || !args->lap_luma[SoftBlender::Idx0].ptr () ||
                 !args->lap_luma[SoftBlender::Idx1].ptr ())
@@ -811,6 +951,113 @@ SoftBlenderPriv::BlenderPrivConfig::start_reconstruct_task_by_lap (
 
     return start_reconstruct_task (args, level);
 }
+/*
+ * stage dependencies in rows, consumer unit row y needs producer rows [0, y * scale + offset)
+ * gauss 2x2 unit:      in rows 4y-2 ~ 4y+5 (uv rows 2y-2 ~ 2y+2)
+ * laplace 8x4 unit:    orig rows 4y ~ 4y+3, gauss rows 2y ~ 2y+3 (uv rows y ~ y+1)
+ * blend 8x2 unit:      in rows 2y ~ 2y+1
+ * reconstruct 8x4 unit: lap rows 4y ~ 4y+3, gauss rows 2y ~ 2y+3 (uv rows y ~ y+1)
+ */
+XCamReturn
+SoftBlenderPriv::BlenderPrivConfig::start_tiled_work (const SmartPtr<ImageHandler::Parameters> &param)
+{
+    XCAM_ASSERT (pyr_levels > 0 && band_task.ptr ());
+    SmartPtr<SoftBlender::BlenderParam> blend_param = param.dynamic_cast_ptr<SoftBlender::BlenderParam> ();
+    XCAM_ASSERT (blend_param.ptr ());
+
+    SmartPtr<GaussDownScale::Args> scale_args[SoftBlender::BufIdxCount][XCAM_SOFT_PYRAMID_MAX_LEVEL];
+    SmartPtr<LaplaceTask::Args> lap_args[SoftBlender::BufIdxCount][XCAM_SOFT_PYRAMID_MAX_LEVEL];
+    uint32_t scale_stage[SoftBlender::BufIdxCount][XCAM_SOFT_PYRAMID_MAX_LEVEL];
+    uint32_t lap_stage[SoftBlender::BufIdxCount][XCAM_SOFT_PYRAMID_MAX_LEVEL];
+    uint32_t last_level = pyr_levels - 1;
+    SmartPtr<PyramidBandTask::Args> args;
+
+    for (uint32_t i = 0; i < SoftBlender::BufIdxCount; ++i) {
+        SoftBlender::BufIdx idx = (SoftBlender::BufIdx)i;
+        SmartPtr<VideoBuffer> in_buf = (idx == SoftBlender::Idx0) ? blend_param->in_buf : blend_param->in1_buf;
+
+        for (uint32_t level = 0; level < pyr_levels; ++level) {
+            scale_args[idx][level] = create_scaler_args (param, in_buf, level, idx);
+            XCAM_FAIL_RETURN (
+                ERROR, scale_args[idx][level].ptr (), XCAM_RETURN_ERROR_MEM,
+                "blender:(%s) start_tiled_work failed on scaler, level(%d),idx(%d)",
+                XCAM_STR (_blender->get_name ()), level, (int)idx);
+            lap_args[idx][level] = create_lap_args (param, level, idx, scale_args[idx][level]);
+            XCAM_FAIL_RETURN (
+                ERROR, lap_args[idx][level].ptr (), XCAM_RETURN_ERROR_MEM,
+                "blender:(%s) start_tiled_work failed on laplace, level(%d),idx(%d)",
+                XCAM_STR (_blender->get_name ()), level, (int)idx);
+
+            if (!args.ptr ())
+                args = new PyramidBandTask::Args (param, scale_args[idx][0]->in_luma->get_height (), band_rows);
+
+            uint32_t orig_stage = (level == 0) ? (uint32_t)PyramidBandTask::InputStage : scale_stage[idx][level - 1];
+            SmartPtr<SoftWorker> worker = pyr_layer[level].scale_task[idx];
+            scale_stage[idx][level] = args->add_stage (
+                worker, scale_args[idx][level], get_global_size (worker, scale_args[idx][level]->out_luma),
+                scale_args[idx][level]->out_luma->get_height ());
+            args->add_dependency (scale_stage[idx][level], orig_stage, 4, 6);
+
+            worker = pyr_layer[level].lap_task[idx];
+            lap_stage[idx][level] = args->add_stage (
+                worker, lap_args[idx][level], get_global_size (worker, lap_args[idx][level]->out_luma),
+                lap_args[idx][level]->out_luma->get_height ());
+            args->add_dependency (lap_stage[idx][level], orig_stage, 4, 4);
+            args->add_dependency (lap_stage[idx][level], scale_stage[idx][level], 2, 4);
+
+            in_buf = scale_args[idx][level]->out_buf;
+        }
+    }
+
+    SmartPtr<BlendTask::Args> blend_args = new BlendTask::Args (param, pyr_layer[last_level].coef_mask);
+    set_blend_input (blend_args, scale_args[SoftBlender::Idx0][last_level]->out_buf, SoftBlender::Idx0);
+    set_blend_input (blend_args, scale_args[SoftBlender::Idx1][last_level]->out_buf, SoftBlender::Idx1);
+    XCamReturn ret = set_blend_output (blend_args);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
+
+    uint32_t upper_stage = args->add_stage (
+        last_level_blend, blend_args, get_global_size (last_level_blend, blend_args->out_luma),
+        blend_args->out_luma->get_height ());
+    args->add_dependency (upper_stage, scale_stage[SoftBlender::Idx0][last_level], 2, 2);
+    args->add_dependency (upper_stage, scale_stage[SoftBlender::Idx1][last_level], 2, 2);
+    SmartPtr<VideoBuffer> upper_buf = blend_args->out_buf;
+
+    for (int32_t level = last_level; level >= 0; --level) {
+        SmartPtr<ReconstructTask::Args> recons_args = new ReconstructTask::Args (param, level);
+        set_reconstruct_gauss (recons_args, upper_buf);
+        set_reconstruct_lap (recons_args, lap_args[SoftBlender::Idx0][level]->out_buf, SoftBlender::Idx0);
+        set_reconstruct_lap (recons_args, lap_args[SoftBlender::Idx1][level]->out_buf, SoftBlender::Idx1);
+        ret = set_reconstruct_output (recons_args, level);
+        if (!xcam_ret_is_ok (ret))
+            return ret;
+
+        SmartPtr<SoftWorker> worker = pyr_layer[level].recon_task;
+        uint32_t stage = args->add_stage (
+            worker, recons_args, get_global_size (worker, recons_args->out_luma),
+            recons_args->out_luma->get_height ());
+        args->add_dependency (stage, upper_stage, 2, 4);
+        args->add_dependency (stage, lap_stage[SoftBlender::Idx0][level], 4, 4);
+        args->add_dependency (stage, lap_stage[SoftBlender::Idx1][level], 4, 4);
+
+        upper_stage = stage;
+        upper_buf = recons_args->out_buf;
+    }
+    args->out_buf = upper_buf;
+
+    // one band runner per pool thread, a single runner works in caller thread
+    SmartPtr<ThreadPool> threads = _blender->get_threads ();
+    if (!threads.ptr ())
+        threads = WorkStealingPool::get_shared_pool ();
+    XCAM_FAIL_RETURN (
+        ERROR, threads.ptr (), XCAM_RETURN_ERROR_THREAD,
+        "blender:(%s) start_tiled_work failed on getting threads", XCAM_STR (_blender->get_name ()));
+    uint32_t runners = XCAM_MIN (threads->get_max_threads (), (uint32_t)args->stages.size ());
+
+    band_task->set_local_size (WorkSize (1, 1));
+    band_task->set_global_size (WorkSize (XCAM_MAX (runners, 1u), 1));
+    return band_task->work (args);
+}
 
 XCamReturn
 SoftBlender::start_work (const SmartPtr<ImageHandler::Parameters> &base)
@@ -828,6 +1075,11 @@ SoftBlender::start_work (const SmartPtr<ImageHandler::Parameters> &base)
         XCAM_FAIL_RETURN (
             ERROR, xcam_ret_is_ok (ret), ret,
             "blender:%s start_blend_task failed", XCAM_STR (get_name ()));
+    } else if (_priv_config->tiled) {
+        ret = _priv_config->start_tiled_work (param);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret), ret,
+            "blender:%s start_tiled_work failed", XCAM_STR (get_name ()));
     } else {
         //start gauss scale level0: idx0
         ret = _priv_config->start_scaler (param, param->in_buf, 0, Idx0);
@@ -891,9 +1143,12 @@ SoftBlender::configure_resource (const SmartPtr<Parameters> &param)
     overlap_info.init (in0_info.format, merge_size.width, merge_size.height);
     SmartPtr<BufferPool> first_lap_pool = new SoftVideoBufAllocator (overlap_info);
     XCAM_ASSERT (first_lap_pool.ptr ());
+    char pool_name[XCAM_MAX_STR_SIZE] = {'\0'};
+    snprintf (pool_name, XCAM_MAX_STR_SIZE, "%s-lap", XCAM_STR (get_name ()));
+    first_lap_pool->set_name (pool_name);
     _priv_config->first_lap_pool = first_lap_pool;
     XCAM_FAIL_RETURN (
-        ERROR, _priv_config->first_lap_pool->reserve (LAP_POOL_SIZE), XCAM_RETURN_ERROR_MEM,
+        ERROR, _priv_config->first_lap_pool->reserve (LAP_POOL_SIZE * _priv_config->inflight_frames), XCAM_RETURN_ERROR_MEM,
         "blender:%s reserve lap buffer pool(w:%d,h:%d) failed",
         XCAM_STR(get_name ()), overlap_info.width, overlap_info.height);
 
@@ -914,9 +1169,11 @@ SoftBlender::configure_resource (const SmartPtr<Parameters> &param)
 
         SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (overlap_info);
         XCAM_ASSERT (pool.ptr ());
+        snprintf (pool_name, XCAM_MAX_STR_SIZE, "%s-overlap%d", XCAM_STR (get_name ()), i);
+        pool->set_name (pool_name);
         _priv_config->pyr_layer[i].overlap_pool = pool;
         XCAM_FAIL_RETURN (
-            ERROR, _priv_config->pyr_layer[i].overlap_pool->reserve (OVERLAP_POOL_SIZE), XCAM_RETURN_ERROR_MEM,
+            ERROR, _priv_config->pyr_layer[i].overlap_pool->reserve (OVERLAP_POOL_SIZE * _priv_config->inflight_frames), XCAM_RETURN_ERROR_MEM,
             "blender:%s reserve buffer pool(w:%d,h:%d) failed",
             XCAM_STR(get_name ()), overlap_info.width, overlap_info.height);
 
@@ -935,10 +1192,29 @@ SoftBlender::configure_resource (const SmartPtr<Parameters> &param)
         XCAM_ASSERT (_priv_config->pyr_layer[i].lap_task[SoftBlender::Idx1].ptr ());
         _priv_config->pyr_layer[i].recon_task = new ReconstructTask (reconst_cb);
         XCAM_ASSERT (_priv_config->pyr_layer[i].recon_task.ptr ());
+
+        setup_worker (_priv_config->pyr_layer[i].scale_task[SoftBlender::Idx0]);
+        setup_worker (_priv_config->pyr_layer[i].scale_task[SoftBlender::Idx1]);
+        setup_worker (_priv_config->pyr_layer[i].lap_task[SoftBlender::Idx0]);
+        setup_worker (_priv_config->pyr_layer[i].lap_task[SoftBlender::Idx1]);
+        setup_worker (_priv_config->pyr_layer[i].recon_task);
+        _priv_config->pyr_layer[i].scale_task[SoftBlender::Idx0]->set_fixed_point (_priv_config->fixed_point);
+        _priv_config->pyr_layer[i].scale_task[SoftBlender::Idx1]->set_fixed_point (_priv_config->fixed_point);
+        _priv_config->pyr_layer[i].lap_task[SoftBlender::Idx0]->set_fixed_point (_priv_config->fixed_point);
+        _priv_config->pyr_layer[i].lap_task[SoftBlender::Idx1]->set_fixed_point (_priv_config->fixed_point);
+        _priv_config->pyr_layer[i].recon_task->set_fixed_point (_priv_config->fixed_point);
     }
 
     _priv_config->last_level_blend = new BlendTask (new CbBlendTask (this));
     XCAM_ASSERT (_priv_config->last_level_blend.ptr ());
+    setup_worker (_priv_config->last_level_blend);
+    _priv_config->last_level_blend->set_fixed_point (_priv_config->fixed_point);
+
+    _priv_config->band_task = new PyramidBandTask (new CbPyramidBandTask (this));
+    XCAM_ASSERT (_priv_config->band_task.ptr ());
+    // every runner takes bands until all stages are done, one item each
+    _priv_config->band_task->set_batch_dispatch (false);
+    setup_worker (_priv_config->band_task);
 
     return XCAM_RETURN_NO_ERROR;
 }
@@ -1063,6 +1339,24 @@ SoftBlender::reconstruct_done (
     }
 }
 
+void
+SoftBlender::band_task_done (
+    const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &base, const XCamReturn error)
+{
+    XCAM_UNUSED (worker);
+
+    SmartPtr<PyramidBandTask::Args> args = base.dynamic_cast_ptr<PyramidBandTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
+    const SmartPtr<ImageHandler::Parameters> param = args->get_param ();
+    XCAM_ASSERT (param.ptr ());
+
+    if (!check_work_continue (param, error))
+        return;
+
+    dump_buf (args->out_buf, "band-output");
+    work_well_done (param, error);
+}
+
 SmartPtr<SoftHandler>
 create_soft_blender ()
 {
@@ -26,6 +26,7 @@
 #include <soft/soft_handler.h>
 
 #define XCAM_SOFT_PYRAMID_MAX_LEVEL 4
+#define XCAM_SOFT_BLENDER_BAND_ROWS 32
 
 namespace XCam {
 
@@ -61,6 +62,15 @@ public:
     ~SoftBlender ();
 
     bool set_pyr_levels (uint32_t levels);
+    // run all pyramid levels band by band (@band_rows rows of level 0) in one task instead of level by level,
+    // keeps intermediate rows in cache, disabled by default
+    bool set_tiled_mode (bool enable, uint32_t band_rows = XCAM_SOFT_BLENDER_BAND_ROWS);
+    // integer kernels (Q8 coefficients and weights) instead of float for all pyramid tasks,
+    // must be set before configuration, disabled by default
+    bool set_fixed_point (bool enable);
+    // frames blended concurrently, scales intermediate buffer pools,
+    // must be set before configuration, default 1
+    bool set_inflight_frames (uint32_t frames);
 
     //derived from SoftHandler
     virtual XCamReturn terminate ();
@@ -73,6 +83,8 @@ public:
         const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &args, const XCamReturn error);
     void reconstruct_done (
         const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &args, const XCamReturn error);
+    void band_task_done (
+        const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &args, const XCamReturn error);
 
 protected:
     explicit SoftBlender (const char *name = "SoftBlender");
@@ -92,6 +104,9 @@ private:
 };
 
 extern SmartPtr<SoftHandler> create_soft_blender ();
+
+// first level blend mask of @width columns, weight of input 0 in [0, 255]
+extern void gen_soft_blend_mask (uint32_t width, std::vector<uint8_t> &mask);
 }
 
 #endif //XCAM_SOFT_BLENDER_H
@@ -20,13 +20,206 @@
  */
 
 #include "soft_blender_tasks_priv.h"
+#include "soft_simd_priv.h"
 
 namespace XCam {
 
 namespace XCamSoftTasks {
 
+using namespace XCamSoftSimd;
+
 const float GaussScaleGray::coeffs[GAUSS_DOWN_SCALE_SIZE] = {0.152f, 0.222f, 0.252f, 0.222f, 0.152f};
 
+/*
+ * fixed-point path, same math as float path on integers
+ * gauss coefficients and blend weights are Q8, up-sampled gauss values are Q2 (x4)
+ */
+static const int32_t gauss_fixed_coeffs[GAUSS_DOWN_SCALE_SIZE] = {39, 57, 64, 57, 39};
+
+static inline Uchar
+clamp_to_uchar (int32_t v)
+{
+    return (Uchar)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+template <uint32_t N>
+static inline void
+multiply_coeff_fixed (int32_t *out, const int32_t *in, int32_t coef)
+{
+    for (uint32_t i = 0; i < N; ++i)
+        out[i] += in[i] * coef;
+}
+
+// 5-tap horizontal sum of Q8 vertical sums, Q16 to uchar
+static inline Uchar
+gauss_sum_fixed (const int32_t *in)
+{
+    int32_t sum = in[0] * gauss_fixed_coeffs[0] + in[1] * gauss_fixed_coeffs[1] + in[2] * gauss_fixed_coeffs[2] +
+                  in[3] * gauss_fixed_coeffs[3] + in[4] * gauss_fixed_coeffs[4];
+    return (Uchar)((sum + (1 << 15)) >> 16);
+}
+
+template <uint32_t N>
+static inline void
+read_split_uv (const Uchar2Image *image, int32_t x, int32_t y, int32_t *u, int32_t *v)
+{
+    Uchar2 line[N];
+    image->read_array<Uchar2, N> (x, y, line);
+    for (uint32_t i = 0; i < N; ++i) {
+        u[i] = line[i].x;
+        v[i] = line[i].y;
+    }
+}
+
+// mask / 255 in Q8, [0, 256]
+static inline int32_t
+mask_to_weight (Uchar mask)
+{
+    return mask + (mask >> 7);
+}
+
+static inline Uchar
+blend_fixed (int32_t a, int32_t b, int32_t weight)
+{
+    return (Uchar)(b + (((a - b) * weight + 128) >> 8));
+}
+
+// up-sample N gauss values into 2 * (N - 1) Q2 values on gauss row
+template <uint32_t N, typename T>
+static inline void
+interpolate_int_row_fixed (const int32_t *gauss, T *ret)
+{
+    for (uint32_t i = 0; i < N - 1; ++i) {
+        ret[i * 2] = gauss[i] * 4;
+        ret[i * 2 + 1] = (gauss[i] + gauss[i + 1]) * 2;
+    }
+}
+
+// up-sample between two gauss rows
+template <uint32_t N, typename T>
+static inline void
+interpolate_half_row_fixed (const int32_t *last, const int32_t *next, T *ret)
+{
+    for (uint32_t i = 0; i < N - 1; ++i) {
+        ret[i * 2] = (last[i] + next[i]) * 2;
+        ret[i * 2 + 1] = last[i] + next[i] + last[i + 1] + next[i + 1];
+    }
+}
+
+// interleave u and v into 8 values of uv kernels
+static inline void
+interleave_uv_fixed (const int32_t *u, const int32_t *v, int16_t *uv)
+{
+    for (uint32_t i = 0; i < 4; ++i) {
+        uv[i * 2] = u[i];
+        uv[i * 2 + 1] = v[i];
+    }
+}
+
+// uv pixels take luma mask of every other column, duplicated for u and v
+static inline void
+uv_mask_fixed (const Uchar *mask, Uchar *uv_mask)
+{
+    for (uint32_t i = 0; i < 4; ++i)
+        uv_mask[i * 2] = uv_mask[i * 2 + 1] = mask[i * 2];
+}
+
+// (orig - up) * 0.5 + 128
+static inline Uchar
+laplace_fixed (int32_t orig, int32_t up_q2)
+{
+    return clamp_to_uchar ((orig * 4 - up_q2 + 4 + 1024) >> 3);
+}
+
+// up + blend (lap_a, lap_b) * 2 - 256
+static inline Uchar
+reconstruct_fixed (int32_t lap_a, int32_t lap_b, int32_t weight, int32_t up_q2)
+{
+    int32_t lap_q8 = lap_b * 256 + (lap_a - lap_b) * weight;
+    int32_t v = up_q2 * 64 + lap_q8 * 2 - 65536 + 128;
+    return clamp_to_uchar (v >> 8);
+}
+
+static void
+gauss_luma_2x2_fixed (const UcharImage *in_luma, UcharImage *out_luma, uint32_t x, uint32_t y)
+{
+    int32_t in_x = x * 4, in_y = y * 4;
+    int32_t line[7];
+    int32_t sum0[7] = {0};
+    int32_t sum1[7] = {0};
+
+    for (int32_t i = 0; i < GAUSS_DOWN_SCALE_SIZE + 2; ++i) {
+        in_luma->read_array<int32_t, 7> (in_x - 2, in_y - 2 + i, line);
+        if (i < GAUSS_DOWN_SCALE_SIZE)
+            multiply_coeff_fixed<7> (sum0, line, gauss_fixed_coeffs[i]);
+        if (i >= 2)
+            multiply_coeff_fixed<7> (sum1, line, gauss_fixed_coeffs[i - 2]);
+    }
+
+    Uchar out[2];
+    out[0] = gauss_sum_fixed (&sum0[0]);
+    out[1] = gauss_sum_fixed (&sum0[2]);
+    out_luma->write_array_no_check<2> (x * 2, y * 2, out);
+    out[0] = gauss_sum_fixed (&sum1[0]);
+    out[1] = gauss_sum_fixed (&sum1[2]);
+    out_luma->write_array_no_check<2> (x * 2, y * 2 + 1, out);
+}
+
+// 4 work units at once if their input window is inside the image, kernels read 24 pixels each row
+static void
+gauss_luma_row_fixed (
+    const UcharImage *in_luma, UcharImage *out_luma, uint32_t x_start, uint32_t x_end, uint32_t y)
+{
+    const SimdKernels &kernels = get_kernels ();
+    int32_t in_y = y * 4;
+    bool rows_inside = in_y >= 2 && in_y + 4 < (int32_t)in_luma->get_height ();
+
+    for (uint32_t x = x_start; x < x_end; ) {
+        int32_t in_x = x * 4 - 2;
+        if (!rows_inside || x + 4 > x_end || in_x < 0 || in_x + 24 > (int32_t)in_luma->get_width ()) {
+            gauss_luma_2x2_fixed (in_luma, out_luma, x, y);
+            ++x;
+            continue;
+        }
+
+        const Uchar *rows[GAUSS_DOWN_SCALE_SIZE + 2];
+        for (int32_t i = 0; i < GAUSS_DOWN_SCALE_SIZE + 2; ++i)
+            rows[i] = in_luma->get_buf_ptr (in_x, in_y - 2 + i);
+        kernels.gauss_fixed_8 (rows, out_luma->get_buf_ptr (x * 2, y * 2));
+        kernels.gauss_fixed_8 (rows + 2, out_luma->get_buf_ptr (x * 2, y * 2 + 1));
+        x += 4;
+    }
+}
+
+static void
+gauss_uv_1x1_fixed (const Uchar2Image *in_uv, Uchar2Image *out_uv, uint32_t x, uint32_t y)
+{
+    int32_t in_x = x * 2, in_y = y * 2;
+    int32_t u_line[5], v_line[5];
+    int32_t u_sum[5] = {0}, v_sum[5] = {0};
+
+    for (int32_t i = 0; i < GAUSS_DOWN_SCALE_SIZE; ++i) {
+        read_split_uv<5> (in_uv, in_x - 2, in_y - 2 + i, u_line, v_line);
+        multiply_coeff_fixed<5> (u_sum, u_line, gauss_fixed_coeffs[i]);
+        multiply_coeff_fixed<5> (v_sum, v_line, gauss_fixed_coeffs[i]);
+    }
+    out_uv->write_data_no_check (x, y, Uchar2 (gauss_sum_fixed (u_sum), gauss_sum_fixed (v_sum)));
+}
+
+static void
+gauss_chroma_1x1_fixed (const UcharImage *in_chroma, UcharImage *out_chroma, uint32_t x, uint32_t y)
+{
+    int32_t in_x = x * 2, in_y = y * 2;
+    int32_t line[5];
+    int32_t sum[5] = {0};
+
+    for (int32_t i = 0; i < GAUSS_DOWN_SCALE_SIZE; ++i) {
+        in_chroma->read_array<int32_t, 5> (in_x - 2, in_y - 2 + i, line);
+        multiply_coeff_fixed<5> (sum, line, gauss_fixed_coeffs[i]);
+    }
+    out_chroma->write_data_no_check (x, y, gauss_sum_fixed (sum));
+}
+
 void
 GaussScaleGray::gauss_luma_2x2 (
     UcharImage *in_luma, UcharImage *out_luma,
@@ -86,6 +279,12 @@ GaussScaleGray::work_range (const SmartPtr<Worker::Arguments> &base, const WorkR
     UcharImage *in_luma = args->in_luma.ptr (), *out_luma = args->out_luma.ptr ();
     XCAM_ASSERT (in_luma && out_luma);
 
+    if (_fixed_point) {
+        for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
+            gauss_luma_row_fixed (in_luma, out_luma, range.pos[0], range.pos[0] + range.pos_len[0], y);
+        return XCAM_RETURN_NO_ERROR;
+    }
+
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
         {
@@ -157,6 +356,23 @@ GaussDownScale::work_range (const SmartPtr<Worker::Arguments> &base, const WorkR
     XCAM_ASSERT (in_luma && (in_uv || (in_u && in_v)));
     XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
 
+    if (_fixed_point) {
+        for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y) {
+            gauss_luma_row_fixed (in_luma, out_luma, range.pos[0], range.pos[0] + range.pos_len[0], y);
+            for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
+            {
+                if (in_uv && out_uv) {
+                    gauss_uv_1x1_fixed (in_uv, out_uv, x, y);
+                }
+                if (in_u && out_u && in_v && out_v) {
+                    gauss_chroma_1x1_fixed (in_u, out_u, x, y);
+                    gauss_chroma_1x1_fixed (in_v, out_v, x, y);
+                }
+            }
+        }
+        return XCAM_RETURN_NO_ERROR;
+    }
+
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
         {
@@ -178,34 +394,6 @@ GaussDownScale::work_range (const SmartPtr<Worker::Arguments> &base, const WorkR
     return XCAM_RETURN_NO_ERROR;
 }
 
-static inline void
-blend_luma_8 (const float *luma0, const float *luma1, const float *mask, float *out)
-{
-    //out[0] = luma0[0] * mask + luma1[0] * ( 1.0f - mask[0]);
-#define BLEND_LUMA_8(idx) out[idx] = (luma0[idx] - luma1[idx]) * mask[idx] + luma1[idx]
-    BLEND_LUMA_8 (0);
-    BLEND_LUMA_8 (1);
-    BLEND_LUMA_8 (2);
-    BLEND_LUMA_8 (3);
-    BLEND_LUMA_8 (4);
-    BLEND_LUMA_8 (5);
-    BLEND_LUMA_8 (6);
-    BLEND_LUMA_8 (7);
-}
-
-static inline void
-normalize_8 (float *value, const float max)
-{
-    value[0] /= max;
-    value[1] /= max;
-    value[2] /= max;
-    value[3] /= max;
-    value[4] /= max;
-    value[5] /= max;
-    value[6] /= max;
-    value[7] /= max;
-}
-
 static inline void
 read_and_blend_pixel_luma_8 (
     const UcharImage *in0, const UcharImage *in1,
@@ -214,12 +402,9 @@ read_and_blend_pixel_luma_8 (
     float *out_luma,
     float *out_mask)
 {
-    float luma0_line[8], luma1_line[8];
-    mask->read_array_no_check<float, 8> (in_x, in_y, out_mask);
-    in0->read_array_no_check<float, 8> (in_x, in_y, luma0_line);
-    in1->read_array_no_check<float, 8> (in_x, in_y, luma1_line);
-    normalize_8 (out_mask, 255.0f);
-    blend_luma_8 (luma0_line, luma1_line, out_mask, out_luma);
+    get_kernels ().blend_8 (
+        in0->get_buf_ptr (in_x, in_y), in1->get_buf_ptr (in_x, in_y), mask->get_buf_ptr (in_x, in_y),
+        out_mask, out_luma);
 }
 
 static inline void
@@ -260,6 +445,36 @@ read_and_blend_chroma_4 (
     BLEND_CHROMA_4 (3);
 }
 
+static inline void
+blend_luma_8_fixed (
+    const UcharImage *in0, const UcharImage *in1, const UcharImage *mask, UcharImage *out,
+    uint32_t x, uint32_t y)
+{
+    get_kernels ().blend_fixed_8 (
+        in0->get_buf_ptr (x, y), in1->get_buf_ptr (x, y), mask->get_buf_ptr (x, y), out->get_buf_ptr (x, y));
+}
+
+static inline void
+blend_uv_4_fixed (
+    const Uchar2Image *in0, const Uchar2Image *in1, Uchar2Image *out,
+    uint32_t x, uint32_t y, const Uchar *uv_mask)
+{
+    get_kernels ().blend_fixed_8 (
+        (const Uchar *)in0->get_buf_ptr (x, y), (const Uchar *)in1->get_buf_ptr (x, y), uv_mask,
+        (Uchar *)out->get_buf_ptr (x, y));
+}
+
+static inline void
+blend_chroma_4_fixed (
+    const UcharImage *in0, const UcharImage *in1, UcharImage *out,
+    uint32_t x, uint32_t y, const Uchar *uv_mask)
+{
+    const Uchar *a = in0->get_buf_ptr (x, y), *b = in1->get_buf_ptr (x, y);
+    Uchar *o = out->get_buf_ptr (x, y);
+    for (uint32_t i = 0; i < 4; ++i)
+        o[i] = blend_fixed (a[i], b[i], mask_to_weight (uv_mask[i * 2]));
+}
+
 void BlendTask::blend_luma (
     UcharImage *in0_luma, UcharImage *in1_luma, UcharImage *out_luma,
     UcharImage *mask, float* luma_mask,
@@ -272,12 +487,12 @@ void BlendTask::blend_luma (
 
     // process luma (in_x, in_y)
     read_and_blend_pixel_luma_8 (in0_luma, in1_luma, mask, in_x, in_y, luma_blend, luma_mask);
-    convert_to_uchar_N<float, 8> (luma_blend, luma_uc);
+    get_kernels ().convert_8 (luma_blend, luma_uc);
     out_luma->write_array_no_check<8> (in_x, in_y, luma_uc);
 
     // process luma (in_x, in_y + 1)
     read_and_blend_pixel_luma_8 (in0_luma, in1_luma, mask, in_x, in_y + 1, luma_blend, luma_mask);
-    convert_to_uchar_N<float, 8> (luma_blend, luma_uc);
+    get_kernels ().convert_8 (luma_blend, luma_uc);
     out_luma->write_array_no_check<8> (in_x, in_y + 1, luma_uc);
 }
 
@@ -323,6 +538,27 @@ BlendTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
     XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
     XCAM_ASSERT (mask);
 
+    if (_fixed_point) {
+        for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
+            for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
+            {
+                Uchar uv_mask[8];
+                blend_luma_8_fixed (in0_luma, in1_luma, mask, out_luma, x * 8, y * 2);
+                blend_luma_8_fixed (in0_luma, in1_luma, mask, out_luma, x * 8, y * 2 + 1);
+
+                // same uv weights as float path, from second luma row
+                uv_mask_fixed (mask->get_buf_ptr (x * 8, y * 2 + 1), uv_mask);
+                if (in0_uv && in1_uv && out_uv) {
+                    blend_uv_4_fixed (in0_uv, in1_uv, out_uv, x * 4, y, uv_mask);
+                }
+                if (in0_u && in0_v && in1_u && in1_v && out_u && out_v) {
+                    blend_chroma_4_fixed (in0_u, in1_u, out_u, x * 4, y, uv_mask);
+                    blend_chroma_4_fixed (in0_v, in1_v, out_v, x * 4, y, uv_mask);
+                }
+            }
+        return XCAM_RETURN_NO_ERROR;
+    }
+
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
         {
@@ -349,20 +585,6 @@ BlendTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
     return XCAM_RETURN_NO_ERROR;
 }
 
-static inline void
-minus_array_8 (float *orig, float *gauss, Uchar *ret)
-{
-#define ORG_MINUS_GAUSS(i) ret[i] = convert_to_uchar<float> ((orig[i] - gauss[i]) * 0.5f + 128.0f)
-    ORG_MINUS_GAUSS(0);
-    ORG_MINUS_GAUSS(1);
-    ORG_MINUS_GAUSS(2);
-    ORG_MINUS_GAUSS(3);
-    ORG_MINUS_GAUSS(4);
-    ORG_MINUS_GAUSS(5);
-    ORG_MINUS_GAUSS(6);
-    ORG_MINUS_GAUSS(7);
-}
-
 static inline void
 interpolate_luma_int_row_8x1 (UcharImage* image, uint32_t fixed_x, uint32_t fixed_y, float *gauss_v, float* ret)
 {
@@ -402,18 +624,15 @@ LaplaceTask::interplate_luma_8x2 (
     uint32_t gauss_x = out_x / 2, first_gauss_y = out_y / 2;
     float inter_value[8];
     float gauss_v[5];
-    float orig_v[8];
     Uchar lap_ret[8];
     //interplate instaed of coefficient
     interpolate_luma_int_row_8x1 (gauss_luma, gauss_x, first_gauss_y, gauss_v, inter_value);
-    orig_luma->read_array_no_check<float, 8> (out_x, out_y, orig_v);
-    minus_array_8 (orig_v, inter_value, lap_ret);
+    get_kernels ().laplace_8 (orig_luma->get_buf_ptr (out_x, out_y), inter_value, lap_ret);
     out_luma->write_array_no_check<8> (out_x, out_y, lap_ret);
 
     uint32_t next_gauss_y = first_gauss_y + 1;
     interpolate_luma_half_row_8x1 (gauss_luma, gauss_x, next_gauss_y, gauss_v, inter_value);
-    orig_luma->read_array_no_check<float, 8> (out_x, out_y + 1, orig_v);
-    minus_array_8 (orig_v, inter_value, lap_ret);
+    get_kernels ().laplace_8 (orig_luma->get_buf_ptr (out_x, out_y + 1), inter_value, lap_ret);
     out_luma->write_array_no_check<8> (out_x, out_y + 1, lap_ret);
 }
 
@@ -487,6 +706,72 @@ interpolate_chroma_half_row_4x1 (UcharImage *image, uint32_t x, uint32_t y, floa
     ret[3] = (ret[2] + tmp) * 0.5f;
 }
 
+static inline void
+laplace_luma_8x2_fixed (
+    const UcharImage *orig_luma, const UcharImage *gauss_luma, UcharImage *out_luma,
+    uint32_t out_x, uint32_t out_y)
+{
+    const SimdKernels &kernels = get_kernels ();
+    int32_t gauss[5], next_gauss[5];
+    int16_t up[8];
+
+    gauss_luma->read_array<int32_t, 5> (out_x / 2, out_y / 2, gauss);
+    interpolate_int_row_fixed<5> (gauss, up);
+    kernels.laplace_fixed_8 (orig_luma->get_buf_ptr (out_x, out_y), up, out_luma->get_buf_ptr (out_x, out_y));
+
+    gauss_luma->read_array<int32_t, 5> (out_x / 2, out_y / 2 + 1, next_gauss);
+    interpolate_half_row_fixed<5> (gauss, next_gauss, up);
+    kernels.laplace_fixed_8 (orig_luma->get_buf_ptr (out_x, out_y + 1), up, out_luma->get_buf_ptr (out_x, out_y + 1));
+}
+
+static inline void
+laplace_uv_4x2_fixed (
+    const Uchar2Image *orig_uv, const Uchar2Image *gauss_uv, Uchar2Image *out_uv,
+    uint32_t out_x, uint32_t out_y)
+{
+    const SimdKernels &kernels = get_kernels ();
+    int32_t gauss_u[3], gauss_v[3], next_u[3], next_v[3], up_u[4], up_v[4];
+    int16_t up[8];
+
+    read_split_uv<3> (gauss_uv, out_x / 2, out_y / 2, gauss_u, gauss_v);
+    interpolate_int_row_fixed<3> (gauss_u, up_u);
+    interpolate_int_row_fixed<3> (gauss_v, up_v);
+    interleave_uv_fixed (up_u, up_v, up);
+    kernels.laplace_fixed_8 (
+        (const Uchar *)orig_uv->get_buf_ptr (out_x, out_y), up, (Uchar *)out_uv->get_buf_ptr (out_x, out_y));
+
+    read_split_uv<3> (gauss_uv, out_x / 2, out_y / 2 + 1, next_u, next_v);
+    interpolate_half_row_fixed<3> (gauss_u, next_u, up_u);
+    interpolate_half_row_fixed<3> (gauss_v, next_v, up_v);
+    interleave_uv_fixed (up_u, up_v, up);
+    kernels.laplace_fixed_8 (
+        (const Uchar *)orig_uv->get_buf_ptr (out_x, out_y + 1), up, (Uchar *)out_uv->get_buf_ptr (out_x, out_y + 1));
+}
+
+static inline void
+laplace_chroma_4x2_fixed (
+    const UcharImage *orig_chroma, const UcharImage *gauss_chroma, UcharImage *out_chroma,
+    uint32_t out_x, uint32_t out_y)
+{
+    int32_t gauss[3], next_gauss[3], up[4];
+    const Uchar *orig = NULL;
+    Uchar *out = NULL;
+
+    gauss_chroma->read_array<int32_t, 3> (out_x / 2, out_y / 2, gauss);
+    interpolate_int_row_fixed<3> (gauss, up);
+    orig = orig_chroma->get_buf_ptr (out_x, out_y);
+    out = out_chroma->get_buf_ptr (out_x, out_y);
+    for (uint32_t i = 0; i < 4; ++i)
+        out[i] = laplace_fixed (orig[i], up[i]);
+
+    gauss_chroma->read_array<int32_t, 3> (out_x / 2, out_y / 2 + 1, next_gauss);
+    interpolate_half_row_fixed<3> (gauss, next_gauss, up);
+    orig = orig_chroma->get_buf_ptr (out_x, out_y + 1);
+    out = out_chroma->get_buf_ptr (out_x, out_y + 1);
+    for (uint32_t i = 0; i < 4; ++i)
+        out[i] = laplace_fixed (orig[i], up[i]);
+}
+
 void
 LaplaceTask::laplace_luma (
     UcharImage *orig_luma, UcharImage *gauss_luma, UcharImage *out_luma,
@@ -555,6 +840,23 @@ LaplaceTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range
     XCAM_ASSERT (gauss_luma && (gauss_uv || (gauss_u && gauss_v)));
     XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
 
+    if (_fixed_point) {
+        for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
+            for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
+            {
+                laplace_luma_8x2_fixed (orig_luma, gauss_luma, out_luma, x * 8, y * 4);
+                laplace_luma_8x2_fixed (orig_luma, gauss_luma, out_luma, x * 8, y * 4 + 2);
+                if (orig_uv && gauss_uv && out_uv) {
+                    laplace_uv_4x2_fixed (orig_uv, gauss_uv, out_uv, x * 4, y * 2);
+                }
+                if (orig_u && orig_v && gauss_u && gauss_v && out_u && out_v) {
+                    laplace_chroma_4x2_fixed (orig_u, gauss_u, out_u, x * 4, y * 2);
+                    laplace_chroma_4x2_fixed (orig_v, gauss_v, out_v, x * 4, y * 2);
+                }
+            }
+        return XCAM_RETURN_NO_ERROR;
+    }
+
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
         {
@@ -573,20 +875,6 @@ LaplaceTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range
     return XCAM_RETURN_NO_ERROR;
 }
 
-static inline void
-reconstruct_luma_8x1 (float *lap, float *up_sample, Uchar *result)
-{
-#define RECONSTRUCT_UP_SAMPLE(i) result[i] = convert_to_uchar<float>(up_sample[i] + lap[i] * 2.0f - 256.0f)
-    RECONSTRUCT_UP_SAMPLE(0);
-    RECONSTRUCT_UP_SAMPLE(1);
-    RECONSTRUCT_UP_SAMPLE(2);
-    RECONSTRUCT_UP_SAMPLE(3);
-    RECONSTRUCT_UP_SAMPLE(4);
-    RECONSTRUCT_UP_SAMPLE(5);
-    RECONSTRUCT_UP_SAMPLE(6);
-    RECONSTRUCT_UP_SAMPLE(7);
-}
-
 static inline void
 reconstruct_uv_4x1 (Float2 *lap, Float2 *up_sample, Uchar2 *uv_uc)
 {
@@ -612,6 +900,92 @@ reconstruct_chroma_4x1 (float *lap, float *up_sample, Uchar *chroma_uc)
     RECONSTRUCT_UP_SAMPLE_CHROMA (3);
 }
 
+static inline void
+reconstruct_luma_8_fixed (
+    UcharImage **lap_luma, const UcharImage *mask, UcharImage *out_luma,
+    uint32_t x, uint32_t y, const int16_t *up)
+{
+    get_kernels ().reconstruct_fixed_8 (
+        lap_luma[0]->get_buf_ptr (x, y), lap_luma[1]->get_buf_ptr (x, y), mask->get_buf_ptr (x, y),
+        up, out_luma->get_buf_ptr (x, y));
+}
+
+static inline void
+reconstruct_luma_8x4_fixed (
+    UcharImage **lap_luma, const UcharImage *gauss_luma, UcharImage *out_luma,
+    const UcharImage *mask, uint32_t x, uint32_t y)
+{
+    int32_t gauss[5], next_gauss[5];
+    int16_t up[8];
+
+    gauss_luma->read_array<int32_t, 5> (x / 2, y / 2, gauss);
+    interpolate_int_row_fixed<5> (gauss, up);
+    reconstruct_luma_8_fixed (lap_luma, mask, out_luma, x, y, up);
+
+    gauss_luma->read_array<int32_t, 5> (x / 2, y / 2 + 1, next_gauss);
+    interpolate_half_row_fixed<5> (gauss, next_gauss, up);
+    reconstruct_luma_8_fixed (lap_luma, mask, out_luma, x, y + 1, up);
+
+    interpolate_int_row_fixed<5> (next_gauss, up);
+    reconstruct_luma_8_fixed (lap_luma, mask, out_luma, x, y + 2, up);
+
+    gauss_luma->read_array<int32_t, 5> (x / 2, y / 2 + 2, gauss);
+    interpolate_half_row_fixed<5> (next_gauss, gauss, up);
+    reconstruct_luma_8_fixed (lap_luma, mask, out_luma, x, y + 3, up);
+}
+
+static inline void
+reconstruct_uv_4x2_fixed (
+    Uchar2Image **lap_uv, const Uchar2Image *gauss_uv, Uchar2Image *out_uv,
+    uint32_t x, uint32_t y, const Uchar *uv_mask1, const Uchar *uv_mask2)
+{
+    const SimdKernels &kernels = get_kernels ();
+    int32_t gauss_u[3], gauss_v[3], next_u[3], next_v[3], up_u[4], up_v[4];
+    int16_t up[8];
+
+    read_split_uv<3> (gauss_uv, x / 2, y / 2, gauss_u, gauss_v);
+    interpolate_int_row_fixed<3> (gauss_u, up_u);
+    interpolate_int_row_fixed<3> (gauss_v, up_v);
+    interleave_uv_fixed (up_u, up_v, up);
+    kernels.reconstruct_fixed_8 (
+        (const Uchar *)lap_uv[0]->get_buf_ptr (x, y), (const Uchar *)lap_uv[1]->get_buf_ptr (x, y),
+        uv_mask1, up, (Uchar *)out_uv->get_buf_ptr (x, y));
+
+    read_split_uv<3> (gauss_uv, x / 2, y / 2 + 1, next_u, next_v);
+    interpolate_half_row_fixed<3> (gauss_u, next_u, up_u);
+    interpolate_half_row_fixed<3> (gauss_v, next_v, up_v);
+    interleave_uv_fixed (up_u, up_v, up);
+    kernels.reconstruct_fixed_8 (
+        (const Uchar *)lap_uv[0]->get_buf_ptr (x, y + 1), (const Uchar *)lap_uv[1]->get_buf_ptr (x, y + 1),
+        uv_mask2, up, (Uchar *)out_uv->get_buf_ptr (x, y + 1));
+}
+
+static inline void
+reconstruct_chroma_4x2_fixed (
+    UcharImage **lap_chroma, const UcharImage *gauss_chroma, UcharImage *out_chroma,
+    uint32_t x, uint32_t y, const Uchar *uv_mask1, const Uchar *uv_mask2)
+{
+    int32_t gauss[3], next_gauss[3], up[4];
+    const Uchar *lap_a = NULL, *lap_b = NULL;
+    Uchar *out = NULL;
+
+    gauss_chroma->read_array<int32_t, 3> (x / 2, y / 2, gauss);
+    interpolate_int_row_fixed<3> (gauss, up);
+    lap_a = lap_chroma[0]->get_buf_ptr (x, y);
+    lap_b = lap_chroma[1]->get_buf_ptr (x, y);
+    out = out_chroma->get_buf_ptr (x, y);
+    for (uint32_t i = 0; i < 4; ++i)
+        out[i] = reconstruct_fixed (lap_a[i], lap_b[i], mask_to_weight (uv_mask1[i * 2]), up[i]);
+
+    gauss_chroma->read_array<int32_t, 3> (x / 2, y / 2 + 1, next_gauss);
+    interpolate_half_row_fixed<3> (gauss, next_gauss, up);
+    lap_a = lap_chroma[0]->get_buf_ptr (x, y + 1);
+    lap_b = lap_chroma[1]->get_buf_ptr (x, y + 1);
+    out = out_chroma->get_buf_ptr (x, y + 1);
+    for (uint32_t i = 0; i < 4; ++i)
+        out[i] = reconstruct_fixed (lap_a[i], lap_b[i], mask_to_weight (uv_mask2[i * 2]), up[i]);
+}
+
 void
 ReconstructTask::reconstruct_luma (
     UcharImage **lap_luma, UcharImage *gauss_luma, UcharImage *out_luma,
@@ -627,28 +1001,28 @@ ReconstructTask::reconstruct_luma (
     // luma 1st - line
     read_and_blend_pixel_luma_8 (lap_luma[0], lap_luma[1], mask_image, in_x, in_y, luma_blend, luma_mask1);
     interpolate_luma_int_row_8x1 (gauss_luma, in_x / 2, in_y / 2, gauss_data, luma_sample);
-    reconstruct_luma_8x1 (luma_blend, luma_sample, luma_uchar);
+    get_kernels ().reconstruct_8 (luma_blend, luma_sample, luma_uchar);
     out_luma->write_array_no_check<8> (in_x, in_y, luma_uchar);
 
     // luma 2nd -line
     in_y += 1;
     read_and_blend_pixel_luma_8 (lap_luma[0], lap_luma[1], mask_image, in_x, in_y, luma_blend, luma_mask1);
     interpolate_luma_half_row_8x1 (gauss_luma, in_x / 2, in_y / 2 + 1, gauss_data, luma_sample);
-    reconstruct_luma_8x1 (luma_blend, luma_sample, luma_uchar);
+    get_kernels ().reconstruct_8 (luma_blend, luma_sample, luma_uchar);
     out_luma->write_array_no_check<8> (in_x, in_y, luma_uchar);
 
     // luma 3rd -line
     in_y += 1;
     read_and_blend_pixel_luma_8 (lap_luma[0], lap_luma[1], mask_image, in_x, in_y, luma_blend, luma_mask2);
     interpolate_luma_int_row_8x1 (gauss_luma, in_x / 2, in_y / 2, gauss_data, luma_sample);
-    reconstruct_luma_8x1 (luma_blend, luma_sample, luma_uchar);
+    get_kernels ().reconstruct_8 (luma_blend, luma_sample, luma_uchar);
     out_luma->write_array_no_check<8> (in_x, in_y, luma_uchar);
 
     // luma 4th -line
     in_y += 1;
     read_and_blend_pixel_luma_8 (lap_luma[0], lap_luma[1], mask_image, in_x, in_y, luma_blend, luma_mask2);
     interpolate_luma_half_row_8x1 (gauss_luma, in_x / 2, in_y / 2 + 1, gauss_data, luma_sample);
-    reconstruct_luma_8x1 (luma_blend, luma_sample, luma_uchar);
+    get_kernels ().reconstruct_8 (luma_blend, luma_sample, luma_uchar);
     out_luma->write_array_no_check<8> (in_x, in_y, luma_uchar);
 }
 
@@ -725,6 +1099,28 @@ ReconstructTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &r
     XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
     XCAM_ASSERT (mask_image);
 
+    if (_fixed_point) {
+        for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
+            for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
+            {
+                Uchar uv_mask1[8], uv_mask2[8];
+                reconstruct_luma_8x4_fixed (lap_luma, gauss_luma, out_luma, mask_image, x * 8, y * 4);
+
+                // same uv weights as float path, from second and fourth luma rows
+                uv_mask_fixed (mask_image->get_buf_ptr (x * 8, y * 4 + 1), uv_mask1);
+                uv_mask_fixed (mask_image->get_buf_ptr (x * 8, y * 4 + 3), uv_mask2);
+                uv_mask2[6] = uv_mask2[7] = uv_mask1[6];
+                if (lap_uv[0] && lap_uv[1] && gauss_uv && out_uv) {
+                    reconstruct_uv_4x2_fixed (lap_uv, gauss_uv, out_uv, x * 4, y * 2, uv_mask1, uv_mask2);
+                }
+                if (lap_u[0] && lap_u[1] && lap_v[0] && lap_v[1] && gauss_u && gauss_v && out_u && out_v) {
+                    reconstruct_chroma_4x2_fixed (lap_u, gauss_u, out_u, x * 4, y * 2, uv_mask1, uv_mask2);
+                    reconstruct_chroma_4x2_fixed (lap_v, gauss_v, out_v, x * 4, y * 2, uv_mask1, uv_mask2);
+                }
+            }
+        return XCAM_RETURN_NO_ERROR;
+    }
+
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y)
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x)
         {
@@ -750,6 +1146,147 @@ ReconstructTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &r
     return XCAM_RETURN_NO_ERROR;
 }
 
+uint32_t
+PyramidBandTask::Args::add_stage (
+    const SmartPtr<SoftWorker> &worker, const SmartPtr<Worker::Arguments> &args,
+    const WorkSize &global, uint32_t height)
+{
+    Stage stage;
+    stage.worker = worker;
+    stage.args = args;
+    stage.global = global;
+    stage.height = height;
+    stage.band_units = XCAM_MAX (band_rows * height / in_height / worker->get_work_unit ().value[1], 1u);
+    stage.done = 0;
+    stage.busy = false;
+    stages.push_back (stage);
+    return stages.size () - 1;
+}
+
+void
+PyramidBandTask::Args::add_dependency (uint32_t stage, uint32_t producer, uint32_t row_scale, uint32_t row_offset)
+{
+    XCAM_ASSERT (stage < stages.size ());
+    XCAM_ASSERT (producer == InputStage || producer < stage);
+    XCAM_ASSERT (row_scale > 0);
+    stages[stage].deps.push_back (Dependency (producer, row_scale, row_offset));
+}
+
+uint32_t
+PyramidBandTask::get_ready_units (const Args *args, const Dependency &dep, uint32_t units)
+{
+    // input frame is ready as a whole
+    if (dep.stage == InputStage)
+        return units;
+
+    const Stage &producer = args->stages[dep.stage];
+    uint32_t rows = producer.done * producer.worker->get_work_unit ().value[1];
+
+    // rows beyond border are clamped by readers, only available after producer finished
+    if (producer.done >= producer.global.value[1])
+        return units;
+    if (rows < dep.row_offset)
+        return 0;
+    return XCAM_MIN ((rows - dep.row_offset) / dep.row_scale + 1, units);
+}
+
+// waits until a stage has ready rows, index is stage count once all stages are done
+XCamReturn
+PyramidBandTask::next_band (Args *args, uint32_t &index, WorkRange &band)
+{
+    SmartLock locker (args->mutex);
+    while (xcam_ret_is_ok (args->error)) {
+        bool finished = true;
+        // stages nearest to output first, rows are consumed soon after they are produced
+        for (int32_t i = (int32_t)args->stages.size () - 1; i >= 0; --i) {
+            Stage &stage = args->stages[i];
+            uint32_t units = stage.global.value[1];
+            if (stage.done >= units)
+                continue;
+            finished = false;
+            if (stage.busy)
+                continue;
+
+            uint32_t end = XCAM_MIN (stage.done + stage.band_units, units);
+            for (uint32_t d = 0; d < stage.deps.size (); ++d) {
+                end = XCAM_MIN (end, get_ready_units (args, stage.deps[d], units));
+            }
+            if (end <= stage.done)
+                continue;
+
+            stage.busy = true;
+            ++args->busy_stages;
+            band.pos[0] = 0;
+            band.pos_len[0] = stage.global.value[0];
+            band.pos[1] = stage.done;
+            band.pos_len[1] = end - stage.done;
+            band.pos_len[2] = 1;
+            index = i;
+            return XCAM_RETURN_NO_ERROR;
+        }
+
+        if (finished) {
+            index = args->stages.size ();
+            return XCAM_RETURN_NO_ERROR;
+        }
+        if (!args->busy_stages) {
+            for (uint32_t i = 0; i < args->stages.size (); ++i) {
+                if (args->stages[i].done < args->stages[i].global.value[1]) {
+                    XCAM_LOG_ERROR (
+                        "pyramid band task stage(%d) stalled at unit row %d", i, args->stages[i].done);
+                    break;
+                }
+            }
+            args->error = XCAM_RETURN_ERROR_UNKNOWN;
+            args->cond.broadcast ();
+            break;
+        }
+        args->cond.wait (args->mutex);
+    }
+    return args->error;
+}
+
+void
+PyramidBandTask::band_done (Args *args, uint32_t index, const WorkRange &band, XCamReturn error)
+{
+    SmartLock locker (args->mutex);
+    Stage &stage = args->stages[index];
+    stage.busy = false;
+    --args->busy_stages;
+    if (xcam_ret_is_ok (error))
+        stage.done = band.pos[1] + band.pos_len[1];
+    else
+        args->error = error;
+    args->cond.broadcast ();
+}
+
+XCamReturn
+PyramidBandTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
+{
+    XCAM_UNUSED (range);
+    SmartPtr<PyramidBandTask::Args> args = base.dynamic_cast_ptr<PyramidBandTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
+    XCAM_ASSERT (args->band_rows > 0 && args->in_height > 0);
+
+    while (true) {
+        uint32_t index = 0;
+        WorkRange band;
+        XCamReturn ret = next_band (args.ptr (), index, band);
+        if (!xcam_ret_is_ok (ret) || index == args->stages.size ())
+            return ret;
+
+        Stage &stage = args->stages[index];
+        ret = stage.worker->run_range (stage.args, band);
+        band_done (args.ptr (), index, band, ret);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret), ret,
+            "pyramid band task stage(%d) failed on rows:[%d, %d)",
+            index, band.pos[1], band.pos[1] + band.pos_len[1]);
+    }
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
 }
 
 }
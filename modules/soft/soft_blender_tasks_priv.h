@@ -48,10 +48,15 @@ public:
 public:
     explicit GaussScaleGray (const char *name = "GaussScaleGray", const SmartPtr<Worker::Callback> &cb = NULL)
         : SoftWorker (name, cb)
+        , _fixed_point (false)
     {
         set_work_unit (2, 2);
     }
 
+    void set_fixed_point (bool enable) {
+        _fixed_point = enable;
+    }
+
 private:
     virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
 
@@ -78,6 +83,7 @@ protected:
 
 protected:
     static const float coeffs[GAUSS_DOWN_SCALE_SIZE];
+    bool               _fixed_point;
 };
 
 class GaussDownScale
@@ -157,10 +163,15 @@ public:
 public:
     explicit BlendTask (const SmartPtr<Worker::Callback> &cb)
         : SoftWorker ("SoftBlendTask", cb)
+        , _fixed_point (false)
     {
         set_work_unit (8, 2);
     }
 
+    void set_fixed_point (bool enable) {
+        _fixed_point = enable;
+    }
+
 private:
     virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
     void blend_luma (
@@ -172,6 +183,9 @@ private:
     void blend_chroma (
         UcharImage *in0_chroma, UcharImage *in1_chroma, UcharImage *out_chroma,
         float* mask, uint32_t x, uint32_t y);
+
+private:
+    bool                  _fixed_point;
 };
 
 class LaplaceTask
@@ -202,10 +216,15 @@ public:
 public:
     explicit LaplaceTask (const SmartPtr<Worker::Callback> &cb)
         : SoftWorker ("SoftLaplaceTask", cb)
+        , _fixed_point (false)
     {
         set_work_unit (8, 4);
     }
 
+    void set_fixed_point (bool enable) {
+        _fixed_point = enable;
+    }
+
 private:
     virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
 
@@ -222,6 +241,9 @@ private:
     void interplate_luma_8x2 (
         UcharImage *orig_luma, UcharImage *gauss_luma, UcharImage *out_luma,
         uint32_t out_x, uint32_t out_y);
+
+private:
+    bool                  _fixed_point;
 };
 
 class ReconstructTask
@@ -251,10 +273,15 @@ public:
 public:
     explicit ReconstructTask (const SmartPtr<Worker::Callback> &cb)
         : SoftWorker ("SoftReconstructTask", cb)
+        , _fixed_point (false)
     {
         set_work_unit (8, 4);
     }
 
+    void set_fixed_point (bool enable) {
+        _fixed_point = enable;
+    }
+
 private:
     virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
     void reconstruct_luma (
@@ -269,6 +296,92 @@ private:
         UcharImage **lap_chroma, UcharImage *gauss_chroma, UcharImage *out_chroma,
         float* mask1, float* mask2,
         uint32_t x, uint32_t y);
+
+private:
+    bool                  _fixed_point;
+};
+
+/*
+ * runs a chain of pyramid stages band by band (rows of level 0) instead of full-image passes,
+ * every stage only advances as far as the rows of its producers are ready,
+ * so intermediate rows are consumed while they are still in cache.
+ * stage outputs are full-size buffers, halo rows are read from finished rows, no recomputing.
+ * each work item is a band runner, runners take the next ready band of any idle stage,
+ * stages nearest to output first, so stages and both inputs run in parallel on several items.
+ */
+class PyramidBandTask
+    : public SoftWorker
+{
+public:
+    enum {
+        InputStage = 0xFFFFFFFF,
+    };
+
+    // unit row y of consumer needs rows [0, y * row_scale + row_offset) of @stage
+    struct Dependency {
+        uint32_t                    stage;
+        uint32_t                    row_scale;
+        uint32_t                    row_offset;
+
+        Dependency (uint32_t s, uint32_t scale, uint32_t offset)
+            : stage (s), row_scale (scale), row_offset (offset)
+        {}
+    };
+
+    struct Stage {
+        SmartPtr<SoftWorker>        worker;
+        SmartPtr<Worker::Arguments> args;
+        WorkSize                    global;
+        uint32_t                    height;
+        // unit rows of about band_rows input rows
+        uint32_t                    band_units;
+        uint32_t                    done;
+        // one band of a stage runs at a time, done rows stay contiguous
+        bool                        busy;
+        std::vector<Dependency>     deps;
+    };
+
+    struct Args : SoftArgs {
+        std::vector<Stage>          stages;
+        const uint32_t              in_height;
+        const uint32_t              band_rows;
+
+        SmartPtr<VideoBuffer>       out_buf;
+
+        // guards done/busy of stages, runners wait on cond for ready rows
+        Mutex                       mutex;
+        Cond                        cond;
+        uint32_t                    busy_stages;
+        XCamReturn                  error;
+
+        Args (
+            const SmartPtr<ImageHandler::Parameters> &param,
+            const uint32_t in_h, const uint32_t rows)
+            : SoftArgs (param)
+            , in_height (in_h)
+            , band_rows (rows)
+            , busy_stages (0)
+            , error (XCAM_RETURN_NO_ERROR)
+        {}
+
+        uint32_t add_stage (
+            const SmartPtr<SoftWorker> &worker, const SmartPtr<Worker::Arguments> &args,
+            const WorkSize &global, uint32_t height);
+        void add_dependency (uint32_t stage, uint32_t producer, uint32_t row_scale, uint32_t row_offset);
+    };
+
+public:
+    explicit PyramidBandTask (const SmartPtr<Worker::Callback> &cb)
+        : SoftWorker ("SoftPyramidBandTask", cb)
+    {
+        set_work_unit (1, 1);
+    }
+
+private:
+    virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
+    uint32_t get_ready_units (const Args *args, const Dependency &dep, uint32_t units);
+    XCamReturn next_band (Args *args, uint32_t &index, WorkRange &band);
+    void band_done (Args *args, uint32_t index, const WorkRange &band, XCamReturn error);
 };
 
 }
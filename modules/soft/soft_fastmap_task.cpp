@@ -0,0 +1,163 @@
+/*
+ * soft_fastmap_task.cpp - soft fastmap remap and blend implementation
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "soft_fastmap_task.h"
+#include "soft_simd_priv.h"
+
+#define FASTMAP_UNIT_PIXELS 8
+
+namespace XCam {
+
+namespace XCamSoftTasks {
+
+// same as geomap, positions out of image take zero value
+template <typename O, typename ImageT>
+static inline O sample_pixel (const ImageT *in, const Float2 &pos, const O &zero)
+{
+    if (pos.x < 0.0f || pos.y < 0.0f || pos.x >= in->get_width () || pos.y >= in->get_height ())
+        return zero;
+    return in->template read_interpolate_data<O> (pos.x, pos.y);
+}
+
+static void
+map_luma (const UcharImage *in, const Float2 *pos, Uchar *out)
+{
+    if (XCamSoftSimd::get_kernels ().interp_uchar (in, pos, FASTMAP_UNIT_PIXELS, out))
+        return;
+
+    for (uint32_t i = 0; i < FASTMAP_UNIT_PIXELS; ++i)
+        out[i] = convert_to_uchar (sample_pixel<float> (in, pos[i], 0.0f));
+}
+
+static void
+blend_luma (
+    const UcharImage *in0, const Float2 *pos0, const UcharImage *in1, const Float2 *pos1,
+    const Uchar *mask, Uchar *out)
+{
+    if (XCamSoftSimd::get_kernels ().fastmap_blend_8 (in0, pos0, in1, pos1, mask, out))
+        return;
+
+    for (uint32_t i = 0; i < FASTMAP_UNIT_PIXELS; ++i) {
+        float v0 = sample_pixel<float> (in0, pos0[i], 0.0f);
+        float v1 = sample_pixel<float> (in1, pos1[i], 0.0f);
+        float m = mask[i] / 255.0f;
+        out[i] = convert_to_uchar ((v0 - v1) * m + v1);
+    }
+}
+
+XCamReturn
+FastMapTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
+{
+    static const Float2 zero_uv (128.0f, 128.0f);
+    static const float zero_chroma = 128.0f;
+
+    SmartPtr<FastMapTask::Args> args = base.dynamic_cast_ptr<FastMapTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
+
+    const bool blend = args->in_luma[1].ptr () != NULL;
+    const uint32_t in_count = blend ? 2 : 1;
+    UcharImage *out_luma = args->out_luma.ptr ();
+    Uchar2Image *out_uv = args->out_uv.ptr ();
+    UcharImage *out_u = args->out_u.ptr (), *out_v = args->out_v.ptr ();
+    XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
+    XCAM_ASSERT (!blend || args->mask.ptr ());
+
+    const UcharImage *in_luma[2] = {NULL, NULL};
+    const Uchar2Image *in_uv[2] = {NULL, NULL};
+    const UcharImage *in_u[2] = {NULL, NULL}, *in_v[2] = {NULL, NULL};
+    const Float2Image *coords[2] = {NULL, NULL};
+    for (uint32_t k = 0; k < in_count; ++k) {
+        in_luma[k] = args->in_luma[k].ptr ();
+        in_uv[k] = args->in_uv[k].ptr ();
+        in_u[k] = args->in_u[k].ptr ();
+        in_v[k] = args->in_v[k].ptr ();
+        coords[k] = args->coords[k].ptr ();
+        XCAM_ASSERT (in_luma[k] && coords[k]);
+        XCAM_ASSERT ((out_uv && in_uv[k]) || (out_u && in_u[k] && in_v[k]));
+    }
+    const Uchar *mask = blend ? args->mask->get_buf_ptr (0, 0) : NULL;
+
+    for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y) {
+        for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x) {
+            const uint32_t out_x = x * FASTMAP_UNIT_PIXELS, out_y = y * 2;
+            const Float2 *pos[2][2] = {{NULL, NULL}, {NULL, NULL}};
+            for (uint32_t k = 0; k < in_count; ++k) {
+                pos[k][0] = coords[k]->get_buf_ptr (args->coords_x[k] + out_x, args->coords_y[k] + out_y);
+                pos[k][1] = coords[k]->get_buf_ptr (args->coords_x[k] + out_x, args->coords_y[k] + out_y + 1);
+            }
+
+            Uchar luma[FASTMAP_UNIT_PIXELS];
+            for (uint32_t r = 0; r < 2; ++r) {
+                if (blend)
+                    blend_luma (in_luma[0], pos[0][r], in_luma[1], pos[1][r], mask + out_x, luma);
+                else
+                    map_luma (in_luma[0], pos[0][r], luma);
+                out_luma->write_array_no_check<FASTMAP_UNIT_PIXELS> (out_x, out_y + r, luma);
+            }
+
+            // chroma samples at even luma position of even row
+            Float2 chroma_pos[2][FASTMAP_UNIT_PIXELS / 2];
+            for (uint32_t k = 0; k < in_count; ++k) {
+                for (uint32_t i = 0; i < FASTMAP_UNIT_PIXELS / 2; ++i)
+                    chroma_pos[k][i] = pos[k][0][i * 2] * 0.5f;
+            }
+
+            if (out_uv) {
+                Uchar2 uv[FASTMAP_UNIT_PIXELS / 2];
+                for (uint32_t i = 0; i < FASTMAP_UNIT_PIXELS / 2; ++i) {
+                    Float2 v = sample_pixel<Float2> (in_uv[0], chroma_pos[0][i], zero_uv);
+                    if (blend) {
+                        Float2 v1 = sample_pixel<Float2> (in_uv[1], chroma_pos[1][i], zero_uv);
+                        float m = mask[out_x + i * 2] / 255.0f;
+                        v = (v - v1) * m + v1;
+                    }
+                    uv[i] = convert_to_uchar2 (v);
+                }
+                out_uv->write_array_no_check<FASTMAP_UNIT_PIXELS / 2> (out_x / 2, out_y / 2, uv);
+            } else {
+                Uchar u[FASTMAP_UNIT_PIXELS / 2], v[FASTMAP_UNIT_PIXELS / 2];
+                for (uint32_t i = 0; i < FASTMAP_UNIT_PIXELS / 2; ++i) {
+                    float u0 = sample_pixel<float> (in_u[0], chroma_pos[0][i], zero_chroma);
+                    float v0 = sample_pixel<float> (in_v[0], chroma_pos[0][i], zero_chroma);
+                    if (blend) {
+                        float u1 = sample_pixel<float> (in_u[1], chroma_pos[1][i], zero_chroma);
+                        float v1 = sample_pixel<float> (in_v[1], chroma_pos[1][i], zero_chroma);
+                        float m = mask[out_x + i * 2] / 255.0f;
+                        u0 = (u0 - u1) * m + u1;
+                        v0 = (v0 - v1) * m + v1;
+                    }
+                    u[i] = convert_to_uchar (u0);
+                    v[i] = convert_to_uchar (v0);
+                }
+                out_u->write_array_no_check<FASTMAP_UNIT_PIXELS / 2> (out_x / 2, out_y / 2, u);
+                out_v->write_array_no_check<FASTMAP_UNIT_PIXELS / 2> (out_x / 2, out_y / 2, v);
+            }
+        }
+    }
+
+    XCAM_LOG_DEBUG ("FastMapTask work on range:[x:%d, width:%d, y:%d, height:%d]",
+                    range.pos[0], range.pos_len[0], range.pos[1], range.pos_len[1]);
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * soft_fastmap_task.h - soft fastmap remap and blend class
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_SOFT_FASTMAP_TASK_H
+#define XCAM_SOFT_FASTMAP_TASK_H
+
+#include <xcam_std.h>
+#include <soft/soft_worker.h>
+#include <soft/soft_handler.h>
+#include <soft/soft_image.h>
+
+namespace XCam {
+
+namespace XCamSoftTasks {
+
+// remap out images by precomputed luma coordinates in one pass,
+// blends two inputs with mask if in_luma[1] is set, otherwise remaps in_luma[0] only.
+// work unit is 8x2 luma pixels, out images width need align to 8 and height to 2
+class FastMapTask
+    : public SoftWorker
+{
+public:
+    struct Args : SoftArgs {
+        SmartPtr<UcharImage>         in_luma[2], out_luma;
+        SmartPtr<Uchar2Image>        in_uv[2], out_uv;
+        SmartPtr<UcharImage>         in_u[2], in_v[2], out_u, out_v;
+        // out pixel (x, y) samples input idx at coords[idx] (coords_x[idx] + x, coords_y[idx] + y)
+        SmartPtr<Float2Image>        coords[2];
+        uint32_t                     coords_x[2], coords_y[2];
+        // one line of out width, weight of input 0 in [0, 255]
+        SmartPtr<UcharImage>         mask;
+
+        Args (const SmartPtr<ImageHandler::Parameters> &param)
+            : SoftArgs (param)
+        {
+            xcam_mem_clear (coords_x);
+            xcam_mem_clear (coords_y);
+        }
+    };
+
+public:
+    explicit FastMapTask (const SmartPtr<Worker::Callback> &cb)
+        : SoftWorker ("FastMapTask", cb)
+    {
+        set_work_unit (8, 2);
+    }
+
+private:
+    virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
+};
+
+}
+
+}
+
+#endif // XCAM_SOFT_FASTMAP_TASK_H
@@ -32,6 +32,8 @@ DECLARE_WORK_CALLBACK (CbGeoMapDualCurveTask, SoftDualCurveGeoMapper, remap_task
 
 SoftGeoMapper::SoftGeoMapper (const char *name)
     : SoftHandler (name)
+    , _compact_scale (1.0f)
+    , _compact (false)
 {
 }
 
@@ -47,6 +49,10 @@ SoftGeoMapper::set_lookup_table (const PointFloat2 *data, uint32_t width, uint32
         "SoftGeoMapper(%s) set loop up table need w>1 and h>1, but width:%d, height:%d",
         XCAM_STR (get_name ()), width, height);
 
+    if (_compact)
+        return set_compact_lookup_table (data, width, height);
+
+    _compact_table.release ();
     _lookup_table = new Float2Image (width, height);
 
     XCAM_FAIL_RETURN(
@@ -66,6 +72,71 @@ SoftGeoMapper::set_lookup_table (const PointFloat2 *data, uint32_t width, uint32
     return true;
 }
 
+bool
+SoftGeoMapper::set_compact_lookup_table (const PointFloat2 *data, uint32_t width, uint32_t height)
+{
+    float max_value = 1.0f;
+    for (uint32_t i = 0; i < width * height; ++i) {
+        max_value = XCAM_MAX (max_value, fabs (data[i].x));
+        max_value = XCAM_MAX (max_value, fabs (data[i].y));
+    }
+
+    // most fraction bits which keep all entries in int16 range
+    uint32_t frac_bits = 0;
+    while (frac_bits < 14 && max_value * (1 << (frac_bits + 1)) < (float)INT16_MAX)
+        ++frac_bits;
+
+    _lookup_table.release ();
+    _compact_table = new Short2Image (width, height);
+    XCAM_FAIL_RETURN(
+        ERROR, _compact_table.ptr () && _compact_table->is_valid (), false,
+        "SoftGeoMapper(%s) set compact look up table failed in data allocation",
+        XCAM_STR (get_name ()));
+
+    const float one = (float)(1 << frac_bits);
+    _compact_scale = 1.0f / one;
+    for (uint32_t i = 0; i < height; ++i) {
+        Short2 *ret = _compact_table->get_buf_ptr (0, i);
+        const PointFloat2 *line = &data[i * width];
+        for (uint32_t j = 0; j < width; ++j) {
+            ret[j].x = (int16_t)roundf (line [j].x * one);
+            ret[j].y = (int16_t)roundf (line [j].y * one);
+        }
+    }
+
+    XCAM_LOG_DEBUG (
+        "SoftGeoMapper(%s) compact look up table(%dx%d) in Q%d",
+        XCAM_STR (get_name ()), width, height, frac_bits);
+    return true;
+}
+
+bool
+SoftGeoMapper::get_lookup_table_size (uint32_t &width, uint32_t &height) const
+{
+    if (_compact_table.ptr () && _compact_table->is_valid ()) {
+        width = _compact_table->get_width ();
+        height = _compact_table->get_height ();
+        return true;
+    }
+    if (_lookup_table.ptr () && _lookup_table->is_valid ()) {
+        width = _lookup_table->get_width ();
+        height = _lookup_table->get_height ();
+        return true;
+    }
+    return false;
+}
+
+void
+SoftGeoMapper::set_table_arguments (const SmartPtr<Worker::Arguments> &base)
+{
+    SmartPtr<XCamSoftTasks::GeoMapTask::Args> args = base.dynamic_cast_ptr<XCamSoftTasks::GeoMapTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
+
+    args->lookup_table = _lookup_table;
+    args->compact_table = _compact_table;
+    args->compact_scale = _compact_scale;
+}
+
 XCamReturn
 SoftGeoMapper::remap (
     const SmartPtr<VideoBuffer> &in,
@@ -83,8 +154,9 @@ SoftGeoMapper::remap (
 XCamReturn
 SoftGeoMapper::configure_resource (const SmartPtr<Parameters> &param)
 {
+    uint32_t lut_width, lut_height;
     XCAM_FAIL_RETURN(
-        ERROR, _lookup_table.ptr () && _lookup_table->is_valid (), XCAM_RETURN_ERROR_PARAM,
+        ERROR, get_lookup_table_size (lut_width, lut_height), XCAM_RETURN_ERROR_PARAM,
         "SoftGeoMapper(%s) configure failed, look_up_table was not set correctly",
         XCAM_STR (get_name ()));
 
@@ -107,6 +179,7 @@ SoftGeoMapper::configure_resource (const SmartPtr<Parameters> &param)
 
     XCAM_ASSERT (!_map_task.ptr ());
     _map_task = create_remap_task ();
+    setup_worker (_map_task);
 
     return XCAM_RETURN_NO_ERROR;
 }
@@ -160,7 +233,9 @@ SoftGeoMapper::init_factors ()
     if (!XCAM_DOUBLE_EQUAL_AROUND (factors.x, 0.0f) && !XCAM_DOUBLE_EQUAL_AROUND (factors.y, 0.0f))
         return true;
 
-    return auto_calculate_factors (_lookup_table->get_width (), _lookup_table->get_height ());
+    uint32_t lut_width = 0, lut_height = 0;
+    get_lookup_table_size (lut_width, lut_height);
+    return auto_calculate_factors (lut_width, lut_height);
 }
 
 SmartPtr<XCamSoftTasks::GeoMapTask>
@@ -172,32 +247,93 @@ SoftGeoMapper::create_remap_task ()
     return map_task;
 }
 
-XCamReturn
-SoftGeoMapper::start_remap_task (const SmartPtr<ImageHandler::Parameters> &param)
+SmartPtr<Worker::Arguments>
+SoftGeoMapper::create_remap_args (const SmartPtr<ImageHandler::Parameters> &param)
 {
-    XCAM_ASSERT (_map_task.ptr ());
-    XCAM_ASSERT (_lookup_table.ptr ());
+    SmartPtr<XCamSoftTasks::GeoMapTask::Args> args = new XCamSoftTasks::GeoMapTask::Args (param);
+    XCAM_ASSERT (args.ptr ());
 
     Float2 factors;
     get_factors (factors.x, factors.y);
+    args->factors = factors;
+    set_table_arguments (args);
+
+    return args;
+}
+
+XCamReturn
+SoftGeoMapper::start_map_work (const SmartPtr<ImageHandler::Parameters> &param, const MapArea *area)
+{
+    XCAM_ASSERT (_map_task.ptr ());
+    XCAM_ASSERT (_lookup_table.ptr () || _compact_table.ptr ());
+
+    SmartPtr<XCamSoftTasks::GeoMapTask::Args> args =
+        create_remap_args (param).dynamic_cast_ptr<XCamSoftTasks::GeoMapTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
 
     SmartPtr<VideoBuffer> in_buf = param->in_buf, out_buf = param->out_buf;
-    SmartPtr<XCamSoftTasks::GeoMapTask::Args> args = new XCamSoftTasks::GeoMapTask::Args (param);
-    args->in_luma = new UcharImage (in_buf, 0);
-    args->out_luma = new UcharImage (out_buf, 0);
+    if (area && area->out_buf.ptr ())
+        out_buf = area->out_buf;
 
-    if (V4L2_PIX_FMT_NV12 == in_buf->get_format ()) {
+    uint32_t format = in_buf->get_format ();
+    args->in_luma = new UcharImage (in_buf, 0);
+    if (V4L2_PIX_FMT_NV12 == format) {
         args->in_uv = new Uchar2Image (in_buf, 1);
-        args->out_uv = new Uchar2Image (out_buf, 1);
-    } else if (V4L2_PIX_FMT_YUV420 == in_buf->get_format ()) {
+    } else if (V4L2_PIX_FMT_YUV420 == format) {
         args->in_u = new UcharImage (in_buf, 1);
         args->in_v = new UcharImage (in_buf, 2);
-        args->out_u = new UcharImage (out_buf, 1);
-        args->out_v = new UcharImage (out_buf, 2);
     }
 
-    args->lookup_table = _lookup_table;
-    args->factors = factors;
+    if (!area) {
+        args->out_luma = new UcharImage (out_buf, 0);
+        if (V4L2_PIX_FMT_NV12 == format) {
+            args->out_uv = new Uchar2Image (out_buf, 1);
+        } else if (V4L2_PIX_FMT_YUV420 == format) {
+            args->out_u = new UcharImage (out_buf, 1);
+            args->out_v = new UcharImage (out_buf, 2);
+        }
+
+        args->map_width = args->out_luma->get_width ();
+        args->map_height = args->out_luma->get_height ();
+        args->out_area = Rect (0, 0, args->map_width, args->map_height);
+    } else {
+        const Rect &rect = area->area;
+        get_output_size (args->map_width, args->map_height);
+        XCAM_FAIL_RETURN (
+            ERROR,
+            rect.pos_x >= 0 && rect.pos_y >= 0 && rect.width > 0 && rect.height > 0 &&
+            rect.pos_x + rect.width <= (int32_t)args->map_width &&
+            rect.pos_y + rect.height <= (int32_t)args->map_height,
+            XCAM_RETURN_ERROR_PARAM,
+            "SoftGeoMapper(%s) map area(%d, %d, %d, %d) is out of output(%dx%d)",
+            XCAM_STR (get_name ()), rect.pos_x, rect.pos_y, rect.width, rect.height,
+            args->map_width, args->map_height);
+        XCAM_FAIL_RETURN (
+            ERROR,
+            rect.pos_x % XCAM_SOFT_WORKUNIT_PIXELS == 0 && rect.width % XCAM_SOFT_WORKUNIT_PIXELS == 0 &&
+            rect.pos_y % 2 == 0 && rect.height % 2 == 0 && area->out_x % 2 == 0 && area->out_y % 2 == 0,
+            XCAM_RETURN_ERROR_PARAM,
+            "SoftGeoMapper(%s) map area(%d, %d, %d, %d) to (%d, %d) is not aligned to work unit",
+            XCAM_STR (get_name ()), rect.pos_x, rect.pos_y, rect.width, rect.height, area->out_x, area->out_y);
+
+        const VideoBufferInfo &out_info = out_buf->get_video_info ();
+        args->out_luma = new UcharImage (
+            out_buf, rect.width, rect.height, out_info.strides[0],
+            out_info.offsets[0] + area->out_x + area->out_y * out_info.strides[0]);
+        if (V4L2_PIX_FMT_NV12 == format) {
+            args->out_uv = new Uchar2Image (
+                out_buf, rect.width / 2, rect.height / 2, out_info.strides[1],
+                out_info.offsets[1] + area->out_x + area->out_y / 2 * out_info.strides[1]);
+        } else if (V4L2_PIX_FMT_YUV420 == format) {
+            args->out_u = new UcharImage (
+                out_buf, rect.width / 2, rect.height / 2, out_info.strides[1],
+                out_info.offsets[1] + area->out_x / 2 + area->out_y / 2 * out_info.strides[1]);
+            args->out_v = new UcharImage (
+                out_buf, rect.width / 2, rect.height / 2, out_info.strides[2],
+                out_info.offsets[2] + area->out_x / 2 + area->out_y / 2 * out_info.strides[2]);
+        }
+        args->out_area = rect;
+    }
 
     uint32_t thread_x = 2;
     uint32_t thread_y = 2;
@@ -207,10 +343,96 @@ SoftGeoMapper::start_remap_task (const SmartPtr<ImageHandler::Parameters> &param
 
     set_work_size (thread_x, thread_y, args->out_luma->get_width (), args->out_luma->get_height ());
 
-    param->in_buf.release ();
     return _map_task->work (args);
 }
 
+SmartPtr<Float2Image>
+SoftGeoMapper::dump_coords ()
+{
+    uint32_t width = 0, height = 0;
+    get_output_size (width, height);
+    XCAM_FAIL_RETURN (
+        ERROR, width > 1 && height > 1 && (_lookup_table.ptr () || _compact_table.ptr ()), NULL,
+        "SoftGeoMapper(%s) dump coords failed, output size(%dx%d) or look up table was not set",
+        XCAM_STR (get_name ()), width, height);
+    XCAM_FAIL_RETURN (
+        ERROR, init_factors (), NULL,
+        "SoftGeoMapper(%s) dump coords failed in factors initialization", XCAM_STR (get_name ()));
+
+    SmartPtr<XCamSoftTasks::GeoMapTask> task = _map_task;
+    if (!task.ptr ())
+        task = create_remap_task ();
+    XCAM_ASSERT (task.ptr ());
+
+    SmartPtr<XCamSoftTasks::GeoMapTask::Args> args =
+        create_remap_args (NULL).dynamic_cast_ptr<XCamSoftTasks::GeoMapTask::Args> ();
+    XCAM_ASSERT (args.ptr ());
+
+    WorkSize work_unit = task->get_work_unit ();
+    uint32_t aligned_w = XCAM_ALIGN_UP (width, work_unit.value[0]);
+    uint32_t aligned_h = XCAM_ALIGN_UP (height, work_unit.value[1]);
+    SmartPtr<Float2Image> coords = new Float2Image (aligned_w, aligned_h);
+    XCAM_FAIL_RETURN (
+        ERROR, coords.ptr () && coords->is_valid (), NULL,
+        "SoftGeoMapper(%s) dump coords failed in data allocation", XCAM_STR (get_name ()));
+
+    args->map_width = width;
+    args->map_height = height;
+    args->out_area = Rect (0, 0, aligned_w, aligned_h);
+    args->out_coords = coords;
+
+    WorkRange range;
+    range.pos_len[0] = aligned_w / work_unit.value[0];
+    range.pos_len[1] = aligned_h / work_unit.value[1];
+    XCamReturn ret = task->run_range (args, range);
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), NULL,
+        "SoftGeoMapper(%s) dump coords failed", XCAM_STR (get_name ()));
+
+    return coords;
+}
+
+XCamReturn
+SoftGeoMapper::start_remap_task (const SmartPtr<ImageHandler::Parameters> &param)
+{
+    XCamReturn ret = XCAM_RETURN_NO_ERROR;
+
+    SmartPtr<AreaParameters> area_param = param.dynamic_cast_ptr<AreaParameters> ();
+    if (!area_param.ptr () || area_param->areas.empty ()) {
+        ret = start_map_work (param, NULL);
+    } else {
+        const MapAreas &areas = area_param->areas;
+        // counted before starting, an early area done must not end the frame
+        area_param->remain_areas = areas.size ();
+        for (uint32_t i = 0; i < areas.size (); ++i) {
+            ret = start_map_work (param, &areas[i]);
+            if (!xcam_ret_is_ok (ret)) {
+                // only started areas are done later
+                area_param->remain_areas -= areas.size () - i;
+                XCAM_LOG_ERROR (
+                    "SoftGeoMapper(%s) start remap task failed on area:%d", XCAM_STR (get_name ()), i);
+                return ret;
+            }
+        }
+    }
+
+    param->in_buf.release ();
+    return ret;
+}
+
+void
+SoftGeoMapper::remap_done (const SmartPtr<ImageHandler::Parameters> &param, const XCamReturn error)
+{
+    if (!check_work_continue (param, error))
+        return;
+
+    SmartPtr<AreaParameters> area_param = param.dynamic_cast_ptr<AreaParameters> ();
+    if (area_param.ptr () && !area_param->areas.empty () && --area_param->remain_areas > 0)
+        return;
+
+    work_well_done (param, error);
+}
+
 XCamReturn
 SoftGeoMapper::start_work (const SmartPtr<ImageHandler::Parameters> &param)
 {
@@ -248,11 +470,7 @@ SoftGeoMapper::remap_task_done (
     SmartPtr<XCamSoftTasks::GeoMapTask::Args> args = base.dynamic_cast_ptr<XCamSoftTasks::GeoMapTask::Args> ();
     XCAM_ASSERT (args.ptr ());
 
-    const SmartPtr<ImageHandler::Parameters> param = args->get_param ();
-    if (!check_work_continue (param, error))
-        return;
-
-    work_well_done (param, error);
+    remap_done (args->get_param (), error);
 }
 
 SmartPtr<SoftHandler> create_soft_geo_mapper ()
@@ -318,11 +536,11 @@ SoftDualConstGeoMapper::init_factors ()
             !XCAM_DOUBLE_EQUAL_AROUND (right_factors.x, 0.0f) && !XCAM_DOUBLE_EQUAL_AROUND (right_factors.y, 0.0f))
         return true;
 
-    SmartPtr<Float2Image> lut_table = get_lookup_table ();
-    XCAM_ASSERT (lut_table.ptr ());
+    uint32_t lut_width = 0, lut_height = 0;
+    get_lookup_table_size (lut_width, lut_height);
 
     XCAM_FAIL_RETURN (
-        ERROR, auto_calculate_factors (lut_table->get_width (), lut_table->get_height ()),
+        ERROR, auto_calculate_factors (lut_width, lut_height),
         false, "SoftGeoMapper(%s) auto calculate factors failed", XCAM_STR(get_name ()));
 
     get_factors (_left_factor_x, _left_factor_y);
@@ -342,15 +560,9 @@ SoftDualConstGeoMapper::create_remap_task ()
     return map_task;
 }
 
-XCamReturn
-SoftDualConstGeoMapper::prepare_arguments (
-    const SmartPtr<Worker::Arguments> &base,
-    const SmartPtr<ImageHandler::Parameters> &param)
+void
+SoftDualConstGeoMapper::prepare_arguments (const SmartPtr<Worker::Arguments> &base)
 {
-    SmartPtr<Float2Image> lookup_table = get_lookup_table ();
-    XCAM_ASSERT (lookup_table.ptr ());
-
-    SmartPtr<VideoBuffer> in_buf = param->in_buf, out_buf = param->out_buf;
     SmartPtr<XCamSoftTasks::GeoMapDualConstTask::Args> args =
         base.dynamic_cast_ptr<XCamSoftTasks::GeoMapDualConstTask::Args> ();
     XCAM_ASSERT (args.ptr ());
@@ -360,46 +572,21 @@ SoftDualConstGeoMapper::prepare_arguments (
     args->left_factor = factors;
     get_right_factors (factors.x, factors.y);
     args->right_factor = factors;
-    args->in_luma = new UcharImage (in_buf, 0);
-    args->out_luma = new UcharImage (out_buf, 0);
-
-    if (V4L2_PIX_FMT_NV12 == in_buf->get_format ()) {
-        args->in_uv = new Uchar2Image (in_buf, 1);
-        args->out_uv = new Uchar2Image (out_buf, 1);
-    } else if (V4L2_PIX_FMT_YUV420 == in_buf->get_format ()) {
-        args->in_u = new UcharImage (in_buf, 1);
-        args->in_v = new UcharImage (in_buf, 2);
-        args->out_u = new UcharImage (out_buf, 1);
-        args->out_v = new UcharImage (out_buf, 2);
-    }
-
-    args->lookup_table = lookup_table;
-
-    uint32_t thread_x = 2;
-    uint32_t thread_y = 2;
-    get_thread_count (thread_x, thread_y);
-    if (thread_x == 0) thread_x = 2;
-    if (thread_y == 0) thread_y = 2;
-
-    set_work_size (thread_x, thread_y, args->out_luma->get_width (), args->out_luma->get_height ());
 
-    param->in_buf.release ();
-    return XCAM_RETURN_NO_ERROR;
+    set_table_arguments (args);
+    XCAM_ASSERT (args->lookup_table.ptr () || args->compact_table.ptr ());
 }
 
-XCamReturn
-SoftDualConstGeoMapper::start_remap_task (const SmartPtr<ImageHandler::Parameters> &param)
+SmartPtr<Worker::Arguments>
+SoftDualConstGeoMapper::create_remap_args (const SmartPtr<ImageHandler::Parameters> &param)
 {
-    SmartPtr<XCamSoftTasks::GeoMapTask> map_task = get_map_task ();
-    XCAM_ASSERT (map_task.ptr ());
-
     SmartPtr<XCamSoftTasks::GeoMapDualConstTask::Args> args =
         new XCamSoftTasks::GeoMapDualConstTask::Args (param);
     XCAM_ASSERT (args.ptr ());
 
-    prepare_arguments (args, param);
+    prepare_arguments (args);
 
-    return map_task->work (args);
+    return args;
 }
 
 void
@@ -413,11 +600,7 @@ SoftDualConstGeoMapper::remap_task_done (
         base.dynamic_cast_ptr<XCamSoftTasks::GeoMapDualConstTask::Args> ();
     XCAM_ASSERT (args.ptr ());
 
-    const SmartPtr<ImageHandler::Parameters> param = args->get_param ();
-    if (!check_work_continue (param, error))
-        return;
-
-    work_well_done (param, error);
+    remap_done (args->get_param (), error);
 }
 
 SoftDualCurveGeoMapper::SoftDualCurveGeoMapper (const char *name)
@@ -449,19 +632,16 @@ SoftDualCurveGeoMapper::create_remap_task ()
     return map_task;
 }
 
-XCamReturn
-SoftDualCurveGeoMapper::start_remap_task (const SmartPtr<ImageHandler::Parameters> &param)
+SmartPtr<Worker::Arguments>
+SoftDualCurveGeoMapper::create_remap_args (const SmartPtr<ImageHandler::Parameters> &param)
 {
-    SmartPtr<XCamSoftTasks::GeoMapTask> map_task = get_map_task ();
-    XCAM_ASSERT (map_task.ptr ());
-
     SmartPtr<XCamSoftTasks::GeoMapDualCurveTask::Args> args =
         new XCamSoftTasks::GeoMapDualCurveTask::Args (param);
     XCAM_ASSERT (args.ptr ());
 
-    prepare_arguments (args, param);
+    prepare_arguments (args);
 
-    return map_task->work (args);
+    return args;
 }
 
 void
@@ -475,11 +655,7 @@ SoftDualCurveGeoMapper::remap_task_done (
         base.dynamic_cast_ptr<XCamSoftTasks::GeoMapDualCurveTask::Args> ();
     XCAM_ASSERT (args.ptr ());
 
-    const SmartPtr<ImageHandler::Parameters> param = args->get_param ();
-    if (!check_work_continue (param, error))
-        return;
-
-    work_well_done (param, error);
+    remap_done (args->get_param (), error);
 }
 
 }
@@ -37,11 +37,44 @@ class GeoMapDualCurveTask;
 class SoftGeoMapper
     : public SoftHandler, public GeoMapper
 {
+public:
+    // area of the whole map output, remapped into out_buf at (out_x, out_y)
+    struct MapArea {
+        Rect                     area;
+        SmartPtr<VideoBuffer>    out_buf;
+        uint32_t                 out_x, out_y;
+
+        MapArea () : out_x (0), out_y (0) {}
+    };
+    typedef std::vector<MapArea> MapAreas;
+
+    // remap listed areas only, area without out_buf goes into param out_buf.
+    // area position and width need align to work unit, empty list remaps the whole output
+    struct AreaParameters
+        : ImageHandler::Parameters
+    {
+        MapAreas                 areas;
+        std::atomic<uint32_t>    remain_areas;
+
+        AreaParameters (const SmartPtr<VideoBuffer> &in = NULL, const SmartPtr<VideoBuffer> &out = NULL)
+            : Parameters (in, out)
+            , remain_areas (0)
+        {}
+    };
+
 public:
     SoftGeoMapper (const char *name = "SoftGeoMapper");
     ~SoftGeoMapper ();
 
     bool set_lookup_table (const PointFloat2 *data, uint32_t width, uint32_t height);
+    // store lookup table in int16 fixed-point, half size of float table, set before set_lookup_table
+    void set_compact_table (bool enable) {
+        _compact = enable;
+    }
+
+    // luma sample position of every output pixel in input image, output size set before.
+    // runs in caller thread, size aligned up to work unit
+    SmartPtr<Float2Image> dump_coords ();
 
     //derived from SoftHandler
     virtual XCamReturn terminate ();
@@ -66,17 +99,29 @@ protected:
     SmartPtr<Float2Image> &get_lookup_table () {
         return _lookup_table;
     }
+    bool get_lookup_table_size (uint32_t &width, uint32_t &height) const;
+    void set_table_arguments (const SmartPtr<Worker::Arguments> &args);
 
 protected:
     virtual bool init_factors ();
     virtual bool auto_calculate_factors (uint32_t lut_w, uint32_t lut_h);
 
     virtual SmartPtr<XCamSoftTasks::GeoMapTask> create_remap_task ();
-    virtual XCamReturn start_remap_task (const SmartPtr<ImageHandler::Parameters> &param);
+    virtual SmartPtr<Worker::Arguments> create_remap_args (const SmartPtr<ImageHandler::Parameters> &param);
+
+    XCamReturn start_remap_task (const SmartPtr<ImageHandler::Parameters> &param);
+    void remap_done (const SmartPtr<ImageHandler::Parameters> &param, const XCamReturn error);
+
+private:
+    XCamReturn start_map_work (const SmartPtr<ImageHandler::Parameters> &param, const MapArea *area);
+    bool set_compact_lookup_table (const PointFloat2 *data, uint32_t width, uint32_t height);
 
 private:
     SmartPtr<XCamSoftTasks::GeoMapTask>   _map_task;
     SmartPtr<Float2Image>                 _lookup_table;
+    SmartPtr<Short2Image>                 _compact_table;
+    float                                 _compact_scale;
+    bool                                  _compact;
 };
 
 extern SmartPtr<SoftHandler> create_soft_geo_mapper ();
@@ -103,13 +148,12 @@ public:
         const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &args, const XCamReturn error);
 
 protected:
-    XCamReturn prepare_arguments (const SmartPtr<Worker::Arguments> &args,
-        const SmartPtr<ImageHandler::Parameters> &param);
+    void prepare_arguments (const SmartPtr<Worker::Arguments> &args);
 
 protected:
     virtual bool init_factors ();
     virtual SmartPtr<XCamSoftTasks::GeoMapTask> create_remap_task ();
-    virtual XCamReturn start_remap_task (const SmartPtr<ImageHandler::Parameters> &param);
+    virtual SmartPtr<Worker::Arguments> create_remap_args (const SmartPtr<ImageHandler::Parameters> &param);
 
 private:
     float        _left_factor_x, _left_factor_y;
@@ -132,7 +176,7 @@ public:
 
 private:
     virtual SmartPtr<XCamSoftTasks::GeoMapTask> create_remap_task ();
-    virtual XCamReturn start_remap_task (const SmartPtr<ImageHandler::Parameters> &param);
+    virtual SmartPtr<Worker::Arguments> create_remap_args (const SmartPtr<ImageHandler::Parameters> &param);
 
 private:
     float        _scaled_height;
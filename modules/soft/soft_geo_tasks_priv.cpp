@@ -20,6 +20,7 @@
  */
 
 #include "soft_geo_tasks_priv.h"
+#include "soft_simd_priv.h"
 
 namespace XCam {
 
@@ -75,7 +76,29 @@ inline void calc_critical_pixels (const uint32_t &img_w, const uint32_t &img_h,
     }
 }
 
-static void interp_sample_pos (const Float2Image *lut, Float2* interp_pos, const Float2 &first, const Float2 &step)
+// float lookup table or int16 fixed-point one
+struct LutSampler {
+    const Float2Image    *table;
+    const Short2Image    *compact;
+    float                 scale;
+
+    explicit LutSampler (const GeoMapTask::Args *args)
+        : table (args->lookup_table.ptr ())
+        , compact (args->compact_table.ptr ())
+        , scale (args->compact_scale)
+    {}
+    bool is_valid () const {
+        return table || compact;
+    }
+    uint32_t get_width () const {
+        return compact ? compact->get_width () : table->get_width ();
+    }
+    uint32_t get_height () const {
+        return compact ? compact->get_height () : table->get_height ();
+    }
+};
+
+static void interp_sample_pos (const LutSampler &lut, Float2* interp_pos, const Float2 &first, const Float2 &step)
 {
 #if ENABLE_AVX512
     Float2 lut_pos[16];
@@ -105,19 +128,45 @@ static void interp_sample_pos (const Float2Image *lut, Float2* interp_pos, const
         Float2(first.x + step.x * 14, first.y), Float2(first.x + step.x * 15, first.y)
     };
 #endif
+    if (lut.compact) {
+#if !ENABLE_AVX512
+        if (XCamSoftSimd::get_kernels ().interp_short2_8 (lut.compact, lut_pos, lut.scale, interp_pos))
+            return;
+#endif
+        lut.compact->read_interpolate_array<Float2, XCAM_SOFT_WORKUNIT_PIXELS> (lut_pos, interp_pos);
+        for (uint32_t i = 0; i < XCAM_SOFT_WORKUNIT_PIXELS; ++i)
+            interp_pos[i] *= lut.scale;
+        return;
+    }
+
+    const Float2Image *table = lut.table;
 #if ENABLE_AVX512
     BoundState interp_bound = BoundInternal;
-    check_interp_bound (lut->get_width (), lut->get_height (), interp_pos, XCAM_SOFT_WORKUNIT_PIXELS - 1, interp_bound);
+    check_interp_bound (table->get_width (), table->get_height (), interp_pos, XCAM_SOFT_WORKUNIT_PIXELS - 1, interp_bound);
     if (interp_bound == BoundInternal) {
-        lut->read_interpolate_array (lut_pos, interp_pos);
+        table->read_interpolate_array (lut_pos, interp_pos);
     } else {
-        lut->read_interpolate_array<Float2, XCAM_SOFT_WORKUNIT_PIXELS> (lut_pos, interp_pos);
+        table->read_interpolate_array<Float2, XCAM_SOFT_WORKUNIT_PIXELS> (lut_pos, interp_pos);
     }
 #else
-    lut->read_interpolate_array<Float2, XCAM_SOFT_WORKUNIT_PIXELS> (lut_pos, interp_pos);
+    if (!XCamSoftSimd::get_kernels ().interp_float2_8 (table, lut_pos, interp_pos))
+        table->read_interpolate_array<Float2, XCAM_SOFT_WORKUNIT_PIXELS> (lut_pos, interp_pos);
 #endif
 }
 
+static void dump_sample_pos (
+    const LutSampler &lut, Float2Image *coords, Float2 first, const Float2 &step,
+    const uint32_t &out_x, const uint32_t &out_y)
+{
+    Float2 interp_pos[XCAM_SOFT_WORKUNIT_PIXELS] = { Float2(0.0f, 0.0f) };
+    interp_sample_pos (lut, interp_pos, first, step);
+    coords->write_array_no_check<XCAM_SOFT_WORKUNIT_PIXELS> (out_x, out_y, interp_pos);
+
+    first.y = first.y + step.y;
+    interp_sample_pos (lut, interp_pos, first, step);
+    coords->write_array_no_check<XCAM_SOFT_WORKUNIT_PIXELS> (out_x, out_y + 1, interp_pos);
+}
+
 static void map_image (
     const UcharImage *in, UcharImage *out, Float2 *interp_pos,
     const uint32_t &width, const uint32_t &height,
@@ -160,7 +209,10 @@ static void map_image (
             }
         }
 #else
-        if (is_chroma) {
+        const uint32_t count = is_chroma ? XCAM_SOFT_WORKUNIT_PIXELS / 2 : XCAM_SOFT_WORKUNIT_PIXELS;
+        if (XCamSoftSimd::get_kernels ().interp_uchar (in, interp_pos, count, interp_pixel_vaule)) {
+            // all positions inside image, done by simd kernel
+        } else if (is_chroma) {
             in->read_interpolate_array < float, XCAM_SOFT_WORKUNIT_PIXELS / 2 > (interp_pos, interp_value);
             convert_to_uchar_N < float, XCAM_SOFT_WORKUNIT_PIXELS / 2 > (interp_value, interp_pixel_vaule);
         } else {
@@ -261,21 +313,25 @@ GeoMapTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
         out_v = args->out_v.ptr ();
     }
 
-    Float2Image *lut = args->lookup_table.ptr ();
-    XCAM_ASSERT (in_luma && (in_uv || (in_u && in_v)));
-    XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
-    XCAM_ASSERT (lut);
+    const LutSampler lut (args.ptr ());
+    Float2Image *coords = args->out_coords.ptr ();
+    XCAM_ASSERT (coords || (in_luma && (in_uv || (in_u && in_v))));
+    XCAM_ASSERT (coords || (out_luma && (out_uv || (out_u && out_v))));
+    XCAM_ASSERT (lut.is_valid ());
 
     Float2 factors = args->factors;
     XCAM_ASSERT (!XCAM_DOUBLE_EQUAL_AROUND (factors.x, 0.0f) && !XCAM_DOUBLE_EQUAL_AROUND (factors.y, 0.0f));
 
     Float2 step = Float2(1.0f, 1.0f) / factors;
 
-    Float2 out_center ((out_luma->get_width () - 1.0f ) / 2.0f, (out_luma->get_height () - 1.0f ) / 2.0f);
-    Float2 lut_center ((lut->get_width () - 1.0f) / 2.0f, (lut->get_height () - 1.0f) / 2.0f);
+    XCAM_ASSERT (args->map_width && args->map_height);
+    Float2 out_center ((args->map_width - 1.0f ) / 2.0f, (args->map_height - 1.0f ) / 2.0f);
+    const uint32_t area_x = args->out_area.pos_x;
+    const uint32_t area_y = args->out_area.pos_y;
+    Float2 lut_center ((lut.get_width () - 1.0f) / 2.0f, (lut.get_height () - 1.0f) / 2.0f);
 
-    uint32_t luma_w = in_luma->get_width ();
-    uint32_t luma_h = in_luma->get_height ();
+    uint32_t luma_w = in_luma ? in_luma->get_width () : 0;
+    uint32_t luma_h = in_luma ? in_luma->get_height () : 0;
     uint32_t chroma_w = luma_w / 2;
     uint32_t chroma_h = luma_h / 2;
     if (NULL != in_uv) {
@@ -289,13 +345,19 @@ GeoMapTask::work_range (const SmartPtr<Arguments> &base, const WorkRange &range)
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y) {
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x) {
             uint32_t out_x = x * XCAM_SOFT_WORKUNIT_PIXELS, out_y = y * 2;
+            uint32_t map_x = area_x + out_x, map_y = area_y + out_y;
 
             // calculate XCAM_SOFT_WORKUNIT_PIXELS * 2 luma, center aligned
-            Float2 out_pos (out_x, out_y);
+            Float2 out_pos (map_x, map_y);
             out_pos -= out_center;
             Float2 first = out_pos / factors;
             first += lut_center;
 
+            if (coords) {
+                dump_sample_pos (lut, coords, first, step, out_x, out_y);
+                continue;
+            }
+
             Float2 interp_pos[XCAM_SOFT_WORKUNIT_PIXELS] = { Float2(0.0f, 0.0f) };
 
             if (NULL != in_u && NULL != in_v) {
@@ -362,10 +424,11 @@ GeoMapDualConstTask::work_range (const SmartPtr<Arguments> &base, const WorkRang
         in_v = args->in_v.ptr ();
         out_v = args->out_v.ptr ();
     }
-    Float2Image *lut = args->lookup_table.ptr ();
-    XCAM_ASSERT (in_luma && (in_uv || (in_u && in_v)));
-    XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
-    XCAM_ASSERT (lut);
+    const LutSampler lut (args.ptr ());
+    Float2Image *coords = args->out_coords.ptr ();
+    XCAM_ASSERT (coords || (in_luma && (in_uv || (in_u && in_v))));
+    XCAM_ASSERT (coords || (out_luma && (out_uv || (out_u && out_v))));
+    XCAM_ASSERT (lut.is_valid ());
 
     Float2 left_factor = args->left_factor;
     Float2 right_factor = args->right_factor;
@@ -376,11 +439,14 @@ GeoMapDualConstTask::work_range (const SmartPtr<Arguments> &base, const WorkRang
     Float2 left_step = Float2(1.0f, 1.0f) / left_factor;
     Float2 right_step = Float2(1.0f, 1.0f) / right_factor;
 
-    Float2 out_center ((out_luma->get_width () - 1.0f ) / 2.0f, (out_luma->get_height () - 1.0f ) / 2.0f);
-    Float2 lut_center ((lut->get_width () - 1.0f) / 2.0f, (lut->get_height () - 1.0f) / 2.0f);
+    XCAM_ASSERT (args->map_width && args->map_height);
+    Float2 out_center ((args->map_width - 1.0f ) / 2.0f, (args->map_height - 1.0f ) / 2.0f);
+    const uint32_t area_x = args->out_area.pos_x;
+    const uint32_t area_y = args->out_area.pos_y;
+    Float2 lut_center ((lut.get_width () - 1.0f) / 2.0f, (lut.get_height () - 1.0f) / 2.0f);
 
-    uint32_t luma_w = in_luma->get_width ();
-    uint32_t luma_h = in_luma->get_height ();
+    uint32_t luma_w = in_luma ? in_luma->get_width () : 0;
+    uint32_t luma_h = in_luma ? in_luma->get_height () : 0;
     uint32_t chroma_w = luma_w / 2;
     uint32_t chroma_h = luma_h / 2;
     if (NULL != in_uv) {
@@ -394,15 +460,21 @@ GeoMapDualConstTask::work_range (const SmartPtr<Arguments> &base, const WorkRang
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y) {
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x) {
             uint32_t out_x = x * XCAM_SOFT_WORKUNIT_PIXELS, out_y = y * 2;
-            Float2 &factor = (out_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? left_factor : right_factor;
-            Float2 &step = (out_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? left_step : right_step;
+            uint32_t map_x = area_x + out_x, map_y = area_y + out_y;
+            Float2 &factor = (map_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? left_factor : right_factor;
+            Float2 &step = (map_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? left_step : right_step;
 
             // calculate XCAM_SOFT_WORKUNIT_PIXELS * 2 luma, center aligned
-            Float2 out_pos (out_x, out_y);
+            Float2 out_pos (map_x, map_y);
             out_pos -= out_center;
             Float2 first = out_pos / factor;
             first += lut_center;
 
+            if (coords) {
+                dump_sample_pos (lut, coords, first, step, out_x, out_y);
+                continue;
+            }
+
             Float2 interp_pos[XCAM_SOFT_WORKUNIT_PIXELS] = { Float2(0.0f, 0.0f) };
             if (NULL != in_u && NULL != in_v) {
                 interp_sample_pos (lut, interp_pos, first, step);
@@ -582,18 +654,22 @@ GeoMapDualCurveTask::work_range (const SmartPtr<Arguments> &base, const WorkRang
         out_v = args->out_v.ptr ();
     }
 
-    Float2Image *lut = args->lookup_table.ptr ();
-    XCAM_ASSERT (in_luma && (in_uv || (in_u && in_v)));
-    XCAM_ASSERT (out_luma && (out_uv || (out_u && out_v)));
-    XCAM_ASSERT (lut);
+    const LutSampler lut (args.ptr ());
+    Float2Image *coords = args->out_coords.ptr ();
+    XCAM_ASSERT (coords || (in_luma && (in_uv || (in_u && in_v))));
+    XCAM_ASSERT (coords || (out_luma && (out_uv || (out_u && out_v))));
+    XCAM_ASSERT (lut.is_valid ());
 
-    set_factors (args, out_luma->get_height ());
+    set_factors (args, args->map_height);
 
-    Float2 out_center ((out_luma->get_width () - 1.0f ) / 2.0f, (out_luma->get_height () - 1.0f ) / 2.0f);
-    Float2 lut_center ((lut->get_width () - 1.0f) / 2.0f, (lut->get_height () - 1.0f) / 2.0f);
+    XCAM_ASSERT (args->map_width && args->map_height);
+    Float2 out_center ((args->map_width - 1.0f ) / 2.0f, (args->map_height - 1.0f ) / 2.0f);
+    const uint32_t area_x = args->out_area.pos_x;
+    const uint32_t area_y = args->out_area.pos_y;
+    Float2 lut_center ((lut.get_width () - 1.0f) / 2.0f, (lut.get_height () - 1.0f) / 2.0f);
 
-    uint32_t luma_w = in_luma->get_width ();
-    uint32_t luma_h = in_luma->get_height ();
+    uint32_t luma_w = in_luma ? in_luma->get_width () : 0;
+    uint32_t luma_h = in_luma ? in_luma->get_height () : 0;
     uint32_t chroma_w = luma_w / 2;
     uint32_t chroma_h = luma_h / 2;
     if (NULL != in_uv) {
@@ -607,15 +683,21 @@ GeoMapDualCurveTask::work_range (const SmartPtr<Arguments> &base, const WorkRang
     for (uint32_t y = range.pos[1]; y < range.pos[1] + range.pos_len[1]; ++y) {
         for (uint32_t x = range.pos[0]; x < range.pos[0] + range.pos_len[0]; ++x) {
             uint32_t out_x = x * XCAM_SOFT_WORKUNIT_PIXELS, out_y = y * 2;
-            Float2 &factor = (out_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? _left_factors[out_y] : _right_factors[out_y];
-            Float2 &step = (out_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? _left_steps[out_y] : _right_steps[out_y];
+            uint32_t map_x = area_x + out_x, map_y = area_y + out_y;
+            Float2 &factor = (map_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? _left_factors[map_y] : _right_factors[map_y];
+            Float2 &step = (map_x + XCAM_SOFT_WORKUNIT_PIXELS / 2 < out_center.x) ? _left_steps[map_y] : _right_steps[map_y];
 
             // calculate XCAM_SOFT_WORKUNIT_PIXELS * 2 luma, center aligned
-            Float2 out_pos (out_x, out_y);
+            Float2 out_pos (map_x, map_y);
             out_pos -= out_center;
             Float2 first = out_pos / factor;
             first += lut_center;
 
+            if (coords) {
+                dump_sample_pos (lut, coords, first, step, out_x, out_y);
+                continue;
+            }
+
             Float2 interp_pos[XCAM_SOFT_WORKUNIT_PIXELS] = { Float2(0.0f, 0.0f) };
             if (NULL != in_u && NULL != in_v) {
                 interp_sample_pos (lut, interp_pos, first, step);
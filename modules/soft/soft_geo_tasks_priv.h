@@ -25,6 +25,7 @@
 #include <soft/soft_worker.h>
 #include <soft/soft_image.h>
 #include <soft/soft_handler.h>
+#include <interface/data_types.h>
 
 namespace XCam {
 
@@ -39,11 +40,22 @@ public:
         SmartPtr<Uchar2Image>       in_uv, out_uv;
         SmartPtr<UcharImage>        in_u, in_v, out_u, out_v;
         SmartPtr<Float2Image>       lookup_table;
+        // int16 fixed-point table used instead of lookup_table if set, entry * compact_scale
+        SmartPtr<Short2Image>       compact_table;
+        float                       compact_scale;
         Float2                      factors;
+        // out images hold out_area of the whole map output(map_width x map_height)
+        Rect                        out_area;
+        // luma sample positions of out_area are written here instead of remapping if set, no in/out images needed
+        SmartPtr<Float2Image>       out_coords;
+        uint32_t                    map_width, map_height;
 
         Args (
             const SmartPtr<ImageHandler::Parameters> &param)
             : SoftArgs (param)
+            , compact_scale (1.0f)
+            , map_width (0)
+            , map_height (0)
         {}
     };
 
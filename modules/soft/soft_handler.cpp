@@ -59,6 +59,7 @@ void
 SyncMeta::wakeup ()
 {
     SmartLock locker (_mutex);
+    _done = true;
     _error = XCAM_RETURN_ERROR_UNKNOWN;
     _cond.broadcast ();
 }
@@ -67,9 +68,8 @@ XCamReturn
 SyncMeta::signal_wait_ret ()
 {
     SmartLock locker (_mutex);
-    if (_done)
-        return _error;
-    _cond.wait (_mutex);
+    while (!_done)
+        _cond.wait (_mutex);
     return _error;
 }
 
@@ -83,6 +83,7 @@ SyncMeta::is_error () const
 SoftHandler::SoftHandler (const char* name)
     : ImageHandler (name)
     , _wip_buf_count (0)
+    , _memfd (false)
 {
 }
 
@@ -97,10 +98,20 @@ SoftHandler::set_threads (const SmartPtr<ThreadPool> &pool)
     return true;
 }
 
+void
+SoftHandler::setup_worker (const SmartPtr<SoftWorker> &worker) const
+{
+    XCAM_ASSERT (worker.ptr ());
+    if (_threads.ptr ())
+        worker->set_threads (_threads);
+}
+
 SmartPtr<BufferPool>
 SoftHandler::create_allocator ()
 {
-    return new SoftVideoBufAllocator;
+    SmartPtr<SoftVideoBufAllocator> allocator = new SoftVideoBufAllocator;
+    allocator->set_memfd (_memfd);
+    return allocator;
 }
 
 XCamReturn
@@ -133,6 +144,8 @@ SoftHandler::execute_buffer (const SmartPtr<ImageHandler::Parameters> &param, bo
         ERROR, param.ptr (), XCAM_RETURN_ERROR_PARAM,
         "soft_hander(%s) execute buffer failed, params is null",
         XCAM_STR (get_name ()));
+    XCAM_TRACE_STAMP (param);
+    param->start_time = MetricsRegistry::now_us ();
 
     if (_need_configure) {
         ret = configure_resource (param);
@@ -214,6 +227,18 @@ SoftHandler::finish ()
     return ret;
 }
 
+XCamReturn
+SoftHandler::sync_param (const SmartPtr<Parameters> &param)
+{
+    XCAM_ASSERT (param.ptr ());
+    SmartPtr<SyncMeta> sync_meta = param->find_meta<SyncMeta> ();
+    XCAM_FAIL_RETURN (
+        ERROR, sync_meta.ptr (), XCAM_RETURN_ERROR_PARAM,
+        "soft_hander(%s) sync param failed, param was not executed", XCAM_STR (get_name ()));
+
+    return sync_meta->signal_wait_ret ();
+}
+
 XCamReturn
 SoftHandler::terminate ()
 {
@@ -275,9 +300,10 @@ SoftHandler::param_ended (SmartPtr<ImageHandler::Parameters> param, XCamReturn e
 
     SmartPtr<SyncMeta> sync_meta = param->find_meta<SyncMeta> ();
     XCAM_ASSERT (sync_meta.ptr ());
-    sync_meta->signal_done (err);
     --_wip_buf_count;
     execute_status_check (param, err);
+    // signal last, a sync caller may release this handler once it wakes up
+    sync_meta->signal_done (err);
 }
 
 bool
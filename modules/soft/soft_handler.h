@@ -32,6 +32,7 @@ class SoftHandler;
 class ThreadPool;
 class SyncMeta;
 class SoftWorker;
+class SoftWorker;
 
 struct SoftArgs
     : Worker::Arguments
@@ -56,18 +57,32 @@ public:
     explicit SoftHandler (const char* name);
     ~SoftHandler ();
 
+    // pool for all workers of this handler instead of process-wide shared pool, set before configure
     bool set_threads (const SmartPtr<ThreadPool> &pool);
+    const SmartPtr<ThreadPool> &get_threads () const {
+        return _threads;
+    }
+    // output buffers are backed by sealed memfd and can be exported by get_fd (), set before configure
+    void enable_memfd (bool enable) {
+        _memfd = enable;
+    }
 
     // derive from ImageHandler
     virtual XCamReturn execute_buffer (const SmartPtr<Parameters> &param, bool sync);
     virtual XCamReturn finish ();
     virtual XCamReturn terminate ();
 
+    // wait for @param started by execute_buffer (@param, false)
+    XCamReturn sync_param (const SmartPtr<Parameters> &param);
+
 protected:
     // derived from ImageHandler
     virtual SmartPtr<BufferPool> create_allocator ();
     virtual XCamReturn configure_rest ();
 
+    // workers take the handler pool if set, else they queue to process-wide shared pool
+    void setup_worker (const SmartPtr<SoftWorker> &worker) const;
+
     //virtual SmartPtr<Worker::Arguments> get_first_worker_args (const SmartPtr<SoftWorker> &worker, SmartPtr<Parameters> &params) = 0;
     virtual void work_well_done (const SmartPtr<ImageHandler::Parameters> &param, XCamReturn err);
     virtual void work_broken (const SmartPtr<ImageHandler::Parameters> &param, XCamReturn err);
@@ -87,6 +102,7 @@ private:
     SmartPtr<SyncMeta>      _cur_sync;
     SafeList<Parameters>    _params;
     mutable std::atomic<int32_t>  _wip_buf_count;
+    bool                    _memfd;
 };
 
 }
@@ -37,12 +37,16 @@
 #define XCAM_SOFT_WORKUNIT_PIXELS 8
 #endif
 
+// base address alignment of soft images, one cache line
+#define XCAM_SOFT_IMAGE_ALIGN 64
+
 namespace XCam {
 
 typedef uint8_t Uchar;
 typedef int8_t Char;
 typedef Vector2<uint8_t> Uchar2;
 typedef Vector2<int8_t> Char2;
+typedef Vector2<int16_t> Short2;
 typedef Vector2<float> Float2;
 typedef Vector2<int> Int2;
 
@@ -187,7 +191,8 @@ public:
     template<uint32_t N>
     inline void write_array_no_check (int32_t x, int32_t y, const T *array) {
         T *t_ptr = (T *)(_buf_ptr + y * _pitch);
-        memcpy (t_ptr + x, array, sizeof (T) * N);
+        // T is plain data with user ctors, copy raw bytes
+        memcpy ((void *)(t_ptr + x), (const void *)array, sizeof (T) * N);
     }
 
     template<uint32_t N>
@@ -258,7 +263,7 @@ SoftImage<T>::SoftImage (
     XCAM_ASSERT (aligned_width >= width);
     XCAM_ASSERT (width > 0 && height > 0);
     _pitch = aligned_width * sizeof (T);
-    _buf_ptr = (uint8_t *)xcam_malloc (_pitch * height);
+    _buf_ptr = (uint8_t *)xcam_malloc_aligned (_pitch * height, XCAM_SOFT_IMAGE_ALIGN);
     XCAM_ASSERT (_buf_ptr);
     _width = width;
     _height = height;
@@ -309,6 +314,7 @@ typedef SoftImage<Uchar> UcharImage;
 typedef SoftImage<Uchar2> Uchar2Image;
 typedef SoftImage<float> FloatImage;
 typedef SoftImage<Float2> Float2Image;
+typedef SoftImage<Short2> Short2Image;
 
 template <class SoftImageT>
 class SoftImageFile
@@ -0,0 +1,801 @@
+/*
+ * soft_simd_priv.cpp - soft SIMD kernels with runtime dispatch
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "soft_simd_priv.h"
+#include <atomic>
+
+#if defined (__x86_64__) || defined (__i386__)
+#define XCAM_SOFT_SIMD_X86 1
+#include <immintrin.h>
+#define XCAM_TARGET_SSE41 __attribute__ ((target ("sse4.1")))
+#define XCAM_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#endif
+
+namespace XCam {
+
+namespace XCamSoftSimd {
+
+static void
+blend_8_scalar (const Uchar *in0, const Uchar *in1, const Uchar *mask, float *out_mask, float *out)
+{
+    for (uint32_t i = 0; i < 8; ++i) {
+        out_mask[i] = (float)mask[i] / 255.0f;
+        out[i] = ((float)in0[i] - (float)in1[i]) * out_mask[i] + (float)in1[i];
+    }
+}
+
+static void
+convert_8_scalar (const float *in, Uchar *out)
+{
+    convert_to_uchar_N<float, 8> (in, out);
+}
+
+static void
+laplace_8_scalar (const Uchar *orig, const float *gauss, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+        out[i] = convert_to_uchar<float> (((float)orig[i] - gauss[i]) * 0.5f + 128.0f);
+}
+
+static void
+reconstruct_8_scalar (const float *lap, const float *up_sample, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+        out[i] = convert_to_uchar<float> (up_sample[i] + lap[i] * 2.0f - 256.0f);
+}
+
+static bool
+interp_uchar_scalar (const UcharImage *, const Float2 *, uint32_t, Uchar *)
+{
+    return false;
+}
+
+static bool
+interp_float2_8_scalar (const Float2Image *, const Float2 *, Float2 *)
+{
+    return false;
+}
+
+static bool
+interp_short2_8_scalar (const Short2Image *, const Float2 *, float, Float2 *)
+{
+    return false;
+}
+
+static bool
+fastmap_blend_8_scalar (
+    const UcharImage *, const Float2 *, const UcharImage *, const Float2 *, const Uchar *, Uchar *)
+{
+    return false;
+}
+
+// same as gauss_fixed_coeffs of blender tasks, sum is 256
+static const int16_t gauss_coeffs_q8[5] = {39, 57, 64, 57, 39};
+
+static inline Uchar
+clamp_uchar_fixed (int32_t v)
+{
+    return (Uchar)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void
+blend_fixed_8_scalar (const Uchar *in0, const Uchar *in1, const Uchar *mask, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; ++i) {
+        int32_t weight = mask[i] + (mask[i] >> 7);
+        out[i] = (Uchar)((in0[i] * weight + in1[i] * (256 - weight) + 128) >> 8);
+    }
+}
+
+static void
+laplace_fixed_8_scalar (const Uchar *orig, const int16_t *up, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+        out[i] = clamp_uchar_fixed ((orig[i] * 4 - up[i] + 4 + 1024) >> 3);
+}
+
+static void
+reconstruct_fixed_8_scalar (
+    const Uchar *lap0, const Uchar *lap1, const Uchar *mask, const int16_t *up, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; ++i) {
+        int32_t weight = mask[i] + (mask[i] >> 7);
+        int32_t lap_q8 = lap0[i] * weight + lap1[i] * (256 - weight);
+        out[i] = clamp_uchar_fixed ((up[i] * 64 + lap_q8 * 2 - 65536 + 128) >> 8);
+    }
+}
+
+static void
+gauss_fixed_8_scalar (const Uchar *const *rows, Uchar *out)
+{
+    int32_t sum[19] = {0};
+    for (uint32_t k = 0; k < 5; ++k)
+        for (uint32_t i = 0; i < 19; ++i)
+            sum[i] += rows[k][i] * gauss_coeffs_q8[k];
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        const int32_t *s = sum + i * 2;
+        int32_t v = s[0] * gauss_coeffs_q8[0] + s[1] * gauss_coeffs_q8[1] + s[2] * gauss_coeffs_q8[2] +
+                    s[3] * gauss_coeffs_q8[3] + s[4] * gauss_coeffs_q8[4];
+        out[i] = (Uchar)((v + (1 << 15)) >> 16);
+    }
+}
+
+#if XCAM_SOFT_SIMD_X86
+
+XCAM_TARGET_SSE41 static inline __m128
+load_uchar_4_sse41 (const Uchar *in)
+{
+    int32_t v;
+    memcpy (&v, in, sizeof (v));
+    return _mm_cvtepi32_ps (_mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (v)));
+}
+
+// same as convert_to_uchar, clamp to [0, 255] then round half up
+XCAM_TARGET_SSE41 static inline void
+store_uchar_4_sse41 (__m128 v, Uchar *out)
+{
+    v = _mm_min_ps (_mm_max_ps (v, _mm_setzero_ps ()), _mm_set1_ps (255.0f));
+    __m128i i32 = _mm_cvttps_epi32 (_mm_add_ps (v, _mm_set1_ps (0.5f)));
+    __m128i u8 = _mm_packus_epi16 (_mm_packs_epi32 (i32, i32), _mm_setzero_si128 ());
+    int32_t r = _mm_cvtsi128_si32 (u8);
+    memcpy (out, &r, sizeof (r));
+}
+
+XCAM_TARGET_SSE41 static void
+blend_8_sse41 (const Uchar *in0, const Uchar *in1, const Uchar *mask, float *out_mask, float *out)
+{
+    const __m128 max = _mm_set1_ps (255.0f);
+    for (uint32_t i = 0; i < 8; i += 4) {
+        __m128 m = _mm_div_ps (load_uchar_4_sse41 (mask + i), max);
+        __m128 a = load_uchar_4_sse41 (in0 + i);
+        __m128 b = load_uchar_4_sse41 (in1 + i);
+        _mm_storeu_ps (out_mask + i, m);
+        _mm_storeu_ps (out + i, _mm_add_ps (_mm_mul_ps (_mm_sub_ps (a, b), m), b));
+    }
+}
+
+XCAM_TARGET_SSE41 static void
+convert_8_sse41 (const float *in, Uchar *out)
+{
+    store_uchar_4_sse41 (_mm_loadu_ps (in), out);
+    store_uchar_4_sse41 (_mm_loadu_ps (in + 4), out + 4);
+}
+
+XCAM_TARGET_SSE41 static void
+laplace_8_sse41 (const Uchar *orig, const float *gauss, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; i += 4) {
+        __m128 v = _mm_sub_ps (load_uchar_4_sse41 (orig + i), _mm_loadu_ps (gauss + i));
+        v = _mm_add_ps (_mm_mul_ps (v, _mm_set1_ps (0.5f)), _mm_set1_ps (128.0f));
+        store_uchar_4_sse41 (v, out + i);
+    }
+}
+
+XCAM_TARGET_SSE41 static void
+reconstruct_8_sse41 (const float *lap, const float *up_sample, Uchar *out)
+{
+    for (uint32_t i = 0; i < 8; i += 4) {
+        __m128 v = _mm_add_ps (_mm_loadu_ps (up_sample + i), _mm_mul_ps (_mm_loadu_ps (lap + i), _mm_set1_ps (2.0f)));
+        store_uchar_4_sse41 (_mm_sub_ps (v, _mm_set1_ps (256.0f)), out + i);
+    }
+}
+
+// l1[1] * (a * b) + l0[0] * ((1 - a) * (1 - b)) + l1[0] * ((1 - a) * b) + l0[1] * (a * (1 - b))
+XCAM_TARGET_SSE41 static inline __m128
+bilinear_4_sse41 (__m128 a, __m128 b, __m128 l00, __m128 l01, __m128 l10, __m128 l11)
+{
+    const __m128 one = _mm_set1_ps (1.0f);
+    __m128 a1 = _mm_sub_ps (one, a);
+    __m128 b1 = _mm_sub_ps (one, b);
+    __m128 v = _mm_add_ps (_mm_mul_ps (l11, _mm_mul_ps (a, b)), _mm_mul_ps (l00, _mm_mul_ps (a1, b1)));
+    v = _mm_add_ps (v, _mm_mul_ps (l10, _mm_mul_ps (a1, b)));
+    return _mm_add_ps (v, _mm_mul_ps (l01, _mm_mul_ps (a, b1)));
+}
+
+// positions must satisfy 0 <= x < max_x and 0 <= y < max_y
+XCAM_TARGET_SSE41 static inline bool
+split_pos_4_sse41 (
+    const Float2 *pos, float max_x, float max_y,
+    __m128 &a, __m128 &b, __m128i &x0, __m128i &y0)
+{
+    __m128 p0 = _mm_loadu_ps ((const float *)pos);
+    __m128 p1 = _mm_loadu_ps ((const float *)pos + 4);
+    __m128 x = _mm_shuffle_ps (p0, p1, _MM_SHUFFLE (2, 0, 2, 0));
+    __m128 y = _mm_shuffle_ps (p0, p1, _MM_SHUFFLE (3, 1, 3, 1));
+
+    __m128 in = _mm_and_ps (
+                    _mm_and_ps (_mm_cmpge_ps (x, _mm_setzero_ps ()), _mm_cmplt_ps (x, _mm_set1_ps (max_x))),
+                    _mm_and_ps (_mm_cmpge_ps (y, _mm_setzero_ps ()), _mm_cmplt_ps (y, _mm_set1_ps (max_y))));
+    if (_mm_movemask_ps (in) != 0xF)
+        return false;
+
+    x0 = _mm_cvttps_epi32 (x);
+    y0 = _mm_cvttps_epi32 (y);
+    a = _mm_sub_ps (x, _mm_cvtepi32_ps (x0));
+    b = _mm_sub_ps (y, _mm_cvtepi32_ps (y0));
+    return true;
+}
+
+XCAM_TARGET_SSE41 static inline __m128
+sample_4_sse41 (const Uchar *buf, int32_t pitch, __m128 a, __m128 b, __m128i x0, __m128i y0)
+{
+    int32_t offset[4];
+    _mm_storeu_si128 ((__m128i *)offset, _mm_add_epi32 (_mm_mullo_epi32 (y0, _mm_set1_epi32 (pitch)), x0));
+
+    const Uchar *p0 = buf + offset[0], *p1 = buf + offset[1], *p2 = buf + offset[2], *p3 = buf + offset[3];
+    __m128 l00 = _mm_setr_ps (p0[0], p1[0], p2[0], p3[0]);
+    __m128 l01 = _mm_setr_ps (p0[1], p1[1], p2[1], p3[1]);
+    __m128 l10 = _mm_setr_ps (p0[pitch], p1[pitch], p2[pitch], p3[pitch]);
+    __m128 l11 = _mm_setr_ps (p0[pitch + 1], p1[pitch + 1], p2[pitch + 1], p3[pitch + 1]);
+
+    return bilinear_4_sse41 (a, b, l00, l01, l10, l11);
+}
+
+XCAM_TARGET_SSE41 static bool
+interp_uchar_sse41 (const UcharImage *image, const Float2 *pos, uint32_t count, Uchar *out)
+{
+    XCAM_ASSERT (count == 4 || count == 8);
+    const Uchar *buf = image->get_buf_ptr (0, 0);
+    const int32_t pitch = image->get_pitch ();
+    const float max_x = (float)image->get_width () - 1.0f;
+    const float max_y = (float)image->get_height () - 1.0f;
+
+    __m128 a[2], b[2];
+    __m128i x0[2], y0[2];
+    for (uint32_t i = 0; i < count / 4; ++i) {
+        if (!split_pos_4_sse41 (pos + i * 4, max_x, max_y, a[i], b[i], x0[i], y0[i]))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < count / 4; ++i)
+        store_uchar_4_sse41 (sample_4_sse41 (buf, pitch, a[i], b[i], x0[i], y0[i]), out + i * 4);
+    return true;
+}
+
+XCAM_TARGET_SSE41 static bool
+fastmap_blend_8_sse41 (
+    const UcharImage *in0, const Float2 *pos0, const UcharImage *in1, const Float2 *pos1,
+    const Uchar *mask, Uchar *out)
+{
+    const UcharImage *image[2] = {in0, in1};
+    const Float2 *pos[2] = {pos0, pos1};
+
+    __m128 a[2][2], b[2][2];
+    __m128i x0[2][2], y0[2][2];
+    for (uint32_t k = 0; k < 2; ++k) {
+        const float max_x = (float)image[k]->get_width () - 1.0f;
+        const float max_y = (float)image[k]->get_height () - 1.0f;
+        for (uint32_t i = 0; i < 2; ++i) {
+            if (!split_pos_4_sse41 (pos[k] + i * 4, max_x, max_y, a[k][i], b[k][i], x0[k][i], y0[k][i]))
+                return false;
+        }
+    }
+
+    const Uchar *buf0 = in0->get_buf_ptr (0, 0), *buf1 = in1->get_buf_ptr (0, 0);
+    const int32_t pitch0 = in0->get_pitch (), pitch1 = in1->get_pitch ();
+    const __m128 max = _mm_set1_ps (255.0f);
+    for (uint32_t i = 0; i < 2; ++i) {
+        __m128 v0 = sample_4_sse41 (buf0, pitch0, a[0][i], b[0][i], x0[0][i], y0[0][i]);
+        __m128 v1 = sample_4_sse41 (buf1, pitch1, a[1][i], b[1][i], x0[1][i], y0[1][i]);
+        __m128 m = _mm_div_ps (load_uchar_4_sse41 (mask + i * 4), max);
+        store_uchar_4_sse41 (_mm_add_ps (_mm_mul_ps (_mm_sub_ps (v0, v1), m), v1), out + i * 4);
+    }
+    return true;
+}
+
+XCAM_TARGET_SSE41 static bool
+interp_float2_8_sse41 (const Float2Image *image, const Float2 *pos, Float2 *out)
+{
+    const uint8_t *buf = (const uint8_t *)image->get_buf_ptr (0, 0);
+    const int32_t pitch = image->get_pitch ();
+    const float max_x = (float)image->get_width () - 1.0f;
+    const float max_y = (float)image->get_height () - 1.0f;
+
+    __m128 a[2], b[2];
+    __m128i x0[2], y0[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        if (!split_pos_4_sse41 (pos + i * 4, max_x, max_y, a[i], b[i], x0[i], y0[i]))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        int32_t offset[4];
+        _mm_storeu_si128 (
+            (__m128i *)offset,
+            _mm_add_epi32 (_mm_mullo_epi32 (y0[i], _mm_set1_epi32 (pitch)), _mm_slli_epi32 (x0[i], 3)));
+
+        // each row holds p0.x p0.y p1.x p1.y
+        __m128 top[4], bottom[4];
+        for (uint32_t j = 0; j < 4; ++j) {
+            top[j] = _mm_loadu_ps ((const float *)(buf + offset[j]));
+            bottom[j] = _mm_loadu_ps ((const float *)(buf + offset[j] + pitch));
+        }
+        _MM_TRANSPOSE4_PS (top[0], top[1], top[2], top[3]);
+        _MM_TRANSPOSE4_PS (bottom[0], bottom[1], bottom[2], bottom[3]);
+
+        __m128 vx = bilinear_4_sse41 (a[i], b[i], top[0], top[2], bottom[0], bottom[2]);
+        __m128 vy = bilinear_4_sse41 (a[i], b[i], top[1], top[3], bottom[1], bottom[3]);
+        _mm_storeu_ps ((float *)(out + i * 4), _mm_unpacklo_ps (vx, vy));
+        _mm_storeu_ps ((float *)(out + i * 4) + 4, _mm_unpackhi_ps (vx, vy));
+    }
+    return true;
+}
+
+XCAM_TARGET_SSE41 static bool
+interp_short2_8_sse41 (const Short2Image *image, const Float2 *pos, float scale, Float2 *out)
+{
+    const uint8_t *buf = (const uint8_t *)image->get_buf_ptr (0, 0);
+    const int32_t pitch = image->get_pitch ();
+    const float max_x = (float)image->get_width () - 1.0f;
+    const float max_y = (float)image->get_height () - 1.0f;
+    const __m128 vscale = _mm_set1_ps (scale);
+
+    __m128 a[2], b[2];
+    __m128i x0[2], y0[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        if (!split_pos_4_sse41 (pos + i * 4, max_x, max_y, a[i], b[i], x0[i], y0[i]))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        int32_t offset[4];
+        _mm_storeu_si128 (
+            (__m128i *)offset,
+            _mm_add_epi32 (_mm_mullo_epi32 (y0[i], _mm_set1_epi32 (pitch)), _mm_slli_epi32 (x0[i], 2)));
+
+        // each row holds p0.x p0.y p1.x p1.y, widened from int16
+        __m128 top[4], bottom[4];
+        for (uint32_t j = 0; j < 4; ++j) {
+            top[j] = _mm_cvtepi32_ps (_mm_cvtepi16_epi32 (_mm_loadl_epi64 ((const __m128i *)(buf + offset[j]))));
+            bottom[j] = _mm_cvtepi32_ps (
+                            _mm_cvtepi16_epi32 (_mm_loadl_epi64 ((const __m128i *)(buf + offset[j] + pitch))));
+        }
+        _MM_TRANSPOSE4_PS (top[0], top[1], top[2], top[3]);
+        _MM_TRANSPOSE4_PS (bottom[0], bottom[1], bottom[2], bottom[3]);
+
+        __m128 vx = _mm_mul_ps (bilinear_4_sse41 (a[i], b[i], top[0], top[2], bottom[0], bottom[2]), vscale);
+        __m128 vy = _mm_mul_ps (bilinear_4_sse41 (a[i], b[i], top[1], top[3], bottom[1], bottom[3]), vscale);
+        _mm_storeu_ps ((float *)(out + i * 4), _mm_unpacklo_ps (vx, vy));
+        _mm_storeu_ps ((float *)(out + i * 4) + 4, _mm_unpackhi_ps (vx, vy));
+    }
+    return true;
+}
+
+XCAM_TARGET_SSE41 static inline __m128i
+load_uchar_8_epi16_sse41 (const Uchar *in)
+{
+    return _mm_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i *)in));
+}
+
+XCAM_TARGET_SSE41 static inline void
+store_epi16_8_sse41 (__m128i v, Uchar *out)
+{
+    _mm_storel_epi64 ((__m128i *)out, _mm_packus_epi16 (v, v));
+}
+
+// mask + (mask >> 7), [0, 256]
+XCAM_TARGET_SSE41 static inline __m128i
+mask_to_weight_sse41 (const Uchar *mask)
+{
+    __m128i m = load_uchar_8_epi16_sse41 (mask);
+    return _mm_add_epi16 (m, _mm_srli_epi16 (m, 7));
+}
+
+// a * w + b * (256 - w) is in [0, 65280], exact in unsigned 16 bits
+XCAM_TARGET_SSE41 static inline __m128i
+mix_q8_sse41 (__m128i a, __m128i b, __m128i w)
+{
+    return _mm_add_epi16 (_mm_mullo_epi16 (a, w), _mm_mullo_epi16 (b, _mm_sub_epi16 (_mm_set1_epi16 (256), w)));
+}
+
+XCAM_TARGET_SSE41 static void
+blend_fixed_8_sse41 (const Uchar *in0, const Uchar *in1, const Uchar *mask, Uchar *out)
+{
+    __m128i v = mix_q8_sse41 (
+        load_uchar_8_epi16_sse41 (in0), load_uchar_8_epi16_sse41 (in1), mask_to_weight_sse41 (mask));
+    store_epi16_8_sse41 (_mm_srli_epi16 (_mm_add_epi16 (v, _mm_set1_epi16 (128)), 8), out);
+}
+
+XCAM_TARGET_SSE41 static void
+laplace_fixed_8_sse41 (const Uchar *orig, const int16_t *up, Uchar *out)
+{
+    __m128i v = _mm_slli_epi16 (load_uchar_8_epi16_sse41 (orig), 2);
+    v = _mm_sub_epi16 (v, _mm_loadu_si128 ((const __m128i *)up));
+    store_epi16_8_sse41 (_mm_srai_epi16 (_mm_add_epi16 (v, _mm_set1_epi16 (4 + 1024)), 3), out);
+}
+
+// split (up * 64 + lap_q8 * 2 - 65536 + 128) >> 8 into high and low bytes to stay in 16 bits,
+// (up >> 2) + (lap_q8 >> 8) * 2 - 256 + (((up & 3) << 6) + ((lap_q8 & 255) << 1) + 128) >> 8
+XCAM_TARGET_SSE41 static void
+reconstruct_fixed_8_sse41 (
+    const Uchar *lap0, const Uchar *lap1, const Uchar *mask, const int16_t *up, Uchar *out)
+{
+    __m128i lap = mix_q8_sse41 (
+        load_uchar_8_epi16_sse41 (lap0), load_uchar_8_epi16_sse41 (lap1), mask_to_weight_sse41 (mask));
+    __m128i up_q2 = _mm_loadu_si128 ((const __m128i *)up);
+
+    __m128i low = _mm_slli_epi16 (_mm_and_si128 (up_q2, _mm_set1_epi16 (3)), 6);
+    low = _mm_add_epi16 (low, _mm_slli_epi16 (_mm_and_si128 (lap, _mm_set1_epi16 (255)), 1));
+    low = _mm_srli_epi16 (_mm_add_epi16 (low, _mm_set1_epi16 (128)), 8);
+
+    __m128i high = _mm_add_epi16 (_mm_srli_epi16 (up_q2, 2), _mm_slli_epi16 (_mm_srli_epi16 (lap, 8), 1));
+    high = _mm_sub_epi16 (high, _mm_set1_epi16 (256));
+    store_epi16_8_sse41 (_mm_add_epi16 (high, low), out);
+}
+
+// vertical Q8 sums of 8 columns, biased by -32768 into signed 16 bits
+XCAM_TARGET_SSE41 static inline __m128i
+gauss_column_8_sse41 (const Uchar *const *rows, uint32_t offset)
+{
+    __m128i sum = _mm_setzero_si128 ();
+    for (uint32_t k = 0; k < 5; ++k) {
+        __m128i v = load_uchar_8_epi16_sse41 (rows[k] + offset);
+        sum = _mm_add_epi16 (sum, _mm_mullo_epi16 (v, _mm_set1_epi16 (gauss_coeffs_q8[k])));
+    }
+    return _mm_xor_si128 (sum, _mm_set1_epi16 ((int16_t)0x8000));
+}
+
+// 4 outputs from column pairs of cur and next, bias of columns is 32768 * 256 after taps
+XCAM_TARGET_SSE41 static inline __m128i
+gauss_row_4_sse41 (__m128i cur, __m128i next)
+{
+    const __m128i c01 = _mm_set_epi16 (
+        gauss_coeffs_q8[1], gauss_coeffs_q8[0], gauss_coeffs_q8[1], gauss_coeffs_q8[0],
+        gauss_coeffs_q8[1], gauss_coeffs_q8[0], gauss_coeffs_q8[1], gauss_coeffs_q8[0]);
+    const __m128i c23 = _mm_set_epi16 (
+        gauss_coeffs_q8[3], gauss_coeffs_q8[2], gauss_coeffs_q8[3], gauss_coeffs_q8[2],
+        gauss_coeffs_q8[3], gauss_coeffs_q8[2], gauss_coeffs_q8[3], gauss_coeffs_q8[2]);
+    const __m128i c4 = _mm_set_epi16 (
+        0, gauss_coeffs_q8[4], 0, gauss_coeffs_q8[4], 0, gauss_coeffs_q8[4], 0, gauss_coeffs_q8[4]);
+
+    __m128i sum = _mm_madd_epi16 (cur, c01);
+    sum = _mm_add_epi32 (sum, _mm_madd_epi16 (_mm_alignr_epi8 (next, cur, 4), c23));
+    sum = _mm_add_epi32 (sum, _mm_madd_epi16 (_mm_alignr_epi8 (next, cur, 8), c4));
+    sum = _mm_add_epi32 (sum, _mm_set1_epi32 (32768 * 256 + (1 << 15)));
+    return _mm_srai_epi32 (sum, 16);
+}
+
+XCAM_TARGET_SSE41 static void
+gauss_fixed_8_sse41 (const Uchar *const *rows, Uchar *out)
+{
+    __m128i col0 = gauss_column_8_sse41 (rows, 0);
+    __m128i col1 = gauss_column_8_sse41 (rows, 8);
+    __m128i col2 = gauss_column_8_sse41 (rows, 16);
+    __m128i v = _mm_packs_epi32 (gauss_row_4_sse41 (col0, col1), gauss_row_4_sse41 (col1, col2));
+    store_epi16_8_sse41 (v, out);
+}
+
+XCAM_TARGET_AVX2 static inline __m256
+load_uchar_8_avx2 (const Uchar *in)
+{
+    return _mm256_cvtepi32_ps (_mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *)in)));
+}
+
+XCAM_TARGET_AVX2 static inline void
+store_uchar_8_avx2 (__m256 v, Uchar *out)
+{
+    v = _mm256_min_ps (_mm256_max_ps (v, _mm256_setzero_ps ()), _mm256_set1_ps (255.0f));
+    __m256i i32 = _mm256_cvttps_epi32 (_mm256_add_ps (v, _mm256_set1_ps (0.5f)));
+    __m128i i16 = _mm_packs_epi32 (_mm256_castsi256_si128 (i32), _mm256_extracti128_si256 (i32, 1));
+    _mm_storel_epi64 ((__m128i *)out, _mm_packus_epi16 (i16, i16));
+}
+
+XCAM_TARGET_AVX2 static void
+blend_8_avx2 (const Uchar *in0, const Uchar *in1, const Uchar *mask, float *out_mask, float *out)
+{
+    __m256 m = _mm256_div_ps (load_uchar_8_avx2 (mask), _mm256_set1_ps (255.0f));
+    __m256 a = load_uchar_8_avx2 (in0);
+    __m256 b = load_uchar_8_avx2 (in1);
+    _mm256_storeu_ps (out_mask, m);
+    _mm256_storeu_ps (out, _mm256_add_ps (_mm256_mul_ps (_mm256_sub_ps (a, b), m), b));
+}
+
+XCAM_TARGET_AVX2 static void
+convert_8_avx2 (const float *in, Uchar *out)
+{
+    store_uchar_8_avx2 (_mm256_loadu_ps (in), out);
+}
+
+XCAM_TARGET_AVX2 static void
+laplace_8_avx2 (const Uchar *orig, const float *gauss, Uchar *out)
+{
+    __m256 v = _mm256_sub_ps (load_uchar_8_avx2 (orig), _mm256_loadu_ps (gauss));
+    v = _mm256_add_ps (_mm256_mul_ps (v, _mm256_set1_ps (0.5f)), _mm256_set1_ps (128.0f));
+    store_uchar_8_avx2 (v, out);
+}
+
+XCAM_TARGET_AVX2 static void
+reconstruct_8_avx2 (const float *lap, const float *up_sample, Uchar *out)
+{
+    __m256 v = _mm256_add_ps (_mm256_loadu_ps (up_sample), _mm256_mul_ps (_mm256_loadu_ps (lap), _mm256_set1_ps (2.0f)));
+    store_uchar_8_avx2 (_mm256_sub_ps (v, _mm256_set1_ps (256.0f)), out);
+}
+
+XCAM_TARGET_AVX2 static inline __m256
+bilinear_8_avx2 (__m256 a, __m256 b, __m256 l00, __m256 l01, __m256 l10, __m256 l11)
+{
+    const __m256 one = _mm256_set1_ps (1.0f);
+    __m256 a1 = _mm256_sub_ps (one, a);
+    __m256 b1 = _mm256_sub_ps (one, b);
+    __m256 v = _mm256_add_ps (_mm256_mul_ps (l11, _mm256_mul_ps (a, b)), _mm256_mul_ps (l00, _mm256_mul_ps (a1, b1)));
+    v = _mm256_add_ps (v, _mm256_mul_ps (l10, _mm256_mul_ps (a1, b)));
+    return _mm256_add_ps (v, _mm256_mul_ps (l01, _mm256_mul_ps (a, b1)));
+}
+
+XCAM_TARGET_AVX2 static inline bool
+split_pos_8_avx2 (
+    const Float2 *pos, float max_x, float max_y,
+    __m256 &a, __m256 &b, __m256i &x0, __m256i &y0)
+{
+    __m256 p0 = _mm256_loadu_ps ((const float *)pos);
+    __m256 p1 = _mm256_loadu_ps ((const float *)pos + 8);
+    // shuffle works in 128-bit lanes, 64-bit permute restores the order
+    __m256 x = _mm256_shuffle_ps (p0, p1, _MM_SHUFFLE (2, 0, 2, 0));
+    __m256 y = _mm256_shuffle_ps (p0, p1, _MM_SHUFFLE (3, 1, 3, 1));
+    x = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (x), _MM_SHUFFLE (3, 1, 2, 0)));
+    y = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (y), _MM_SHUFFLE (3, 1, 2, 0)));
+
+    __m256 in = _mm256_and_ps (
+                    _mm256_and_ps (_mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_GE_OQ),
+                                   _mm256_cmp_ps (x, _mm256_set1_ps (max_x), _CMP_LT_OQ)),
+                    _mm256_and_ps (_mm256_cmp_ps (y, _mm256_setzero_ps (), _CMP_GE_OQ),
+                                   _mm256_cmp_ps (y, _mm256_set1_ps (max_y), _CMP_LT_OQ)));
+    if (_mm256_movemask_ps (in) != 0xFF)
+        return false;
+
+    x0 = _mm256_cvttps_epi32 (x);
+    y0 = _mm256_cvttps_epi32 (y);
+    a = _mm256_sub_ps (x, _mm256_cvtepi32_ps (x0));
+    b = _mm256_sub_ps (y, _mm256_cvtepi32_ps (y0));
+    return true;
+}
+
+// positions split by split_pos_8_avx2 with max_x = width - 3
+XCAM_TARGET_AVX2 static inline __m256
+sample_8_avx2 (const Uchar *buf, int32_t pitch, __m256 a, __m256 b, __m256i x0, __m256i y0)
+{
+    const __m256i low_byte = _mm256_set1_epi32 (0xFF);
+    __m256i offset = _mm256_add_epi32 (_mm256_mullo_epi32 (y0, _mm256_set1_epi32 (pitch)), x0);
+    __m256i top = _mm256_i32gather_epi32 ((const int *)buf, offset, 1);
+    __m256i bottom = _mm256_i32gather_epi32 ((const int *)(buf + pitch), offset, 1);
+
+    __m256 l00 = _mm256_cvtepi32_ps (_mm256_and_si256 (top, low_byte));
+    __m256 l01 = _mm256_cvtepi32_ps (_mm256_and_si256 (_mm256_srli_epi32 (top, 8), low_byte));
+    __m256 l10 = _mm256_cvtepi32_ps (_mm256_and_si256 (bottom, low_byte));
+    __m256 l11 = _mm256_cvtepi32_ps (_mm256_and_si256 (_mm256_srli_epi32 (bottom, 8), low_byte));
+
+    return bilinear_8_avx2 (a, b, l00, l01, l10, l11);
+}
+
+XCAM_TARGET_AVX2 static bool
+interp_uchar_avx2 (const UcharImage *image, const Float2 *pos, uint32_t count, Uchar *out)
+{
+    if (count != 8)
+        return interp_uchar_sse41 (image, pos, count, out);
+
+    const Uchar *buf = image->get_buf_ptr (0, 0);
+    const int32_t pitch = image->get_pitch ();
+    // 32-bit gather reads 4 bytes from x0, keep x0 + 3 inside the row
+    const float max_x = (float)image->get_width () - 3.0f;
+    const float max_y = (float)image->get_height () - 1.0f;
+
+    __m256 a, b;
+    __m256i x0, y0;
+    if (!split_pos_8_avx2 (pos, max_x, max_y, a, b, x0, y0))
+        return false;
+
+    store_uchar_8_avx2 (sample_8_avx2 (buf, pitch, a, b, x0, y0), out);
+    return true;
+}
+
+XCAM_TARGET_AVX2 static bool
+fastmap_blend_8_avx2 (
+    const UcharImage *in0, const Float2 *pos0, const UcharImage *in1, const Float2 *pos1,
+    const Uchar *mask, Uchar *out)
+{
+    // 32-bit gather reads 4 bytes from x0, keep x0 + 3 inside the row
+    __m256 a0, b0, a1, b1;
+    __m256i x0, y0, x1, y1;
+    if (!split_pos_8_avx2 (pos0, in0->get_width () - 3.0f, in0->get_height () - 1.0f, a0, b0, x0, y0) ||
+            !split_pos_8_avx2 (pos1, in1->get_width () - 3.0f, in1->get_height () - 1.0f, a1, b1, x1, y1))
+        return false;
+
+    __m256 v0 = sample_8_avx2 (in0->get_buf_ptr (0, 0), in0->get_pitch (), a0, b0, x0, y0);
+    __m256 v1 = sample_8_avx2 (in1->get_buf_ptr (0, 0), in1->get_pitch (), a1, b1, x1, y1);
+    __m256 m = _mm256_div_ps (load_uchar_8_avx2 (mask), _mm256_set1_ps (255.0f));
+    store_uchar_8_avx2 (_mm256_add_ps (_mm256_mul_ps (_mm256_sub_ps (v0, v1), m), v1), out);
+    return true;
+}
+
+XCAM_TARGET_AVX2 static bool
+interp_float2_8_avx2 (const Float2Image *image, const Float2 *pos, Float2 *out)
+{
+    const float *buf = (const float *)image->get_buf_ptr (0, 0);
+    const int32_t pitch = image->get_pitch ();
+    const float max_x = (float)image->get_width () - 1.0f;
+    const float max_y = (float)image->get_height () - 1.0f;
+
+    __m256 a, b;
+    __m256i x0, y0;
+    if (!split_pos_8_avx2 (pos, max_x, max_y, a, b, x0, y0))
+        return false;
+
+    // byte offsets of p0.x in top row
+    __m256i offset = _mm256_add_epi32 (_mm256_mullo_epi32 (y0, _mm256_set1_epi32 (pitch)), _mm256_slli_epi32 (x0, 3));
+    const float *bottom = (const float *)((const uint8_t *)buf + pitch);
+
+    __m256 x00 = _mm256_i32gather_ps (buf, offset, 1);
+    __m256 y00 = _mm256_i32gather_ps (buf + 1, offset, 1);
+    __m256 x01 = _mm256_i32gather_ps (buf + 2, offset, 1);
+    __m256 y01 = _mm256_i32gather_ps (buf + 3, offset, 1);
+    __m256 x10 = _mm256_i32gather_ps (bottom, offset, 1);
+    __m256 y10 = _mm256_i32gather_ps (bottom + 1, offset, 1);
+    __m256 x11 = _mm256_i32gather_ps (bottom + 2, offset, 1);
+    __m256 y11 = _mm256_i32gather_ps (bottom + 3, offset, 1);
+
+    __m256 vx = bilinear_8_avx2 (a, b, x00, x01, x10, x11);
+    __m256 vy = bilinear_8_avx2 (a, b, y00, y01, y10, y11);
+
+    __m256 lo = _mm256_unpacklo_ps (vx, vy);
+    __m256 hi = _mm256_unpackhi_ps (vx, vy);
+    _mm256_storeu_ps ((float *)out, _mm256_permute2f128_ps (lo, hi, 0x20));
+    _mm256_storeu_ps ((float *)out + 8, _mm256_permute2f128_ps (lo, hi, 0x31));
+    return true;
+}
+
+#endif
+
+static const SimdKernels scalar_kernels = {
+    blend_8_scalar,
+    convert_8_scalar,
+    laplace_8_scalar,
+    reconstruct_8_scalar,
+    interp_uchar_scalar,
+    interp_float2_8_scalar,
+    interp_short2_8_scalar,
+    fastmap_blend_8_scalar,
+    blend_fixed_8_scalar,
+    laplace_fixed_8_scalar,
+    reconstruct_fixed_8_scalar,
+    gauss_fixed_8_scalar,
+};
+
+#if XCAM_SOFT_SIMD_X86
+static const SimdKernels sse41_kernels = {
+    blend_8_sse41,
+    convert_8_sse41,
+    laplace_8_sse41,
+    reconstruct_8_sse41,
+    interp_uchar_sse41,
+    interp_float2_8_sse41,
+    interp_short2_8_sse41,
+    fastmap_blend_8_sse41,
+    blend_fixed_8_sse41,
+    laplace_fixed_8_sse41,
+    reconstruct_fixed_8_sse41,
+    gauss_fixed_8_sse41,
+};
+
+static const SimdKernels avx2_kernels = {
+    blend_8_avx2,
+    convert_8_avx2,
+    laplace_8_avx2,
+    reconstruct_8_avx2,
+    interp_uchar_avx2,
+    interp_float2_8_avx2,
+    interp_short2_8_sse41,
+    fastmap_blend_8_avx2,
+    // 8 int16 pixels fill one 128-bit register
+    blend_fixed_8_sse41,
+    laplace_fixed_8_sse41,
+    reconstruct_fixed_8_sse41,
+    gauss_fixed_8_sse41,
+};
+#endif
+
+static SimdLevel
+detect_simd_level ()
+{
+    SimdLevel level = SimdScalar;
+#if XCAM_SOFT_SIMD_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+        level = SimdAVX2;
+    else if (__builtin_cpu_supports ("sse4.1"))
+        level = SimdSSE41;
+#endif
+
+    const char *env = getenv ("XCAM_SOFT_SIMD");
+    if (env) {
+        SimdLevel cap = level;
+        if (!strcasecmp (env, "scalar"))
+            cap = SimdScalar;
+        else if (!strcasecmp (env, "sse4.1"))
+            cap = SimdSSE41;
+        else if (!strcasecmp (env, "avx2"))
+            cap = SimdAVX2;
+        else
+            XCAM_LOG_WARNING ("unknown XCAM_SOFT_SIMD:%s, select from [scalar/sse4.1/avx2]", env);
+        level = XCAM_MIN (level, cap);
+    }
+
+    XCAM_LOG_DEBUG ("soft simd level:%s", get_simd_level_name (level));
+    return level;
+}
+
+SimdLevel
+get_simd_level ()
+{
+    static const SimdLevel level = detect_simd_level ();
+    return level;
+}
+
+const char *
+get_simd_level_name (SimdLevel level)
+{
+    switch (level) {
+    case SimdSSE41:
+        return "sse4.1";
+    case SimdAVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+const SimdKernels &
+get_kernels (SimdLevel level)
+{
+#if XCAM_SOFT_SIMD_X86
+    if (level == SimdAVX2)
+        return avx2_kernels;
+    if (level == SimdSSE41)
+        return sse41_kernels;
+#else
+    XCAM_UNUSED (level);
+#endif
+    return scalar_kernels;
+}
+
+static std::atomic<const SimdKernels *> forced_kernels (NULL);
+
+SimdLevel
+set_simd_level (SimdLevel level)
+{
+    level = XCAM_MIN (level, get_simd_level ());
+    forced_kernels.store (&get_kernels (level), std::memory_order_relaxed);
+    return level;
+}
+
+const SimdKernels &
+get_kernels ()
+{
+    const SimdKernels *forced = forced_kernels.load (std::memory_order_relaxed);
+    if (forced)
+        return *forced;
+
+    static const SimdKernels &kernels = get_kernels (get_simd_level ());
+    return kernels;
+}
+
+}
+
+}
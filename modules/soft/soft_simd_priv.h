@@ -0,0 +1,97 @@
+/*
+ * soft_simd_priv.h - soft SIMD kernels with runtime dispatch
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_SOFT_SIMD_PRIV_H
+#define XCAM_SOFT_SIMD_PRIV_H
+
+#include <xcam_std.h>
+#include <soft/soft_image.h>
+
+namespace XCam {
+
+namespace XCamSoftSimd {
+
+enum SimdLevel {
+    SimdScalar = 0,
+    SimdSSE41,
+    SimdAVX2,
+};
+
+/*
+ * kernels work on 8 pixels, results are bit-exact with the scalar path
+ * (same operation order, no FMA contraction).
+ * interp_* return false if any position is too close to the border,
+ * the caller falls back to the border-checked scalar path then.
+ */
+struct SimdKernels {
+    // out_mask = mask / 255, out = (in0 - in1) * out_mask + in1
+    void (*blend_8) (const Uchar *in0, const Uchar *in1, const Uchar *mask, float *out_mask, float *out);
+    // out = convert_to_uchar (in)
+    void (*convert_8) (const float *in, Uchar *out);
+    // out = convert_to_uchar ((orig - gauss) * 0.5 + 128)
+    void (*laplace_8) (const Uchar *orig, const float *gauss, Uchar *out);
+    // out = convert_to_uchar (up_sample + lap * 2 - 256)
+    void (*reconstruct_8) (const float *lap, const float *up_sample, Uchar *out);
+    // bilinear sampling of @count (4 or 8) uchar pixels
+    bool (*interp_uchar) (
+        const UcharImage *image, const Float2 *pos, uint32_t count, Uchar *out);
+    // bilinear sampling of 8 Float2 lookup table entries
+    bool (*interp_float2_8) (
+        const Float2Image *image, const Float2 *pos, Float2 *out);
+    // bilinear sampling of 8 int16 fixed-point lookup table entries, result * scale
+    bool (*interp_short2_8) (
+        const Short2Image *image, const Float2 *pos, float scale, Float2 *out);
+    // bilinear sampling of 8 pixels in both images, out = convert_to_uchar ((v0 - v1) * mask / 255 + v1)
+    bool (*fastmap_blend_8) (
+        const UcharImage *in0, const Float2 *pos0, const UcharImage *in1, const Float2 *pos1,
+        const Uchar *mask, Uchar *out);
+
+    /*
+     * fixed-point kernels, 8 pixels in int16 lanes, weight = mask + (mask >> 7) in Q8,
+     * up-sampled gauss values in Q2, see soft_blender_tasks_priv.cpp
+     */
+    // out = (in0 * weight + in1 * (256 - weight) + 128) >> 8
+    void (*blend_fixed_8) (const Uchar *in0, const Uchar *in1, const Uchar *mask, Uchar *out);
+    // out = clamp ((orig * 4 - up + 4 + 1024) >> 3)
+    void (*laplace_fixed_8) (const Uchar *orig, const int16_t *up, Uchar *out);
+    // out = clamp ((up * 64 + (lap0 * weight + lap1 * (256 - weight)) * 2 - 65536 + 128) >> 8)
+    void (*reconstruct_fixed_8) (
+        const Uchar *lap0, const Uchar *lap1, const Uchar *mask, const int16_t *up, Uchar *out);
+    // 5x5 gauss of 8 pixels on every other column of rows[0..4] + 2, each row has 24 readable pixels
+    void (*gauss_fixed_8) (const Uchar *const *rows, Uchar *out);
+};
+
+// highest level supported by cpu, capped by env XCAM_SOFT_SIMD=scalar|sse4.1|avx2
+SimdLevel get_simd_level ();
+const char *get_simd_level_name (SimdLevel level);
+
+// overrides level of get_kernels () for checks against the scalar path, capped by get_simd_level (),
+// returns the level set. call it while no soft task is running
+SimdLevel set_simd_level (SimdLevel level);
+
+// kernels of current simd level, selected once unless overridden
+const SimdKernels &get_kernels ();
+const SimdKernels &get_kernels (SimdLevel level);
+
+}
+
+}
+
+#endif // XCAM_SOFT_SIMD_PRIV_H
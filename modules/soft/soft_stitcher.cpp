@@ -26,7 +26,10 @@
 #include "soft_video_buf_allocator.h"
 #include "interface/feature_match.h"
 #include "soft_copy_task.h"
+#include "soft_fastmap_task.h"
 #include "xcam_utils.h"
+#include "xcam_numa.h"
+#include "thread_pool.h"
 #include <map>
 
 #define ENABLE_FEATURE_MATCH HAVE_OPENCV
@@ -85,6 +88,7 @@ namespace SoftStitcherPriv {
 DECLARE_HANDLER_CALLBACK (CbGeoMap, SoftStitcher, geomap_done);
 DECLARE_HANDLER_CALLBACK (CbBlender, SoftStitcher, blender_done);
 DECLARE_WORK_CALLBACK (CbCopyTask, SoftStitcher, copy_task_done);
+DECLARE_WORK_CALLBACK (CbFastMapTask, SoftStitcher, fastmap_task_done);
 
 struct BlenderParam
     : SoftBlender::BlenderParam
@@ -104,9 +108,10 @@ struct BlenderParam
 
 typedef std::map<void*, SmartPtr<BlenderParam>> BlenderParams;
 typedef std::map<void*, int32_t> BlendCopyTaskNums;
+typedef std::map<int32_t, SmartPtr<ThreadPool>> NodeThreads;
 
 struct HandlerParam
-    : ImageHandler::Parameters
+    : SoftGeoMapper::AreaParameters
 {
     SmartPtr<SoftStitcher::StitcherParam>  stitch_param;
     uint32_t idx;
@@ -129,6 +134,19 @@ struct StitcherCopyArgs
     {}
 };
 
+struct StitcherFastMapArgs
+    : XCamSoftTasks::FastMapTask::Args
+{
+    uint32_t idx;
+
+    StitcherFastMapArgs (
+        uint32_t i,
+        const SmartPtr<ImageHandler::Parameters> &param)
+        : XCamSoftTasks::FastMapTask::Args (param)
+        , idx (i)
+    {}
+};
+
 struct Factor {
     float x, y;
 
@@ -155,6 +173,7 @@ struct FisheyeMap {
     FisheyeDewarpMode            dewarp_mode;
     FisheyeInfo                  fisheye_info;
     Factor                       left_match_factor, right_match_factor;
+    SoftGeoMapper::MapAreas      overlap_areas;
 
     XCamReturn set_map_table (
         SoftStitcher *stitcher, const Stitcher::RoundViewSlice &view_slice, uint32_t cam_idx);
@@ -170,6 +189,24 @@ struct Copier {
 };
 typedef std::vector<Copier>    Copiers;
 
+// copy area of one camera or overlap of two cameras, mapped by precomputed coordinates
+struct FastMapArea {
+    SmartPtr<XCamSoftTasks::FastMapTask>    task;
+    uint32_t                                in_idx[2];
+    Rect                                    in_area[2];
+    Rect                                    out_area;
+    SmartPtr<UcharImage>                    mask;
+
+    FastMapArea () {
+        in_idx[0] = in_idx[1] = INVALID_INDEX;
+    }
+
+    XCamReturn start_fastmap_task (
+        const SmartPtr<SoftStitcher::StitcherParam> &param,
+        const uint32_t idx, const SmartPtr<Float2Image> *coords);
+};
+typedef std::vector<FastMapArea>    FastMapAreas;
+
 class StitcherImpl {
     friend class XCam::SoftStitcher;
 
@@ -177,6 +214,9 @@ public:
     StitcherImpl (SoftStitcher *handler)
         : _stitcher (handler)
         , _pixel_format (V4L2_PIX_FMT_NV12)
+        , _fused_map (false)
+        , _fastmap (false)
+        , _fastmap_active (false)
     {}
 
     XCamReturn init_config (uint32_t count);
@@ -194,8 +234,11 @@ public:
         const uint32_t idx, const SmartPtr<VideoBuffer> &buf);
 
     XCamReturn start_overlap_task (uint32_t idx, const SmartPtr<BlenderParam> &param);
+    XCamReturn start_fastmap_works (const SmartPtr<SoftStitcher::StitcherParam> &param);
     XCamReturn stop ();
 
+    XCamReturn activate_fastmap ();
+
     XCamReturn gen_geomap_table ();
     XCamReturn start_feature_match (
         const SmartPtr<VideoBuffer> &left_buf, const SmartPtr<VideoBuffer> &right_buf, const uint32_t idx);
@@ -207,15 +250,25 @@ public:
     uint32_t get_pixel_format () const {
         return _pixel_format;
     };
+    bool is_fused_map () const {
+        return _fused_map;
+    }
+    bool is_fastmap_active () const {
+        return _fastmap_active;
+    }
 
 private:
     SmartPtr<SoftGeoMapper> create_geo_mapper (const Stitcher::RoundViewSlice &view_slice);
 
     XCamReturn init_fisheye (uint32_t idx);
+    SmartPtr<ThreadPool> get_node_threads (int32_t node);
     XCamReturn init_blender (uint32_t idx);
     XCamReturn init_copier (Stitcher::CopyArea area);
     bool init_geomap_factors (uint32_t idx);
     XCamReturn create_copier (Stitcher::CopyArea area);
+    bool init_fused_map (uint32_t count);
+    bool init_fastmap (uint32_t count);
+    bool add_fastmap_area (FastMapArea &area);
 
     void calc_factors (
         const uint32_t &idx, const Factor &last_left_factor, const Factor &last_right_factor,
@@ -228,13 +281,20 @@ private:
     FisheyeMap              _fisheye [XCAM_STITCH_MAX_CAMERAS];
     Overlap                 _overlaps [XCAM_STITCH_MAX_CAMERAS];
     Copiers                 _copiers;
+    FastMapAreas            _fastmap_areas;
+    SmartPtr<Float2Image>   _fastmap_coords [XCAM_STITCH_MAX_CAMERAS];
     SmartPtr<BufferPool>    _geomap_pool;
+    // geomap pools by numa node, shared by cameras on the same node
+    NodeThreads             _node_threads;
 
     Mutex                   _map_mutex;
     BlendCopyTaskNums       _task_counts;
 
     SoftStitcher           *_stitcher;
     uint32_t               _pixel_format;
+    bool                   _fused_map;
+    bool                   _fastmap;
+    bool                   _fastmap_active;
 };
 
 XCamReturn
@@ -286,12 +346,13 @@ FisheyeMap::set_map_table (
     dewarper->set_table_size (table_width, table_height);
 
     FisheyeDewarp::MapTable map_table (table_width * table_height);
-    dewarper->gen_table (map_table);
+    dewarper->gen_table_cached (map_table, stitcher->get_lut_cache_dir ());
 
     char prefix[XCAM_MAX_STR_SIZE] = {0};
     snprintf (prefix, XCAM_MAX_STR_SIZE, "fisheye-lut-%dx%d", table_width, table_height);
     stitcher_dump_fisheye_lut (map_table, cam_idx, prefix);
 
+    mapper->set_compact_table (stitcher->get_compact_lut ());
     XCAM_FAIL_RETURN (
         ERROR, mapper->set_lookup_table (map_table.data (), table_width, table_height), XCAM_RETURN_ERROR_UNKNOWN,
         "soft-stitcher:%s set fisheye geomap lookup table failed", XCAM_STR (stitcher->get_name ()));
@@ -397,6 +458,34 @@ StitcherImpl::create_geo_mapper (const Stitcher::RoundViewSlice &view_slice)
     return mapper;
 }
 
+SmartPtr<ThreadPool>
+StitcherImpl::get_node_threads (int32_t node)
+{
+    XCAM_ASSERT (node >= 0);
+    NodeThreads::iterator i = _node_threads.find (node);
+    if (i != _node_threads.end ())
+        return i->second;
+
+    std::vector<uint32_t> cpus;
+    XCAM_FAIL_RETURN (
+        ERROR, NumaTopology::get_node_cpus (node, cpus) && !cpus.empty (), NULL,
+        "stitcher:%s get cpus of numa node(%d) failed", XCAM_STR (_stitcher->get_name ()), node);
+    uint32_t thread_count = cpus.size ();
+
+    char name[XCAM_MAX_STR_SIZE];
+    snprintf (name, XCAM_MAX_STR_SIZE, "%s-node%d", XCAM_STR (_stitcher->get_name ()), node);
+
+    SmartPtr<ThreadPool> threads = new ThreadPool (name);
+    XCAM_ASSERT (threads.ptr ());
+    threads->set_cpus (cpus);
+    threads->set_fifo_priority (_stitcher->_geomap_priority);
+    // extra thread to process all_items_done
+    threads->set_threads (thread_count, thread_count + 1);
+
+    _node_threads[node] = threads;
+    return threads;
+}
+
 XCamReturn
 StitcherImpl::init_fisheye (uint32_t idx)
 {
@@ -411,6 +500,22 @@ StitcherImpl::init_fisheye (uint32_t idx)
     SmartPtr<ImageHandler::Callback> geomap_cb = new CbGeoMap (_stitcher);
     fisheye.mapper = create_geo_mapper (view_slice);
     fisheye.mapper->set_callback (geomap_cb);
+    // stitcher pool goes to its handlers, pool of numa node overrides it for geomapper
+    fisheye.mapper->set_threads (_stitcher->get_threads ());
+
+    int32_t node = _stitcher->_numa_nodes[idx];
+    if (node >= 0) {
+        SmartPtr<ThreadPool> threads = get_node_threads (node);
+        XCAM_FAIL_RETURN (
+            ERROR, threads.ptr (), XCAM_RETURN_ERROR_THREAD,
+            "stitcher:%s init geomap threads failed, idx:%d", XCAM_STR (_stitcher->get_name ()), idx);
+        fisheye.mapper->set_threads (threads);
+    } else if (_stitcher->_geomap_priority > 0) {
+        // SCHED_FIFO threads free to run on every cpu could starve the rest of the system
+        XCAM_LOG_WARNING (
+            "stitcher:%s geomap priority ignored, camera(%d) has no numa node",
+            XCAM_STR (_stitcher->get_name ()), idx);
+    }
 
     VideoBufferInfo buf_info;
     uint32_t pixel_format = get_pixel_format ();
@@ -419,11 +524,15 @@ StitcherImpl::init_fisheye (uint32_t idx)
         XCAM_ALIGN_UP (view_slice.width, SOFT_STITCHER_ALIGNMENT_X),
         XCAM_ALIGN_UP (view_slice.height, SOFT_STITCHER_ALIGNMENT_Y));
 
-    SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (buf_info);
+    SmartPtr<SoftVideoBufAllocator> pool = new SoftVideoBufAllocator (buf_info);
     XCAM_ASSERT (pool.ptr ());
+    char pool_name[XCAM_MAX_STR_SIZE] = {'\0'};
+    snprintf (pool_name, XCAM_MAX_STR_SIZE, "%s-geomap%d", XCAM_STR (_stitcher->get_name ()), idx);
+    pool->set_name (pool_name);
+    pool->set_numa_node (node);
     fisheye.buf_pool = pool;
     XCAM_FAIL_RETURN (
-        ERROR, fisheye.buf_pool->reserve (2), XCAM_RETURN_ERROR_MEM,
+        ERROR, fisheye.buf_pool->reserve (_stitcher->get_inflight_frames () + 1), XCAM_RETURN_ERROR_MEM,
         "stitcher:%s reserve geomap buffer pool(w:%d,h:%d) failed",
         XCAM_STR (_stitcher->get_name ()), buf_info.width, buf_info.height);
 
@@ -446,6 +555,7 @@ StitcherImpl::create_copier (Stitcher::CopyArea area)
     Copier copier;
     copier.copy_task = new XCamSoftTasks::CopyTask (copy_cb);
     XCAM_ASSERT (copier.copy_task.ptr ());
+    _stitcher->setup_worker (copier.copy_task);
     copier.copy_area = area;
     _copiers.push_back (copier);
 
@@ -511,8 +621,10 @@ StitcherImpl::init_blender (uint32_t idx)
 {
     _overlaps[idx].blender = create_soft_blender ().dynamic_cast_ptr<SoftBlender>();
     XCAM_ASSERT (_overlaps[idx].blender.ptr ());
+    _overlaps[idx].blender->set_threads (_stitcher->get_threads ());
 
     _overlaps[idx].blender->set_pyr_levels (_stitcher->get_blend_pyr_levels ());
+    _overlaps[idx].blender->set_inflight_frames (_stitcher->get_inflight_frames ());
 
     uint32_t out_width, out_height;
     _stitcher->get_output_size (out_width, out_height);
@@ -582,6 +694,126 @@ StitcherImpl::init_copier (Stitcher::CopyArea area)
     return XCAM_RETURN_NO_ERROR;
 }
 
+static bool
+is_map_area_aligned (const Rect &area, uint32_t out_x, uint32_t out_y)
+{
+    return area.pos_x % XCAM_SOFT_WORKUNIT_PIXELS == 0 && area.width % XCAM_SOFT_WORKUNIT_PIXELS == 0 &&
+           area.pos_y % 2 == 0 && area.height % 2 == 0 && out_x % 2 == 0 && out_y % 2 == 0;
+}
+
+static bool
+add_overlap_area (SoftGeoMapper::MapAreas &areas, const Rect &area)
+{
+    if (!is_map_area_aligned (area, area.pos_x, area.pos_y))
+        return false;
+
+    SoftGeoMapper::MapArea map_area;
+    map_area.area = area;
+    map_area.out_x = area.pos_x;
+    map_area.out_y = area.pos_y;
+    areas.push_back (map_area);
+    return true;
+}
+
+bool
+StitcherImpl::init_fused_map (uint32_t count)
+{
+    // geomap writes copy areas into output buffer directly,
+    // only overlap strips are kept in geomap buffers for blender and feature match
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t pre_idx = (i + count - 1) % count;
+        SoftGeoMapper::MapAreas &areas = _fisheye[i].overlap_areas;
+        areas.clear ();
+
+        if (!add_overlap_area (areas, _stitcher->get_overlap (pre_idx).right) ||
+                !add_overlap_area (areas, _stitcher->get_overlap (i).left)) {
+            XCAM_LOG_DEBUG (
+                "soft-stitcher:%s camera(idx:%d) overlap areas are not aligned, fused map disabled",
+                XCAM_STR (_stitcher->get_name ()), i);
+            return false;
+        }
+    }
+
+    for (Copiers::iterator i = _copiers.begin (); i != _copiers.end (); ++i) {
+        const Stitcher::CopyArea &area = i->copy_area;
+        if (!is_map_area_aligned (area.in_area, area.out_area.pos_x, area.out_area.pos_y)) {
+            XCAM_LOG_DEBUG (
+                "soft-stitcher:%s copy area(idx:%d) is not aligned, fused map disabled",
+                XCAM_STR (_stitcher->get_name ()), area.in_idx);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+StitcherImpl::add_fastmap_area (FastMapArea &area)
+{
+    const Rect &out = area.out_area;
+    bool aligned = out.pos_x % 2 == 0 && out.pos_y % 2 == 0 && out.width % 8 == 0 && out.height % 2 == 0;
+    for (uint32_t k = 0; k < 2 && area.in_idx[k] != INVALID_INDEX; ++k) {
+        const Rect &in = area.in_area[k];
+        aligned = aligned && in.pos_x >= 0 && in.pos_y >= 0 && in.pos_x % 2 == 0 && in.pos_y % 2 == 0 &&
+                  in.width == out.width && in.height == out.height;
+    }
+    if (!aligned || out.width <= 0 || out.height <= 0)
+        return false;
+
+    area.task = new XCamSoftTasks::FastMapTask (new CbFastMapTask (_stitcher));
+    XCAM_ASSERT (area.task.ptr ());
+    _stitcher->setup_worker (area.task);
+    _fastmap_areas.push_back (area);
+    return true;
+}
+
+bool
+StitcherImpl::init_fastmap (uint32_t count)
+{
+    _fastmap_areas.clear ();
+
+    for (Copiers::iterator i = _copiers.begin (); i != _copiers.end (); ++i) {
+        FastMapArea area;
+        area.in_idx[0] = i->copy_area.in_idx;
+        area.in_area[0] = i->copy_area.in_area;
+        area.out_area = i->copy_area.out_area;
+        if (!add_fastmap_area (area)) {
+            XCAM_LOG_DEBUG (
+                "soft-stitcher:%s copy area(idx:%d) is not aligned, fastmap disabled",
+                XCAM_STR (_stitcher->get_name ()), area.in_idx[0]);
+            return false;
+        }
+    }
+
+    // blend mask is the first level mask of blender
+    for (uint32_t i = 0; i < count; ++i) {
+        const SmartPtr<SoftBlender> &blender = _overlaps[i].blender;
+        FastMapArea area;
+        area.in_idx[0] = i;
+        area.in_idx[1] = (i + 1) % count;
+        area.in_area[0] = blender->get_input_merge_area (0);
+        area.in_area[1] = blender->get_input_merge_area (1);
+        area.out_area = blender->get_merge_window ();
+        if (!add_fastmap_area (area)) {
+            XCAM_LOG_DEBUG (
+                "soft-stitcher:%s overlap(idx:%d) is not aligned, fastmap disabled",
+                XCAM_STR (_stitcher->get_name ()), i);
+            return false;
+        }
+
+        std::vector<uint8_t> mask_line;
+        gen_soft_blend_mask (area.out_area.width, mask_line);
+        SmartPtr<UcharImage> mask = new UcharImage (area.out_area.width, 1);
+        XCAM_FAIL_RETURN (
+            ERROR, mask.ptr () && mask->is_valid (), false,
+            "soft-stitcher:%s allocate fastmap mask failed", XCAM_STR (_stitcher->get_name ()));
+        memcpy (mask->get_buf_ptr (0, 0), mask_line.data (), area.out_area.width);
+        _fastmap_areas.back ().mask = mask;
+    }
+
+    return true;
+}
+
 XCamReturn
 StitcherImpl::init_config (uint32_t count)
 {
@@ -613,6 +845,12 @@ StitcherImpl::init_config (uint32_t count)
             "soft-stitcher:%s init copyer failed, idx:%d.", XCAM_STR (_stitcher->get_name ()), areas[i].in_idx);
     }
 
+    _fused_map = _stitcher->_fused_map && init_fused_map (count);
+    XCAM_LOG_DEBUG ("soft-stitcher:%s fused map %s", XCAM_STR (_stitcher->get_name ()), _fused_map ? "on" : "off");
+
+    _fastmap = _stitcher->_fastmap && init_fastmap (count);
+    _fastmap_active = false;
+
     return XCAM_RETURN_NO_ERROR;
 }
 
@@ -679,6 +917,24 @@ StitcherImpl::start_geomap_works (const SmartPtr<SoftStitcher::StitcherParam> &p
         geomap_params->out_buf = out_buf;
         geomap_params->stitch_param = param;
 
+        if (_fused_map) {
+            geomap_params->areas = _fisheye[i].overlap_areas;
+            if (_stitcher->complete_stitch ()) {
+                for (Copiers::iterator i_copy = _copiers.begin (); i_copy != _copiers.end (); ++i_copy) {
+                    const Stitcher::CopyArea &copy_area = i_copy->copy_area;
+                    if (copy_area.in_idx != i)
+                        continue;
+
+                    SoftGeoMapper::MapArea area;
+                    area.area = copy_area.in_area;
+                    area.out_buf = param->out_buf;
+                    area.out_x = copy_area.out_area.pos_x;
+                    area.out_y = copy_area.out_area.pos_y;
+                    geomap_params->areas.push_back (area);
+                }
+            }
+        }
+
         init_geomap_factors (i);
         XCamReturn ret = _fisheye[i].mapper->execute_buffer (geomap_params, false);
         XCAM_FAIL_RETURN (
@@ -689,6 +945,106 @@ StitcherImpl::start_geomap_works (const SmartPtr<SoftStitcher::StitcherParam> &p
     return XCAM_RETURN_NO_ERROR;
 }
 
+XCamReturn
+StitcherImpl::activate_fastmap ()
+{
+    if (!_fastmap || _fastmap_active)
+        return XCAM_RETURN_NO_ERROR;
+
+    // geomap factors are final, take the last feature match result then dump coordinates
+    uint32_t camera_num = _stitcher->get_camera_num ();
+    for (uint32_t i = 0; i < camera_num; ++i) {
+        init_geomap_factors (i);
+        _fastmap_coords[i] = _fisheye[i].mapper->dump_coords ();
+        if (!_fastmap_coords[i].ptr ()) {
+            XCAM_LOG_WARNING (
+                "soft-stitcher:%s dump fastmap coordinates failed, idx:%d, fastmap disabled",
+                XCAM_STR (_stitcher->get_name ()), i);
+            _fastmap = false;
+            return XCAM_RETURN_ERROR_MEM;
+        }
+    }
+
+    _fastmap_active = true;
+    XCAM_LOG_DEBUG ("soft-stitcher:%s fastmap activated", XCAM_STR (_stitcher->get_name ()));
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+FastMapArea::start_fastmap_task (
+    const SmartPtr<SoftStitcher::StitcherParam> &param,
+    const uint32_t idx, const SmartPtr<Float2Image> *coords)
+{
+    XCAM_ASSERT (task.ptr ());
+
+    SmartPtr<VideoBuffer> out_buf = param->out_buf;
+    const VideoBufferInfo &out_info = out_buf->get_video_info ();
+    uint32_t format = out_info.format;
+
+    SmartPtr<StitcherFastMapArgs> args = make_smart<StitcherFastMapArgs> (idx, param);
+    for (uint32_t k = 0; k < 2 && in_idx[k] != INVALID_INDEX; ++k) {
+        const SmartPtr<VideoBuffer> &in_buf = param->in_bufs[in_idx[k]];
+        XCAM_ASSERT (in_buf.ptr () && in_buf->get_format () == format);
+
+        args->in_luma[k] = make_smart<UcharImage> (in_buf, 0);
+        if (V4L2_PIX_FMT_NV12 == format) {
+            args->in_uv[k] = make_smart<Uchar2Image> (in_buf, 1);
+        } else if (V4L2_PIX_FMT_YUV420 == format) {
+            args->in_u[k] = make_smart<UcharImage> (in_buf, 1);
+            args->in_v[k] = make_smart<UcharImage> (in_buf, 2);
+        }
+        args->coords[k] = coords[in_idx[k]];
+        args->coords_x[k] = in_area[k].pos_x;
+        args->coords_y[k] = in_area[k].pos_y;
+    }
+    args->mask = mask;
+
+    args->out_luma = make_smart<UcharImage> (
+        out_buf, out_area.width, out_area.height, out_info.strides[0],
+        out_info.offsets[0] + out_area.pos_x + out_area.pos_y * out_info.strides[0]);
+    if (V4L2_PIX_FMT_NV12 == format) {
+        args->out_uv = make_smart<Uchar2Image> (
+            out_buf, out_area.width / 2, out_area.height / 2, out_info.strides[1],
+            out_info.offsets[1] + out_area.pos_x + out_area.pos_y / 2 * out_info.strides[1]);
+    } else if (V4L2_PIX_FMT_YUV420 == format) {
+        args->out_u = make_smart<UcharImage> (
+            out_buf, out_area.width / 2, out_area.height / 2, out_info.strides[1],
+            out_info.offsets[1] + out_area.pos_x / 2 + out_area.pos_y / 2 * out_info.strides[1]);
+        args->out_v = make_smart<UcharImage> (
+            out_buf, out_area.width / 2, out_area.height / 2, out_info.strides[2],
+            out_info.offsets[2] + out_area.pos_x / 2 + out_area.pos_y / 2 * out_info.strides[2]);
+    } else {
+        XCAM_LOG_ERROR ("fastmap_task buffer pixel format:%d unsupported!", format);
+        return XCAM_RETURN_ERROR_PARAM;
+    }
+
+    uint32_t thread_x = 1, thread_y = 16;
+    WorkSize global_size (out_area.width / 8, out_area.height / 2);
+    WorkSize local_size (
+        xcam_ceil (global_size.value[0], thread_x) / thread_x,
+        xcam_ceil (global_size.value[1], thread_y) / thread_y);
+
+    task->set_local_size (local_size);
+    task->set_global_size (global_size);
+
+    return task->work (args);
+}
+
+XCamReturn
+StitcherImpl::start_fastmap_works (const SmartPtr<SoftStitcher::StitcherParam> &param)
+{
+    XCAM_ASSERT (_fastmap_active);
+
+    for (uint32_t i = 0; i < _fastmap_areas.size (); ++i) {
+        XCamReturn ret = _fastmap_areas[i].start_fastmap_task (param, i, _fastmap_coords);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret), ret,
+            "soft-stitcher:%s start fastmap task failed, area:%d", XCAM_STR (_stitcher->get_name ()), i);
+    }
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
 SmartPtr<BlenderParam>
 Overlap::find_blender_param_in_map (
     const SmartPtr<SoftStitcher::StitcherParam> &key,
@@ -838,33 +1194,33 @@ Copier::start_copy_task (
     const VideoBufferInfo &in_info = in_buf->get_video_info ();
     const VideoBufferInfo &out_info = out_buf->get_video_info ();
 
-    SmartPtr<StitcherCopyArgs> args = new StitcherCopyArgs (idx, param);
-    args->in_luma = new UcharImage (
+    SmartPtr<StitcherCopyArgs> args = make_smart<StitcherCopyArgs> (idx, param);
+    args->in_luma = make_smart<UcharImage> (
         in_buf, copy_area.in_area.width, copy_area.in_area.height, in_info.strides[0],
         in_info.offsets[0] + copy_area.in_area.pos_x + copy_area.in_area.pos_y * in_info.strides[0]);
 
-    args->out_luma = new UcharImage (
+    args->out_luma = make_smart<UcharImage> (
         out_buf, copy_area.out_area.width, copy_area.out_area.height, out_info.strides[0],
         out_info.offsets[0] + copy_area.out_area.pos_x + copy_area.out_area.pos_y * out_info.strides[0]);
 
     if ((V4L2_PIX_FMT_NV12 == in_info.format) && (V4L2_PIX_FMT_NV12 == out_info.format)) {
-        args->in_uv = new Uchar2Image (
+        args->in_uv = make_smart<Uchar2Image> (
             in_buf, copy_area.in_area.width / 2, copy_area.in_area.height / 2, in_info.strides[1],
             in_info.offsets[1] + copy_area.in_area.pos_x + copy_area.in_area.pos_y / 2 * in_info.strides[1]);
-        args->out_uv = new Uchar2Image (
+        args->out_uv = make_smart<Uchar2Image> (
             out_buf, copy_area.out_area.width / 2, copy_area.out_area.height / 2, out_info.strides[1],
             out_info.offsets[1] + copy_area.out_area.pos_x + copy_area.out_area.pos_y / 2 * out_info.strides[1]);
     } else if ((V4L2_PIX_FMT_YUV420 == in_info.format) && (V4L2_PIX_FMT_YUV420 == out_info.format)) {
-        args->in_u = new UcharImage (
+        args->in_u = make_smart<UcharImage> (
             in_buf, copy_area.in_area.width / 2, copy_area.in_area.height / 2, in_info.strides[1],
             in_info.offsets[1] + copy_area.in_area.pos_x / 2 + copy_area.in_area.pos_y / 2 * in_info.strides[1]);
-        args->in_v = new UcharImage (
+        args->in_v = make_smart<UcharImage> (
             in_buf, copy_area.in_area.width / 2, copy_area.in_area.height / 2, in_info.strides[2],
             in_info.offsets[2] + copy_area.in_area.pos_x / 2 + copy_area.in_area.pos_y / 2 * in_info.strides[2]);
-        args->out_u = new UcharImage (
+        args->out_u = make_smart<UcharImage> (
             out_buf, copy_area.out_area.width / 2, copy_area.out_area.height / 2, out_info.strides[1],
             out_info.offsets[1] + copy_area.out_area.pos_x / 2 + copy_area.out_area.pos_y / 2 * out_info.strides[1]);
-        args->out_v = new UcharImage (
+        args->out_v = make_smart<UcharImage> (
             out_buf, copy_area.out_area.width / 2, copy_area.out_area.height / 2, out_info.strides[2],
             out_info.offsets[2] + copy_area.out_area.pos_x / 2 + copy_area.out_area.pos_y / 2 * out_info.strides[2]);
     } else {
@@ -928,6 +1284,13 @@ StitcherImpl::stop ()
         }
     }
 
+    for (FastMapAreas::iterator i_map = _fastmap_areas.begin (); i_map != _fastmap_areas.end (); ++i_map) {
+        if (i_map->task.ptr ()) {
+            i_map->task->stop ();
+            i_map->task.release ();
+        }
+    }
+
     if (_geomap_pool.ptr ()) {
         _geomap_pool->stop ();
     }
@@ -940,7 +1303,14 @@ StitcherImpl::stop ()
 SoftStitcher::SoftStitcher (const char *name)
     : SoftHandler (name)
     , Stitcher (SOFT_STITCHER_ALIGNMENT_X, SOFT_STITCHER_ALIGNMENT_Y)
+    , _fused_map (true)
+    , _fastmap (false)
+    , _alone_inflight (false)
+    , _geomap_priority (0)
 {
+    for (uint32_t i = 0; i < XCAM_STITCH_MAX_CAMERAS; ++i)
+        _numa_nodes[i] = -1;
+
     SmartPtr<SoftStitcherPriv::StitcherImpl> impl = new SoftStitcherPriv::StitcherImpl (this);
     XCAM_ASSERT (impl.ptr ());
     _impl = impl;
@@ -958,23 +1328,31 @@ SoftStitcher::~SoftStitcher ()
     terminate ();
 }
 
-XCamReturn
-SoftStitcher::stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuffer> &out_buf)
+bool
+SoftStitcher::set_camera_numa_node (uint32_t idx, int32_t node)
 {
     XCAM_FAIL_RETURN (
-        ERROR, !in_bufs.empty (), XCAM_RETURN_ERROR_PARAM,
-        "soft-stitcher:%s stitch buffer failed, in_bufs is empty", XCAM_STR (get_name ()));
+        ERROR, idx < XCAM_STITCH_MAX_CAMERAS, false,
+        "soft_stitcher:%s set numa node failed, camera index(%d) out of range", XCAM_STR (get_name ()), idx);
+    XCAM_FAIL_RETURN (
+        ERROR, node < (int32_t) NumaTopology::get_node_count (), false,
+        "soft_stitcher:%s set numa node failed, node(%d) not found", XCAM_STR (get_name ()), node);
 
-    ensure_stitch_path ();
+    _numa_nodes[idx] = node;
+    return true;
+}
 
-    SmartPtr<StitcherParam> param = new StitcherParam;
+SmartPtr<SoftStitcher::StitcherParam>
+SoftStitcher::create_param (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_TRACE_BEGIN_FRAME ();
+    SmartPtr<StitcherParam> param = make_smart<StitcherParam> ();
     param->out_buf = out_buf;
 
     uint32_t count = 0;
     for (VideoBufferList::const_iterator i = in_bufs.begin (); i != in_bufs.end (); ++i) {
-        SmartPtr<VideoBuffer> buf = *i;
-        XCAM_ASSERT (buf.ptr ());
-        param->in_bufs[count++] = buf;
+        XCAM_ASSERT ((*i).ptr ());
+        param->in_bufs[count++] = *i;
     }
 
     uint32_t format = param->in_bufs[0]->get_format ();
@@ -986,6 +1364,19 @@ SoftStitcher::stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuff
         }
     }
 
+    return param;
+}
+
+XCamReturn
+SoftStitcher::stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !in_bufs.empty (), XCAM_RETURN_ERROR_PARAM,
+        "soft-stitcher:%s stitch buffer failed, in_bufs is empty", XCAM_STR (get_name ()));
+
+    ensure_stitch_path ();
+
+    SmartPtr<StitcherParam> param = create_param (in_bufs, out_buf);
     XCamReturn ret = execute_buffer (param, true);
 
     if (!out_buf.ptr () && xcam_ret_is_ok (ret)) {
@@ -995,10 +1386,66 @@ SoftStitcher::stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuff
     return ret;
 }
 
+XCamReturn
+SoftStitcher::submit_buffers (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !in_bufs.empty (), XCAM_RETURN_ERROR_PARAM,
+        "soft-stitcher:%s submit buffers failed, in_bufs is empty", XCAM_STR (get_name ()));
+    XCAM_FAIL_RETURN (
+        ERROR, _inflight_params.size () < get_inflight_frames (), XCAM_RETURN_ERROR_ORDER,
+        "soft-stitcher:%s submit buffers failed, %d frames in flight, fetch buffer first",
+        XCAM_STR (get_name ()), (int)_inflight_params.size ());
+
+    ensure_stitch_path ();
+
+    // first frame configures all handlers and feature match updates geomap factors of the next frame,
+    // such frames run alone, errors of waited frames are returned in fetch_buffer
+    bool run_alone = _need_configure || need_feature_match ();
+    if (run_alone || _alone_inflight) {
+        for (std::list<SmartPtr<StitcherParam>>::iterator i = _inflight_params.begin ();
+                i != _inflight_params.end (); ++i) {
+            sync_param (*i);
+        }
+    }
+    _alone_inflight = run_alone;
+
+    SmartPtr<StitcherParam> param = create_param (in_bufs, out_buf);
+    XCamReturn ret = execute_buffer (param, false);
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "soft-stitcher:%s submit buffers failed in execution", XCAM_STR (get_name ()));
+
+    _inflight_params.push_back (std::move (param));
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+SoftStitcher::fetch_buffer (SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !_inflight_params.empty (), XCAM_RETURN_ERROR_ORDER,
+        "soft-stitcher:%s fetch buffer failed, no frame in flight", XCAM_STR (get_name ()));
+
+    SmartPtr<StitcherParam> param = std::move (_inflight_params.front ());
+    _inflight_params.pop_front ();
+
+    XCAM_TRACE_SCOPE ("stitcher", "fetch wait");
+
+    XCamReturn ret = sync_param (param);
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "soft-stitcher:%s fetch buffer failed, frame stitching broken", XCAM_STR (get_name ()));
+
+    out_buf = param->out_buf;
+    return XCAM_RETURN_NO_ERROR;
+}
+
 XCamReturn
 SoftStitcher::terminate ()
 {
     _impl->stop ();
+    _inflight_params.clear ();
     return SoftHandler::terminate ();
 }
 
@@ -1020,7 +1467,9 @@ SoftStitcher::start_task_count (const SmartPtr<SoftStitcher::StitcherParam> &par
     }
 
     int32_t count = get_camera_num ();
-    if (complete_stitch ()) {
+    if (_impl->is_fastmap_active ()) {
+        count = _impl->_fastmap_areas.size ();
+    } else if (complete_stitch () && !_impl->is_fused_map ()) {
         count += get_copy_area ().size ();
     }
 
@@ -1055,6 +1504,9 @@ SoftStitcher::geomap_done (
     }
 
     if (complete_stitch ()) {
+        if (_impl->is_fused_map ())
+            return;
+
         ret = _impl->start_copy_tasks (param, geomap_param->idx, geomap_param->out_buf);
         if (!xcam_ret_is_ok (ret)) {
             work_broken (param, ret);
@@ -1095,6 +1547,31 @@ SoftStitcher::blender_done (
     }
 }
 
+void
+SoftStitcher::fastmap_task_done (
+    const SmartPtr<Worker> &worker,
+    const SmartPtr<Worker::Arguments> &base,
+    const XCamReturn error)
+{
+    XCAM_UNUSED (worker);
+    XCAM_ASSERT (worker.ptr ());
+    SmartPtr<SoftStitcherPriv::StitcherFastMapArgs> args = base.dynamic_cast_ptr<SoftStitcherPriv::StitcherFastMapArgs> ();
+    XCAM_ASSERT (args.ptr ());
+    const SmartPtr<SoftStitcher::StitcherParam> param =
+        args->get_param ().dynamic_cast_ptr<SoftStitcher::StitcherParam> ();
+    XCAM_ASSERT (param.ptr ());
+
+    if (!check_work_continue (param, error)) {
+        _impl->remove_task_count (param);
+        return;
+    }
+    XCAM_LOG_DEBUG ("soft-stitcher:%s fastmap area:%d done", XCAM_STR (get_name ()), args->idx);
+
+    if (_impl->dec_task_count (param) == 0) {
+        work_well_done (param, error);
+    }
+}
+
 void
 SoftStitcher::copy_task_done (
     const SmartPtr<Worker> &worker,
@@ -1193,11 +1670,22 @@ SoftStitcher::start_work (const SmartPtr<Parameters> &base)
         "soft_stitcher:%s start_work failed, params or in_bufs are empty",
         XCAM_STR (get_name ()));
 
+    if (complete_stitch () && !need_feature_match ())
+        _impl->activate_fastmap ();
+
     XCamReturn ret = start_task_count (param);
     XCAM_FAIL_RETURN (
         ERROR, xcam_ret_is_ok (ret), XCAM_RETURN_ERROR_PARAM,
         "soft_stitcher:%s start blender count failed", XCAM_STR (get_name ()));
 
+    if (_impl->is_fastmap_active ()) {
+        ret = _impl->start_fastmap_works (param);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret), XCAM_RETURN_ERROR_PARAM,
+            "soft_stitcher:%s start fastmap works failed", XCAM_STR (get_name ()));
+        return ret;
+    }
+
     ret = _impl->start_geomap_works (param);
     XCAM_FAIL_RETURN (
         ERROR, xcam_ret_is_ok (ret), XCAM_RETURN_ERROR_PARAM,
@@ -24,6 +24,7 @@
 #include <xcam_std.h>
 #include <interface/stitcher.h>
 #include <soft/soft_handler.h>
+#include <list>
 
 namespace XCam {
 
@@ -32,6 +33,7 @@ class StitcherImpl;
 class CbGeoMap;
 class CbBlender;
 class CbCopyTask;
+class CbFastMapTask;
 };
 
 class SoftStitcher
@@ -42,6 +44,7 @@ class SoftStitcher
     friend class SoftStitcherPriv::CbGeoMap;
     friend class SoftStitcherPriv::CbBlender;
     friend class SoftStitcherPriv::CbCopyTask;
+    friend class SoftStitcherPriv::CbFastMapTask;
 
 public:
     struct StitcherParam
@@ -61,15 +64,42 @@ public:
     //derived from SoftHandler
     virtual XCamReturn terminate ();
 
+    // remap non-overlap areas into output buffer directly instead of copying them from geomap buffers,
+    // enabled by default, falls back to copy if areas are not aligned to geomap work unit
+    void set_fused_map (bool enable) {
+        _fused_map = enable;
+    }
+
+    // once feature match is done, replace geomap and blender with one pass over precomputed
+    // coordinates and single level mask blend, disabled by default.
+    // falls back to normal path if stitching areas are not aligned to 8x2
+    void set_fastmap (bool enable) {
+        _fastmap = enable;
+    }
+
+    // run geomap of camera @idx on threads pinned to numa @node, shared by cameras on that node,
+    // and place its geomap buffers on the node, -1 to use shared threads and default placement,
+    // set before configure
+    bool set_camera_numa_node (uint32_t idx, int32_t node);
+    // run geomap threads pinned to numa nodes with SCHED_FIFO @priority, 0 keeps default, set before configure
+    void set_geomap_fifo_priority (int32_t priority) {
+        _geomap_priority = priority;
+    }
+
 protected:
     // interface derive from Stitcher
     XCamReturn stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuffer> &out_buf);
+    // stages of consecutive frames overlap, intermediate buffers are taken from pools per frame
+    XCamReturn submit_buffers (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf);
+    XCamReturn fetch_buffer (SmartPtr<VideoBuffer> &out_buf);
 
     //derived from SoftHandler
     XCamReturn configure_resource (const SmartPtr<Parameters> &param);
     XCamReturn start_work (const SmartPtr<Parameters> &param);
 
 private:
+    SmartPtr<StitcherParam> create_param (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf);
+
     // handler done, call back functions
     XCamReturn start_task_count (
         const SmartPtr<SoftStitcher::StitcherParam> &param);
@@ -82,9 +112,18 @@ private:
     void copy_task_done (
         const SmartPtr<Worker> &worker,
         const SmartPtr<Worker::Arguments> &base, const XCamReturn error);
+    void fastmap_task_done (
+        const SmartPtr<Worker> &worker,
+        const SmartPtr<Worker::Arguments> &base, const XCamReturn error);
 
 private:
     SmartPtr<SoftStitcherPriv::StitcherImpl> _impl;
+    bool                                     _fused_map;
+    bool                                     _fastmap;
+    std::list<SmartPtr<StitcherParam>>       _inflight_params;
+    bool                                     _alone_inflight;
+    int32_t                                  _numa_nodes[XCAM_STITCH_MAX_CAMERAS];
+    int32_t                                  _geomap_priority;
 };
 
 }
@@ -19,14 +19,125 @@
  */
 
 #include "soft_video_buf_allocator.h"
+#include <xcam_mutex.h>
+#include <xcam_numa.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+#define XCAM_SOFT_BUF_ALIGN 64
+#define XCAM_SOFT_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+// buffers smaller than half of huge page take aligned heap memory
+#define XCAM_SOFT_ARENA_MIN_SIZE (XCAM_SOFT_HUGE_PAGE_SIZE / 2)
+// free blocks beyond this size are returned to system
+#define XCAM_SOFT_ARENA_MAX_CACHED (512 * 1024 * 1024)
 
 namespace XCam {
 
+static bool soft_buf_arena_mode = false;
+
+// blocks are multiples of huge page size, mapped with MAP_HUGETLB if huge pages are reserved,
+// otherwise advised to transparent huge pages. released blocks are cached by size and reused
+// by any arena allocator.
+class SoftBufArena
+{
+public:
+    static SoftBufArena &instance ();
+
+    uint8_t *alloc (size_t &size);
+    void release (uint8_t *ptr, size_t size);
+
+private:
+    explicit SoftBufArena ()
+        : _cached_size (0)
+        , _hugetlb (true)
+    {}
+    uint8_t *map_block (size_t size);
+
+private:
+    Mutex                            _mutex;
+    std::multimap<size_t, uint8_t *> _free_blocks;
+    size_t                           _cached_size;
+    bool                             _hugetlb;
+};
+
+SoftBufArena &
+SoftBufArena::instance ()
+{
+    // never destroyed, buffers may outlive static objects
+    static SoftBufArena *arena = new SoftBufArena;
+    return *arena;
+}
+
+uint8_t *
+SoftBufArena::map_block (size_t size)
+{
+    void *ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (_hugetlb) {
+        ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr == MAP_FAILED) {
+            XCAM_LOG_INFO ("soft buf arena: no reserved huge pages, fall back to transparent huge pages");
+            _hugetlb = false;
+        }
+    }
+#endif
+    if (ptr == MAP_FAILED) {
+        ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        XCAM_FAIL_RETURN (
+            ERROR, ptr != MAP_FAILED, NULL,
+            "soft buf arena: map block failed, size:%zu", size);
+#ifdef MADV_HUGEPAGE
+        madvise (ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+    return (uint8_t *)ptr;
+}
+
+uint8_t *
+SoftBufArena::alloc (size_t &size)
+{
+    size = XCAM_ALIGN_UP (size, XCAM_SOFT_HUGE_PAGE_SIZE);
+
+    SmartLock locker (_mutex);
+    std::multimap<size_t, uint8_t *>::iterator i = _free_blocks.find (size);
+    if (i != _free_blocks.end ()) {
+        uint8_t *ptr = i->second;
+        _free_blocks.erase (i);
+        _cached_size -= size;
+        return ptr;
+    }
+    return map_block (size);
+}
+
+void
+SoftBufArena::release (uint8_t *ptr, size_t size)
+{
+    XCAM_ASSERT (ptr && size);
+
+    SmartLock locker (_mutex);
+    if (_cached_size + size > XCAM_SOFT_ARENA_MAX_CACHED) {
+        munmap (ptr, size);
+        return;
+    }
+    _free_blocks.insert (std::make_pair (size, ptr));
+    _cached_size += size;
+}
+
 class VideoMemData
     : public BufferData
 {
 public:
-    explicit VideoMemData (uint32_t size);
+    explicit VideoMemData (uint32_t size, bool arena = false);
     virtual ~VideoMemData ();
     bool is_valid () const {
         return (_mem_ptr ? true : false);
@@ -38,22 +149,38 @@ public:
 
 private:
     uint8_t    *_mem_ptr;
-    uint32_t    _mem_size;
+    size_t      _mem_size;
+    bool        _arena;
 };
 
-VideoMemData::VideoMemData (uint32_t size)
+VideoMemData::VideoMemData (uint32_t size, bool arena)
     : _mem_ptr (NULL)
     , _mem_size (0)
+    , _arena (false)
 {
     XCAM_ASSERT (size > 0);
-    _mem_ptr = xcam_malloc_type_array (uint8_t, size);
-    if (_mem_ptr)
+    if (arena && size >= XCAM_SOFT_ARENA_MIN_SIZE) {
+        size_t block_size = size;
+        _mem_ptr = SoftBufArena::instance ().alloc (block_size);
+        if (_mem_ptr) {
+            _mem_size = block_size;
+            _arena = true;
+        }
+    } else if (arena) {
+        _mem_ptr = (uint8_t *)xcam_malloc_aligned (size, XCAM_SOFT_BUF_ALIGN);
+    } else {
+        _mem_ptr = xcam_malloc_type_array (uint8_t, size);
+    }
+    if (_mem_ptr && !_arena)
         _mem_size = size;
 }
 
 VideoMemData::~VideoMemData ()
 {
-    xcam_free (_mem_ptr);
+    if (_arena)
+        SoftBufArena::instance ().release (_mem_ptr, _mem_size);
+    else
+        xcam_free (_mem_ptr);
 }
 
 uint8_t *
@@ -69,11 +196,116 @@ VideoMemData::unmap ()
     return true;
 }
 
+// size is sealed once mapped, importers of the fd can rely on it
+class VideoMemfdData
+    : public BufferData
+{
+public:
+    explicit VideoMemfdData (uint32_t size);
+    virtual ~VideoMemfdData ();
+    bool is_valid () const {
+        return (_mem_ptr ? true : false);
+    }
+
+    //derive from BufferData
+    virtual uint8_t *map ();
+    virtual bool unmap ();
+    virtual int get_fd ();
+
+private:
+    uint8_t    *_mem_ptr;
+    size_t      _mem_size;
+    int         _fd;
+};
+
+static int
+create_memfd (const char *name, unsigned int flags)
+{
+#ifdef SYS_memfd_create
+    return (int) syscall (SYS_memfd_create, name, flags);
+#else
+    XCAM_UNUSED (name);
+    XCAM_UNUSED (flags);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+VideoMemfdData::VideoMemfdData (uint32_t size)
+    : _mem_ptr (NULL)
+    , _mem_size (0)
+    , _fd (-1)
+{
+    XCAM_ASSERT (size > 0);
+    size_t mem_size = XCAM_ALIGN_UP (size, (size_t) sysconf (_SC_PAGESIZE));
+
+    int fd = create_memfd ("xcam-soft-buf", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        XCAM_LOG_ERROR ("VideoMemfdData create memfd failed, %s", strerror (errno));
+        return;
+    }
+
+    if (ftruncate (fd, mem_size) < 0) {
+        XCAM_LOG_ERROR ("VideoMemfdData resize memfd to %zu failed, %s", mem_size, strerror (errno));
+        close (fd);
+        return;
+    }
+
+#ifdef F_ADD_SEALS
+    if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+        XCAM_LOG_WARNING ("VideoMemfdData seal memfd failed, %s", strerror (errno));
+#endif
+
+    void *ptr = mmap (NULL, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        XCAM_LOG_ERROR ("VideoMemfdData map memfd failed, size:%zu, %s", mem_size, strerror (errno));
+        close (fd);
+        return;
+    }
+
+    _mem_ptr = (uint8_t *)ptr;
+    _mem_size = mem_size;
+    _fd = fd;
+}
+
+VideoMemfdData::~VideoMemfdData ()
+{
+    if (_mem_ptr)
+        munmap (_mem_ptr, _mem_size);
+    if (_fd >= 0)
+        close (_fd);
+}
+
+uint8_t *
+VideoMemfdData::map ()
+{
+    XCAM_ASSERT (_mem_ptr);
+    return _mem_ptr;
+}
+
+bool
+VideoMemfdData::unmap ()
+{
+    return true;
+}
+
+int
+VideoMemfdData::get_fd ()
+{
+    return _fd;
+}
+
 SoftVideoBufAllocator::SoftVideoBufAllocator ()
+    : _arena (soft_buf_arena_mode)
+    , _memfd (false)
+    , _numa_node (-1)
 {
 }
 
 SoftVideoBufAllocator::SoftVideoBufAllocator (const VideoBufferInfo &info)
+    : _arena (soft_buf_arena_mode)
+    , _memfd (false)
+    , _numa_node (-1)
 {
     set_video_info (info);
 }
@@ -82,6 +314,62 @@ SoftVideoBufAllocator::~SoftVideoBufAllocator ()
 {
 }
 
+void
+SoftVideoBufAllocator::set_arena_mode (bool enable)
+{
+    soft_buf_arena_mode = enable;
+}
+
+bool
+SoftVideoBufAllocator::get_arena_mode ()
+{
+    return soft_buf_arena_mode;
+}
+
+bool
+SoftVideoBufAllocator::fixate_video_info (VideoBufferInfo &info)
+{
+    if (!_arena)
+        return true;
+
+    // chroma planes of planar formats have half pitch, double the alignment for them
+    uint32_t align = XCAM_SOFT_BUF_ALIGN;
+    for (uint32_t i = 0; i < info.components; ++i) {
+        if (info.strides[i] < info.aligned_width) {
+            align = XCAM_SOFT_BUF_ALIGN * 2;
+            break;
+        }
+    }
+
+    uint32_t aligned_width = XCAM_ALIGN_UP (info.aligned_width, align);
+    if (aligned_width == info.aligned_width)
+        return true;
+
+    VideoBufferInfo new_info;
+    XCAM_FAIL_RETURN (
+        ERROR,
+        new_info.init (info.format, info.width, info.height, aligned_width, info.aligned_height),
+        false,
+        "SoftVideoBufAllocator align pitch failed, format:%s, aligned_width:%d",
+        xcam_fourcc_to_string (info.format), aligned_width);
+    info = new_info;
+    return true;
+}
+
+static void
+place_on_node (const SmartPtr<BufferData> &data, uint32_t size, int32_t node)
+{
+    if (node < 0)
+        return;
+
+    uint8_t *ptr = data->map ();
+    XCAM_ASSERT (ptr);
+    NumaTopology::bind_memory (ptr, size, (uint32_t) node);
+    // first touch faults pages in by policy above, or near allocating thread if binding failed
+    memset (ptr, 0, size);
+    data->unmap ();
+}
+
 SmartPtr<BufferData>
 SoftVideoBufAllocator::allocate_data (const VideoBufferInfo &buffer_info, const void* in_data)
 {
@@ -90,10 +378,20 @@ SoftVideoBufAllocator::allocate_data (const VideoBufferInfo &buffer_info, const
         ERROR, buffer_info.size, NULL,
         "SoftVideoBufAllocator allocate data failed. buf_size is zero");
 
-    SmartPtr<VideoMemData> data = new VideoMemData (buffer_info.size);
+    if (_memfd) {
+        SmartPtr<VideoMemfdData> data = new VideoMemfdData (buffer_info.size);
+        XCAM_FAIL_RETURN (
+            ERROR, data.ptr () && data->is_valid (), NULL,
+            "SoftVideoBufAllocator allocate memfd data failed. buf_size:%d", buffer_info.size);
+        place_on_node (data, buffer_info.size, _numa_node);
+        return data;
+    }
+
+    SmartPtr<VideoMemData> data = new VideoMemData (buffer_info.size, _arena);
     XCAM_FAIL_RETURN (
         ERROR, data.ptr () && data->is_valid (), NULL,
         "SoftVideoBufAllocator allocate data failed. buf_size:%d", buffer_info.size);
+    place_on_node (data, buffer_info.size, _numa_node);
 
     return data;
 }
@@ -34,9 +34,45 @@ public:
     explicit SoftVideoBufAllocator (const VideoBufferInfo &info);
     virtual ~SoftVideoBufAllocator ();
 
+    // process-wide, applies to allocators created afterwards, default false
+    // arena buffers have 64-byte aligned pitches and take memory from huge-page backed blocks
+    // which are shared and reused by all arena allocators
+    static void set_arena_mode (bool enable);
+    static bool get_arena_mode ();
+    bool is_arena () const {
+        return _arena;
+    }
+
+    // back buffers with sealed memfd mapped shared, get_fd () of buffers returns the memfd
+    // which can be exported as fd memory without copy, set before reserve, default false
+    void set_memfd (bool enable) {
+        _memfd = enable;
+    }
+    bool is_memfd () const {
+        return _memfd;
+    }
+
+    // place buffers on numa @node and fault all pages in at allocation, so buffers are not
+    // spread by whichever thread touches them first, -1 to leave placement to kernel, set before reserve
+    void set_numa_node (int32_t node) {
+        _numa_node = node;
+    }
+    int32_t get_numa_node () const {
+        return _numa_node;
+    }
+
+protected:
+    //derive from BufferPool
+    virtual bool fixate_video_info (VideoBufferInfo &info);
+
 private:
     //derive from BufferPool
     virtual SmartPtr<BufferData> allocate_data (const VideoBufferInfo &buffer_info, const void* in_data = NULL);
+
+private:
+    bool                  _arena;
+    bool                  _memfd;
+    int32_t               _numa_node;
 };
 
 #if 0
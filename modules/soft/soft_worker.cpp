@@ -20,7 +20,11 @@
 
 #include "soft_worker.h"
 #include "thread_pool.h"
+#include "work_stealing_pool.h"
 #include "xcam_mutex.h"
+#include <time.h>
+
+#define XCAM_SOFT_WORKER_MIN_CHUNK_NS 50000
 
 namespace XCam {
 
@@ -50,6 +54,8 @@ private:
     XCAM_DEAD_COPY (ItemSynch);
 };
 
+// contiguous run of tiles [begin, end) in x-y-z order,
+// sizes are copied so the worker can be resized for the next work while items run
 class WorkItem
     : public ThreadPool::UserData
 {
@@ -57,11 +63,17 @@ public:
     WorkItem (
         const SmartPtr<SoftWorker> &worker,
         const SmartPtr<Worker::Arguments> &args,
-        const WorkSize &item,
+        const WorkSize &global, const WorkSize &local,
+        const WorkSize &items,
+        uint32_t begin, uint32_t end,
         SmartPtr<ItemSynch> &sync)
         : _worker (worker)
         , _args (args)
-        , _item (item)
+        , _global (global)
+        , _local (local)
+        , _items (items)
+        , _begin (begin)
+        , _end (end)
         , _sync (sync)
     {
     }
@@ -72,20 +84,96 @@ public:
 private:
     SmartPtr<SoftWorker>         _worker;
     SmartPtr<Worker::Arguments>  _args;
-    WorkSize                     _item;
+    WorkSize                     _global;
+    WorkSize                     _local;
+    WorkSize                     _items;
+    uint32_t                     _begin;
+    uint32_t                     _end;
     SmartPtr<ItemSynch>          _sync;
 };
 
+// runs all_items_done on a done thread of shared pool, a blocking callback chain can't starve pool threads
+class DoneItem
+    : public ThreadPool::UserData
+{
+public:
+    DoneItem (
+        const SmartPtr<SoftWorker> &worker,
+        const SmartPtr<Worker::Arguments> &args,
+        XCamReturn error)
+        : _worker (worker)
+        , _args (args)
+        , _error (error)
+        , _ran (false)
+    {
+    }
+    virtual XCamReturn run ();
+    virtual void done (XCamReturn err);
+
+private:
+    SmartPtr<SoftWorker>         _worker;
+    SmartPtr<Worker::Arguments>  _args;
+    XCamReturn                   _error;
+    bool                         _ran;
+};
+
+// worker whose callback runs on this thread, it can't wait for its own items in stop
+static thread_local const SoftWorker *tls_done_worker = NULL;
+
+XCamReturn
+DoneItem::run ()
+{
+    _ran = true;
+    if (!_worker->_stopped) {
+        tls_done_worker = _worker.ptr ();
+        _worker->all_items_done (_args, _error);
+        tls_done_worker = NULL;
+    }
+    return XCAM_RETURN_NO_ERROR;
+}
+
+void
+DoneItem::done (XCamReturn err)
+{
+    // dropped by stopping pool, callback still gets the error
+    if (!_ran && !_worker->_stopped)
+        _worker->all_items_done (_args, err);
+    _worker->inflight_done ();
+}
+
+static inline uint64_t
+get_time_ns ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 XCamReturn
 WorkItem::run ()
 {
+    if (_worker->_stopped)
+        return XCAM_RETURN_ERROR_THREAD;
+
     XCamReturn ret = _sync->get_error();
     if (!xcam_ret_is_ok (ret))
         return ret;
 
-    ret = _worker->work_impl (_args, _item);
-    if (!xcam_ret_is_ok (ret))
-        _sync->update_error (ret);
+    XCAM_TRACE_SCOPE ("worker", _worker->get_name ());
+    uint64_t start = _worker->_batch_dispatch ? get_time_ns () : 0;
+
+    const uint32_t plane = _items.value[0] * _items.value[1];
+    for (uint32_t i = _begin; i < _end; ++i) {
+        WorkSize item (i % _items.value[0], (i % plane) / _items.value[0], i / plane);
+        ret = _worker->work_impl (_args, item, _global, _local);
+        if (!xcam_ret_is_ok (ret)) {
+            _sync->update_error (ret);
+            return ret;
+        }
+    }
+
+    if (_worker->_batch_dispatch)
+        _worker->update_tile_cost ((get_time_ns () - start) / (_end - _begin));
 
     return ret;
 }
@@ -97,13 +185,29 @@ WorkItem::done (XCamReturn err)
         XCamReturn ret = _sync->get_error ();
         if (xcam_ret_is_ok (ret))
             ret = err;
-        _worker->all_items_done (_args, ret);
+
+        SmartPtr<WorkStealingPool> pool = _worker->_done_pool;
+        if (pool.ptr ()) {
+            ++_worker->_inflight_items;
+            SmartPtr<DoneItem> item = new DoneItem (_worker, _args, ret);
+            if (!xcam_ret_is_ok (pool->queue_done (item)))
+                item->done (XCAM_RETURN_ERROR_THREAD);
+        } else if (!_worker->_stopped) {
+            _worker->all_items_done (_args, ret);
+        }
     }
+    _worker->inflight_done ();
 }
 
 SoftWorker::SoftWorker (const char *name, const SmartPtr<Callback> &cb)
     : Worker (name, cb)
     , _work_unit (1, 1, 1)
+    , _shared_threads (true)
+    , _use_shared (false)
+    , _batch_dispatch (true)
+    , _stopped (false)
+    , _inflight_items (0)
+    , _tile_cost_ns (0)
 {
 }
 
@@ -127,19 +231,117 @@ SoftWorker::set_work_unit (uint32_t x, uint32_t y, uint32_t z)
 bool
 SoftWorker::set_threads (const SmartPtr<ThreadPool> &threads)
 {
+    SmartLock locker (_threads_mutex);
     XCAM_FAIL_RETURN (
         ERROR, !_threads.ptr (), false,
         "SoftWorker(%s) set threads failed, it's already set before.", XCAM_STR (get_name ()));
     _threads = threads;
+    _use_shared = false;
+    _done_pool.release ();
     return true;
 }
 
 XCamReturn
 SoftWorker::stop ()
 {
-    if (_threads.ptr ()) {
-        _threads->stop ();
+    SmartPtr<ThreadPool> threads;
+    bool use_shared = false;
+    {
+        SmartLock locker (_threads_mutex);
+        threads = _threads;
+        use_shared = _use_shared;
+    }
+
+    if (!threads.ptr ())
+        return XCAM_RETURN_NO_ERROR;
+
+    if (!use_shared) {
+        threads->stop ();
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    // shared pool keeps running for other workers, only drain items of this worker
+    SmartLock locker (_inflight_mutex);
+    _stopped = true;
+    // items queued later are skipped, the last one done restarts the worker
+    if (!_done_pool->is_pool_thread () && tls_done_worker != this) {
+        while (_inflight_items > 0)
+            _inflight_cond.wait (_inflight_mutex);
+    }
+    if (!_inflight_items)
+        _stopped = false;
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+void
+SoftWorker::inflight_done ()
+{
+    SmartLock locker (_inflight_mutex);
+    if (--_inflight_items == 0) {
+        _stopped = false;
+        _inflight_cond.broadcast ();
+    }
+}
+
+void
+SoftWorker::update_tile_cost (uint64_t cost_ns)
+{
+    // moving average, 1/4 weight on the latest sample
+    uint64_t avg = _tile_cost_ns;
+    avg = avg ? (avg * 3 + cost_ns) / 4 : cost_ns;
+    _tile_cost_ns = avg ? avg : 1;
+}
+
+uint32_t
+SoftWorker::get_chunk_count (uint32_t max_items)
+{
+    if (!_batch_dispatch)
+        return max_items;
+
+    XCAM_ASSERT (_threads.ptr ());
+    uint32_t chunks = XCAM_MIN (_threads->get_max_threads (), max_items);
+
+    uint64_t cost = _tile_cost_ns;
+    if (cost) {
+        // keep each chunk long enough to hide the dispatch overhead
+        uint64_t min_tiles = (XCAM_SOFT_WORKER_MIN_CHUNK_NS + cost - 1) / cost;
+        uint64_t max_chunks = (max_items + min_tiles - 1) / min_tiles;
+        if (max_chunks < chunks)
+            chunks = (uint32_t)max_chunks;
     }
+
+    return XCAM_MAX (chunks, 1u);
+}
+
+XCamReturn
+SoftWorker::init_threads (uint32_t max_items)
+{
+    XCamReturn ret = XCAM_RETURN_NO_ERROR;
+
+    if (_shared_threads) {
+        _threads = WorkStealingPool::get_shared_pool ();
+        XCAM_FAIL_RETURN (
+            ERROR, _threads.ptr (), XCAM_RETURN_ERROR_THREAD,
+            "SoftWorker(%s) get shared threads failed", XCAM_STR(get_name()));
+        _done_pool = _threads.dynamic_cast_ptr<WorkStealingPool> ();
+        XCAM_ASSERT (_done_pool.ptr ());
+        _use_shared = true;
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    char thr_name [XCAM_MAX_STR_SIZE];
+    snprintf (thr_name, XCAM_MAX_STR_SIZE, "%s-thrs", XCAM_STR(get_name ()));
+
+    SmartPtr<ThreadPool> threads = new ThreadPool (thr_name);
+    XCAM_ASSERT (threads.ptr ());
+    threads->set_threads (max_items, max_items + 1); //extra thread to process all_items_done
+    ret = threads->start ();
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "SoftWorker(%s) work failed when starting threads", XCAM_STR(get_name()));
+    _threads = threads;
+
     return XCAM_RETURN_NO_ERROR;
 }
 
@@ -148,8 +350,8 @@ SoftWorker::work (const SmartPtr<Worker::Arguments> &args)
 {
     XCamReturn ret = XCAM_RETURN_NO_ERROR;
 
-    const WorkSize &global = get_global_size ();
-    const WorkSize &local = get_local_size ();
+    const WorkSize global = get_global_size ();
+    const WorkSize local = get_local_size ();
 
     XCAM_ASSERT (local.value[0] && local.value[1] && local.value[2]);
     XCAM_ASSERT (global.value[0] && global.value[1] && global.value[2]);
@@ -167,42 +369,47 @@ SoftWorker::work (const SmartPtr<Worker::Arguments> &args)
         "SoftWorker(%s) max item is zero. work failed.", XCAM_STR (get_name ()));
 
     if (max_items == 1) {
-        ret = work_impl (args, WorkSize(0, 0, 0));
+        XCAM_TRACE_SCOPE ("worker", get_name ());
+        ret = work_impl (args, WorkSize(0, 0, 0), global, local);
         status_check (args, ret);
         return ret;
     }
 
-    if (!_threads.ptr ()) {
-        char thr_name [XCAM_MAX_STR_SIZE];
-        snprintf (thr_name, XCAM_MAX_STR_SIZE, "%s-thrs", XCAM_STR(get_name ()));
-
-        SmartPtr<ThreadPool> threads = new ThreadPool (thr_name);
-        XCAM_ASSERT (threads.ptr ());
-        _threads = threads;
-        _threads->set_threads (max_items, max_items + 1); //extra thread to process all_items_done
-        ret = _threads->start ();
+    {
+        // frames in flight may start the same worker from several threads,
+        // init_threads sets _threads, _done_pool and _use_shared together under the lock
+        SmartLock locker (_threads_mutex);
+        if (!_threads.ptr ())
+            ret = init_threads (max_items);
         XCAM_FAIL_RETURN (
             ERROR, xcam_ret_is_ok (ret), ret,
-            "SoftWorker(%s) work failed when starting threads", XCAM_STR(get_name()));
+            "SoftWorker(%s) init threads failed", XCAM_STR(get_name()));
     }
 
-    SmartPtr<ItemSynch> sync = new ItemSynch (max_items);
-    for (uint32_t z = 0; z < items.value[2]; ++z)
-        for (uint32_t y = 0; y < items.value[1]; ++y)
-            for (uint32_t x = 0; x < items.value[0]; ++x)
-            {
-                SmartPtr<WorkItem> item = new WorkItem (this, args, WorkSize(x, y, z), sync);
-                ret = _threads->queue (item);
-                if (!xcam_ret_is_ok (ret)) {
-                    //consider half queued but half failed
-                    sync->update_error (ret);
-                    //status_check (args, ret); // need it here?
-                    XCAM_LOG_ERROR (
-                        "SoftWorker(%s) queue work item(x:%d y: %d z:%d) failed",
-                        XCAM_STR(get_name()), x, y, z);
-                    return ret;
-                }
-            }
+    XCAM_FAIL_RETURN (
+        ERROR, !_stopped, XCAM_RETURN_ERROR_THREAD,
+        "SoftWorker(%s) work failed, worker already stopped", XCAM_STR(get_name()));
+
+    uint32_t chunks = get_chunk_count (max_items);
+    SmartPtr<ItemSynch> sync = new ItemSynch (chunks);
+    for (uint32_t i = 0; i < chunks; ++i) {
+        // spread remainder over the first chunks
+        uint32_t begin = (uint32_t)((uint64_t)max_items * i / chunks);
+        uint32_t end = (uint32_t)((uint64_t)max_items * (i + 1) / chunks);
+        SmartPtr<WorkItem> item = new WorkItem (this, args, global, local, items, begin, end, sync);
+        ++_inflight_items;
+        ret = _threads->queue (item);
+        if (!xcam_ret_is_ok (ret)) {
+            inflight_done ();
+            //consider half queued but half failed
+            sync->update_error (ret);
+            //status_check (args, ret); // need it here?
+            XCAM_LOG_ERROR (
+                "SoftWorker(%s) queue work items(%d-%d) failed",
+                XCAM_STR(get_name()), begin, end);
+            return ret;
+        }
+    }
 
     return XCAM_RETURN_NO_ERROR;
 }
@@ -214,12 +421,9 @@ SoftWorker::all_items_done (const SmartPtr<Arguments> &args, XCamReturn error)
 }
 
 WorkRange
-SoftWorker::get_range (const WorkSize &item)
+SoftWorker::get_range (const WorkSize &item, const WorkSize &global, const WorkSize &local)
 {
     WorkRange range;
-    const WorkSize &global = get_global_size ();
-    const WorkSize &local = get_local_size ();
-
     for (uint32_t i = 0; i < WORK_MAX_DIM; ++i) {
         range.pos[i] = item.value[i] * local.value[i];
         XCAM_ASSERT (range.pos[i] < global.value[i]);
@@ -232,9 +436,10 @@ SoftWorker::get_range (const WorkSize &item)
 }
 
 XCamReturn
-SoftWorker::work_impl (const SmartPtr<Arguments> &args, const WorkSize &item)
+SoftWorker::work_impl (
+    const SmartPtr<Arguments> &args, const WorkSize &item, const WorkSize &global, const WorkSize &local)
 {
-    WorkRange range = get_range (item);
+    WorkRange range = get_range (item, global, local);
     return work_range (args, range);
 }
 
@@ -23,10 +23,12 @@
 
 #include <xcam_std.h>
 #include <worker.h>
+#include <xcam_mutex.h>
 
 namespace XCam {
 
 class ThreadPool;
+class WorkStealingPool;
 
 struct WorkRange {
     uint32_t pos[WORK_MAX_DIM];
@@ -43,6 +45,7 @@ class SoftWorker
     : public Worker
 {
     friend class WorkItem;
+    friend class DoneItem;
 
 public:
     explicit SoftWorker (const char *name, const SmartPtr<Callback> &cb = NULL);
@@ -54,25 +57,56 @@ public:
     }
 
     bool set_threads (const SmartPtr<ThreadPool> &threads);
+    // use process-wide work stealing pool if no threads set, enabled by default
+    void set_shared_threads (bool enable) {
+        _shared_threads = enable;
+    }
+    // split work into about one contiguous chunk per thread instead of one item per tile,
+    // chunk size tuned by measured tile cost, enabled by default
+    void set_batch_dispatch (bool enable) {
+        _batch_dispatch = enable;
+    }
+
+    // run @range (in work units) in caller thread, no callback is triggered
+    XCamReturn run_range (const SmartPtr<Arguments> &args, const WorkRange &range) {
+        return work_range (args, range);
+    }
 
     // derived from Worker
     virtual XCamReturn work (const SmartPtr<Arguments> &args);
+    // on shared pool waits until items of this worker are done, worker can work again after
     virtual XCamReturn stop ();
 
 private:
     //new virtual functions
     virtual XCamReturn work_range (const SmartPtr<Arguments> &args, const WorkRange &range);
-    virtual WorkRange get_range (const WorkSize &item);
+    virtual WorkRange get_range (const WorkSize &item, const WorkSize &global, const WorkSize &local);
     virtual XCamReturn work_unit (const SmartPtr<Arguments> &args, const WorkSize &unit);
 
-    XCamReturn work_impl (const SmartPtr<Arguments> &args, const WorkSize &item);
+    XCamReturn work_impl (
+        const SmartPtr<Arguments> &args, const WorkSize &item, const WorkSize &global, const WorkSize &local);
     void all_items_done (const SmartPtr<Arguments> &args, XCamReturn error);
+    XCamReturn init_threads (uint32_t max_items);
+    void inflight_done ();
+    uint32_t get_chunk_count (uint32_t max_items);
+    void update_tile_cost (uint64_t cost_ns);
 
     XCAM_DEAD_COPY (SoftWorker);
 
 private:
-    SmartPtr<ThreadPool>    _threads;
-    WorkSize                _work_unit;
+    SmartPtr<ThreadPool>        _threads;
+    Mutex                       _threads_mutex;
+    // all_items_done runs on its done threads when work goes to shared pool
+    SmartPtr<WorkStealingPool>  _done_pool;
+    WorkSize                    _work_unit;
+    bool                        _shared_threads;
+    bool                        _use_shared;
+    bool                        _batch_dispatch;
+    std::atomic<bool>           _stopped;
+    std::atomic<uint32_t>       _inflight_items;
+    Mutex                       _inflight_mutex;
+    Cond                        _inflight_cond;
+    std::atomic<uint64_t>       _tile_cost_ns;
 };
 
 }
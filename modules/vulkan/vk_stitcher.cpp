@@ -273,7 +273,7 @@ StitcherImpl::set_geomap_table (
     fd.set_bowl_config (bowl);
 
     FisheyeDewarp::MapTable map_table (table_width * table_height);
-    fd.gen_table (map_table);
+    fd.gen_table_cached (map_table, _stitcher->get_lut_cache_dir ());
 
     bool ret = mapper->set_lookup_table (map_table.data (), table_width, table_height);
     XCAM_FAIL_RETURN (
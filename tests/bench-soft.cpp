@@ -0,0 +1,728 @@
+/*
+ * bench-soft.cpp - benchmark of soft kernels and soft stitcher presets
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "test_common.h"
+#include "test_sv_params.h"
+
+#include <soft/soft_video_buf_allocator.h>
+#include <soft/soft_blender_tasks_priv.h>
+#include <soft/soft_geo_tasks_priv.h>
+#include <soft/soft_copy_task.h>
+#include <soft/soft_blender.h>
+#include <interface/blender.h>
+#include <interface/stitcher.h>
+#include <work_stealing_pool.h>
+#include <xcam_numa.h>
+#include <algorithm>
+#include <time.h>
+
+#define BENCH_LUT_WIDTH 64
+#define BENCH_LUT_HEIGHT 36
+
+using namespace XCam;
+using namespace XCamSoftTasks;
+
+struct BenchResult {
+    std::string    name;
+    const char    *type;
+    uint32_t       width;
+    uint32_t       height;
+    uint32_t       threads;
+    uint32_t       iterations;
+    double         startup_us;
+    double         mean_us;
+    double         min_us;
+    double         p50_us;
+    double         p90_us;
+    double         p99_us;
+    double         max_us;
+    double         mpixels_per_sec;
+};
+typedef std::vector<BenchResult> BenchResults;
+
+static double
+now_us ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+// nearest-rank percentile of sorted samples
+static double
+percentile (const std::vector<double> &sorted, double percent)
+{
+    XCAM_ASSERT (!sorted.empty ());
+    size_t rank = (size_t)(percent / 100.0 * sorted.size () + 0.5);
+    rank = XCAM_CLAMP (rank, (size_t)1, sorted.size ());
+    return sorted[rank - 1];
+}
+
+static void
+summarize (std::vector<double> &samples, uint64_t pixels, BenchResult &result)
+{
+    XCAM_ASSERT (!samples.empty ());
+    std::sort (samples.begin (), samples.end ());
+
+    double sum = 0.0;
+    for (size_t i = 0; i < samples.size (); ++i)
+        sum += samples[i];
+
+    result.iterations = samples.size ();
+    result.mean_us = sum / samples.size ();
+    result.min_us = samples.front ();
+    result.max_us = samples.back ();
+    result.p50_us = percentile (samples, 50.0);
+    result.p90_us = percentile (samples, 90.0);
+    result.p99_us = percentile (samples, 99.0);
+    result.mpixels_per_sec = pixels / result.mean_us;
+}
+
+// luma gradient with noise, chroma around 128, same pattern for same seed
+static SmartPtr<VideoBuffer>
+create_frame (uint32_t width, uint32_t height, uint32_t seed)
+{
+    VideoBufferInfo info;
+    info.init (V4L2_PIX_FMT_NV12, width, height, XCAM_ALIGN_UP (width, 16), XCAM_ALIGN_UP (height, 16));
+
+    SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (info);
+    XCAM_FAIL_RETURN (ERROR, pool->reserve (1), NULL, "bench reserve %dx%d frame failed", width, height);
+    SmartPtr<VideoBuffer> buf = pool->get_buffer ();
+    XCAM_FAIL_RETURN (ERROR, buf.ptr (), NULL, "bench get %dx%d frame failed", width, height);
+
+    const VideoBufferInfo &buf_info = buf->get_video_info ();
+    uint8_t *mem = buf->map ();
+    uint32_t rand = seed * 2654435761u + 1;
+    for (uint32_t y = 0; y < buf_info.aligned_height; ++y) {
+        uint8_t *luma = mem + buf_info.offsets[0] + y * buf_info.strides[0];
+        for (uint32_t x = 0; x < buf_info.aligned_width; ++x) {
+            rand = rand * 1664525u + 1013904223u;
+            luma[x] = (uint8_t)(x * 3 + y * 5 + seed * 17 + (rand >> 28));
+        }
+    }
+    for (uint32_t y = 0; y < buf_info.aligned_height / 2; ++y) {
+        uint8_t *uv = mem + buf_info.offsets[1] + y * buf_info.strides[1];
+        for (uint32_t x = 0; x < buf_info.aligned_width; ++x)
+            uv[x] = (uint8_t)(128 + ((x + y + seed) & 0x1F) - 16);
+    }
+    buf->unmap ();
+
+    return buf;
+}
+
+static SmartPtr<UcharImage>
+create_mask (uint32_t width, uint32_t height)
+{
+    SmartPtr<UcharImage> mask = new UcharImage (width, height, XCAM_ALIGN_UP (width, SOFT_BLENDER_ALIGNMENT_X));
+    XCAM_ASSERT (mask.ptr () && mask->is_valid ());
+    for (uint32_t y = 0; y < height; ++y) {
+        Uchar *ptr = mask->get_buf_ptr (0, y);
+        for (uint32_t x = 0; x < mask->get_pitch (); ++x)
+            ptr[x] = (uint8_t)(x < width ? 255 - x * 255 / width : 0);
+    }
+    return mask;
+}
+
+class BenchCallback
+    : public Worker::Callback
+{
+public:
+    BenchCallback ()
+        : _done (false)
+        , _error (XCAM_RETURN_NO_ERROR)
+    {}
+
+    virtual void work_status (
+        const SmartPtr<Worker> &worker, const SmartPtr<Worker::Arguments> &args, const XCamReturn error)
+    {
+        XCAM_UNUSED (worker);
+        XCAM_UNUSED (args);
+        SmartLock locker (_mutex);
+        _done = true;
+        _error = error;
+        _cond.broadcast ();
+    }
+
+    XCamReturn wait () {
+        SmartLock locker (_mutex);
+        while (!_done)
+            _cond.wait (_mutex);
+        _done = false;
+        return _error;
+    }
+
+private:
+    Mutex          _mutex;
+    Cond           _cond;
+    bool           _done;
+    XCamReturn     _error;
+};
+
+struct KernelBench {
+    SmartPtr<SoftWorker>            worker;
+    SmartPtr<Worker::Arguments>     args;
+};
+
+// one item per row of work units, SoftWorker regroups items into per-thread chunks
+static void
+set_work_size (const SmartPtr<SoftWorker> &worker, uint32_t out_w, uint32_t out_h)
+{
+    WorkSize unit = worker->get_work_unit ();
+    WorkSize global (
+        xcam_ceil (out_w, unit.value[0]) / unit.value[0],
+        xcam_ceil (out_h, unit.value[1]) / unit.value[1]);
+    worker->set_global_size (global);
+    worker->set_local_size (WorkSize (global.value[0], 1));
+}
+
+static bool
+setup_gauss_scale (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<GaussScaleGray::Args> args = new GaussScaleGray::Args;
+    args->in_luma = new UcharImage (create_frame (width, height, 0), 0);
+    args->out_luma = new UcharImage (width / 2, height / 2);
+
+    bench.worker = new GaussScaleGray ("GaussScaleGray", cb);
+    bench.args = args;
+    set_work_size (bench.worker, width / 2, height / 2);
+    return true;
+}
+
+static bool
+setup_blend (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<VideoBuffer> in0 = create_frame (width, height, 0);
+    SmartPtr<VideoBuffer> in1 = create_frame (width, height, 1);
+    SmartPtr<VideoBuffer> out = create_frame (width, height, 2);
+
+    SmartPtr<BlendTask::Args> args = new BlendTask::Args (NULL, create_mask (width, height), out);
+    args->in_luma[0] = new UcharImage (in0, 0);
+    args->in_luma[1] = new UcharImage (in1, 0);
+    args->in_uv[0] = new Uchar2Image (in0, 1);
+    args->in_uv[1] = new Uchar2Image (in1, 1);
+    args->out_luma = new UcharImage (out, 0);
+    args->out_uv = new Uchar2Image (out, 1);
+
+    bench.worker = new BlendTask (cb);
+    bench.args = args;
+    set_work_size (bench.worker, width, height);
+    return true;
+}
+
+static bool
+setup_laplace (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<VideoBuffer> orig = create_frame (width, height, 0);
+    SmartPtr<VideoBuffer> gauss = create_frame (width / 2, height / 2, 1);
+    SmartPtr<VideoBuffer> out = create_frame (width, height, 2);
+
+    SmartPtr<LaplaceTask::Args> args = new LaplaceTask::Args (NULL, 0, SoftBlender::Idx0, out);
+    args->orig_luma = new UcharImage (orig, 0);
+    args->orig_uv = new Uchar2Image (orig, 1);
+    args->gauss_luma = new UcharImage (gauss, 0);
+    args->gauss_uv = new Uchar2Image (gauss, 1);
+    args->out_luma = new UcharImage (out, 0);
+    args->out_uv = new Uchar2Image (out, 1);
+
+    bench.worker = new LaplaceTask (cb);
+    bench.args = args;
+    set_work_size (bench.worker, width, height);
+    return true;
+}
+
+static bool
+setup_reconstruct (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<VideoBuffer> gauss = create_frame (width / 2, height / 2, 0);
+    SmartPtr<VideoBuffer> lap0 = create_frame (width, height, 1);
+    SmartPtr<VideoBuffer> lap1 = create_frame (width, height, 2);
+    SmartPtr<VideoBuffer> out = create_frame (width, height, 3);
+
+    SmartPtr<ReconstructTask::Args> args = new ReconstructTask::Args (NULL, 0, out);
+    args->gauss_luma = new UcharImage (gauss, 0);
+    args->gauss_uv = new Uchar2Image (gauss, 1);
+    args->lap_luma[0] = new UcharImage (lap0, 0);
+    args->lap_luma[1] = new UcharImage (lap1, 0);
+    args->lap_uv[0] = new Uchar2Image (lap0, 1);
+    args->lap_uv[1] = new Uchar2Image (lap1, 1);
+    args->out_luma = new UcharImage (out, 0);
+    args->out_uv = new Uchar2Image (out, 1);
+    args->mask = create_mask (width, height);
+
+    bench.worker = new ReconstructTask (cb);
+    bench.args = args;
+    set_work_size (bench.worker, width, height);
+    return true;
+}
+
+static bool
+setup_geomap (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<VideoBuffer> in = create_frame (width, height, 0);
+    SmartPtr<VideoBuffer> out = create_frame (width, height, 1);
+
+    // mild barrel distortion over the whole input
+    SmartPtr<Float2Image> lut = new Float2Image (BENCH_LUT_WIDTH, BENCH_LUT_HEIGHT);
+    XCAM_ASSERT (lut.ptr () && lut->is_valid ());
+    for (uint32_t y = 0; y < BENCH_LUT_HEIGHT; ++y) {
+        Float2 *ptr = lut->get_buf_ptr (0, y);
+        for (uint32_t x = 0; x < BENCH_LUT_WIDTH; ++x) {
+            float nx = x * 2.0f / (BENCH_LUT_WIDTH - 1) - 1.0f;
+            float ny = y * 2.0f / (BENCH_LUT_HEIGHT - 1) - 1.0f;
+            float scale = 1.0f - 0.1f * (nx * nx + ny * ny);
+            ptr[x] = Float2 ((nx * scale + 1.0f) / 2.0f * (width - 1), (ny * scale + 1.0f) / 2.0f * (height - 1));
+        }
+    }
+
+    SmartPtr<GeoMapTask::Args> args = new GeoMapTask::Args (NULL);
+    args->in_luma = new UcharImage (in, 0);
+    args->in_uv = new Uchar2Image (in, 1);
+    args->out_luma = new UcharImage (out, 0);
+    args->out_uv = new Uchar2Image (out, 1);
+    args->lookup_table = lut;
+    args->factors = Float2 ((width - 1.0f) / (BENCH_LUT_WIDTH - 1.0f), (height - 1.0f) / (BENCH_LUT_HEIGHT - 1.0f));
+    args->map_width = width;
+    args->map_height = height;
+    args->out_area = Rect (0, 0, width, height);
+
+    bench.worker = new GeoMapTask (cb);
+    bench.args = args;
+    set_work_size (bench.worker, width, height);
+    return true;
+}
+
+static bool
+setup_copy (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench)
+{
+    SmartPtr<VideoBuffer> in = create_frame (width, height, 0);
+    SmartPtr<VideoBuffer> out = create_frame (width, height, 1);
+
+    SmartPtr<CopyTask::Args> args = new CopyTask::Args (NULL);
+    args->in_luma = new UcharImage (in, 0);
+    args->in_uv = new Uchar2Image (in, 1);
+    args->out_luma = new UcharImage (out, 0);
+    args->out_uv = new Uchar2Image (out, 1);
+
+    bench.worker = new CopyTask (cb);
+    bench.args = args;
+    // same layout as stitcher, one unit is two luma rows
+    WorkSize global (1, xcam_ceil (height, 2) / 2);
+    bench.worker->set_global_size (global);
+    bench.worker->set_local_size (WorkSize (1, 1));
+    return true;
+}
+
+// fixed-point variants of pyramid kernels, same inputs as float ones
+#define BENCH_SETUP_FIXED(setup, Task)                                  \
+    static bool                                                         \
+    setup##_fixed (                                                     \
+        uint32_t width, uint32_t height,                                \
+        const SmartPtr<Worker::Callback> &cb, KernelBench &bench)       \
+    {                                                                   \
+        if (!setup (width, height, cb, bench))                          \
+            return false;                                               \
+        bench.worker.dynamic_cast_ptr<Task> ()->set_fixed_point (true); \
+        return true;                                                    \
+    }
+
+BENCH_SETUP_FIXED (setup_gauss_scale, GaussScaleGray)
+BENCH_SETUP_FIXED (setup_blend, BlendTask)
+BENCH_SETUP_FIXED (setup_laplace, LaplaceTask)
+BENCH_SETUP_FIXED (setup_reconstruct, ReconstructTask)
+
+typedef bool (*KernelSetup) (uint32_t width, uint32_t height, const SmartPtr<Worker::Callback> &cb, KernelBench &bench);
+
+static const struct {
+    const char     *name;
+    KernelSetup     setup;
+} kernel_list[] = {
+    {"GaussScaleGray", setup_gauss_scale},
+    {"BlendTask", setup_blend},
+    {"LaplaceTask", setup_laplace},
+    {"ReconstructTask", setup_reconstruct},
+    {"GaussScaleGrayFixed", setup_gauss_scale_fixed},
+    {"BlendTaskFixed", setup_blend_fixed},
+    {"LaplaceTaskFixed", setup_laplace_fixed},
+    {"ReconstructTaskFixed", setup_reconstruct_fixed},
+    {"GeoMapTask", setup_geomap},
+    {"CopyTask", setup_copy},
+};
+
+static int
+bench_kernel (
+    const char *name, KernelSetup setup, uint32_t width, uint32_t height, uint32_t threads,
+    uint32_t warmup, uint32_t iterations, BenchResults &results)
+{
+    SmartPtr<BenchCallback> cb = new BenchCallback;
+    KernelBench bench;
+    CHECK_EXP (setup (width, height, cb, bench), "setup kernel %s failed", name);
+
+    std::vector<double> samples;
+    for (uint32_t i = 0; i < warmup + iterations; ++i) {
+        double start = now_us ();
+        XCamReturn ret = bench.worker->work (bench.args);
+        CHECK (ret, "kernel %s work failed", name);
+        CHECK (cb->wait (), "kernel %s work status failed", name);
+        if (i >= warmup)
+            samples.push_back (now_us () - start);
+    }
+    bench.worker->stop ();
+
+    BenchResult result;
+    result.name = name;
+    result.type = "kernel";
+    result.width = width;
+    result.height = height;
+    result.threads = threads;
+    result.startup_us = 0.0;
+    summarize (samples, (uint64_t)width * height, result);
+    results.push_back (result);
+    return 0;
+}
+
+static const struct {
+    const char     *name;
+    bool            tiled;
+} blender_modes[] = {
+    {"untiled", false},
+    {"tiled", true},
+};
+
+// two frames of full size through a 2-level soft blender
+static int
+bench_blender (
+    const char *mode, bool tiled, uint32_t width, uint32_t height, uint32_t threads,
+    uint32_t warmup, uint32_t iterations, BenchResults &results)
+{
+    SmartPtr<Blender> blender = Blender::create_soft_blender ();
+    SmartPtr<SoftBlender> soft_blender = blender.dynamic_cast_ptr<SoftBlender> ();
+    XCAM_ASSERT (soft_blender.ptr ());
+    CHECK_EXP (
+        soft_blender->set_pyr_levels (2) && soft_blender->set_tiled_mode (tiled, XCAM_SOFT_BLENDER_BAND_ROWS),
+        "set blender mode %s failed", mode);
+    blender->set_output_size (width, height);
+    Rect area (0, 0, width, height);
+    blender->set_merge_window (area);
+    blender->set_input_merge_area (area, 0);
+    blender->set_input_merge_area (area, 1);
+
+    SmartPtr<VideoBuffer> in0 = create_frame (width, height, 0);
+    SmartPtr<VideoBuffer> in1 = create_frame (width, height, 1);
+    std::vector<double> samples;
+    for (uint32_t i = 0; i < warmup + iterations; ++i) {
+        SmartPtr<VideoBuffer> out_buf;
+        double start = now_us ();
+        CHECK (blender->blend (in0, in1, out_buf), "blender mode %s blend failed", mode);
+        if (i >= warmup)
+            samples.push_back (now_us () - start);
+    }
+
+    BenchResult result;
+    result.name = std::string ("SoftBlender-") + mode;
+    result.type = "blender";
+    result.width = width;
+    result.height = height;
+    result.threads = threads;
+    result.startup_us = 0.0;
+    summarize (samples, (uint64_t)width * height, result);
+    results.push_back (result);
+    return 0;
+}
+
+struct StitchPreset {
+    const char         *name;
+    CamModel            cam_model;
+    StitchScopicMode    scopic_mode;
+    uint32_t            camera_num;
+    uint32_t            input_num;
+    uint32_t            in_width, in_height;
+    uint32_t            out_width, out_height;
+};
+
+static const StitchPreset stitch_presets[] = {
+    {"a2c1080p", CamA2C1080P, ScopicMono, 2, 1, 1920, 960, 1920, 640},
+    {"c3c4k", CamC3C4K, ScopicStereoLeft, 3, 3, 1920, 1440, 3840, 1920},
+    {"c3c8k", CamC3C8K, ScopicStereoLeft, 3, 3, 3840, 2880, 7680, 3840},
+    {"c6c8k", CamC6C8K, ScopicMono, 6, 6, 3840, 2880, 7680, 3840},
+};
+
+static int
+bench_stitcher (
+    const StitchPreset &preset, uint32_t threads, uint32_t warmup, uint32_t iterations, BenchResults &results)
+{
+    SmartPtr<Stitcher> stitcher = Stitcher::create_soft_stitcher ();
+    XCAM_ASSERT (stitcher.ptr ());
+
+    stitcher->set_camera_num (preset.camera_num);
+    stitcher->set_output_size (preset.out_width, preset.out_height);
+    stitcher->set_dewarp_mode (DewarpSphere);
+    stitcher->set_blend_pyr_levels (2);
+
+    float vp_range[XCAM_STITCH_FISHEYE_MAX_NUM];
+    stitcher->set_viewpoints_range (viewpoints_range (preset.cam_model, vp_range));
+    StitchInfo info = stitch_info (preset.cam_model, preset.scopic_mode);
+    get_fisheye_info (preset.cam_model, preset.scopic_mode, info.fisheye_info);
+    stitcher->set_stitch_info (info);
+
+    VideoBufferList in_bufs;
+    for (uint32_t i = 0; i < preset.input_num; ++i) {
+        SmartPtr<VideoBuffer> buf = create_frame (preset.in_width, preset.in_height, i);
+        CHECK_EXP (buf.ptr (), "create input frame failed");
+        in_bufs.push_back (buf);
+    }
+
+    // first frame generates fisheye lookup tables, reported as startup
+    double startup = 0.0;
+    std::vector<double> samples;
+    for (uint32_t i = 0; i < warmup + iterations + 1; ++i) {
+        SmartPtr<VideoBuffer> out_buf;
+        double start = now_us ();
+        CHECK (stitcher->stitch_buffers (in_bufs, out_buf), "stitcher preset %s stitch failed", preset.name);
+        double duration = now_us () - start;
+        if (i == 0)
+            startup = duration;
+        else if (i > warmup)
+            samples.push_back (duration);
+    }
+
+    BenchResult result;
+    result.name = std::string ("SoftStitcher-") + preset.name;
+    result.type = "stitcher";
+    result.width = preset.out_width;
+    result.height = preset.out_height;
+    result.threads = threads;
+    result.startup_us = startup;
+    summarize (samples, (uint64_t)preset.out_width * preset.out_height, result);
+    results.push_back (result);
+    return 0;
+}
+
+static void
+print_result (const BenchResult &r)
+{
+    printf ("%-24s %5dx%-5d thr:%-3d iter:%-4d mean:%10.1fus p50:%10.1fus p90:%10.1fus p99:%10.1fus %8.1f Mpix/s\n",
+            r.name.c_str (), r.width, r.height, r.threads, r.iterations,
+            r.mean_us, r.p50_us, r.p90_us, r.p99_us, r.mpixels_per_sec);
+}
+
+static bool
+write_json (const char *file_name, const BenchResults &results, uint32_t warmup)
+{
+    FILE *fp = fopen (file_name, "wb");
+    XCAM_FAIL_RETURN (ERROR, fp, false, "open json file(%s) failed", file_name);
+
+    std::vector<uint32_t> cpus;
+    NumaTopology::get_online_cpus (cpus);
+
+    fprintf (fp, "{\n\"machine\":{\"cpus\":%d,\"numa_nodes\":%d},\n\"warmup\":%d,\n\"results\":[\n",
+             (int)cpus.size (), NumaTopology::get_node_count (), warmup);
+    for (size_t i = 0; i < results.size (); ++i) {
+        const BenchResult &r = results[i];
+        fprintf (fp, "{\"name\":\"%s\",\"type\":\"%s\",\"width\":%d,\"height\":%d,\"threads\":%d,\"iterations\":%d,"
+                 "\"startup_us\":%.1f,\"mean_us\":%.1f,\"min_us\":%.1f,\"p50_us\":%.1f,\"p90_us\":%.1f,"
+                 "\"p99_us\":%.1f,\"max_us\":%.1f,\"mpixels_per_sec\":%.2f}%s\n",
+                 r.name.c_str (), r.type, r.width, r.height, r.threads, r.iterations,
+                 r.startup_us, r.mean_us, r.min_us, r.p50_us, r.p90_us, r.p99_us, r.max_us, r.mpixels_per_sec,
+                 i + 1 < results.size () ? "," : "");
+    }
+    fprintf (fp, "]}\n");
+    fclose (fp);
+    return true;
+}
+
+static bool
+match_name (const char *list, const char *name)
+{
+    if (!list || !strcasecmp (list, "all"))
+        return true;
+
+    std::string names = std::string (",") + list + ",";
+    std::string key = std::string (",") + name + ",";
+    return names.find (key) != std::string::npos;
+}
+
+static void usage(const char* arg0)
+{
+    printf ("Usage:\n"
+            "%s --kernels KERNELS --presets PRESETS --threads 1,2,4 --json result.json ...\n"
+            "\t--kernels           optional, comma separated kernels to run, all or none, default: all\n"
+            "\t                    select from [GaussScaleGray/BlendTask/LaplaceTask/ReconstructTask/GeoMapTask/CopyTask]\n"
+            "\t                    fixed-point pyramid kernels: [GaussScaleGrayFixed/BlendTaskFixed/LaplaceTaskFixed/ReconstructTaskFixed]\n"
+            "\t--presets           optional, comma separated soft stitcher presets on sphere dewarp, all or none, default: none\n"
+            "\t                    select from [a2c1080p/c3c4k/c3c8k/c6c8k]\n"
+            "\t--blenders          optional, comma separated 2-level soft blender modes on kernel frame, all or none, default: none\n"
+            "\t                    select from [untiled/tiled]\n"
+            "\t--width             optional, kernel frame width, default: 1920\n"
+            "\t--height            optional, kernel frame height, default: 1080\n"
+            "\t--threads           optional, thread counts of shared pool to sweep, cpu list format, e.g. 1-4,8\n"
+            "\t                    default: 1 and online cpu count\n"
+            "\t--warmup            optional, untimed runs before measuring, default: 5\n"
+            "\t--iterations        optional, timed runs of each kernel, default: 50\n"
+            "\t--stitch-iterations optional, timed frames of each stitcher preset, default: 20\n"
+            "\t--json              optional, write results to json file\n"
+            "\t--help              usage\n",
+            arg0);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *kernels = "all";
+    const char *presets = "none";
+    const char *blenders = "none";
+    const char *thread_list = NULL;
+    const char *json_file = NULL;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t warmup = 5;
+    uint32_t iterations = 50;
+    uint32_t stitch_iterations = 20;
+
+    const struct option long_opts[] = {
+        {"kernels", required_argument, NULL, 'k'},
+        {"presets", required_argument, NULL, 'p'},
+        {"blenders", required_argument, NULL, 'b'},
+        {"width", required_argument, NULL, 'w'},
+        {"height", required_argument, NULL, 'h'},
+        {"threads", required_argument, NULL, 't'},
+        {"warmup", required_argument, NULL, 'W'},
+        {"iterations", required_argument, NULL, 'i'},
+        {"stitch-iterations", required_argument, NULL, 'I'},
+        {"json", required_argument, NULL, 'j'},
+        {"help", no_argument, NULL, 'e'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt = -1;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'k':
+            kernels = optarg;
+            break;
+        case 'p':
+            presets = optarg;
+            break;
+        case 'b':
+            blenders = optarg;
+            break;
+        case 'w':
+            width = atoi(optarg);
+            break;
+        case 'h':
+            height = atoi(optarg);
+            break;
+        case 't':
+            thread_list = optarg;
+            break;
+        case 'W':
+            warmup = atoi(optarg);
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 'I':
+            stitch_iterations = atoi(optarg);
+            break;
+        case 'j':
+            json_file = optarg;
+            break;
+        case 'e':
+            usage (argv[0]);
+            return 0;
+        default:
+            XCAM_LOG_ERROR ("getopt_long return unknown value: %c", opt);
+            usage (argv[0]);
+            return -1;
+        }
+    }
+
+    if (optind < argc || argc < 1) {
+        XCAM_LOG_ERROR ("unknown option %s", argv[optind]);
+        usage (argv[0]);
+        return -1;
+    }
+
+    CHECK_EXP (width >= 64 && height >= 64, "frame size %dx%d is too small", width, height);
+    CHECK_EXP (iterations && stitch_iterations, "iterations must be larger than 0");
+    width = XCAM_ALIGN_UP (width, 16);
+    height = XCAM_ALIGN_UP (height, 16);
+
+    std::vector<uint32_t> threads;
+    if (thread_list) {
+        CHECK_EXP (NumaTopology::parse_cpu_list (thread_list, threads), "invalid thread counts: %s", thread_list);
+    } else {
+        std::vector<uint32_t> cpus;
+        NumaTopology::get_online_cpus (cpus);
+        threads.push_back (1);
+        if (cpus.size () > 1)
+            threads.push_back (cpus.size ());
+    }
+
+    printf ("kernels:\t\t%s\n", kernels);
+    printf ("presets:\t\t%s\n", presets);
+    printf ("blenders:\t\t%s\n", blenders);
+    printf ("kernel frame:\t\t%dx%d\n", width, height);
+    printf ("warmup:\t\t\t%d\n", warmup);
+    printf ("iterations:\t\t%d\n", iterations);
+    printf ("stitch iterations:\t%d\n", stitch_iterations);
+    printf ("json:\t\t\t%s\n", json_file ? json_file : "none");
+
+    BenchResults results;
+    for (size_t t = 0; t < threads.size (); ++t) {
+        CHECK_EXP (threads[t], "thread count must be larger than 0");
+        CHECK_EXP (WorkStealingPool::set_shared_threads (threads[t]), "set shared pool threads(%d) failed", threads[t]);
+
+        for (size_t k = 0; k < sizeof (kernel_list) / sizeof (kernel_list[0]); ++k) {
+            if (strcasecmp (kernels, "none") == 0 || !match_name (kernels, kernel_list[k].name))
+                continue;
+            CHECK_EXP (
+                bench_kernel (kernel_list[k].name, kernel_list[k].setup, width, height, threads[t],
+                              warmup, iterations, results) == 0,
+                "bench kernel %s failed", kernel_list[k].name);
+            print_result (results.back ());
+        }
+
+        for (size_t b = 0; b < sizeof (blender_modes) / sizeof (blender_modes[0]); ++b) {
+            if (strcasecmp (blenders, "none") == 0 || !match_name (blenders, blender_modes[b].name))
+                continue;
+            CHECK_EXP (
+                bench_blender (blender_modes[b].name, blender_modes[b].tiled, width, height, threads[t],
+                               warmup, iterations, results) == 0,
+                "bench blender mode %s failed", blender_modes[b].name);
+            print_result (results.back ());
+        }
+
+        for (size_t p = 0; p < sizeof (stitch_presets) / sizeof (stitch_presets[0]); ++p) {
+            if (strcasecmp (presets, "none") == 0 || !match_name (presets, stitch_presets[p].name))
+                continue;
+            CHECK_EXP (
+                bench_stitcher (stitch_presets[p], threads[t], warmup, stitch_iterations, results) == 0,
+                "bench stitcher preset %s failed", stitch_presets[p].name);
+            print_result (results.back ());
+        }
+    }
+    WorkStealingPool::set_shared_threads (0);
+
+    if (json_file) {
+        CHECK_EXP (write_json (json_file, results, warmup), "write json file %s failed", json_file);
+        printf ("results written to %s\n", json_file);
+    }
+
+    return 0;
+}
@@ -21,6 +21,7 @@
  */
 
 #include <fstream>
+#include <map>
 #include <random>
 #include <string>
 #include <vector>
@@ -36,6 +37,8 @@
 #include "dnn/inference/dnn_object_detection.h"
 #include "dnn/inference/dnn_super_resolution.h"
 #include "dnn/inference/dnn_semantic_segmentation.h"
+#include "dnn/inference/dnn_batch_detection.h"
+#include "dnn/inference/dnn_roi_detection.h"
 
 using namespace XCam;
 using namespace ov;
@@ -87,6 +90,171 @@ write_out_image (const SmartPtr<InferStream> &out)
     out->write_buf ();
 }
 
+// boxes are drawn on inference threads, frames are written in submit order by main thread
+class DetectCallback
+    : public DnnInferenceEngine::Callback
+    , public DnnBatchDetector::Callback
+{
+    struct DetectFrame {
+        SmartPtr<VideoBuffer>   buf;
+        bool                    done;
+    };
+
+public:
+    DetectCallback ()
+        : _frame_id (0)
+    {}
+
+    void *add_frame (const SmartPtr<VideoBuffer> &buf);
+    void write_frames (const SmartPtr<InferStream> &out);
+
+    virtual void infer_done (DnnInferenceEngine *engine, void *cookie, XCamReturn error);
+    virtual void detected (DnnBatchDetector *detector, const DnnDetectResult &result, XCamReturn error);
+
+private:
+    void frame_done (uint64_t id, const SmartPtr<VideoBuffer> &buf,
+                     const std::vector<Vec4i> &boxes, const std::vector<int32_t> &classes, XCamReturn error);
+
+private:
+    Mutex                               _mutex;
+    uint64_t                            _frame_id;
+    std::map<uint64_t, DetectFrame>     _frames;
+};
+
+void *
+DetectCallback::add_frame (const SmartPtr<VideoBuffer> &buf)
+{
+    SmartLock locker (_mutex);
+    DetectFrame &frame = _frames[_frame_id];
+    frame.buf = buf;
+    frame.done = false;
+
+    // batch results are matched by timestamp
+    buf->set_timestamp (_frame_id);
+
+    return (void *)(uintptr_t)(_frame_id++);
+}
+
+void
+DetectCallback::write_frames (const SmartPtr<InferStream> &out)
+{
+    VideoBufferList bufs;
+    {
+        SmartLock locker (_mutex);
+        while (!_frames.empty () && _frames.begin ()->second.done) {
+            bufs.push_back (_frames.begin ()->second.buf);
+            _frames.erase (_frames.begin ());
+        }
+    }
+
+    if (!out.ptr ())
+        return;
+
+    for (VideoBufferList::iterator iter = bufs.begin (); iter != bufs.end (); ++iter) {
+        out->get_buf () = *iter;
+        write_out_image (out);
+    }
+}
+
+void
+DetectCallback::infer_done (DnnInferenceEngine *engine, void *cookie, XCamReturn error)
+{
+    uint64_t id = (uint64_t)(uintptr_t)cookie;
+    SmartPtr<VideoBuffer> buf;
+    {
+        SmartLock locker (_mutex);
+        XCAM_ASSERT (_frames.find (id) != _frames.end ());
+        buf = _frames[id].buf;
+    }
+
+    std::vector<Vec4i> boxes;
+    std::vector<int32_t> classes;
+    DnnObjectDetection *object_detector = dynamic_cast<DnnObjectDetection *> (engine);
+    if (error == XCAM_RETURN_NO_ERROR && object_detector) {
+        uint32_t blob_size = 0;
+        std::vector<float*> result_ptr;
+        for (uint32_t output_idx = 0; output_idx < engine->get_output_size (); output_idx ++) {
+            result_ptr.push_back ((float*)engine->get_inference_results (output_idx, blob_size));
+        }
+        error = object_detector->get_bounding_boxes (result_ptr, 0, boxes, classes);
+    }
+
+    frame_done (id, buf, boxes, classes, error);
+}
+
+void
+DetectCallback::detected (DnnBatchDetector *detector, const DnnDetectResult &result, XCamReturn error)
+{
+    XCAM_UNUSED (detector);
+    XCAM_LOG_DEBUG ("source %d frame %" PRId64 " detected %d objects",
+                    result.source, result.timestamp, (uint32_t)result.boxes.size ());
+
+    frame_done ((uint64_t)result.timestamp, result.buf, result.boxes, result.classes, error);
+}
+
+void
+DetectCallback::frame_done (
+    uint64_t id, const SmartPtr<VideoBuffer> &buf,
+    const std::vector<Vec4i> &boxes, const std::vector<int32_t> &classes, XCamReturn error)
+{
+    if (error == XCAM_RETURN_NO_ERROR) {
+        const VideoBufferInfo &info = buf->get_video_info ();
+        uint8_t* detect_image = buf->map ();
+        XCamDNN::draw_bounding_boxes (detect_image, info.width, info.height,
+                                      DnnInferImageFormatRGBPacked, boxes, classes);
+        buf->unmap ();
+    } else {
+        XCAM_LOG_WARNING ("frame %" PRIu64 " inference failed, written without boxes", id);
+    }
+
+    SmartLock locker (_mutex);
+    _frames[id].done = true;
+}
+
+// DetectionOutput list of a batch of 3 with 2 images set, as roi detection does with less rois than
+// batch slots, image 1 rows go between image 0 rows and padding follows the terminator
+static int
+check_detection_output ()
+{
+    const uint32_t channels = 7;
+    const float result[][channels] = {
+        {0, 1, 0.9f, 0.1f, 0.1f, 0.2f, 0.2f},
+        {1, 2, 0.8f, 0.5f, 0.5f, 0.7f, 0.9f},
+        {0, 3, 0.3f, 0.1f, 0.1f, 0.2f, 0.2f},
+        {0, 4, 0.7f, 0.0f, 0.5f, 0.5f, 1.0f},
+        {1, 5, 0.6f, 0.2f, 0.2f, 0.4f, 0.4f},
+        // slot of a batch not filled by roi detection keeps a stale image
+        {2, 8, 0.9f, 0.3f, 0.3f, 0.6f, 0.6f},
+        {-1, 0, 0, 0, 0, 0, 0},
+        {0, 6, 0.9f, 0.1f, 0.1f, 0.2f, 0.2f},
+        {1, 7, 0.9f, 0.1f, 0.1f, 0.2f, 0.2f},
+    };
+    const uint32_t rows = sizeof (result) / sizeof (result[0]);
+    const int32_t expect_classes[2][2] = {{1, 4}, {2, 5}};
+    const Vec4i expect_boxes[2][2] = {
+        {Vec4i (10, 20, 10, 20), Vec4i (0, 100, 50, 100)},
+        {Vec4i (50, 100, 20, 80), Vec4i (20, 40, 20, 40)}
+    };
+
+    for (uint32_t idx = 0; idx < 2; idx++) {
+        std::vector<Vec4i> boxes;
+        std::vector<int32_t> classes;
+        DnnObjectDetection::parse_detection_output (&result[0][0], rows, channels, idx, 100, 200, boxes, classes);
+        CHECK_EXP (
+            boxes.size () == 2 && classes.size () == 2,
+            "image %d of batch got %d boxes, expect 2", idx, (int)boxes.size ());
+        for (uint32_t i = 0; i < 2; i++) {
+            CHECK_EXP (
+                classes[i] == expect_classes[idx][i] &&
+                abs (boxes[i][0] - expect_boxes[idx][i][0]) <= 1 && abs (boxes[i][1] - expect_boxes[idx][i][1]) <= 1 &&
+                abs (boxes[i][2] - expect_boxes[idx][i][2]) <= 1 && abs (boxes[i][3] - expect_boxes[idx][i][3]) <= 1,
+                "image %d box %d class %d {%d, %d, %d, %d} mismatch", idx, i, classes[i],
+                boxes[i][0], boxes[i][1], boxes[i][2], boxes[i][3]);
+        }
+    }
+    return 0;
+}
+
 static void usage (const char* arg0)
 {
     printf ("Usage:\n"
@@ -104,6 +272,11 @@ static void usage (const char* arg0)
             "\t--in-h              optional, input height, default: 800\n"
             "\t--output            output image(NV12/MP4)\n"
             "\t--save              save output image\n"
+            "\t--infer-requests    optional, frames inferred concurrently in video detection, default: 1\n"
+            "\t--batch             optional, cameras batched in video detection, frames are taken round-robin, default: 1\n"
+            "\t--tile-overlap      optional, overlap of tiles in video super resolution, default: 16\n"
+            "\t--roi-refresh       optional, video detection on moving regions, full frame every N frames, default: off\n"
+            "\t                    moving regions share one inference of --batch slots\n"
             "\t--help              usage\n",
             arg0);
 }
@@ -121,6 +294,10 @@ int main (int argc, char *argv[])
         {"in-h", required_argument, NULL, 'h'},
         {"output", required_argument, NULL, 'o'},
         {"save", required_argument, NULL, 's'},
+        {"infer-requests", required_argument, NULL, 'r'},
+        {"batch", required_argument, NULL, 'b'},
+        {"tile-overlap", required_argument, NULL, 't'},
+        {"roi-refresh", required_argument, NULL, 'R'},
         {"help", no_argument, NULL, 'H'},
         {NULL, 0, NULL, 0},
     };
@@ -141,6 +318,9 @@ int main (int argc, char *argv[])
     std::vector<std::string> images;
     bool save_output = true;
     bool process_video = false;
+    uint32_t batch_size = 1;
+    uint32_t tile_overlap = DNN_SR_DEFAULT_TILE_OVERLAP;
+    int32_t roi_refresh = -1;
 
     int32_t opt = -1;
     while ((opt = getopt_long (argc, argv, "", long_opts, NULL)) != -1) {
@@ -203,6 +383,22 @@ int main (int argc, char *argv[])
             XCAM_ASSERT (optarg);
             save_output = (strcasecmp (optarg, "false") == 0 ? false : true);
             break;
+        case 'r':
+            XCAM_ASSERT (optarg);
+            infer_config.infer_requests = (uint32_t)atoi(optarg);
+            break;
+        case 'b':
+            XCAM_ASSERT (optarg);
+            batch_size = (uint32_t)atoi(optarg);
+            break;
+        case 't':
+            XCAM_ASSERT (optarg);
+            tile_overlap = (uint32_t)atoi(optarg);
+            break;
+        case 'R':
+            XCAM_ASSERT (optarg);
+            roi_refresh = atoi(optarg);
+            break;
         case 'H':
             usage (argv[0]);
             return 0;
@@ -238,15 +434,29 @@ int main (int argc, char *argv[])
     printf ("input image:\t\t%s\n", (input_image != NULL) ? input_image : "NULL");
     printf ("model type:\t\t%d\n", infer_config.model_type);
     printf ("model file name:\t\t%s\n", (infer_config.model_filename.c_str () != NULL) ? infer_config.model_filename.c_str () : "NULL");
+    printf ("infer requests:\t\t%d\n", infer_config.infer_requests);
+    printf ("batch size:\t\t%d\n", batch_size);
+
+    if (infer_config.infer_requests < 1 || batch_size < 1) {
+        XCAM_LOG_ERROR ("infer requests and batch size must be larger than 0");
+        return -1;
+    }
+
+    if (DnnInferObjectDetection == infer_config.model_type) {
+        CHECK_EXP (check_detection_output () == 0, "detection output of batch check failed");
+    }
 
     // --------------------------- 1. Set input image file names -----------------------------------------------------------
     if (ins.size () == 1 && ins[0].ptr ()) {
         process_video = true;
         ins[0]->set_buf_size (input_width, input_height);
-        CHECK (ins[0]->create_buf_pool (6, V4L2_PIX_FMT_BGR24), "create buffer pool failed");
+        // frames in flight and finished ones waiting to be written hold input buffers
+        CHECK (ins[0]->create_buf_pool (XCAM_MAX (6u, (infer_config.infer_requests * 2 + 1) * batch_size + 1), V4L2_PIX_FMT_BGR24),
+               "create buffer pool failed");
         CHECK (ins[0]->open_reader ("rb"), "open input file(%s) failed", ins[0]->get_file_name ());
 
-        if (save_output && outs.size () == 1) {
+        // super resolution output size is known after model loaded
+        if (save_output && outs.size () == 1 && DnnInferSuperResolution != infer_config.model_type) {
             outs[0]->set_buf_size (input_width, input_height);
             CHECK (outs[0]->estimate_file_format (),
                    "%s: estimate file format failed", outs[0]->get_file_name ());
@@ -358,11 +568,132 @@ int main (int argc, char *argv[])
 
     // --------------------------- 5. load inference model -------------------------------------------------
     XCAM_LOG_DEBUG ("5. load inference model");
+    if (process_video && DnnInferObjectDetection == infer_config.model_type && batch_size > 1) {
+        CHECK (
+            infer_engine->set_batch_size (batch_size),
+            "set batch size failed!");
+    }
     CHECK (
         infer_engine->load_model (infer_config),
         "load model failed!");
 
-    if (process_video && DnnInferObjectDetection == infer_config.model_type) {
+    if (process_video && DnnInferSuperResolution == infer_config.model_type) {
+        // frames of any size are inferred in tiles of model input size
+        SmartPtr<DnnSuperResolution> super_res = infer_engine.dynamic_cast_ptr<DnnSuperResolution> ();
+        uint32_t scale = super_res->get_scale ();
+        CHECK_EXP (scale > 0, "invalid super resolution scale");
+
+        VideoBufferInfo sr_info;
+        sr_info.init (V4L2_PIX_FMT_BGR24, input_width * scale, input_height * scale);
+        SmartPtr<BufferPool> sr_pool = new SoftVideoBufAllocator (sr_info);
+        CHECK_EXP (sr_pool->reserve (2), "reserve super resolution buffers failed");
+
+        SmartPtr<InferStream> out;
+        if (save_output && outs.size () == 1) {
+            out = outs[0];
+            out->set_buf_size (sr_info.width, sr_info.height);
+            CHECK (out->estimate_file_format (),
+                   "%s: estimate file format failed", out->get_file_name ());
+            CHECK (out->open_writer ("wb"), "open output file(%s) failed", out->get_file_name ());
+        }
+
+        do {
+            if (ins[0]->read_buf() == XCAM_RETURN_BYPASS)
+                break;
+
+            SmartPtr<VideoBuffer> sr_buf = sr_pool->get_buffer (sr_pool);
+            CHECK (
+                super_res->process_tiled (ins[0]->get_buf (), sr_buf, tile_overlap),
+                "tiled super resolution failed!");
+
+            if (out.ptr ()) {
+                out->get_buf () = sr_buf;
+                write_out_image (out);
+            }
+        } while (true);
+    } else if (process_video && DnnInferObjectDetection == infer_config.model_type && roi_refresh >= 0) {
+        DnnRoiConfig roi_config;
+        roi_config.refresh_interval = (uint32_t)roi_refresh;
+        DnnRoiDetector roi_detector (infer_engine.dynamic_cast_ptr<DnnObjectDetection> (), roi_config);
+
+        do {
+            if (ins[0]->read_buf() == XCAM_RETURN_BYPASS)
+                break;
+
+            std::vector<Vec4i> boxes;
+            std::vector<int32_t> classes;
+            SmartPtr<VideoBuffer> buf = ins[0]->get_buf ();
+            CHECK (
+                roi_detector.detect (buf, boxes, classes),
+                "roi detection failed!");
+            XCAM_LOG_DEBUG ("frame inferred on %d rois, %d objects",
+                            (uint32_t)roi_detector.get_rois ().size (), (uint32_t)boxes.size ());
+
+            if (save_output && outs.size () == 1) {
+                const VideoBufferInfo &info = buf->get_video_info ();
+                uint8_t* detect_image = buf->map ();
+                CHECK (
+                    XCamDNN::draw_bounding_boxes (detect_image, info.width, info.height,
+                                                  DnnInferImageFormatRGBPacked, boxes, classes),
+                    "Draw bounding boxes failed!" );
+                buf->unmap ();
+
+                outs[0]->get_buf () = buf;
+                write_out_image (outs[0]);
+            }
+        } while (true);
+    } else if (process_video && DnnInferObjectDetection == infer_config.model_type && batch_size > 1) {
+        // frames of a batch_size camera rig are simulated by one video, frame N from camera N % batch_size
+        SmartPtr<DetectCallback> callback = new DetectCallback;
+        DnnBatchDetector batcher (infer_engine.dynamic_cast_ptr<DnnObjectDetection> ());
+        batcher.set_callback (callback);
+        CHECK (batcher.start (), "start batch detector failed!");
+
+        SmartPtr<InferStream> out;
+        if (save_output && outs.size () == 1)
+            out = outs[0];
+
+        uint32_t source = 0;
+        do {
+            if (ins[0]->read_buf() == XCAM_RETURN_BYPASS)
+                break;
+
+            callback->add_frame (ins[0]->get_buf ());
+            CHECK (
+                batcher.push_frame (source, ins[0]->get_buf ()),
+                "push frame failed!");
+            source = (source + 1) % batch_size;
+
+            callback->write_frames (out);
+        } while (true);
+
+        CHECK (batcher.stop (), "stop batch detector failed!");
+        callback->write_frames (out);
+    } else if (process_video && DnnInferObjectDetection == infer_config.model_type && infer_config.infer_requests > 1) {
+        // frame N+1 is preprocessed while frame N is inferring
+        SmartPtr<DetectCallback> callback = new DetectCallback;
+        infer_engine->set_callback (callback);
+
+        SmartPtr<InferStream> out;
+        if (save_output && outs.size () == 1)
+            out = outs[0];
+
+        do {
+            if (ins[0]->read_buf() == XCAM_RETURN_BYPASS)
+                break;
+
+            VideoBufferList detect_buffers;
+            detect_buffers.push_back (ins[0]->get_buf ());
+            CHECK (
+                infer_engine->submit (detect_buffers, callback->add_frame (ins[0]->get_buf ())),
+                "submit frame failed!");
+
+            callback->write_frames (out);
+        } while (true);
+
+        infer_engine->wait_all ();
+        callback->write_frames (out);
+    } else if (process_video && DnnInferObjectDetection == infer_config.model_type) {
         do {
             if (ins[0]->read_buf() == XCAM_RETURN_BYPASS)
                 break;
@@ -25,10 +25,24 @@
 #include "test_sv_params.h"
 
 #include <soft/soft_video_buf_allocator.h>
+#include <soft/soft_blender.h>
+#include <soft/soft_fastmap_task.h>
+#include <soft/soft_simd_priv.h>
+#include <soft/soft_stitcher.h>
+#include <work_stealing_pool.h>
 #include <interface/blender.h>
 #include <interface/geo_mapper.h>
 #include <interface/stitcher.h>
 #include <fisheye_dewarp.h>
+#include <sys/time.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #define MAP_WIDTH 3
 #define MAP_HEIGHT 4
@@ -231,7 +245,14 @@ using namespace XCam;
 enum SoftType {
     SoftTypeNone    = 0,
     SoftTypeBlender,
-    SoftTypeRemap
+    SoftTypeRemap,
+    SoftTypeFastmap,
+    SoftTypeBufBench,
+    SoftTypeBufPolicy,
+    SoftTypeBufExport,
+    SoftTypeFusedMap,
+    SoftTypeSimd,
+    SoftTypeTiledBlend
 };
 
 #define TEST_MAP_FACTOR_X  16
@@ -313,11 +334,786 @@ set_map_table (SmartPtr<GeoMapper> mapper, uint32_t stitch_width, uint32_t stitc
     mapper->set_lookup_table (map_table.data (), table_width, table_height);
 }
 
+static SmartPtr<Blender>
+create_blender (
+    uint32_t input_width, uint32_t input_height, uint32_t output_width, uint32_t output_height,
+    uint32_t pyr_levels, bool tiled, uint32_t band_rows, bool fixed_point)
+{
+    SmartPtr<Blender> blender = Blender::create_soft_blender ();
+    XCAM_ASSERT (blender.ptr ());
+    blender->set_output_size (output_width, output_height);
+
+    SmartPtr<SoftBlender> soft_blender = blender.dynamic_cast_ptr<SoftBlender> ();
+    XCAM_ASSERT (soft_blender.ptr ());
+    if (!soft_blender->set_pyr_levels (pyr_levels) ||
+            !soft_blender->set_tiled_mode (tiled, band_rows) ||
+            !soft_blender->set_fixed_point (fixed_point))
+        return NULL;
+
+    Rect area;
+    area.pos_x = 0;
+    area.pos_y = 0;
+    area.width = output_width;
+    area.height = output_height;
+    blender->set_merge_window (area);
+    area.pos_x = 0;
+    area.pos_y = 0;
+    area.width = input_width;
+    area.height = input_height;
+    blender->set_input_merge_area (area, 0);
+    area.pos_x = 0;
+    area.pos_y = 0;
+    area.width = input_width;
+    area.height = input_height;
+    blender->set_input_merge_area (area, 1);
+
+    return blender;
+}
+
+// psnr of plane @index, compares width * bytes of each row
+static XCamReturn
+calculate_psnr (
+    const SmartPtr<VideoBuffer> &cur, const SmartPtr<VideoBuffer> &ref, uint32_t index, float &psnr)
+{
+    const VideoBufferInfo &cur_info = cur->get_video_info ();
+    const VideoBufferInfo &ref_info = ref->get_video_info ();
+    VideoBufferPlanarInfo planar;
+    cur_info.get_planar_info (planar, index);
+    uint32_t row_bytes = planar.width * planar.pixel_bytes;
+
+    uint8_t *cur_mem = cur->map ();
+    uint8_t *ref_mem = ref->map ();
+    if (!cur_mem || !ref_mem) {
+        XCAM_LOG_ERROR ("calculate_psnr map buffer failed");
+        return XCAM_RETURN_ERROR_MEM;
+    }
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < planar.height; i++) {
+        const uint8_t *cur_line = cur_mem + cur_info.offsets[index] + i * cur_info.strides[index];
+        const uint8_t *ref_line = ref_mem + ref_info.offsets[index] + i * ref_info.strides[index];
+        for (uint32_t j = 0; j < row_bytes; j++) {
+            int32_t diff = (int32_t)cur_line[j] - (int32_t)ref_line[j];
+            sum += diff * diff;
+        }
+    }
+    float mse = (float) sum / (planar.height * row_bytes) + 0.000001f;
+    psnr = 10 * log10 (255 * 255 / mse);
+
+    cur->unmap ();
+    ref->unmap ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+// smooth synthetic warp inside input image, differs per input
+static void
+gen_fastmap_coords (Float2Image &coords, uint32_t in_w, uint32_t in_h, uint32_t idx)
+{
+    float scale_x = (in_w - 2.0f) / coords.get_width ();
+    float scale_y = (in_h - 2.0f) / coords.get_height ();
+    for (uint32_t y = 0; y < coords.get_height (); ++y) {
+        Float2 *line = coords.get_buf_ptr (0, y);
+        for (uint32_t x = 0; x < coords.get_width (); ++x) {
+            if (idx == 0) {
+                line[x].x = x * scale_x + 0.3f + 0.25f * sinf (y * 0.05f);
+                line[x].y = y * scale_y + 0.4f;
+            } else {
+                line[x].x = x * scale_x + 0.7f + 0.2f * cosf (x * 0.03f);
+                line[x].y = y * scale_y + 0.55f + 0.3f * sinf (x * 0.02f);
+            }
+        }
+    }
+}
+
+// bilinear sampling of shader_fastmap_blend_*.comp.sl, normalized value of byte (x, y) in @step bytes pixels
+static float
+gl_fastmap_sample (const uint8_t *buf, uint32_t pitch, uint32_t step, float x, float y)
+{
+    uint32_t x00 = (uint32_t)x, y00 = (uint32_t)y;
+    float fract_x = x - floorf (x), fract_y = y - floorf (y);
+    const uint8_t *l0 = buf + y00 * pitch + x00 * step;
+    const uint8_t *l1 = l0 + pitch;
+    return (l0[0] / 255.0f) * ((1.0f - fract_x) * (1.0f - fract_y)) + (l0[step] / 255.0f) * (fract_x * (1.0f - fract_y)) +
+           (l1[0] / 255.0f) * ((1.0f - fract_x) * fract_y) + (l1[step] / 255.0f) * (fract_x * fract_y);
+}
+
+static uint8_t
+gl_pack_unorm (float v)
+{
+    return (uint8_t) roundf (XCAM_CLAMP (v, 0.0f, 1.0f) * 255.0f);
+}
+
+// compares out with shader math, returns max diff of plane @index
+static uint32_t
+check_fastmap_plane (
+    const SmartPtr<VideoBuffer> &in0, const SmartPtr<VideoBuffer> &in1, const SmartPtr<VideoBuffer> &out,
+    const SmartPtr<Float2Image> *coords, const uint8_t *mask, uint32_t index, uint32_t &mismatch)
+{
+    const SmartPtr<VideoBuffer> in[2] = {in0, in1};
+    const uint8_t *in_mem[2];
+    uint32_t in_pitch[2];
+    for (uint32_t k = 0; k < 2; ++k) {
+        const VideoBufferInfo &info = in[k]->get_video_info ();
+        in_mem[k] = in[k]->map () + info.offsets[index];
+        in_pitch[k] = info.strides[index];
+    }
+    const VideoBufferInfo &out_info = out->get_video_info ();
+    const uint8_t *out_mem = out->map () + out_info.offsets[index];
+
+    // NV12, luma samples all pixels, uv samples at even luma position of even row
+    const uint32_t ratio = index ? 2 : 1;
+    const uint32_t pixel_bytes = ratio;
+    uint32_t max_diff = 0;
+    mismatch = 0;
+    for (uint32_t y = 0; y < out_info.height / ratio; ++y) {
+        for (uint32_t x = 0; x < out_info.width / ratio; ++x) {
+            float m = mask[x * ratio] / 255.0f;
+            for (uint32_t c = 0; c < pixel_bytes; ++c) {
+                float v[2];
+                for (uint32_t k = 0; k < 2; ++k) {
+                    Float2 pos = coords[k]->read_data (x * ratio, y * ratio) / (float)ratio;
+                    v[k] = gl_fastmap_sample (in_mem[k] + c, in_pitch[k], pixel_bytes, pos.x, pos.y);
+                }
+                uint8_t ref = gl_pack_unorm ((v[0] - v[1]) * m + v[1]);
+                uint8_t cur = out_mem[y * out_info.strides[index] + x * pixel_bytes + c];
+                uint32_t diff = abs ((int32_t)ref - (int32_t)cur);
+                max_diff = XCAM_MAX (max_diff, diff);
+                mismatch += (diff != 0);
+            }
+        }
+    }
+
+    in0->unmap ();
+    in1->unmap ();
+    out->unmap ();
+    return max_diff;
+}
+
+// counts user space dTLB read misses, invalid if perf events are not permitted
+class DtlbMissCounter {
+public:
+    DtlbMissCounter () : _fd (-1) {
+#if defined(__linux__)
+        struct perf_event_attr attr;
+        xcam_mem_clear (attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof (attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~DtlbMissCounter () {
+        if (_fd >= 0)
+            close (_fd);
+    }
+
+    bool is_valid () const {
+        return _fd >= 0;
+    }
+    void start () {
+#if defined(__linux__)
+        if (_fd >= 0) {
+            ioctl (_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl (_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    uint64_t stop () {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (_fd >= 0) {
+            ioctl (_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read (_fd, &count, sizeof (count)) != sizeof (count))
+                count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int _fd;
+};
+
+// chains NV12 buffers like stitcher stages, each stage copies the previous one in
+// 64-byte column strips, which touches a new row (page) on every access like remap does
+static int
+run_buf_bench (uint32_t width, uint32_t height, int loop, bool arena)
+{
+    const uint32_t stage_count = 6;
+    const uint32_t strip_bytes = 64;
+
+    SoftVideoBufAllocator::set_arena_mode (arena);
+    VideoBufferInfo info;
+    info.init (V4L2_PIX_FMT_NV12, width, height);
+
+    SmartPtr<VideoBuffer> bufs[stage_count];
+    uint8_t *mem[stage_count];
+    for (uint32_t i = 0; i < stage_count; ++i) {
+        SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (info);
+        CHECK_EXP (pool->reserve (1), "reserve buffer pool failed");
+        bufs[i] = pool->get_buffer ();
+        CHECK_EXP (bufs[i].ptr (), "get buffer failed");
+        mem[i] = bufs[i]->map ();
+        memset (mem[i], i, bufs[i]->get_video_info ().size);
+    }
+
+    const VideoBufferInfo &buf_info = bufs[0]->get_video_info ();
+    const uint32_t pitch = buf_info.strides[0];
+    const uint32_t rows = buf_info.aligned_height * 3 / 2;
+    const uint32_t line_bytes = XCAM_ALIGN_DOWN (width, strip_bytes);
+    uint32_t aligned_strips = 0;
+    for (uint32_t i = 0; i < stage_count; ++i)
+        aligned_strips += ((uintptr_t)mem[i] % strip_bytes == 0 && pitch % strip_bytes == 0);
+
+    DtlbMissCounter dtlb;
+    struct timeval start, end;
+    gettimeofday (&start, NULL);
+    dtlb.start ();
+    for (int n = 0; n < loop; ++n) {
+        for (uint32_t i = 1; i < stage_count; ++i) {
+            for (uint32_t x = 0; x < line_bytes; x += strip_bytes) {
+                for (uint32_t y = 0; y < rows; ++y)
+                    memcpy (mem[i] + y * pitch + x, mem[i - 1] + y * pitch + x, strip_bytes);
+            }
+        }
+    }
+    uint64_t misses = dtlb.stop ();
+    gettimeofday (&end, NULL);
+
+    double sec = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+    double bytes = (double)line_bytes * rows * (stage_count - 1) * loop;
+    printf ("%s buffers: pitch %d, %d/%d stages 64-byte aligned, %.3f s, %.1f MB/s",
+            arena ? "arena" : "heap", pitch, aligned_strips, stage_count, sec, bytes / sec / (1024.0 * 1024.0));
+    if (dtlb.is_valid ())
+        printf (", dTLB read misses %" PRIu64 "\n", misses);
+    else
+        printf (", dTLB read misses n/a\n");
+
+    for (uint32_t i = 0; i < stage_count; ++i)
+        bufs[i]->unmap ();
+    SoftVideoBufAllocator::set_arena_mode (false);
+    return 0;
+}
+
+// drops the oldest pending buffer each time pool runs dry, like a real-time sink shedding frames
+class DropOldestCallback
+    : public BufferPool::Callback
+{
+public:
+    explicit DropOldestCallback (VideoBufferList &pending)
+        : _pending (pending)
+        , _dry_count (0)
+    {}
+
+    virtual void buffer_dry (BufferPool *pool) {
+        XCAM_UNUSED (pool);
+        ++_dry_count;
+        if (!_pending.empty ())
+            _pending.pop_front ();
+    }
+
+    uint32_t get_dry_count () const {
+        return _dry_count;
+    }
+
+private:
+    VideoBufferList    &_pending;
+    uint32_t            _dry_count;
+};
+
+static int
+run_buf_policy (uint32_t width, uint32_t height)
+{
+    const int32_t timeout = 20000;
+
+    VideoBufferInfo info;
+    info.init (V4L2_PIX_FMT_NV12, width, height);
+    SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (info);
+    CHECK_EXP (pool->reserve (2), "reserve buffer pool failed");
+
+    VideoBufferList pending;
+    for (uint32_t i = 0; i < 2; ++i) {
+        pending.push_back (pool->get_buffer ());
+        CHECK_EXP (pending.back ().ptr (), "get buffer failed");
+    }
+
+    CHECK_EXP (pool->set_acquire_policy (BufferPool::AcquireFailFast), "set fail-fast policy failed");
+    CHECK_EXP (!pool->get_buffer ().ptr (), "fail-fast policy got buffer from drained pool");
+
+    CHECK_EXP (pool->set_acquire_policy (BufferPool::AcquireBlock, 0, timeout), "set block policy failed");
+    struct timeval start, end;
+    gettimeofday (&start, NULL);
+    SmartPtr<VideoBuffer> buf = pool->get_buffer ();
+    gettimeofday (&end, NULL);
+    int32_t waited = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
+    CHECK_EXP (!buf.ptr () && waited >= timeout / 2, "timed get buffer returned after %dus", waited);
+    CHECK_EXP (!pool->try_get_buffer (pool).ptr (), "try get buffer got buffer from drained pool");
+
+    CHECK_EXP (pool->set_acquire_policy (BufferPool::AcquireGrow, 3), "set grow policy failed");
+    pending.push_back (pool->get_buffer ());
+    CHECK_EXP (pending.back ().ptr (), "grow policy failed to allocate buffer");
+    CHECK_EXP (!pool->try_get_buffer (pool).ptr (), "grow policy exceeded grow count");
+
+    SmartPtr<DropOldestCallback> callback = new DropOldestCallback (pending);
+    pool->set_callback (callback);
+    CHECK_EXP (pool->set_acquire_policy (BufferPool::AcquireBlock, 0, timeout), "set block policy failed");
+    for (uint32_t i = 0; i < 4; ++i) {
+        buf = pool->get_buffer ();
+        CHECK_EXP (buf.ptr (), "block policy with dry callback failed to get buffer");
+        pending.push_back (buf);
+    }
+    buf.release ();
+    CHECK_EXP (callback->get_dry_count () == 4 && pending.size () == 3,
+               "drop-oldest dry count:%d, pending buffers:%d", callback->get_dry_count (), (int)pending.size ());
+    pool->set_callback (NULL);
+
+    printf ("buffer policy: fail-fast, timed block, grow and dropping by dry callback passed\n");
+    return 0;
+}
+
+static SmartPtr<VideoBuffer>
+create_stitch_frame (uint32_t width, uint32_t height, uint32_t seed = 0)
+{
+    VideoBufferInfo info;
+    info.init (V4L2_PIX_FMT_NV12, width, height);
+    SmartPtr<BufferPool> pool = new SoftVideoBufAllocator (info);
+    XCAM_FAIL_RETURN (ERROR, pool->reserve (1), NULL, "reserve %dx%d frame failed", width, height);
+    SmartPtr<VideoBuffer> buf = pool->get_buffer ();
+    XCAM_FAIL_RETURN (ERROR, buf.ptr (), NULL, "get %dx%d frame failed", width, height);
+
+    const VideoBufferInfo &buf_info = buf->get_video_info ();
+    uint8_t *mem = buf->map ();
+    for (uint32_t y = 0; y < buf_info.aligned_height; ++y) {
+        uint8_t *luma = mem + buf_info.offsets[0] + y * buf_info.strides[0];
+        for (uint32_t x = 0; x < buf_info.aligned_width; ++x)
+            luma[x] = (uint8_t)(x * 3 + y * 5 + ((x * y) >> 7) + seed * ((x ^ y) & 0x3F));
+    }
+    for (uint32_t y = 0; y < buf_info.aligned_height / 2; ++y) {
+        uint8_t *uv = mem + buf_info.offsets[1] + y * buf_info.strides[1];
+        for (uint32_t x = 0; x < buf_info.aligned_width; ++x)
+            uv[x] = (uint8_t)(128 + ((x + y + seed) & 0x1F) - 16);
+    }
+    buf->unmap ();
+    return buf;
+}
+
+// mismatched bytes of NV12 frames in width of each row
+static uint32_t
+count_mismatch (const SmartPtr<VideoBuffer> &buf0, const SmartPtr<VideoBuffer> &buf1)
+{
+    const VideoBufferInfo &info0 = buf0->get_video_info ();
+    const VideoBufferInfo &info1 = buf1->get_video_info ();
+    XCAM_ASSERT (info0.width == info1.width && info0.height == info1.height);
+
+    uint8_t *mem0 = buf0->map ();
+    uint8_t *mem1 = buf1->map ();
+    uint32_t mismatch = 0;
+    for (uint32_t plane = 0; plane < 2; ++plane) {
+        uint32_t rows = plane ? info0.height / 2 : info0.height;
+        for (uint32_t y = 0; y < rows; ++y) {
+            const uint8_t *a = mem0 + info0.offsets[plane] + y * info0.strides[plane];
+            const uint8_t *b = mem1 + info1.offsets[plane] + y * info1.strides[plane];
+            for (uint32_t x = 0; x < info0.width; ++x)
+                mismatch += (a[x] != b[x]);
+        }
+    }
+    buf0->unmap ();
+    buf1->unmap ();
+    return mismatch;
+}
+
+static SmartPtr<VideoBuffer>
+stitch_dual_fisheye (const SmartPtr<VideoBuffer> &in_buf, uint32_t width, uint32_t height, bool fused_map, int loop)
+{
+    SmartPtr<SoftStitcher> soft_stitcher = new SoftStitcher ();
+    soft_stitcher->set_fused_map (fused_map);
+    SmartPtr<Stitcher> stitcher = soft_stitcher;
+    stitcher->set_camera_num (2);
+    stitcher->set_output_size (width, height);
+    stitcher->set_dewarp_mode (DewarpSphere);
+    stitcher->set_blend_pyr_levels (2);
+
+    float vp_range[XCAM_STITCH_FISHEYE_MAX_NUM];
+    stitcher->set_viewpoints_range (viewpoints_range (CamA2C1080P, vp_range));
+    StitchInfo info = stitch_info (CamA2C1080P, ScopicMono);
+    get_fisheye_info (CamA2C1080P, ScopicMono, info.fisheye_info);
+    stitcher->set_stitch_info (info);
+
+    VideoBufferList in_bufs;
+    in_bufs.push_back (in_buf);
+    SmartPtr<VideoBuffer> out_buf;
+    for (int i = 0; i < loop; ++i) {
+        out_buf.release ();
+        XCamReturn ret = stitcher->stitch_buffers (in_bufs, out_buf);
+        XCAM_FAIL_RETURN (
+            ERROR, xcam_ret_is_ok (ret) && out_buf.ptr (), NULL,
+            "stitch with fused map %s failed", fused_map ? "on" : "off");
+    }
+    return out_buf;
+}
+
+// remapping copy areas straight into output must give the same frame as copying them from geomap buffers
+static int
+run_fused_map (int loop)
+{
+    const uint32_t in_width = 1920, in_height = 960;
+    const uint32_t out_width = 1920, out_height = 640;
+
+    SmartPtr<VideoBuffer> in_buf = create_stitch_frame (in_width, in_height);
+    CHECK_EXP (in_buf.ptr (), "create stitch input failed");
+    SmartPtr<VideoBuffer> fused = stitch_dual_fisheye (in_buf, out_width, out_height, true, loop);
+    SmartPtr<VideoBuffer> unfused = stitch_dual_fisheye (in_buf, out_width, out_height, false, loop);
+    CHECK_EXP (fused.ptr () && unfused.ptr (), "stitch dual fisheye failed");
+
+    uint32_t mismatch = count_mismatch (fused, unfused);
+    printf ("fused map vs copy path: %d mismatched bytes of %dx%d NV12\n", mismatch, out_width, out_height);
+    CHECK_EXP (!mismatch, "fused map output differs from copy path");
+    return 0;
+}
+
+#define SIMD_CHECK_ROUNDS 4096
+
+static uint32_t simd_rand_state = 1;
+
+static uint32_t
+simd_rand ()
+{
+    simd_rand_state = simd_rand_state * 1664525u + 1013904223u;
+    return simd_rand_state >> 8;
+}
+
+// uniform in [min, max), every 8th value on a half step to hit rounding ties
+static float
+simd_rand_float (float min, float max, uint32_t i)
+{
+    if (i % 8 == 7)
+        return (float)((int32_t)(min + (max - min) * (simd_rand () & 0xFF) / 256.0f)) + 0.5f;
+    return min + (max - min) * (simd_rand () & 0xFFFF) / 65536.0f;
+}
+
+// positions on the whole image, kernels reject the ones near the border
+static void
+simd_rand_pos (uint32_t width, uint32_t height, Float2 *pos, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        pos[i].x = simd_rand_float (0.0f, (float)width, i);
+        pos[i].y = simd_rand_float (0.0f, (float)height, i + 1);
+    }
+}
+
+template <typename T>
+static void
+simd_fill_image (SoftImage<T> &image, float min, float max);
+
+template <>
+void
+simd_fill_image (UcharImage &image, float, float)
+{
+    for (uint32_t y = 0; y < image.get_height (); ++y)
+        for (uint32_t x = 0; x < image.get_width (); ++x)
+            *image.get_buf_ptr (x, y) = (Uchar)simd_rand ();
+}
+
+template <>
+void
+simd_fill_image (Float2Image &image, float min, float max)
+{
+    for (uint32_t y = 0; y < image.get_height (); ++y)
+        for (uint32_t x = 0; x < image.get_width (); ++x)
+            *image.get_buf_ptr (x, y) = Float2 (simd_rand_float (min, max, x), simd_rand_float (min, max, y));
+}
+
+template <>
+void
+simd_fill_image (Short2Image &image, float, float)
+{
+    for (uint32_t y = 0; y < image.get_height (); ++y)
+        for (uint32_t x = 0; x < image.get_width (); ++x)
+            *image.get_buf_ptr (x, y) = Short2 ((int16_t)simd_rand (), (int16_t)simd_rand ());
+}
+
+// every kernel of @level against the scalar path on random data, bit for bit
+static int
+check_simd_kernels (XCamSoftSimd::SimdLevel level)
+{
+    const XCamSoftSimd::SimdKernels &scalar = XCamSoftSimd::get_kernels (XCamSoftSimd::SimdScalar);
+    const XCamSoftSimd::SimdKernels &simd = XCamSoftSimd::get_kernels (level);
+    const char *name = XCamSoftSimd::get_simd_level_name (level);
+
+    // odd sizes, so that rows have no aligned pitch
+    UcharImage luma0 (37, 23), luma1 (41, 19);
+    Float2Image table (29, 17);
+    Short2Image compact (31, 13);
+    simd_fill_image (luma0, 0.0f, 0.0f);
+    simd_fill_image (luma1, 0.0f, 0.0f);
+    simd_fill_image (table, -512.0f, 4096.0f);
+    simd_fill_image (compact, 0.0f, 0.0f);
+
+    uint32_t interp_count = 0;
+    for (uint32_t round = 0; round < SIMD_CHECK_ROUNDS; ++round) {
+        Uchar in0[8], in1[8], mask[8], orig[8];
+        float in[8], gauss[8], lap[8], up_sample[8];
+        for (uint32_t i = 0; i < 8; ++i) {
+            in0[i] = (Uchar)simd_rand ();
+            in1[i] = (Uchar)simd_rand ();
+            mask[i] = (round % 16 == 0) ? (i % 2 ? 255 : 0) : (Uchar)simd_rand ();
+            orig[i] = (Uchar)simd_rand ();
+            in[i] = simd_rand_float (-64.0f, 320.0f, i);
+            gauss[i] = simd_rand_float (0.0f, 255.0f, i);
+            lap[i] = simd_rand_float (0.0f, 255.0f, i);
+            up_sample[i] = simd_rand_float (0.0f, 255.0f, i);
+        }
+
+        float mask_ref[8], mask_out[8], blend_ref[8], blend_out[8];
+        scalar.blend_8 (in0, in1, mask, mask_ref, blend_ref);
+        simd.blend_8 (in0, in1, mask, mask_out, blend_out);
+        CHECK_EXP (
+            !memcmp (mask_ref, mask_out, sizeof (mask_ref)) && !memcmp (blend_ref, blend_out, sizeof (blend_ref)),
+            "%s blend_8 differs from scalar in round %d", name, round);
+
+        Uchar ref[8], out[8];
+        scalar.convert_8 (in, ref);
+        simd.convert_8 (in, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s convert_8 differs from scalar in round %d", name, round);
+
+        scalar.laplace_8 (orig, gauss, ref);
+        simd.laplace_8 (orig, gauss, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s laplace_8 differs from scalar in round %d", name, round);
+
+        scalar.reconstruct_8 (lap, up_sample, ref);
+        simd.reconstruct_8 (lap, up_sample, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s reconstruct_8 differs from scalar in round %d", name, round);
+
+        // fixed-point kernels, up-sampled gauss in Q2 covers [0, 255 * 4]
+        int16_t up_q2[8];
+        Uchar gauss_rows[5][24];
+        const Uchar *rows[5];
+        for (uint32_t i = 0; i < 8; ++i)
+            up_q2[i] = (int16_t)(simd_rand () % 1021);
+        for (uint32_t k = 0; k < 5; ++k) {
+            for (uint32_t i = 0; i < 24; ++i)
+                gauss_rows[k][i] = (round % 16 == 1) ? 255 : (Uchar)simd_rand ();
+            rows[k] = gauss_rows[k];
+        }
+
+        scalar.blend_fixed_8 (in0, in1, mask, ref);
+        simd.blend_fixed_8 (in0, in1, mask, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s blend_fixed_8 differs from scalar in round %d", name, round);
+
+        scalar.laplace_fixed_8 (orig, up_q2, ref);
+        simd.laplace_fixed_8 (orig, up_q2, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s laplace_fixed_8 differs from scalar in round %d", name, round);
+
+        scalar.reconstruct_fixed_8 (in0, in1, mask, up_q2, ref);
+        simd.reconstruct_fixed_8 (in0, in1, mask, up_q2, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s reconstruct_fixed_8 differs from scalar in round %d", name, round);
+
+        scalar.gauss_fixed_8 (rows, ref);
+        simd.gauss_fixed_8 (rows, out);
+        CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s gauss_fixed_8 differs from scalar in round %d", name, round);
+
+        // interp kernels are checked against the border-checked scalar path of the tasks
+        Float2 pos[8], pos1[8];
+        uint32_t count = (round % 2) ? 4 : 8;
+        simd_rand_pos (luma0.get_width (), luma0.get_height (), pos, 8);
+        if (simd.interp_uchar (&luma0, pos, count, out)) {
+            float value[8];
+            if (count == 4)
+                luma0.read_interpolate_array<float, 4> (pos, value);
+            else
+                luma0.read_interpolate_array<float, 8> (pos, value);
+            convert_to_uchar_N<float, 8> (value, ref);
+            CHECK_EXP (!memcmp (ref, out, count), "%s interp_uchar of %d differs from scalar in round %d", name, count, round);
+            ++interp_count;
+        }
+
+        Float2 pos_ref[8], pos_out[8];
+        simd_rand_pos (table.get_width (), table.get_height (), pos, 8);
+        if (simd.interp_float2_8 (&table, pos, pos_out)) {
+            table.read_interpolate_array<Float2, 8> (pos, pos_ref);
+            CHECK_EXP (!memcmp (pos_ref, pos_out, sizeof (pos_ref)), "%s interp_float2_8 differs from scalar in round %d", name, round);
+            ++interp_count;
+        }
+
+        const float scale = 1.0f / 16.0f;
+        simd_rand_pos (compact.get_width (), compact.get_height (), pos, 8);
+        if (simd.interp_short2_8 (&compact, pos, scale, pos_out)) {
+            compact.read_interpolate_array<Float2, 8> (pos, pos_ref);
+            for (uint32_t i = 0; i < 8; ++i)
+                pos_ref[i] *= scale;
+            CHECK_EXP (!memcmp (pos_ref, pos_out, sizeof (pos_ref)), "%s interp_short2_8 differs from scalar in round %d", name, round);
+            ++interp_count;
+        }
+
+        simd_rand_pos (luma0.get_width (), luma0.get_height (), pos, 8);
+        simd_rand_pos (luma1.get_width (), luma1.get_height (), pos1, 8);
+        if (simd.fastmap_blend_8 (&luma0, pos, &luma1, pos1, mask, out)) {
+            for (uint32_t i = 0; i < 8; ++i) {
+                float v0 = luma0.read_interpolate_data<float> (pos[i].x, pos[i].y);
+                float v1 = luma1.read_interpolate_data<float> (pos1[i].x, pos1[i].y);
+                ref[i] = convert_to_uchar ((v0 - v1) * (mask[i] / 255.0f) + v1);
+            }
+            CHECK_EXP (!memcmp (ref, out, sizeof (ref)), "%s fastmap_blend_8 differs from scalar in round %d", name, round);
+            ++interp_count;
+        }
+    }
+    CHECK_EXP (interp_count > SIMD_CHECK_ROUNDS, "%s interp kernels took too few positions:%d", name, interp_count);
+    return 0;
+}
+
+// blends frames whose pyramid rows end in tails shorter than a kernel in float and fixed point and stitches dual fisheye
+// through geomap lookup with every simd level, outputs must equal scalar ones
+static int
+run_simd (int loop)
+{
+    XCamSoftSimd::SimdLevel max_level = XCamSoftSimd::get_simd_level ();
+    const uint32_t blend_width = 1000, blend_height = 560;
+    SmartPtr<VideoBuffer> blend_in0 = create_stitch_frame (blend_width, blend_height);
+    SmartPtr<VideoBuffer> blend_in1 = create_stitch_frame (blend_width, blend_height, 1);
+    SmartPtr<VideoBuffer> stitch_in = create_stitch_frame (1920, 960);
+    CHECK_EXP (blend_in0.ptr () && blend_in1.ptr () && stitch_in.ptr (), "create simd check inputs failed");
+
+    SmartPtr<VideoBuffer> blend_ref, fixed_ref, stitch_ref;
+    for (int level = XCamSoftSimd::SimdScalar; level <= max_level; ++level) {
+        XCamSoftSimd::SimdLevel cur = (XCamSoftSimd::SimdLevel)level;
+        const char *name = XCamSoftSimd::get_simd_level_name (cur);
+        CHECK_EXP (XCamSoftSimd::set_simd_level (cur) == cur, "set simd level %s failed", name);
+        if (cur != XCamSoftSimd::SimdScalar)
+            CHECK_EXP (check_simd_kernels (cur) == 0, "%s kernels check failed", name);
+
+        SmartPtr<Blender> blender = create_blender (
+            blend_width, blend_height, blend_width, blend_height, 2, false, XCAM_SOFT_BLENDER_BAND_ROWS, false);
+        CHECK_EXP (blender.ptr (), "create blender failed");
+        SmartPtr<Blender> fixed_blender = create_blender (
+            blend_width, blend_height, blend_width, blend_height, 2, false, XCAM_SOFT_BLENDER_BAND_ROWS, true);
+        CHECK_EXP (fixed_blender.ptr (), "create fixed-point blender failed");
+        SmartPtr<VideoBuffer> blend_out, fixed_out;
+        for (int i = 0; i < loop; ++i) {
+            blend_out.release ();
+            fixed_out.release ();
+            CHECK (blender->blend (blend_in0, blend_in1, blend_out), "%s blend failed", name);
+            CHECK (fixed_blender->blend (blend_in0, blend_in1, fixed_out), "%s fixed-point blend failed", name);
+        }
+        SmartPtr<VideoBuffer> stitch_out = stitch_dual_fisheye (stitch_in, 1920, 640, true, loop);
+        CHECK_EXP (stitch_out.ptr (), "%s stitch failed", name);
+
+        if (cur == XCamSoftSimd::SimdScalar) {
+            blend_ref = blend_out;
+            fixed_ref = fixed_out;
+            stitch_ref = stitch_out;
+            continue;
+        }
+        uint32_t blend_mismatch = count_mismatch (blend_out, blend_ref);
+        uint32_t fixed_mismatch = count_mismatch (fixed_out, fixed_ref);
+        uint32_t stitch_mismatch = count_mismatch (stitch_out, stitch_ref);
+        printf ("simd %s vs scalar: %d mismatched bytes in %dx%d blend, %d in fixed-point blend, %d in 1920x640 stitch\n",
+                name, blend_mismatch, blend_width, blend_height, fixed_mismatch, stitch_mismatch);
+        CHECK_EXP (!blend_mismatch && !fixed_mismatch && !stitch_mismatch, "simd %s output differs from scalar", name);
+    }
+    XCamSoftSimd::set_simd_level (max_level);
+
+    printf ("simd check passed up to %s\n", XCamSoftSimd::get_simd_level_name (max_level));
+    return 0;
+}
+
+// band runners of tiled blend take stages in any order on pool threads, output must equal untiled blend
+static int
+run_tiled_blend (int loop)
+{
+    const uint32_t width = 1000, height = 560;
+    const uint32_t thread_counts[] = {1, 2, 4};
+    const uint32_t band_rows[] = {4, XCAM_SOFT_BLENDER_BAND_ROWS};
+    SmartPtr<VideoBuffer> in0 = create_stitch_frame (width, height);
+    SmartPtr<VideoBuffer> in1 = create_stitch_frame (width, height, 1);
+    CHECK_EXP (in0.ptr () && in1.ptr (), "create tiled blend inputs failed");
+
+    for (uint32_t t = 0; t < sizeof (thread_counts) / sizeof (thread_counts[0]); ++t) {
+        SmartPtr<ThreadPool> pool = new WorkStealingPool ("tiled-blend");
+        pool->set_threads (thread_counts[t], thread_counts[t]);
+        CHECK (pool->start (), "start pool of %d threads failed", thread_counts[t]);
+
+        for (uint32_t levels = 1; levels <= 3; ++levels) {
+            SmartPtr<Blender> blender = create_blender (
+                width, height, width, height, levels, false, XCAM_SOFT_BLENDER_BAND_ROWS, false);
+            CHECK_EXP (blender.ptr (), "create blender failed");
+            SmartPtr<VideoBuffer> ref;
+            CHECK (blender->blend (in0, in1, ref), "untiled blend failed");
+
+            for (uint32_t b = 0; b < sizeof (band_rows) / sizeof (band_rows[0]); ++b) {
+                SmartPtr<Blender> tiled = create_blender (width, height, width, height, levels, true, band_rows[b], false);
+                CHECK_EXP (tiled.ptr (), "create tiled blender failed");
+                tiled.dynamic_cast_ptr<SoftBlender> ()->set_threads (pool);
+                for (int i = 0; i < loop; ++i) {
+                    SmartPtr<VideoBuffer> out;
+                    CHECK (tiled->blend (in0, in1, out), "tiled blend failed");
+                    uint32_t mismatch = count_mismatch (out, ref);
+                    CHECK_EXP (
+                        !mismatch, "tiled blend differs from untiled in %d bytes, threads:%d levels:%d band rows:%d",
+                        mismatch, thread_counts[t], levels, band_rows[b]);
+                }
+            }
+        }
+        pool->stop ();
+        printf ("tiled blend matches untiled blend on %d threads\n", thread_counts[t]);
+    }
+    return 0;
+}
+
+// maps buffer fd again as an importer would and checks it sees the same pixels and a sealed size
+static int
+run_buf_export (uint32_t width, uint32_t height)
+{
+    VideoBufferInfo info;
+    info.init (V4L2_PIX_FMT_NV12, width, height);
+    SmartPtr<SoftVideoBufAllocator> pool = new SoftVideoBufAllocator (info);
+    pool->set_memfd (true);
+    CHECK_EXP (pool->reserve (2), "reserve memfd buffer pool failed");
+
+    SmartPtr<VideoBuffer> buf = pool->get_buffer ();
+    CHECK_EXP (buf.ptr (), "get memfd buffer failed");
+    int fd = buf->get_fd ();
+    CHECK_EXP (fd >= 0, "memfd buffer has no fd");
+
+    const uint32_t size = buf->get_video_info ().size;
+    uint8_t *mem = buf->map ();
+    CHECK_EXP (mem, "map memfd buffer failed");
+    for (uint32_t i = 0; i < size; ++i)
+        mem[i] = (uint8_t)(i * 7);
+
+    uint8_t *imported = (uint8_t *) mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    CHECK_EXP (imported != MAP_FAILED, "import memfd(%d) failed", fd);
+    bool same = (memcmp (mem, imported, size) == 0);
+    munmap (imported, size);
+    buf->unmap ();
+    CHECK_EXP (same, "imported memfd content differs");
+
+#ifdef F_GET_SEALS
+    int seals = fcntl (fd, F_GET_SEALS);
+    CHECK_EXP (seals >= 0 && (seals & F_SEAL_SHRINK) && (seals & F_SEAL_GROW), "memfd(%d) is not sealed", fd);
+    CHECK_EXP (ftruncate (fd, 0) < 0, "sealed memfd(%d) was shrunk", fd);
+#endif
+
+    printf ("buffer export: memfd fd %d, %d bytes shared and sealed\n", fd, size);
+    return 0;
+}
+
 static void usage(const char* arg0)
 {
     printf ("Usage:\n"
             "%s --type TYPE --input0 input.nv12 --input1 input1.nv12 --output output.nv12 ...\n"
-            "\t--type              processing type, selected from: blend, remap\n"
+            "\t--type              processing type, selected from: blend, remap, fastmap\n"
+            "\t                    fastmap: blend two inputs with synthetic coordinates, checked against GL fastmap math\n"
+            "\t                    bufbench: copy --out-w x --out-h NV12 buffers between stages, heap vs arena buffers\n"
+            "\t                    bufpolicy: check buffer pool acquire policies with --out-w x --out-h NV12 buffers\n"
+            "\t                    bufexport: check memfd backed --out-w x --out-h NV12 buffers are shared by fd\n"
+            "\t                    fusedmap: check dual fisheye stitching with fused map matches copy path, --loop frames\n"
+            "\t                    simd: check sse4.1/avx2 kernels, blend and stitch match scalar path bit for bit\n"
+            "\t                    tiledblend: check tiled blend matches untiled blend on several pool sizes\n"
             "\t--cam-model          optional, camera model\n"
             "\t                    select from [cama2c1080p/camb4c1080p/camc3c8k/camd3c8k], default: camb4c1080p\n"
             "\t--input0            input image(NV12)\n"
@@ -329,8 +1125,14 @@ static void usage(const char* arg0)
             "\t--out-h             optional, output height, default: 800\n"
             "\t--save              optional, save file or not, select from [true/false], default: true\n"
             "\t--loop              optional, how many loops need to run, default: 1\n"
+            "\t--pyr-levels        optional, blend pyramid levels, default: 2\n"
+            "\t--tiled             optional, blend pyramid band by band, select from [true/false], default: false\n"
+            "\t--band-rows         optional, rows of each band in tiled blend, default: %d\n"
+            "\t--fixed-point       optional, blend with fixed-point kernels and report PSNR against float path\n"
+            "\t                    select from [true/false], default: false\n"
+            "\t--buf-arena         optional, allocate soft buffers from huge-page arena, select from [true/false], default: false\n"
             "\t--help              usage\n",
-            arg0);
+            arg0, XCAM_SOFT_BLENDER_BAND_ROWS);
 }
 
 int main (int argc, char *argv[])
@@ -349,6 +1151,11 @@ int main (int argc, char *argv[])
 
     int loop = 1;
     bool save_output = true;
+    uint32_t pyr_levels = 2;
+    bool tiled = false;
+    uint32_t band_rows = XCAM_SOFT_BLENDER_BAND_ROWS;
+    bool fixed_point = false;
+    bool buf_arena = false;
 
     const struct option long_opts[] = {
         {"type", required_argument, NULL, 't'},
@@ -363,6 +1170,11 @@ int main (int argc, char *argv[])
         {"out-h", required_argument, NULL, 'H'},
         {"save", required_argument, NULL, 's'},
         {"loop", required_argument, NULL, 'l'},
+        {"pyr-levels", required_argument, NULL, 'P'},
+        {"tiled", required_argument, NULL, 'T'},
+        {"band-rows", required_argument, NULL, 'B'},
+        {"fixed-point", required_argument, NULL, 'X'},
+        {"buf-arena", required_argument, NULL, 'A'},
         {"help", no_argument, NULL, 'e'},
         {NULL, 0, NULL, 0},
     };
@@ -376,6 +1188,20 @@ int main (int argc, char *argv[])
                 type = SoftTypeBlender;
             else if (!strcasecmp (optarg, "remap"))
                 type = SoftTypeRemap;
+            else if (!strcasecmp (optarg, "fastmap"))
+                type = SoftTypeFastmap;
+            else if (!strcasecmp (optarg, "bufbench"))
+                type = SoftTypeBufBench;
+            else if (!strcasecmp (optarg, "bufpolicy"))
+                type = SoftTypeBufPolicy;
+            else if (!strcasecmp (optarg, "bufexport"))
+                type = SoftTypeBufExport;
+            else if (!strcasecmp (optarg, "fusedmap"))
+                type = SoftTypeFusedMap;
+            else if (!strcasecmp (optarg, "simd"))
+                type = SoftTypeSimd;
+            else if (!strcasecmp (optarg, "tiledblend"))
+                type = SoftTypeTiledBlend;
             else {
                 XCAM_LOG_ERROR ("unknown type:%s", optarg);
                 usage (argv[0]);
@@ -430,6 +1256,21 @@ int main (int argc, char *argv[])
         case 'l':
             loop = atoi(optarg);
             break;
+        case 'P':
+            pyr_levels = atoi(optarg);
+            break;
+        case 'T':
+            tiled = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'B':
+            band_rows = atoi(optarg);
+            break;
+        case 'X':
+            fixed_point = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'A':
+            buf_arena = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
         case 'e':
             usage (argv[0]);
             return 0;
@@ -446,6 +1287,41 @@ int main (int argc, char *argv[])
         return -1;
     }
 
+    if (type == SoftTypeBufBench) {
+        printf ("buffer size:\t\t%dx%d\n", output_width, output_height);
+        printf ("loop count:\t\t%d\n", loop);
+        CHECK_EXP (run_buf_bench (output_width, output_height, loop, false) == 0, "heap buffer bench failed");
+        CHECK_EXP (run_buf_bench (output_width, output_height, loop, true) == 0, "arena buffer bench failed");
+        return 0;
+    }
+
+    if (type == SoftTypeBufPolicy) {
+        CHECK_EXP (run_buf_policy (output_width, output_height) == 0, "buffer policy check failed");
+        return 0;
+    }
+
+    if (type == SoftTypeBufExport) {
+        CHECK_EXP (run_buf_export (output_width, output_height) == 0, "buffer export check failed");
+        return 0;
+    }
+
+    if (type == SoftTypeFusedMap) {
+        CHECK_EXP (run_fused_map (loop) == 0, "fused map check failed");
+        return 0;
+    }
+
+    if (type == SoftTypeSimd) {
+        CHECK_EXP (run_simd (loop) == 0, "simd check failed");
+        return 0;
+    }
+
+    if (type == SoftTypeTiledBlend) {
+        CHECK_EXP (run_tiled_blend (loop) == 0, "tiled blend check failed");
+        return 0;
+    }
+
+    SoftVideoBufAllocator::set_arena_mode (buf_arena);
+
     if (ins.empty () || outs.empty () ||
             !strlen (ins[0]->get_file_name ()) || !strlen (outs[0]->get_file_name ())) {
         XCAM_LOG_ERROR ("input or output file name was not set");
@@ -463,6 +1339,7 @@ int main (int argc, char *argv[])
     printf ("output height:\t\t%d\n", output_height);
     printf ("save output:\t\t%s\n", save_output ? "true" : "false");
     printf ("loop count:\t\t%d\n", loop);
+    printf ("buffer arena:\t\t%s\n", buf_arena ? "true" : "false");
 
     XCAM_UNUSED (intrinsic_names);
     XCAM_UNUSED (extrinsic_names);
@@ -482,35 +1359,39 @@ int main (int argc, char *argv[])
     switch (type) {
     case SoftTypeBlender: {
         CHECK_EXP (ins.size () == 2, "blender needs 2 input files.");
-        SmartPtr<Blender> blender = Blender::create_soft_blender ();
-        XCAM_ASSERT (blender.ptr ());
-        blender->set_output_size (output_width, output_height);
-
-        Rect area;
-        area.pos_x = 0;
-        area.pos_y = 0;
-        area.width = output_width;
-        area.height = output_height;
-        blender->set_merge_window (area);
-        area.pos_x = 0;
-        area.pos_y = 0;
-        area.width = input_width;
-        area.height = input_height;
-        blender->set_input_merge_area (area, 0);
-        area.pos_x = 0;
-        area.pos_y = 0;
-        area.width = input_width;
-        area.height = input_height;
-        blender->set_input_merge_area (area, 1);
+        SmartPtr<Blender> blender = create_blender (
+            input_width, input_height, output_width, output_height, pyr_levels, tiled, band_rows, fixed_point);
+        CHECK_EXP (blender.ptr (), "create blender failed, pyramid levels:%d, band rows:%d", pyr_levels, band_rows);
+        printf ("pyramid levels:\t\t%d\n", pyr_levels);
+        printf ("tiled blend:\t\t%s, band rows:%d\n", tiled ? "true" : "false", band_rows);
+        printf ("fixed point:\t\t%s\n", fixed_point ? "true" : "false");
 
         CHECK (ins[0]->read_buf(), "read buffer from file(%s) failed.", ins[0]->get_file_name ());
         CHECK (ins[1]->read_buf(), "read buffer from file(%s) failed.", ins[1]->get_file_name ());
+        uint32_t blend_count = loop;
         while (loop--) {
+            PROFILING_START (soft_blend);
             CHECK (blender->blend (ins[0]->get_buf (), ins[1]->get_buf (), outs[0]->get_buf ()), "blend buffer failed");
+            PROFILING_END (soft_blend, blend_count);
             if (save_output)
                 outs[0]->write_buf ();
             FPS_CALCULATION (soft_blend, XCAM_OBJ_DUR_FRAME_NUM);
         }
+
+        if (fixed_point) {
+            SmartPtr<Blender> float_blender = create_blender (
+                input_width, input_height, output_width, output_height, pyr_levels, tiled, band_rows, false);
+            CHECK_EXP (float_blender.ptr (), "create float blender failed");
+
+            SmartPtr<VideoBuffer> float_buf;
+            CHECK (float_blender->blend (ins[0]->get_buf (), ins[1]->get_buf (), float_buf), "float blend failed");
+            XCAM_ASSERT (float_buf.ptr ());
+
+            float psnr_y = 0.0f, psnr_uv = 0.0f;
+            CHECK (calculate_psnr (outs[0]->get_buf (), float_buf, 0, psnr_y), "calculate psnr failed");
+            CHECK (calculate_psnr (outs[0]->get_buf (), float_buf, 1, psnr_uv), "calculate psnr failed");
+            printf ("fixed-point vs float PSNR: Y %.2f dB, UV %.2f dB\n", psnr_y, psnr_uv);
+        }
         break;
     }
     case SoftTypeRemap: {
@@ -540,6 +1421,54 @@ int main (int argc, char *argv[])
         }
         break;
     }
+    case SoftTypeFastmap: {
+        CHECK_EXP (ins.size () == 2, "fastmap needs 2 input files.");
+        CHECK_EXP (input_format == V4L2_PIX_FMT_NV12, "fastmap test supports NV12 only.");
+        CHECK_EXP (output_width % 8 == 0 && output_height % 2 == 0, "fastmap output size needs align to 8x2.");
+        CHECK (outs[0]->create_buf_pool (1, input_format), "create output buffer pool failed");
+
+        CHECK (ins[0]->read_buf(), "read buffer from file(%s) failed.", ins[0]->get_file_name ());
+        CHECK (ins[1]->read_buf(), "read buffer from file(%s) failed.", ins[1]->get_file_name ());
+        const SmartPtr<VideoBuffer> &out_buf = outs[0]->get_buf ();
+
+        SmartPtr<XCamSoftTasks::FastMapTask::Args> args = new XCamSoftTasks::FastMapTask::Args (NULL);
+        for (uint32_t k = 0; k < 2; ++k) {
+            args->coords[k] = new Float2Image (output_width, output_height);
+            gen_fastmap_coords (*args->coords[k].ptr (), input_width, input_height, k);
+            args->in_luma[k] = new UcharImage (ins[k]->get_buf (), 0);
+            args->in_uv[k] = new Uchar2Image (ins[k]->get_buf (), 1);
+        }
+        args->out_luma = new UcharImage (out_buf, 0);
+        args->out_uv = new Uchar2Image (out_buf, 1);
+
+        std::vector<uint8_t> mask;
+        gen_soft_blend_mask (output_width, mask);
+        args->mask = new UcharImage (output_width, 1);
+        memcpy (args->mask->get_buf_ptr (0, 0), mask.data (), output_width);
+
+        SmartPtr<XCamSoftTasks::FastMapTask> task = new XCamSoftTasks::FastMapTask (NULL);
+        WorkRange range;
+        range.pos_len[0] = output_width / 8;
+        range.pos_len[1] = output_height / 2;
+        uint32_t map_count = loop;
+        while (loop--) {
+            PROFILING_START (soft_fastmap);
+            CHECK (task->run_range (args, range), "fastmap buffer failed");
+            PROFILING_END (soft_fastmap, map_count);
+            if (save_output)
+                outs[0]->write_buf ();
+        }
+
+        uint32_t mismatch_y = 0, mismatch_uv = 0;
+        uint32_t diff_y = check_fastmap_plane (
+                              ins[0]->get_buf (), ins[1]->get_buf (), out_buf, args->coords, mask.data (), 0, mismatch_y);
+        uint32_t diff_uv = check_fastmap_plane (
+                               ins[0]->get_buf (), ins[1]->get_buf (), out_buf, args->coords, mask.data (), 1, mismatch_uv);
+        printf ("fastmap vs GL fastmap math: Y max diff %d (%d mismatched), UV max diff %d (%d mismatched)\n",
+                diff_y, mismatch_y, diff_uv, mismatch_uv);
+        CHECK_EXP (diff_y <= 1 && diff_uv <= 1, "fastmap output differs from GL fastmap math");
+        break;
+    }
     default: {
         XCAM_LOG_ERROR ("unsupported type:%d", type);
         usage (argv[0]);
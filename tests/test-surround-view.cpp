@@ -26,6 +26,10 @@
 #include <calibration_parser.h>
 #include <fisheye_image_file.h>
 #include <soft/soft_video_buf_allocator.h>
+#include <soft/soft_stitcher.h>
+#include <xcam_trace.h>
+#include <xcam_metrics.h>
+#include <xcam_numa.h>
 #include <dma_video_buffer.h>
 #if HAVE_GLES
 #include <gles/gl_video_buffer.h>
@@ -455,6 +459,30 @@ stable_stitch (const SmartPtr<Stitcher> &stitcher)
 
 XCAM_OBJ_PROFILING_DEFINES;
 
+static XCamReturn
+stitch_buffers (
+    const SmartPtr<Stitcher> &stitcher,
+    const VideoBufferList &in_bufs, SmartPtr<VideoBuffer> &out_buf)
+{
+    static bool started = false;
+    if (started)
+        return stitcher->stitch_buffers (in_bufs, out_buf);
+
+    // first frame initializes stitcher, mostly spent on fisheye lookup tables
+    struct timeval start_time, end_time;
+    gettimeofday (&start_time, NULL);
+    XCamReturn ret = stitcher->stitch_buffers (in_bufs, out_buf);
+    gettimeofday (&end_time, NULL);
+    started = true;
+
+    double duration = (end_time.tv_sec - start_time.tv_sec) * 1000.0 +
+                      (end_time.tv_usec - start_time.tv_usec) / 1000.0;
+    printf ("stitcher startup(%s dewarp): %.2fms\n",
+            stitcher->get_dewarp_mode () == DewarpSphere ? "sphere" : "bowl", duration);
+
+    return ret;
+}
+
 static int
 single_frame (
     const SmartPtr<Stitcher> &stitcher,
@@ -491,12 +519,12 @@ single_frame (
         if (enable_dmabuf) {
 #if HAVE_GLES
             out_dma_buf = convert_to_dma_buffer (outs[out_config.stitch_index]->get_buf ());
-            CHECK (stitcher->stitch_buffers (in_buffers, out_dma_buf), "stitch buffer failed.");
+            CHECK (stitch_buffers (stitcher, in_buffers, out_dma_buf), "stitch buffer failed.");
 #else
             XCAM_LOG_ERROR ("GLES module is unsupported");
 #endif
         } else {
-            CHECK (stitcher->stitch_buffers (in_buffers, outs[out_config.stitch_index]->get_buf ()), "stitch buffer failed.");
+            CHECK (stitch_buffers (stitcher, in_buffers, outs[out_config.stitch_index]->get_buf ()), "stitch buffer failed.");
         }
 
         XCAM_OBJ_PROFILING_END ("stitch-buffers", XCAM_OBJ_DUR_FRAME_NUM);
@@ -523,6 +551,28 @@ single_frame (
     return 0;
 }
 
+static int
+fetch_frame (
+    const SmartPtr<Stitcher> &stitcher,
+    const SVStreams &ins, const SVStreams &outs, const SVOutConfig &out_config)
+{
+    SmartPtr<VideoBuffer> out_buf;
+    CHECK (stitcher->fetch_buffer (out_buf), "fetch buffer failed.");
+
+    outs[out_config.stitch_index]->get_buf () = out_buf;
+    if (out_config.is_save()) {
+        if (stitcher->complete_stitch ()) {
+            write_image (stitcher, ins, outs, out_config);
+        }
+    }
+
+    if (stable_stitch (stitcher)) {
+        FPS_CALCULATION (surround_view, XCAM_OBJ_DUR_FRAME_NUM);
+    }
+
+    return 0;
+}
+
 static int
 multi_frame (
     const SmartPtr<Stitcher> &stitcher,
@@ -530,6 +580,7 @@ multi_frame (
     const SVOutConfig &out_config, int loop)
 {
     XCamReturn ret = XCAM_RETURN_NO_ERROR;
+    uint32_t inflight = 0;
 
     VideoBufferList in_buffers;
     while (loop--) {
@@ -553,8 +604,20 @@ multi_frame (
 
             XCAM_OBJ_PROFILING_START;
 
+            // pipelined stitching, output of the oldest frame is written once all inflight frames are submitted
+            if (stitcher->get_inflight_frames () > 1) {
+                CHECK (stitcher->submit_buffers (in_buffers, NULL), "submit buffers failed.");
+                if (++inflight == stitcher->get_inflight_frames ()) {
+                    CHECK_EXP (fetch_frame (stitcher, ins, outs, out_config) == 0, "fetch frame failed.");
+                    --inflight;
+                }
+
+                XCAM_OBJ_PROFILING_END ("stitch-buffers", XCAM_OBJ_DUR_FRAME_NUM);
+                continue;
+            }
+
             CHECK (
-                stitcher->stitch_buffers (in_buffers, outs[out_config.stitch_index]->get_buf ()),
+                stitch_buffers (stitcher, in_buffers, outs[out_config.stitch_index]->get_buf ()),
                 "stitch buffer failed.");
 
             XCAM_OBJ_PROFILING_END ("stitch-buffers", XCAM_OBJ_DUR_FRAME_NUM);
@@ -571,6 +634,10 @@ multi_frame (
         } while (true);
     }
 
+    for (; inflight > 0; --inflight) {
+        CHECK_EXP (fetch_frame (stitcher, ins, outs, out_config) == 0, "fetch frame failed.");
+    }
+
     return 0;
 }
 
@@ -632,13 +699,29 @@ static void usage(const char* arg0)
 #else
             "\t--fm-mode           optional, feature match mode, select from [none], default: none\n"
 #endif
+            "\t--lut-cache-dir     optional, directory to cache geomap lookup tables, default: no cache\n"
+            "\t--compact-lut       optional, int16 fixed-point geomap lookup tables (soft module)\n"
+            "\t                    select from [true/false], default: false\n"
+            "\t--fastmap           optional, precomputed coordinates and single level blend after feature match (soft module)\n"
+            "\t                    select from [true/false], default: false\n"
+            "\t--buf-arena         optional, allocate soft buffers from huge-page arena with 64-byte aligned pitches (soft module)\n"
+            "\t                    select from [true/false], default: false\n"
+            "\t--trace             optional, dump per-stage chrome trace json to file, needs --enable-trace build\n"
+            "\t--stats             optional, print pool, queue and handler metrics after stitching\n"
+            "\t                    select from [true/false], default: false\n"
+            "\t--numa              optional, spread cameras over numa nodes, geomap threads and buffers of each\n"
+            "\t                    camera are placed on its node (soft module), select from [true/false], default: false\n"
+            "\t--geomap-priority   optional, SCHED_FIFO priority of geomap threads, needs --numa (soft module), default: 0\n"
+            "\t--async-io          optional, read ahead inputs and write behind outputs on background threads\n"
+            "\t                    select from [true/false], default: false\n"
             "\t--frame-mode        optional, times of buffer reading, select from [single/multi], default: multi\n"
+            "\t--inflight-frames   optional, frames stitched concurrently in multi frame mode, range [1, %d], default: 1\n"
             "\t--save              optional, save file or not, select from [true/false], default: true\n"
             "\t--save-topview      optional, save top view video, select from [true/false], default: false\n"
             "\t--save-cubemap      optional, save cubemap video, select from [true/false], default: false\n"
             "\t--loop              optional, how many loops need to run, default: 1\n"
             "\t--help              usage\n",
-            arg0);
+            arg0, XCAM_STITCH_MAX_INFLIGHT_FRAMES);
 }
 
 int main (int argc, char *argv[])
@@ -668,6 +751,16 @@ int main (int argc, char *argv[])
     StitchScopicMode scopic_mode = ScopicMono;
 
     uint32_t blend_pyr_levels = 2;
+    const char *lut_cache_dir = NULL;
+    const char *trace_file = NULL;
+    bool compact_lut = false;
+    bool fastmap = false;
+    bool buf_arena = false;
+    bool print_stats = false;
+    bool numa = false;
+    bool async_io = false;
+    int32_t geomap_priority = 0;
+    uint32_t inflight_frames = 1;
 
     bool enable_dmabuf = false;
 
@@ -706,7 +799,17 @@ int main (int argc, char *argv[])
         {"fm-frames", required_argument, NULL, 'n'},
         {"fm-status", required_argument, NULL, 'T'},
 #endif
+        {"lut-cache-dir", required_argument, NULL, 'A'},
+        {"compact-lut", required_argument, NULL, 'K'},
+        {"fastmap", required_argument, NULL, 'Z'},
+        {"buf-arena", required_argument, NULL, 'B'},
+        {"trace", required_argument, NULL, 'G'},
+        {"stats", required_argument, NULL, 'O'},
+        {"numa", required_argument, NULL, 'U'},
+        {"async-io", required_argument, NULL, 'a'},
+        {"geomap-priority", required_argument, NULL, 'Q'},
         {"frame-mode", required_argument, NULL, 'f'},
+        {"inflight-frames", required_argument, NULL, 'I'},
         {"save", required_argument, NULL, 's'},
         {"save-topview", required_argument, NULL, 't'},
         {"save-cubemap", required_argument, NULL, 'q'},
@@ -917,6 +1020,36 @@ int main (int argc, char *argv[])
         case 'R':
             repeat = atoi(optarg);
             break;
+        case 'A':
+            lut_cache_dir = optarg;
+            break;
+        case 'K':
+            compact_lut = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'Z':
+            fastmap = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'B':
+            buf_arena = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'G':
+            trace_file = optarg;
+            break;
+        case 'O':
+            print_stats = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'U':
+            numa = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'Q':
+            geomap_priority = atoi(optarg);
+            break;
+        case 'a':
+            async_io = (strcasecmp (optarg, "true") == 0 ? true : false);
+            break;
+        case 'I':
+            inflight_frames = atoi(optarg);
+            break;
         case 'e':
             usage (argv[0]);
             return 0;
@@ -981,13 +1114,33 @@ int main (int argc, char *argv[])
     printf ("feature match status:\t%s\n", (fm_status == FMStatusWholeWay) ? "wholeway" :
             ((fm_status == FMStatusHalfWay) ? "halfway" : "fmfirst"));
 #endif
+    printf ("lut cache dir:\t\t%s\n", lut_cache_dir ? lut_cache_dir : "none");
+    printf ("compact lut:\t\t%s\n", compact_lut ? "true" : "false");
+    printf ("fastmap:\t\t%s\n", fastmap ? "true" : "false");
+    printf ("buffer arena:\t\t%s\n", buf_arena ? "true" : "false");
+    printf ("trace file:\t\t%s\n", trace_file ? trace_file : "none");
+    printf ("print stats:\t\t%s\n", print_stats ? "true" : "false");
+    printf ("numa:\t\t\t%s\n", numa ? "true" : "false");
+    printf ("geomap priority:\t%d\n", geomap_priority);
+    printf ("async io:\t\t%s\n", async_io ? "true" : "false");
     printf ("frame mode:\t\t%s\n", (frame_mode == FrameSingle) ? "singleframe" : "multiframe");
+    printf ("inflight frames:\t%d\n", inflight_frames);
     printf ("save output:\t\t%s\n", out_config.save_output ? "true" : "false");
     printf ("save topview:\t\t%s\n", out_config.save_topview ? "true" : "false");
     printf ("save cubemap:\t\t%s\n", out_config.save_cubemap ? "true" : "false");
     printf ("loop count:\t\t%d\n", loop);
     printf ("repeat count:\t\t%d\n", repeat);
 
+    if (module == SVModuleSoft)
+        SoftVideoBufAllocator::set_arena_mode (buf_arena);
+
+    if (trace_file) {
+#if !ENABLE_TRACE
+        XCAM_LOG_WARNING ("trace hooks are not built, configure with --enable-trace");
+#endif
+        Trace::start ();
+    }
+
 #if HAVE_GLES
     SmartPtr<EGLBase> egl;
     if (module == SVModuleGLES) {
@@ -1058,10 +1211,15 @@ int main (int argc, char *argv[])
     for (uint32_t i = 0; i < ins.size (); ++i) {
         ins[i]->set_module (module);
         ins[i]->set_buf_size (input_width, input_height);
+        ins[i]->set_async_io (async_io);
         CHECK (ins[i]->create_buf_pool (6, input_format), "create buffer pool failed");
         CHECK (ins[i]->open_reader ("rb"), "open input file(%s) failed", ins[i]->get_file_name ());
     }
 
+    for (uint32_t i = 0; i < outs.size (); ++i) {
+        outs[i]->set_async_io (async_io);
+    }
+
     outs[out_config.stitch_index]->set_buf_size (output_width, output_height);
     if (enable_dmabuf) {
 #if HAVE_GLES
@@ -1090,6 +1248,20 @@ int main (int argc, char *argv[])
         stitcher->set_dewarp_mode (dewarp_mode);
         stitcher->set_scale_mode (scale_mode);
         stitcher->set_blend_pyr_levels (blend_pyr_levels);
+        stitcher->set_lut_cache_dir (lut_cache_dir);
+        stitcher->set_compact_lut (compact_lut);
+        if (module == SVModuleSoft) {
+            SmartPtr<SoftStitcher> soft_stitcher = stitcher.dynamic_cast_ptr<SoftStitcher> ();
+            XCAM_ASSERT (soft_stitcher.ptr ());
+            soft_stitcher->set_fastmap (fastmap);
+            soft_stitcher->set_geomap_fifo_priority (geomap_priority);
+            if (numa) {
+                uint32_t node_count = NumaTopology::get_node_count ();
+                for (uint32_t i = 0; i < fisheye_num; ++i)
+                    soft_stitcher->set_camera_numa_node (i, i % node_count);
+            }
+        }
+        CHECK_EXP (stitcher->set_inflight_frames (inflight_frames), "invalid inflight frames: %d", inflight_frames);
         stitcher->set_fm_mode (fm_mode);
 #if HAVE_OPENCV
         stitcher->set_fm_frames (fm_frames);
@@ -1165,5 +1337,13 @@ int main (int argc, char *argv[])
             "run stitcher failed");
     }
 
+    if (trace_file) {
+        Trace::stop ();
+        CHECK_EXP (Trace::dump (trace_file), "dump trace to %s failed", trace_file);
+    }
+
+    if (print_stats)
+        printf ("%s", MetricsRegistry::instance ().dump ().c_str ());
+
     return 0;
 }
@@ -0,0 +1,532 @@
+/*
+ * test-thread-pool.cpp - work stealing pool checks and micro benchmark of thread pool queues
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "test_common.h"
+#include <thread_pool.h>
+#include <work_stealing_pool.h>
+#include <safe_list.h>
+#include <mpmc_queue.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define CHECK_SPAWN_ITEMS 64
+#define CHECK_CHILD_ITEMS 16
+#define CHECK_STOP_ITEMS 256
+#define CHECK_RESTART_ROUNDS 50
+#define CHECK_BLOCKING_CALLBACKS 8
+#define CHECK_WAIT_MS 5000
+#define CHECK_RING_CAPACITY 8
+
+using namespace XCam;
+
+struct CheckCounts {
+    std::atomic<uint32_t>  runs;
+    std::atomic<uint32_t>  dones;
+    std::atomic<uint32_t>  errors;
+
+    CheckCounts () : runs (0), dones (0), errors (0) {}
+};
+
+class CheckItem
+    : public ThreadPool::UserData
+{
+public:
+    CheckItem (CheckCounts *counts, uint32_t sleep_us = 0)
+        : _counts (counts)
+        , _sleep_us (sleep_us)
+    {}
+    virtual XCamReturn run () {
+        if (_sleep_us)
+            usleep (_sleep_us);
+        ++_counts->runs;
+        return XCAM_RETURN_NO_ERROR;
+    }
+    virtual void done (XCamReturn err) {
+        if (!xcam_ret_is_ok (err))
+            ++_counts->errors;
+        ++_counts->dones;
+    }
+
+protected:
+    CheckCounts  *_counts;
+
+private:
+    uint32_t      _sleep_us;
+};
+
+// queues its children from a pool thread, they go to the local deque and get stolen
+class SpawnItem
+    : public CheckItem
+{
+public:
+    SpawnItem (const SmartPtr<WorkStealingPool> &pool, CheckCounts *counts)
+        : CheckItem (counts)
+        , _pool (pool)
+    {}
+    virtual XCamReturn run () {
+        if (!_pool->is_pool_thread ())
+            return XCAM_RETURN_ERROR_THREAD;
+        for (uint32_t i = 0; i < CHECK_CHILD_ITEMS; ++i) {
+            XCamReturn ret = _pool->queue (new CheckItem (_counts));
+            if (!xcam_ret_is_ok (ret))
+                return ret;
+        }
+        return CheckItem::run ();
+    }
+
+private:
+    SmartPtr<WorkStealingPool>  _pool;
+};
+
+// blocks a done thread until released, like a callback waiting for a free buffer
+class BlockingCallback
+    : public CheckItem
+{
+public:
+    BlockingCallback (
+        const SmartPtr<WorkStealingPool> &pool, CheckCounts *counts,
+        std::atomic<uint32_t> *blocked, std::atomic<bool> *release)
+        : CheckItem (counts)
+        , _pool (pool)
+        , _blocked (blocked)
+        , _release (release)
+    {}
+    virtual XCamReturn run () {
+        if (_pool->is_pool_thread ())
+            return XCAM_RETURN_ERROR_THREAD;
+        ++(*_blocked);
+        for (uint32_t i = 0; i < CHECK_WAIT_MS && !(*_release); ++i)
+            usleep (1000);
+        return CheckItem::run ();
+    }
+
+private:
+    SmartPtr<WorkStealingPool>  _pool;
+    std::atomic<uint32_t>      *_blocked;
+    std::atomic<bool>          *_release;
+};
+
+class CheckProducer
+    : public Thread
+{
+public:
+    CheckProducer (const SmartPtr<ThreadPool> &pool, CheckCounts *counts)
+        : Thread ("check-producer")
+        , _pool (pool)
+        , _counts (counts)
+        , _accepted (0)
+    {}
+    uint32_t get_accepted () const {
+        return _accepted;
+    }
+
+protected:
+    virtual bool loop () {
+        if (xcam_ret_is_ok (_pool->queue (new CheckItem (_counts))))
+            ++_accepted;
+        return true;
+    }
+
+private:
+    SmartPtr<ThreadPool>        _pool;
+    CheckCounts                *_counts;
+    std::atomic<uint32_t>       _accepted;
+};
+
+static bool
+wait_dones (const CheckCounts &counts, uint32_t target)
+{
+    for (uint32_t i = 0; i < CHECK_WAIT_MS && counts.dones < target; ++i)
+        usleep (1000);
+    return counts.dones == target;
+}
+
+static int
+check_stealing_pool (uint32_t threads)
+{
+    SmartPtr<WorkStealingPool> pool = new WorkStealingPool ("check-pool");
+    pool->set_threads (threads, threads);
+    CHECK (pool->start (), "work stealing pool start failed");
+
+    // items queued from outside and from pool threads all run once
+    CheckCounts spawn;
+    for (uint32_t i = 0; i < CHECK_SPAWN_ITEMS; ++i)
+        CHECK (pool->queue (new SpawnItem (pool, &spawn)), "queue spawn item failed");
+    uint32_t total = CHECK_SPAWN_ITEMS * (CHECK_CHILD_ITEMS + 1);
+    CHECK_EXP (
+        wait_dones (spawn, total) && spawn.runs == total && !spawn.errors,
+        "spawned items runs:%d dones:%d errors:%d, expect %d",
+        spawn.runs.load (), spawn.dones.load (), spawn.errors.load (), total);
+
+    // blocked callbacks get a done thread each and pool threads keep running items
+    CheckCounts callbacks, unblocked;
+    std::atomic<uint32_t> blocked (0);
+    std::atomic<bool> release (false);
+    uint32_t callback_count = pool->get_max_threads () + CHECK_BLOCKING_CALLBACKS;
+    for (uint32_t i = 0; i < callback_count; ++i)
+        CHECK (pool->queue_done (new BlockingCallback (pool, &callbacks, &blocked, &release)), "queue done item failed");
+    for (uint32_t i = 0; i < CHECK_WAIT_MS && blocked < callback_count; ++i)
+        usleep (1000);
+    for (uint32_t i = 0; i < CHECK_SPAWN_ITEMS; ++i)
+        CHECK (pool->queue (new CheckItem (&unblocked)), "queue item failed");
+    bool pool_ran = wait_dones (unblocked, CHECK_SPAWN_ITEMS);
+    uint32_t blocked_count = blocked;
+    release = true;
+    CHECK_EXP (
+        blocked_count == callback_count && pool_ran,
+        "callbacks blocked:%d of %d, pool items done:%d of %d",
+        blocked_count, callback_count, unblocked.dones.load (), CHECK_SPAWN_ITEMS);
+    CHECK_EXP (
+        wait_dones (callbacks, callback_count) && !callbacks.errors,
+        "callbacks dones:%d errors:%d of %d", callbacks.dones.load (), callbacks.errors.load (), callback_count);
+
+    // items still queued at stop are done with error, none is lost
+    CheckCounts stopped;
+    for (uint32_t i = 0; i < CHECK_STOP_ITEMS; ++i)
+        CHECK (pool->queue (new CheckItem (&stopped, 1000)), "queue slow item failed");
+    CHECK (pool->stop (), "work stealing pool stop failed");
+    CHECK_EXP (
+        stopped.dones == CHECK_STOP_ITEMS && stopped.runs + stopped.errors == CHECK_STOP_ITEMS && stopped.errors,
+        "stop dropped items runs:%d dones:%d errors:%d of %d",
+        stopped.runs.load (), stopped.dones.load (), stopped.errors.load (), CHECK_STOP_ITEMS);
+    CHECK_EXP (
+        pool->queue (new CheckItem (&stopped)) == XCAM_RETURN_ERROR_THREAD,
+        "stopped pool accepted an item");
+
+    // queue racing with stop and restart, every accepted item is done once
+    CheckCounts racing;
+    SmartPtr<CheckProducer> producers[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        producers[i] = new CheckProducer (pool, &racing);
+        producers[i]->start ();
+    }
+    for (uint32_t i = 0; i < CHECK_RESTART_ROUNDS; ++i) {
+        CHECK (pool->start (), "work stealing pool restart failed");
+        usleep (500);
+        CHECK (pool->stop (), "work stealing pool stop failed");
+    }
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 2; ++i) {
+        producers[i]->stop ();
+        accepted += producers[i]->get_accepted ();
+    }
+    CHECK_EXP (
+        racing.dones == accepted && racing.runs + racing.errors == accepted,
+        "racing items accepted:%d runs:%d dones:%d errors:%d",
+        accepted, racing.runs.load (), racing.dones.load (), racing.errors.load ());
+
+    // resizing shared pool swaps in a new one, items on the old one keep running
+    CheckCounts shared;
+    SmartPtr<ThreadPool> old_shared = WorkStealingPool::get_shared_pool ();
+    CHECK_EXP (old_shared.ptr (), "get shared pool failed");
+    for (uint32_t i = 0; i < CHECK_STOP_ITEMS; ++i)
+        CHECK (old_shared->queue (new CheckItem (&shared, 100)), "queue shared item failed");
+    CHECK_EXP (WorkStealingPool::set_shared_threads (threads), "set shared pool threads(%d) failed", threads);
+    SmartPtr<ThreadPool> new_shared = WorkStealingPool::get_shared_pool ();
+    CHECK_EXP (
+        new_shared.ptr () && new_shared.ptr () != old_shared.ptr () && new_shared->get_max_threads () == threads,
+        "shared pool not swapped with %d threads", threads);
+    CHECK_EXP (
+        wait_dones (shared, CHECK_STOP_ITEMS) && shared.runs == CHECK_STOP_ITEMS && !shared.errors,
+        "old shared pool items runs:%d dones:%d errors:%d of %d",
+        shared.runs.load (), shared.dones.load (), shared.errors.load (), CHECK_STOP_ITEMS);
+    WorkStealingPool::set_shared_threads (0);
+
+    printf ("work stealing pool check passed, %d items accepted while restarting\n", accepted);
+    return 0;
+}
+
+static int
+check_ring_pool (uint32_t threads)
+{
+    SmartPtr<ThreadPool> pool = new ThreadPool ("check-ring");
+    pool->set_threads (threads, threads);
+    pool->set_lock_free (true, CHECK_RING_CAPACITY);
+    CHECK (pool->start (), "ring pool start failed");
+
+    // more slow items than ring cells, queue waits for free cells instead of failing
+    CheckCounts full;
+    for (uint32_t i = 0; i < CHECK_STOP_ITEMS; ++i)
+        CHECK (pool->queue (new CheckItem (&full, 100)), "queue item to full ring failed");
+    CHECK_EXP (
+        wait_dones (full, CHECK_STOP_ITEMS) && full.runs == CHECK_STOP_ITEMS && !full.errors,
+        "full ring items runs:%d dones:%d errors:%d of %d",
+        full.runs.load (), full.dones.load (), full.errors.load (), CHECK_STOP_ITEMS);
+
+    // producers blocked on full ring racing with stop and restart, every accepted item is done once
+    CheckCounts racing;
+    SmartPtr<CheckProducer> producers[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        producers[i] = new CheckProducer (pool, &racing);
+        producers[i]->start ();
+    }
+    for (uint32_t i = 0; i < CHECK_RESTART_ROUNDS; ++i) {
+        usleep (500);
+        CHECK (pool->stop (), "ring pool stop failed");
+        CHECK (pool->start (), "ring pool restart failed");
+    }
+    CHECK (pool->stop (), "ring pool stop failed");
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 2; ++i) {
+        producers[i]->stop ();
+        accepted += producers[i]->get_accepted ();
+    }
+    CHECK_EXP (
+        racing.dones == accepted && racing.runs + racing.errors == accepted,
+        "ring racing items accepted:%d runs:%d dones:%d errors:%d",
+        accepted, racing.runs.load (), racing.dones.load (), racing.errors.load ());
+
+    printf ("ring pool check passed, %d items accepted while restarting\n", accepted);
+    return 0;
+}
+
+class BenchItem
+    : public ThreadPool::UserData
+{
+public:
+    explicit BenchItem (std::atomic<uint32_t> *remain)
+        : _remain (remain)
+    {}
+    virtual XCamReturn run () {
+        return XCAM_RETURN_NO_ERROR;
+    }
+    virtual void done (XCamReturn) {
+        --(*_remain);
+    }
+
+private:
+    std::atomic<uint32_t>  *_remain;
+};
+
+template <typename Queue>
+class Consumer
+    : public Thread
+{
+public:
+    Consumer (Queue &queue, std::atomic<uint32_t> &remain)
+        : Thread ("bench-consumer")
+        , _queue (queue)
+        , _remain (remain)
+    {}
+
+protected:
+    virtual bool loop () {
+        SmartPtr<ThreadPool::UserData> data = _queue.pop ();
+        if (!data.ptr ())
+            return false;
+        data->done (data->run ());
+        return _remain > 0;
+    }
+
+private:
+    Queue                  &_queue;
+    std::atomic<uint32_t>  &_remain;
+};
+
+static double
+get_time_ms ()
+{
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+template <typename Queue>
+static double
+bench_queue (Queue &queue, uint32_t consumers, uint32_t items)
+{
+    std::atomic<uint32_t> remain (items);
+    std::vector<SmartPtr<ThreadPool::UserData> > data (items);
+    for (uint32_t i = 0; i < items; ++i)
+        data[i] = new BenchItem (&remain);
+
+    std::vector<SmartPtr<Thread> > threads;
+    for (uint32_t i = 0; i < consumers; ++i) {
+        SmartPtr<Thread> thread = new Consumer<Queue> (queue, remain);
+        thread->start ();
+        threads.push_back (thread);
+    }
+
+    double start = get_time_ms ();
+    for (uint32_t i = 0; i < items; ++i) {
+        while (!queue.push (data[i]))
+            sched_yield ();
+    }
+    while (remain > 0)
+        sched_yield ();
+    double end = get_time_ms ();
+
+    queue.pause_pop ();
+    for (uint32_t i = 0; i < consumers; ++i)
+        threads[i]->stop ();
+    queue.resume_pop ();
+
+    return end - start;
+}
+
+static double
+bench_pool (bool lock_free, uint32_t threads, uint32_t items)
+{
+    SmartPtr<ThreadPool> pool = new ThreadPool ("bench-pool");
+    pool->set_threads (threads, threads);
+    pool->set_lock_free (lock_free);
+    pool->start ();
+
+    std::atomic<uint32_t> remain (items);
+    double start = get_time_ms ();
+    for (uint32_t i = 0; i < items; ++i) {
+        SmartPtr<BenchItem> item = new BenchItem (&remain);
+        pool->queue (item);
+    }
+    while (remain > 0)
+        sched_yield ();
+    double end = get_time_ms ();
+
+    pool->stop ();
+    return end - start;
+}
+
+// per frame param of stitch path, not a RefObj, holds buffers shared by all frames
+#define BENCH_PARAM_BUFS 4
+
+struct BenchParam {
+    SmartPtr<ThreadPool::UserData> bufs[BENCH_PARAM_BUFS];
+};
+
+static SmartPtr<BenchParam>
+pass_param (SmartPtr<BenchParam> param)
+{
+    return param;
+}
+
+// create param, queue it in flight, hand it over by value and drop it, like submit/fetch of stitcher
+static double
+bench_smartptr (bool move, uint32_t items)
+{
+    std::atomic<uint32_t> remain (0);
+    SmartPtr<ThreadPool::UserData> buf = new BenchItem (&remain);
+    std::list<SmartPtr<BenchParam> > inflight;
+
+    double start = get_time_ms ();
+    for (uint32_t i = 0; i < items; ++i) {
+        SmartPtr<BenchParam> param;
+        if (move)
+            param = make_smart<BenchParam> ();
+        else
+            param = new BenchParam;
+        for (uint32_t k = 0; k < BENCH_PARAM_BUFS; ++k)
+            param->bufs[k] = buf;
+
+        if (move) {
+            inflight.push_back (std::move (param));
+            SmartPtr<BenchParam> done = pass_param (std::move (inflight.front ()));
+            inflight.pop_front ();
+        } else {
+            inflight.push_back (param);
+            SmartPtr<BenchParam> done = pass_param (inflight.front ());
+            inflight.pop_front ();
+        }
+    }
+    return get_time_ms () - start;
+}
+
+static void usage(const char* arg0)
+{
+    printf ("Usage:\n"
+            "%s --threads 4 --items 100000 ...\n"
+            "\t--threads           optional, consumer threads, default: 4\n"
+            "\t--items             optional, items queued per loop, default: 100000\n"
+            "\t--loop              optional, how many loops need to run, default: 3\n"
+            "\t--help              usage\n",
+            arg0);
+}
+
+int main (int argc, char *argv[])
+{
+    uint32_t threads = 4;
+    uint32_t items = 100000;
+    int loop = 3;
+
+    const struct option long_opts[] = {
+        {"threads", required_argument, NULL, 't'},
+        {"items", required_argument, NULL, 'i'},
+        {"loop", required_argument, NULL, 'l'},
+        {"help", no_argument, NULL, 'e'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt = -1;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'i':
+            items = atoi(optarg);
+            break;
+        case 'l':
+            loop = atoi(optarg);
+            break;
+        case 'e':
+            usage (argv[0]);
+            return 0;
+        default:
+            XCAM_LOG_ERROR ("getopt_long return unknown value:%c", opt);
+            usage (argv[0]);
+            return -1;
+        }
+    }
+
+    if (optind < argc) {
+        XCAM_LOG_ERROR ("unknown option %s", argv[optind]);
+        usage (argv[0]);
+        return -1;
+    }
+
+    CHECK_EXP (threads && items && loop > 0, "invalid params, threads:%d items:%d loop:%d", threads, items, loop);
+
+    printf ("threads:\t\t%d\n", threads);
+    printf ("items:\t\t\t%d\n", items);
+    printf ("loop count:\t\t%d\n", loop);
+
+    CHECK_EXP (check_stealing_pool (threads) == 0, "work stealing pool check failed");
+    CHECK_EXP (check_ring_pool (threads) == 0, "ring pool check failed");
+
+    SafeList<ThreadPool::UserData> safe_list;
+    MpmcQueue<ThreadPool::UserData> mpmc_queue;
+
+    for (int i = 0; i < loop; ++i) {
+        double list_ms = bench_queue (safe_list, threads, items);
+        double ring_ms = bench_queue (mpmc_queue, threads, items);
+        double pool_list_ms = bench_pool (false, threads, items);
+        double pool_ring_ms = bench_pool (true, threads, items);
+        double ptr_copy_ms = bench_smartptr (false, items);
+        double ptr_move_ms = bench_smartptr (true, items);
+
+        printf ("loop:%d queue safe-list:%.2fms(%.0f items/s) mpmc:%.2fms(%.0f items/s)\n",
+                i, list_ms, items * 1000.0 / list_ms, ring_ms, items * 1000.0 / ring_ms);
+        printf ("loop:%d pool  safe-list:%.2fms(%.0f items/s) mpmc:%.2fms(%.0f items/s)\n",
+                i, pool_list_ms, items * 1000.0 / pool_list_ms, pool_ring_ms, items * 1000.0 / pool_ring_ms);
+        printf ("loop:%d param new+copy:%.2fms(%.0f items/s) make_smart+move:%.2fms(%.0f items/s)\n",
+                i, ptr_copy_ms, items * 1000.0 / ptr_copy_ms, ptr_move_ms, items * 1000.0 / ptr_move_ms);
+    }
+
+    return 0;
+}
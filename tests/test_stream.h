@@ -24,6 +24,7 @@
 
 #include <buffer_pool.h>
 #include <image_file.h>
+#include <async_image_file.h>
 #if (!defined(ANDROID) && (HAVE_OPENCV))
 #include "ocv/cv_utils.h"
 #endif
@@ -100,6 +101,10 @@ public:
     void set_file (const SmartPtr<ImageFile> &file) {
         _file = file;
     }
+    // reads ahead and writes behind NV12/YUV420 files on a background thread, set before open
+    void set_async_io (bool enable) {
+        _async_io = enable;
+    }
 
     SmartPtr<VideoBuffer> &get_buf ();
     XCamReturn estimate_file_format ();
@@ -127,6 +132,7 @@ protected:
     }
 
 private:
+    SmartPtr<ImageFile> create_file ();
 #if XCAM_TEST_OPENCV
     XCamReturn cv_open_writer ();
     void cv_write_buf (char *frame_str = NULL);
@@ -144,6 +150,7 @@ private:
     SmartPtr<BufferPool>     _pool;
 
     SmartPtr<ImageFile>      _file;
+    bool                     _async_io;
     int                      _fifo;
 #if XCAM_TEST_OPENCV
     cv::VideoWriter          _writer;
@@ -155,6 +162,7 @@ Stream::Stream (const char *file_name, uint32_t width, uint32_t height)
     : _file_name (NULL)
     , _width (width)
     , _height (height)
+    , _async_io (false)
     , _fifo (-1)
     , _format (FileNV12)
 {
@@ -191,11 +199,8 @@ Stream::open_reader (const char *option)
         ERROR, (_format == FileNV12) || (_format == FileYUV420), XCAM_RETURN_ERROR_PARAM,
         "stream(%s) only support NV12 or YUV420 input format", _file_name);
 
-    if (!_file.ptr ()) {
-        SmartPtr<ImageFile> file = new ImageFile ();
-        XCAM_ASSERT (file.ptr ());
-        _file = file;
-    }
+    if (!_file.ptr ())
+        _file = create_file ();
 
     if (_file->open (_file_name, option) != XCAM_RETURN_NO_ERROR) {
         XCAM_LOG_ERROR ("stream(%s) open failed", _file_name);
@@ -211,11 +216,8 @@ Stream::open_writer (const char *option)
     XCAM_ASSERT (_format != FileNone);
 
     if (_format == FileNV12 || _format == FileYUV420) {
-        if (!_file.ptr ()) {
-            SmartPtr<ImageFile> file = new ImageFile ();
-            XCAM_ASSERT (file.ptr ());
-            _file = file;
-        }
+        if (!_file.ptr ())
+            _file = create_file ();
 
         if (_file->open (_file_name, option) != XCAM_RETURN_NO_ERROR) {
             XCAM_LOG_ERROR ("stream(%s) open failed", _file_name);
@@ -242,6 +244,19 @@ Stream::open_writer (const char *option)
     return XCAM_RETURN_NO_ERROR;
 }
 
+SmartPtr<ImageFile>
+Stream::create_file ()
+{
+    SmartPtr<ImageFile> file;
+    if (_async_io)
+        file = new AsyncImageFile ();
+    else
+        file = new ImageFile ();
+    XCAM_ASSERT (file.ptr ());
+
+    return file;
+}
+
 XCamReturn
 Stream::close_file ()
 {
@@ -22,6 +22,10 @@
 #define GST_XCAM_UTILS_H
 
 #include "dma_video_buffer.h"
+#include "xcam_metrics.h"
+
+// custom query structure name, answered with "stats" string field of xcam metrics
+#define GST_XCAM_STATS_QUERY_NAME "xcam-stats"
 
 class DmaGstBuffer
     : public XCam::DmaVideoBuffer
@@ -45,4 +49,20 @@ private:
     GstBuffer *_gst_buf;
 };
 
+// returns FALSE if query is not a stats query
+static inline gboolean
+gst_xcam_stats_query (GstQuery *query)
+{
+    if (GST_QUERY_TYPE (query) != GST_QUERY_CUSTOM)
+        return FALSE;
+
+    GstStructure *structure = gst_query_writable_structure (query);
+    if (!structure || !gst_structure_has_name (structure, GST_XCAM_STATS_QUERY_NAME))
+        return FALSE;
+
+    std::string stats = XCam::MetricsRegistry::instance ().dump ();
+    gst_structure_set (structure, "stats", G_TYPE_STRING, stats.c_str (), NULL);
+    return TRUE;
+}
+
 #endif // GST_XCAM_UTILS_H
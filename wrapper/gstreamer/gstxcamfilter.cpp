@@ -222,6 +222,7 @@ static gboolean gst_xcam_filter_stop (GstBaseTransform *trans);
 static void gst_xcam_filter_before_transform (GstBaseTransform *trans, GstBuffer *buffer);
 static GstFlowReturn gst_xcam_filter_prepare_output_buffer (GstBaseTransform * trans, GstBuffer *input, GstBuffer **outbuf);
 static GstFlowReturn gst_xcam_filter_transform (GstBaseTransform *trans, GstBuffer *inbuf, GstBuffer *outbuf);
+static gboolean gst_xcam_filter_query (GstBaseTransform *trans, GstPadDirection direction, GstQuery *query);
 
 XCAM_END_DECLARE
 
@@ -332,6 +333,7 @@ gst_xcam_filter_class_init (GstXCamFilterClass *class_self)
     basetrans_class->before_transform = GST_DEBUG_FUNCPTR (gst_xcam_filter_before_transform);
     basetrans_class->prepare_output_buffer = GST_DEBUG_FUNCPTR (gst_xcam_filter_prepare_output_buffer);
     basetrans_class->transform = GST_DEBUG_FUNCPTR (gst_xcam_filter_transform);
+    basetrans_class->query = GST_DEBUG_FUNCPTR (gst_xcam_filter_query);
 }
 
 static void
@@ -966,6 +968,15 @@ gst_xcam_filter_transform (GstBaseTransform *trans, GstBuffer *inbuf, GstBuffer
     return GST_FLOW_OK;
 }
 
+static gboolean
+gst_xcam_filter_query (GstBaseTransform *trans, GstPadDirection direction, GstQuery *query)
+{
+    if (gst_xcam_stats_query (query))
+        return TRUE;
+
+    return GST_BASE_TRANSFORM_CLASS (parent_class)->query (trans, direction, query);
+}
+
 static gboolean
 gst_xcam_filter_plugin_init (GstPlugin *xcamfilter)
 {
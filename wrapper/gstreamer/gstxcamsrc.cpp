@@ -37,6 +37,7 @@
 
 #include "gstxcamsrc.h"
 #include "gstxcambufferpool.h"
+#include "gst_xcam_utils.h"
 #if HAVE_IA_AIQ
 #include "gstxcaminterface.h"
 #include "dynamic_analyzer_loader.h"
@@ -371,6 +372,7 @@ static void gst_xcam_src_get_property (GObject *object, guint prop_id, GValue *v
 static GstCaps* gst_xcam_src_get_caps (GstBaseSrc *src, GstCaps *filter);
 static gboolean gst_xcam_src_set_caps (GstBaseSrc *src, GstCaps *caps);
 static gboolean gst_xcam_src_decide_allocation (GstBaseSrc *src, GstQuery *query);
+static gboolean gst_xcam_src_query (GstBaseSrc *src, GstQuery *query);
 static gboolean gst_xcam_src_start (GstBaseSrc *src);
 static gboolean gst_xcam_src_stop (GstBaseSrc *src);
 static gboolean gst_xcam_src_unlock (GstBaseSrc *src);
@@ -568,6 +570,7 @@ gst_xcam_src_class_init (GstXCamSrcClass * class_self)
     basesrc_class->get_caps = GST_DEBUG_FUNCPTR (gst_xcam_src_get_caps);
     basesrc_class->set_caps = GST_DEBUG_FUNCPTR (gst_xcam_src_set_caps);
     basesrc_class->decide_allocation = GST_DEBUG_FUNCPTR (gst_xcam_src_decide_allocation);
+    basesrc_class->query = GST_DEBUG_FUNCPTR (gst_xcam_src_query);
 
     basesrc_class->start = GST_DEBUG_FUNCPTR (gst_xcam_src_start);
     basesrc_class->stop = GST_DEBUG_FUNCPTR (gst_xcam_src_stop);
@@ -1338,6 +1341,15 @@ gst_xcam_src_decide_allocation (GstBaseSrc *src, GstQuery *query)
     return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (src, query);
 }
 
+static gboolean
+gst_xcam_src_query (GstBaseSrc *src, GstQuery *query)
+{
+    if (gst_xcam_stats_query (query))
+        return TRUE;
+
+    return GST_BASE_SRC_CLASS (parent_class)->query (src, query);
+}
+
 static GstFlowReturn
 gst_xcam_src_alloc (GstBaseSrc *src, guint64 offset, guint size, GstBuffer **buffer)
 {
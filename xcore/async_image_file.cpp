@@ -0,0 +1,311 @@
+/*
+ * async_image_file.cpp - image file with background read-ahead and write-behind
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "async_image_file.h"
+#include <fcntl.h>
+
+namespace XCam {
+
+class AsyncFileThread
+    : public Thread
+{
+public:
+    explicit AsyncFileThread (AsyncImageFile *file)
+        : Thread ("async-file")
+        , _file (file)
+    {}
+
+protected:
+    virtual bool loop () {
+        return _file->io_loop ();
+    }
+
+private:
+    AsyncImageFile   *_file;
+};
+
+static size_t
+get_frame_size (const VideoBufferInfo &info)
+{
+    VideoBufferPlanarInfo planar;
+    size_t size = 0;
+    for (uint32_t comp = 0; comp < info.components; comp++) {
+        info.get_planar_info (planar, comp);
+        size += planar.width * planar.pixel_bytes * planar.height;
+    }
+    return size;
+}
+
+// packed frame to buffer if @to_buf, else buffer to packed frame
+static void
+copy_frame (const VideoBufferInfo &info, uint8_t *memory, uint8_t *frame, bool to_buf)
+{
+    VideoBufferPlanarInfo planar;
+    for (uint32_t comp = 0; comp < info.components; comp++) {
+        info.get_planar_info (planar, comp);
+        uint32_t row_bytes = planar.width * planar.pixel_bytes;
+
+        uint32_t rows = (info.strides [comp] == row_bytes) ? 1 : planar.height;
+        uint32_t copy_bytes = (rows == 1) ? row_bytes * planar.height : row_bytes;
+        for (uint32_t i = 0; i < rows; i++) {
+            uint8_t *ptr = memory + info.offsets [comp] + i * info.strides [comp];
+            if (to_buf)
+                memcpy (ptr, frame, copy_bytes);
+            else
+                memcpy (frame, ptr, copy_bytes);
+            frame += copy_bytes;
+        }
+    }
+}
+
+AsyncImageFile::AsyncImageFile (uint32_t depth)
+    : _depth (XCAM_MAX (depth, 1u))
+    , _writer (false)
+    , _frame_size (0)
+    , _head (0)
+    , _count (0)
+    , _status (XCAM_RETURN_NO_ERROR)
+    , _stopping (false)
+{
+}
+
+AsyncImageFile::~AsyncImageFile ()
+{
+    close ();
+}
+
+XCamReturn
+AsyncImageFile::open (const char *name, const char *option)
+{
+    close ();
+
+    XCamReturn ret = ImageFile::open (name, option);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
+
+    _writer = (strchr (option, 'w') || strchr (option, 'a'));
+    if (!_writer)
+        posix_fadvise (fileno (_fp), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+AsyncImageFile::close ()
+{
+    XCamReturn ret = stop_io ();
+    ImageFile::close ();
+    return ret;
+}
+
+XCamReturn
+AsyncImageFile::rewind ()
+{
+    XCamReturn ret = stop_io ();
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "AsyncImageFile(%s) write queued frames failed before rewind", XCAM_STR (get_file_name ()));
+
+    return ImageFile::rewind ();
+}
+
+XCamReturn
+AsyncImageFile::start_io (const VideoBufferInfo &info)
+{
+    size_t size = get_frame_size (info);
+    if (_thread.ptr ()) {
+        XCAM_FAIL_RETURN (
+            ERROR, size == _frame_size, XCAM_RETURN_ERROR_PARAM,
+            "AsyncImageFile(%s) frame size changed from %zu to %zu",
+            XCAM_STR (get_file_name ()), _frame_size, size);
+        return XCAM_RETURN_NO_ERROR;
+    }
+
+    if (size != _frame_size) {
+        _frames.clear ();
+        _frames.resize (_depth, std::vector<uint8_t> (size));
+        _frame_size = size;
+    }
+
+    _head = 0;
+    _count = 0;
+    _status = XCAM_RETURN_NO_ERROR;
+    _stopping = false;
+
+    _thread = new AsyncFileThread (this);
+    XCAM_FAIL_RETURN (
+        ERROR, _thread->start (), XCAM_RETURN_ERROR_THREAD,
+        "AsyncImageFile(%s) start io thread failed", XCAM_STR (get_file_name ()));
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+AsyncImageFile::stop_io ()
+{
+    if (!_thread.ptr ())
+        return XCAM_RETURN_NO_ERROR;
+
+    // thread exits once stopped, queued frames must be written before
+    flush ();
+    {
+        SmartLock locker (_mutex);
+        _stopping = true;
+        _cond.broadcast ();
+    }
+    _thread->stop ();
+    _thread.release ();
+
+    // end of file is not an error for caller of close or rewind
+    XCamReturn ret = (_status == XCAM_RETURN_BYPASS) ? XCAM_RETURN_NO_ERROR : _status;
+    _head = 0;
+    _count = 0;
+    _status = XCAM_RETURN_NO_ERROR;
+    _stopping = false;
+    return ret;
+}
+
+bool
+AsyncImageFile::io_loop ()
+{
+    uint32_t slot = 0;
+    {
+        SmartLock locker (_mutex);
+        if (_writer) {
+            // queued frames are drained before stopping
+            while (!_stopping && !_count)
+                _cond.wait (_mutex);
+            if (!_count)
+                return false;
+            slot = _head;
+        } else {
+            while (!_stopping && (_count == _depth || _status != XCAM_RETURN_NO_ERROR))
+                _cond.wait (_mutex);
+            if (_stopping)
+                return false;
+            slot = (_head + _count) % _depth;
+        }
+    }
+
+    uint8_t *frame = _frames[slot].data ();
+    XCamReturn ret = _writer ? write_file (frame, _frame_size) : read_file (frame, _frame_size);
+
+    SmartLock locker (_mutex);
+    if (ret != XCAM_RETURN_NO_ERROR) {
+        _status = ret;
+        if (_writer)
+            _count = 0;
+    } else if (_writer) {
+        _head = (_head + 1) % _depth;
+        --_count;
+    } else {
+        ++_count;
+    }
+    _cond.broadcast ();
+
+    return !_writer || ret == XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+AsyncImageFile::read_buf (const SmartPtr<VideoBuffer> &buf)
+{
+    XCAM_ASSERT (is_valid () && !_writer);
+
+    const VideoBufferInfo &info = buf->get_video_info ();
+    XCamReturn ret = start_io (info);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
+
+    {
+        SmartLock locker (_mutex);
+        while (!_count && _status == XCAM_RETURN_NO_ERROR)
+            _cond.wait (_mutex);
+        if (!_count)
+            return _status;
+    }
+
+    uint8_t *memory = buf->map ();
+    if (NULL == memory) {
+        XCAM_LOG_ERROR ("AsyncImageFile map buffer failed");
+        buf->unmap ();
+        return XCAM_RETURN_ERROR_MEM;
+    }
+    // head slot is not touched by io thread until released
+    copy_frame (info, memory, _frames[_head].data (), true);
+    buf->unmap ();
+
+    SmartLock locker (_mutex);
+    _head = (_head + 1) % _depth;
+    --_count;
+    _cond.broadcast ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+AsyncImageFile::write_buf (const SmartPtr<VideoBuffer> &buf)
+{
+    XCAM_ASSERT (is_valid () && _writer);
+
+    const VideoBufferInfo &info = buf->get_video_info ();
+    XCamReturn ret = start_io (info);
+    if (!xcam_ret_is_ok (ret))
+        return ret;
+
+    uint32_t slot = 0;
+    {
+        SmartLock locker (_mutex);
+        while (_count == _depth && _status == XCAM_RETURN_NO_ERROR)
+            _cond.wait (_mutex);
+        if (_status != XCAM_RETURN_NO_ERROR)
+            return _status;
+        slot = (_head + _count) % _depth;
+    }
+
+    uint8_t *memory = buf->map ();
+    if (NULL == memory) {
+        XCAM_LOG_ERROR ("AsyncImageFile map buffer failed");
+        buf->unmap ();
+        return XCAM_RETURN_ERROR_MEM;
+    }
+    copy_frame (info, memory, _frames[slot].data (), false);
+    buf->unmap ();
+
+    SmartLock locker (_mutex);
+    ++_count;
+    _cond.broadcast ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+AsyncImageFile::flush ()
+{
+    if (!_thread.ptr () || !_writer)
+        return XCAM_RETURN_NO_ERROR;
+
+    SmartLock locker (_mutex);
+    while (_count && _status == XCAM_RETURN_NO_ERROR)
+        _cond.wait (_mutex);
+
+    return _status;
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * async_image_file.h - image file with background read-ahead and write-behind
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_ASYNC_IMAGE_FILE_H
+#define XCAM_ASYNC_IMAGE_FILE_H
+
+#include <xcam_std.h>
+#include <xcam_mutex.h>
+#include <xcam_thread.h>
+#include <image_file.h>
+#include <vector>
+
+#define XCAM_ASYNC_FILE_DEFAULT_DEPTH 2
+
+namespace XCam {
+
+class AsyncFileThread;
+
+/*
+ * frames are staged in @depth packed slots and moved from/to disk by an io thread
+ * with one fread/fwrite per frame, caller thread only copies between slot and buffer.
+ * opened with "r" the file reads ahead, with "w" or "a" it writes behind.
+ * io starts on first read_buf/write_buf, all frames must have the same size.
+ */
+class AsyncImageFile
+    : public ImageFile
+{
+    friend class AsyncFileThread;
+
+public:
+    explicit AsyncImageFile (uint32_t depth = XCAM_ASYNC_FILE_DEFAULT_DEPTH);
+    virtual ~AsyncImageFile ();
+
+    virtual XCamReturn open (const char *name, const char *option);
+    // queued frames are written before file is closed
+    virtual XCamReturn close ();
+    // drops read-ahead frames or waits queued frames written
+    virtual XCamReturn rewind ();
+
+    // returns XCAM_RETURN_BYPASS at end of file like ImageFile
+    virtual XCamReturn read_buf (const SmartPtr<VideoBuffer> &buf);
+    // buf is copied, it can be reused once returned
+    virtual XCamReturn write_buf (const SmartPtr<VideoBuffer> &buf);
+    // waits until queued frames are written, returns first write error
+    XCamReturn flush ();
+
+private:
+    XCAM_DEAD_COPY (AsyncImageFile);
+
+    XCamReturn start_io (const VideoBufferInfo &info);
+    XCamReturn stop_io ();
+    bool io_loop ();
+
+private:
+    uint32_t                            _depth;
+    bool                                _writer;
+    size_t                              _frame_size;
+    std::vector<std::vector<uint8_t> >  _frames;
+
+    // _count frames are ready from _head, read-ahead ones or queued ones
+    Mutex                               _mutex;
+    Cond                                _cond;
+    uint32_t                            _head;
+    uint32_t                            _count;
+    XCamReturn                          _status;
+    bool                                _stopping;
+    SmartPtr<Thread>                    _thread;
+};
+
+}
+
+#endif // XCAM_ASYNC_IMAGE_FILE_H
@@ -69,6 +69,8 @@ typedef enum {
 uint32_t xcam_version ();
 void * xcam_malloc (size_t size);
 void * xcam_malloc0 (size_t size);
+// align must be power of 2 and multiple of sizeof(void *), release by xcam_free
+void * xcam_malloc_aligned (size_t size, size_t align);
 
 void xcam_free (void *ptr);
 
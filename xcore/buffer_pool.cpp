@@ -68,11 +68,51 @@ BufferPool::BufferPool ()
     : _allocated_num (0)
     , _max_count (0)
     , _started (false)
+    , _name (NULL)
+    , _policy (AcquireBlock)
+    , _grow_count (0)
+    , _timeout (-1)
+    , _metric_allocated (NULL)
+    , _metric_in_use (NULL)
+    , _metric_starved (NULL)
+    , _metric_failed (NULL)
+    , _metric_wait_us (NULL)
 {
 }
 
 BufferPool::~BufferPool ()
 {
+    if (_metric_allocated)
+        _metric_allocated->sub (_allocated_num);
+    xcam_free (_name);
+}
+
+bool
+BufferPool::set_name (const char *name)
+{
+    SmartLock lock (_mutex);
+    XCAM_FAIL_RETURN (
+        ERROR, !_metric_allocated, false,
+        "BufferPool(%s) set name failed, need set before reserve", XCAM_STR (_name));
+
+    xcam_free (_name);
+    _name = name ? strndup (name, XCAM_MAX_STR_SIZE) : NULL;
+    return true;
+}
+
+void
+BufferPool::init_metrics_unsafe ()
+{
+    if (_metric_allocated)
+        return;
+
+    std::string metric_name = MetricsRegistry::instance ().instance_name ("buffer_pool", _name);
+
+    _metric_allocated = xcam_metric_counter ("buffer_pool", metric_name.c_str (), "allocated");
+    _metric_in_use = xcam_metric_counter ("buffer_pool", metric_name.c_str (), "in_use");
+    _metric_starved = xcam_metric_counter ("buffer_pool", metric_name.c_str (), "starved");
+    _metric_failed = xcam_metric_counter ("buffer_pool", metric_name.c_str (), "failed");
+    _metric_wait_us = xcam_metric_histogram ("buffer_pool", metric_name.c_str (), "wait_us");
 }
 
 bool
@@ -104,6 +144,7 @@ BufferPool::reserve (uint32_t max_count)
     XCAM_ASSERT (max_count);
 
     SmartLock lock (_mutex);
+    init_metrics_unsafe ();
 
     for (i = _allocated_num; i < max_count; ++i) {
         SmartPtr<BufferData> new_data = allocate_data (_buffer_info);
@@ -122,6 +163,7 @@ BufferPool::reserve (uint32_t max_count)
         XCAM_LOG_WARNING ("BufferPool expect to reserve %d data but only reserved %d", max_count, i);
     }
     _max_count = i;
+    _metric_allocated->add ((int64_t)_max_count - _allocated_num);
     _allocated_num = _max_count;
     _started = true;
 
@@ -148,15 +190,62 @@ BufferPool::add_data_unsafe (const SmartPtr<BufferData> &data)
     if (!data.ptr ())
         return false;
 
+    init_metrics_unsafe ();
     _buf_list.push (data);
     ++_allocated_num;
+    _metric_allocated->add ();
 
     XCAM_ASSERT (_allocated_num <= _max_count || !_max_count);
     return true;
 }
 
+bool
+BufferPool::set_acquire_policy (AcquirePolicy policy, uint32_t grow_count, int32_t timeout)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, policy != AcquireGrow || grow_count, false,
+        "BufferPool(%s) set acquire policy failed, grow policy needs grow count", XCAM_STR (_name));
+
+    SmartLock lock (_mutex);
+    _policy = policy;
+    _grow_count = grow_count;
+    _timeout = timeout;
+    return true;
+}
+
+SmartPtr<BufferData>
+BufferPool::grow_data ()
+{
+    SmartLock lock (_mutex);
+    if (!_started || _allocated_num >= _grow_count)
+        return NULL;
+
+    SmartPtr<BufferData> data = allocate_data (_buffer_info);
+    XCAM_FAIL_RETURN (
+        WARNING, data.ptr (), NULL,
+        "BufferPool(%s) grow failed in allocating data", XCAM_STR (_name));
+
+    ++_allocated_num;
+    _max_count = XCAM_MAX (_max_count, _allocated_num);
+    _metric_allocated->add ();
+    XCAM_LOG_DEBUG ("BufferPool(%s) grew to %d buffers", XCAM_STR (_name), _allocated_num);
+    return data;
+}
+
 SmartPtr<VideoBuffer>
 BufferPool::get_buffer (const SmartPtr<BufferPool> &self)
+{
+    return get_buffer (self, _timeout);
+}
+
+SmartPtr<VideoBuffer>
+BufferPool::try_get_buffer (const SmartPtr<BufferPool> &self)
+{
+    return get_buffer (self, 0);
+}
+
+SmartPtr<VideoBuffer>
+BufferPool::get_buffer (const SmartPtr<BufferPool> &self, int32_t timeout)
 {
     SmartPtr<BufferProxy> ret_buf;
     SmartPtr<BufferData> data;
@@ -174,13 +263,30 @@ BufferPool::get_buffer (const SmartPtr<BufferPool> &self)
         NULL,
         "BufferPool get_buffer failed since parameter<self> not this");
 
-    data = _buf_list.pop ();
+    data = _buf_list.pop (0);
+    if (!data.ptr ()) {
+        _metric_starved->add ();
+        if (_callback.ptr ())
+            _callback->buffer_dry (this);
+
+        if (_policy == AcquireGrow)
+            data = grow_data ();
+
+        if (!data.ptr () && _policy != AcquireFailFast && timeout != 0) {
+            uint64_t wait_start = MetricsRegistry::now_us ();
+            data = _buf_list.pop (timeout);
+            _metric_wait_us->record (MetricsRegistry::now_us () - wait_start);
+        }
+    }
+
     if (!data.ptr ()) {
-        XCAM_LOG_DEBUG ("BufferPool failed to get buffer");
+        _metric_failed->add ();
+        XCAM_LOG_DEBUG ("BufferPool(%s) failed to get buffer", XCAM_STR (_name));
         return NULL;
     }
     ret_buf = create_buffer_from_data (data);
     ret_buf->set_buf_pool (self);
+    _metric_in_use->add ();
 
     return ret_buf;
 }
@@ -204,6 +310,7 @@ BufferPool::stop ()
 void
 BufferPool::release (SmartPtr<BufferData> &data)
 {
+    _metric_in_use->sub ();
     {
         SmartLock lock (_mutex);
         if (!_started)
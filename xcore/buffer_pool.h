@@ -23,6 +23,7 @@
 
 #include <xcam_std.h>
 #include <safe_list.h>
+#include <xcam_metrics.h>
 #include <video_buffer.h>
 
 namespace XCam {
@@ -84,17 +85,57 @@ class BufferPool
 {
     friend class BufferProxy;
 
+public:
+    // what get_buffer does when no free buffer is left
+    enum AcquirePolicy {
+        AcquireBlock = 0,    // wait until a buffer is released or timeout, default
+        AcquireFailFast,     // return NULL at once
+        AcquireGrow,         // allocate more buffers up to grow count, then wait
+    };
+
+    // pool does not know which frames are pending, owners holding them shed frames here,
+    // e.g. drop the oldest pending frame so that a blocking get_buffer gets its buffer
+    class Callback {
+    public:
+        Callback () {}
+        virtual ~Callback () {}
+        // called without pool lock each time acquisition finds no free buffer
+        virtual void buffer_dry (BufferPool *pool) = 0;
+
+    private:
+        XCAM_DEAD_COPY (Callback);
+    };
+
 public:
     explicit BufferPool ();
     virtual ~BufferPool ();
 
     bool set_video_info (const VideoBufferInfo &info);
     bool reserve (uint32_t max_count = 4);
+    // names metrics of "buffer_pool.<name>.*", set before reserve
+    bool set_name (const char *name);
+    const char *get_name () const {
+        return _name;
+    }
 
     SmartPtr<VideoBuffer> create_buffer_from_external_data (const void* data);
 
+    // waits by acquire policy and timeout
     SmartPtr<VideoBuffer> get_buffer (const SmartPtr<BufferPool> &self);
     SmartPtr<VideoBuffer> get_buffer ();
+    // timeout in microseconds, -1 waits until a buffer is released
+    SmartPtr<VideoBuffer> get_buffer (const SmartPtr<BufferPool> &self, int32_t timeout);
+    // never waits, AcquireGrow may still allocate
+    SmartPtr<VideoBuffer> try_get_buffer (const SmartPtr<BufferPool> &self);
+
+    // grow_count is the max buffers of AcquireGrow, timeout in microseconds is applied to get_buffer (self)
+    bool set_acquire_policy (AcquirePolicy policy, uint32_t grow_count = 0, int32_t timeout = -1);
+    AcquirePolicy get_acquire_policy () const {
+        return _policy;
+    }
+    void set_callback (const SmartPtr<Callback> &callback) {
+        _callback = callback;
+    }
 
     void stop ();
 
@@ -121,6 +162,8 @@ protected:
 
 private:
     void release (SmartPtr<BufferData> &data);
+    void init_metrics_unsafe ();
+    SmartPtr<BufferData> grow_data ();
     XCAM_DEAD_COPY (BufferPool);
 
 private:
@@ -130,6 +173,19 @@ private:
     uint32_t                 _allocated_num;
     uint32_t                 _max_count;
     bool                     _started;
+    char                    *_name;
+    AcquirePolicy            _policy;
+    uint32_t                 _grow_count;
+    int32_t                  _timeout;
+    SmartPtr<Callback>       _callback;
+
+    // allocated and in_use are gauges, starved counts get_buffer calls found no free buffer,
+    // failed counts the ones returned NULL
+    MetricCounter           *_metric_allocated;
+    MetricCounter           *_metric_in_use;
+    MetricCounter           *_metric_starved;
+    MetricCounter           *_metric_failed;
+    MetricHistogram         *_metric_wait_us;
 };
 
 class VKDevice;
@@ -42,9 +42,9 @@ public:
         return _file_name;
     }
 
-    XCamReturn open (const char *name, const char *option);
-    XCamReturn close ();
-    XCamReturn rewind ();
+    virtual XCamReturn open (const char *name, const char *option);
+    virtual XCamReturn close ();
+    virtual XCamReturn rewind ();
 
     XCamReturn read_file (void *buf, size_t size);
     XCamReturn write_file (const void *buf, size_t size);
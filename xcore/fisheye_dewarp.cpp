@@ -21,9 +21,136 @@
 
 #include "fisheye_dewarp.h"
 #include "xcam_utils.h"
+#include "work_stealing_pool.h"
+#include <typeinfo>
+#include <unistd.h>
+#include <list>
+
+#define XCAM_LUT_CACHE_MAGIC 0x54554C58 // "XLUT"
+#define XCAM_LUT_CACHE_VERSION 1
+
+// FNV-1a
+#define XCAM_HASH_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define XCAM_HASH_PRIME 0x100000001b3ULL
+
+// minimum table rows per parallel chunk
+#define XCAM_DEWARP_MIN_CHUNK_ROWS 8
 
 namespace XCam {
 
+struct LutCacheHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    key;
+    uint32_t    width;
+    uint32_t    height;
+};
+
+static uint64_t
+hash_bytes (uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= XCAM_HASH_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+static inline uint64_t
+hash_value (uint64_t hash, const T &value)
+{
+    return hash_bytes (hash, &value, sizeof (value));
+}
+
+// hash members one by one, structures may have padding bytes
+static uint64_t
+hash_intrinsic (uint64_t hash, const IntrinsicParameter &intr)
+{
+    hash = hash_value (hash, intr.width);
+    hash = hash_value (hash, intr.height);
+    hash = hash_value (hash, intr.cx);
+    hash = hash_value (hash, intr.cy);
+    hash = hash_value (hash, intr.fx);
+    hash = hash_value (hash, intr.fy);
+    hash = hash_value (hash, intr.fov);
+    hash = hash_value (hash, intr.skew);
+    hash = hash_value (hash, intr.c);
+    hash = hash_value (hash, intr.d);
+    hash = hash_value (hash, intr.e);
+    hash = hash_value (hash, intr.poly_length);
+    hash = hash_value (hash, intr.poly_coeff);
+    return hash_value (hash, (uint32_t)intr.flip);
+}
+
+static uint64_t
+hash_extrinsic (uint64_t hash, const ExtrinsicParameter &extr)
+{
+    hash = hash_value (hash, extr.trans_x);
+    hash = hash_value (hash, extr.trans_y);
+    hash = hash_value (hash, extr.trans_z);
+    hash = hash_value (hash, extr.roll);
+    hash = hash_value (hash, extr.pitch);
+    return hash_value (hash, extr.yaw);
+}
+
+struct DewarpSync {
+    typedef std::list<std::pair<uint32_t, uint32_t>> RowRanges;
+
+    Mutex       mutex;
+    Cond        cond;
+    uint32_t    pending;
+    RowRanges   failed;
+
+    DewarpSync () : pending (0) {}
+};
+
+class DewarpRowsTask
+    : public ThreadPool::UserData
+{
+public:
+    DewarpRowsTask (
+        FisheyeDewarp *dewarper, FisheyeDewarp::MapTable *map_table,
+        uint32_t row_begin, uint32_t row_end, const SmartPtr<DewarpSync> &sync)
+        : _dewarper (dewarper)
+        , _map_table (map_table)
+        , _row_begin (row_begin)
+        , _row_end (row_end)
+        , _sync (sync)
+    {}
+
+    virtual XCamReturn run ();
+    virtual void done (XCamReturn err);
+
+private:
+    FisheyeDewarp              *_dewarper;
+    FisheyeDewarp::MapTable    *_map_table;
+    uint32_t                    _row_begin;
+    uint32_t                    _row_end;
+    SmartPtr<DewarpSync>        _sync;
+};
+
+XCamReturn
+DewarpRowsTask::run ()
+{
+    _dewarper->gen_table_rows (*_map_table, _row_begin, _row_end);
+    return XCAM_RETURN_NO_ERROR;
+}
+
+void
+DewarpRowsTask::done (XCamReturn err)
+{
+    SmartLock locker (_sync->mutex);
+    if (!xcam_ret_is_ok (err)) {
+        XCAM_LOG_WARNING (
+            "dewarp rows(%d-%d) failed in thread pool, error:%d", _row_begin, _row_end, err);
+        _sync->failed.push_back (std::make_pair (_row_begin, _row_end));
+    }
+    --_sync->pending;
+    _sync->cond.broadcast ();
+}
+
 FisheyeDewarp::FisheyeDewarp ()
     : _in_width (0)
     , _in_height (0)
@@ -80,6 +207,149 @@ FisheyeDewarp::get_table_size (uint32_t &width, uint32_t &height)
     height = _tbl_height;
 }
 
+void
+FisheyeDewarp::gen_table (MapTable &map_table)
+{
+    XCAM_ASSERT (map_table.size () >= _tbl_width * _tbl_height);
+    prepare_table ();
+
+    SmartPtr<WorkStealingPool> pool = WorkStealingPool::get_shared_pool ().dynamic_cast_ptr<WorkStealingPool> ();
+    uint32_t chunk_count = 1;
+    // no nested dispatch from pool threads, waiting there may starve the pool
+    if (pool.ptr () && !pool->is_pool_thread ()) {
+        chunk_count = XCAM_MIN (pool->get_max_threads () * 2, _tbl_height / XCAM_DEWARP_MIN_CHUNK_ROWS);
+    }
+
+    if (chunk_count <= 1) {
+        gen_table_rows (map_table, 0, _tbl_height);
+        return;
+    }
+
+    SmartPtr<DewarpSync> sync = new DewarpSync;
+    uint32_t chunk_rows = xcam_ceil (_tbl_height, chunk_count) / chunk_count;
+    uint32_t row_begin = chunk_rows;
+    for (; row_begin < _tbl_height; row_begin += chunk_rows) {
+        uint32_t row_end = XCAM_MIN (row_begin + chunk_rows, _tbl_height);
+        SmartPtr<DewarpRowsTask> task = new DewarpRowsTask (this, &map_table, row_begin, row_end, sync);
+
+        {
+            SmartLock locker (sync->mutex);
+            ++sync->pending;
+        }
+        if (!xcam_ret_is_ok (pool->queue (task))) {
+            {
+                SmartLock locker (sync->mutex);
+                --sync->pending;
+            }
+            gen_table_rows (map_table, row_begin, row_end);
+        }
+    }
+
+    // first chunk in caller thread
+    gen_table_rows (map_table, 0, XCAM_MIN (chunk_rows, _tbl_height));
+
+    DewarpSync::RowRanges failed;
+    {
+        SmartLock locker (sync->mutex);
+        while (sync->pending > 0)
+            sync->cond.wait (sync->mutex);
+        failed.swap (sync->failed);
+    }
+
+    // rows not done by pool, e.g. pool stopped before running them
+    for (DewarpSync::RowRanges::iterator i = failed.begin (); i != failed.end (); ++i)
+        gen_table_rows (map_table, i->first, i->second);
+}
+
+void
+FisheyeDewarp::gen_table_cached (MapTable &map_table, const char *cache_dir)
+{
+    if (!cache_dir || !strlen (cache_dir)) {
+        gen_table (map_table);
+        return;
+    }
+
+    uint64_t key = hash_params (XCAM_HASH_OFFSET_BASIS);
+    char file_name[XCAM_MAX_STR_SIZE] = {'\0'};
+    snprintf (file_name, XCAM_MAX_STR_SIZE, "%s/xcam-lut-%016" PRIx64 ".bin", cache_dir, key);
+
+    if (load_table (map_table, file_name, key)) {
+        XCAM_LOG_DEBUG ("fisheye-dewarp: load table from cache file:%s", file_name);
+        return;
+    }
+
+    gen_table (map_table);
+    save_table (map_table, file_name, key);
+}
+
+uint64_t
+FisheyeDewarp::hash_params (uint64_t hash)
+{
+    const char *type_name = typeid (*this).name ();
+    hash = hash_bytes (hash, type_name, strlen (type_name));
+    hash = hash_value (hash, _in_width);
+    hash = hash_value (hash, _in_height);
+    hash = hash_value (hash, _out_width);
+    hash = hash_value (hash, _out_height);
+    hash = hash_value (hash, _tbl_width);
+    return hash_value (hash, _tbl_height);
+}
+
+bool
+FisheyeDewarp::load_table (MapTable &map_table, const char *file_name, uint64_t key)
+{
+    FILE *fp = fopen (file_name, "rb");
+    if (!fp)
+        return false;
+
+    LutCacheHeader header;
+    size_t count = (size_t)_tbl_width * _tbl_height;
+    bool ret = (fread (&header, sizeof (header), 1, fp) == 1) &&
+               header.magic == XCAM_LUT_CACHE_MAGIC && header.version == XCAM_LUT_CACHE_VERSION &&
+               header.key == key && header.width == _tbl_width && header.height == _tbl_height &&
+               map_table.size () >= count &&
+               fread (map_table.data (), sizeof (PointFloat2), count, fp) == count;
+    fclose (fp);
+
+    if (!ret) {
+        XCAM_LOG_WARNING ("fisheye-dewarp: cache file:%s mismatched or broken, regenerate table", file_name);
+    }
+    return ret;
+}
+
+bool
+FisheyeDewarp::save_table (const MapTable &map_table, const char *file_name, uint64_t key)
+{
+    // write into temporary file then rename, readers never see partial files
+    char tmp_name[XCAM_MAX_STR_SIZE] = {'\0'};
+    snprintf (tmp_name, XCAM_MAX_STR_SIZE, "%s.%d.tmp", file_name, (int)getpid ());
+
+    FILE *fp = fopen (tmp_name, "wb");
+    XCAM_FAIL_RETURN (
+        WARNING, fp, false,
+        "fisheye-dewarp: open cache file:%s failed, %s", tmp_name, strerror (errno));
+
+    LutCacheHeader header;
+    header.magic = XCAM_LUT_CACHE_MAGIC;
+    header.version = XCAM_LUT_CACHE_VERSION;
+    header.key = key;
+    header.width = _tbl_width;
+    header.height = _tbl_height;
+
+    size_t count = (size_t)_tbl_width * _tbl_height;
+    bool ret = (fwrite (&header, sizeof (header), 1, fp) == 1) &&
+               fwrite (map_table.data (), sizeof (PointFloat2), count, fp) == count;
+    ret = (fclose (fp) == 0) && ret;
+
+    if (!ret || rename (tmp_name, file_name) != 0) {
+        XCAM_LOG_WARNING ("fisheye-dewarp: save cache file:%s failed", file_name);
+        unlink (tmp_name);
+        return false;
+    }
+
+    return true;
+}
+
 void
 SphereFisheyeDewarp::set_fisheye_info (const FisheyeInfo &info)
 {
@@ -93,8 +363,22 @@ SphereFisheyeDewarp::set_dst_range (float longitude, float latitude)
     _dst_latitude = latitude;
 }
 
+uint64_t
+SphereFisheyeDewarp::hash_params (uint64_t hash)
+{
+    hash = FisheyeDewarp::hash_params (hash);
+    hash = hash_intrinsic (hash, _info.intrinsic);
+    hash = hash_extrinsic (hash, _info.extrinsic);
+    hash = hash_value (hash, _info.radius);
+    hash = hash_value (hash, _info.distort_coeff);
+    hash = hash_value (hash, _info.c_coeff);
+    hash = hash_value (hash, _info.cam_model);
+    hash = hash_value (hash, _dst_longitude);
+    return hash_value (hash, _dst_latitude);
+}
+
 void
-SphereFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
+SphereFisheyeDewarp::prepare_table ()
 {
     uint32_t tbl_w, tbl_h;
     get_table_size (tbl_w, tbl_h);
@@ -104,33 +388,53 @@ SphereFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
                     tbl_w, tbl_h,
                     _info.intrinsic.cx, _info.intrinsic.cy, _info.intrinsic.fov, _info.radius, _info.extrinsic.roll);
 
-    FisheyeInfo info = _info;
-    info.intrinsic.fov = degree2radian (_info.intrinsic.fov);
-    info.extrinsic.roll = degree2radian (_info.extrinsic.roll);
+    _tbl_info = _info;
+    _tbl_info.intrinsic.fov = degree2radian (_info.intrinsic.fov);
+    _tbl_info.extrinsic.roll = degree2radian (_info.extrinsic.roll);
 
-    PointFloat2 radian_per_pixel;
-    radian_per_pixel.x = degree2radian (_dst_longitude / tbl_w);
-    radian_per_pixel.y = degree2radian (_dst_latitude / tbl_h);
+    _radian_per_pixel.x = degree2radian (_dst_longitude / tbl_w);
+    _radian_per_pixel.y = degree2radian (_dst_latitude / tbl_h);
 
-    PointFloat2 tbl_center (tbl_w / 2.0f, tbl_h / 2.0f);
-    PointFloat2 min_pos (info.intrinsic.cx - info.radius, info.intrinsic.cy - info.radius);
-    PointFloat2 max_pos (info.intrinsic.cx + info.radius, info.intrinsic.cy + info.radius);
+    _tbl_center = PointFloat2 (tbl_w / 2.0f, tbl_h / 2.0f);
+    _min_pos = PointFloat2 (_tbl_info.intrinsic.cx - _tbl_info.radius, _tbl_info.intrinsic.cy - _tbl_info.radius);
+    _max_pos = PointFloat2 (_tbl_info.intrinsic.cx + _tbl_info.radius, _tbl_info.intrinsic.cy + _tbl_info.radius);
 
+    _cos_roll = cos (_tbl_info.extrinsic.roll);
+    _sin_roll = sin (_tbl_info.extrinsic.roll);
+
+    // longitude only depends on column, shared by all rows
+    float half_pi = XCAM_PI / 2.0f;
+    _cos_longitude.resize (tbl_w);
+    _sin_longitude.resize (tbl_w);
+    for (uint32_t col = 0; col < tbl_w; ++col) {
+        float longitude = (col - _tbl_center.x) * _radian_per_pixel.x + half_pi;
+        _cos_longitude[col] = cos (longitude);
+        _sin_longitude[col] = sin (longitude);
+    }
+}
+
+void
+SphereFisheyeDewarp::gen_table_rows (FisheyeDewarp::MapTable &map_table, uint32_t row_begin, uint32_t row_end)
+{
+    uint32_t tbl_w, tbl_h;
+    get_table_size (tbl_w, tbl_h);
+
+    const FisheyeInfo &info = _tbl_info;
     float half_pi = XCAM_PI / 2.0f;
     float double_radius = info.radius * 2.0f;
 
     PointFloat2 *pos;
-    PointFloat2 gps_pos, dst;
-    for(uint32_t row = 0; row < tbl_h; ++row) {
+    PointFloat2 dst;
+    for(uint32_t row = row_begin; row < row_end; ++row) {
+        float latitude = (row - _tbl_center.y) * _radian_per_pixel.y + half_pi;
+        float z = cos (latitude);
+        float sin_latitude = sin (latitude);
+
         for(uint32_t col = 0; col < tbl_w; ++col) {
             pos = &map_table[row * tbl_w + col];
 
-            gps_pos.x = (col - tbl_center.x) * radian_per_pixel.x + half_pi;
-            gps_pos.y = (row - tbl_center.y) * radian_per_pixel.y + half_pi;
-
-            float z = cos (gps_pos.y);
-            float x = sin (gps_pos.y) * cos (gps_pos.x);
-            float y = sin (gps_pos.y) * sin (gps_pos.x);
+            float x = sin_latitude * _cos_longitude[col];
+            float y = sin_latitude * _sin_longitude[col];
             float r_angle = acos (y);
             float r = r_angle * double_radius / info.intrinsic.fov;
             float xz_size = sqrt (x * x + z * z);
@@ -138,12 +442,12 @@ SphereFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
             dst.x = -r * x / xz_size;
             dst.y = -r * z / xz_size;
 
-            pos->x = cos (info.extrinsic.roll) * dst.x - sin (info.extrinsic.roll) * dst.y;
-            pos->y = sin (info.extrinsic.roll) * dst.x + cos (info.extrinsic.roll) * dst.y;
+            pos->x = _cos_roll * dst.x - _sin_roll * dst.y;
+            pos->y = _sin_roll * dst.x + _cos_roll * dst.y;
             pos->x += info.intrinsic.cx;
             pos->y += info.intrinsic.cy;
-            pos->x = XCAM_CLAMP (pos->x, min_pos.x, max_pos.x);
-            pos->y = XCAM_CLAMP (pos->y, min_pos.y, max_pos.y);
+            pos->x = XCAM_CLAMP (pos->x, _min_pos.x, _max_pos.x);
+            pos->y = XCAM_CLAMP (pos->y, _min_pos.y, _max_pos.y);
         }
     }
 }
@@ -172,8 +476,24 @@ BowlFisheyeDewarp::get_intr_param ()
     return _intr_param;
 }
 
+uint64_t
+BowlFisheyeDewarp::hash_params (uint64_t hash)
+{
+    hash = FisheyeDewarp::hash_params (hash);
+    hash = hash_intrinsic (hash, _intr_param);
+    hash = hash_extrinsic (hash, _extr_param);
+    hash = hash_value (hash, _bowl_cfg.a);
+    hash = hash_value (hash, _bowl_cfg.b);
+    hash = hash_value (hash, _bowl_cfg.c);
+    hash = hash_value (hash, _bowl_cfg.angle_start);
+    hash = hash_value (hash, _bowl_cfg.angle_end);
+    hash = hash_value (hash, _bowl_cfg.center_z);
+    hash = hash_value (hash, _bowl_cfg.wall_height);
+    return hash_value (hash, _bowl_cfg.ground_length);
+}
+
 void
-BowlFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
+BowlFisheyeDewarp::prepare_table ()
 {
     uint32_t out_w, out_h, tbl_w, tbl_h;
     get_out_size (out_w, out_h);
@@ -186,12 +506,29 @@ BowlFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
                     _bowl_cfg.ground_length, _bowl_cfg.wall_height,
                     _bowl_cfg.a, _bowl_cfg.b, _bowl_cfg.c, _bowl_cfg.center_z);
 
+    Mat4f rotation_mat = generate_rotation_matrix (degree2radian (_extr_param.roll),
+                         degree2radian (_extr_param.pitch), degree2radian (_extr_param.yaw));
+    Mat4f rotation_tran_mat = rotation_mat;
+    rotation_tran_mat (0, 3) = _extr_param.trans_x;
+    rotation_tran_mat (1, 3) = _extr_param.trans_y;
+    rotation_tran_mat (2, 3) = _extr_param.trans_z;
+
+    _inv_rotation_tran_mat = rotation_tran_mat.inverse ();
+}
+
+void
+BowlFisheyeDewarp::gen_table_rows (FisheyeDewarp::MapTable &map_table, uint32_t row_begin, uint32_t row_end)
+{
+    uint32_t out_w, out_h, tbl_w, tbl_h;
+    get_out_size (out_w, out_h);
+    get_table_size (tbl_w, tbl_h);
+
     float scale_factor_w = (float) out_w / tbl_w;
     float scale_factor_h = (float) out_h / tbl_h;
 
     PointFloat2 img_coord, out_pos;
     PointFloat3 world_coord, cam_coord, cam_world_coord;
-    for(uint32_t row = 0; row < tbl_h; row++) {
+    for(uint32_t row = row_begin; row < row_end; row++) {
         for(uint32_t col = 0; col < tbl_w; col++) {
             out_pos.x = col * scale_factor_w;
             out_pos.y = row * scale_factor_h;
@@ -209,23 +546,18 @@ BowlFisheyeDewarp::gen_table (FisheyeDewarp::MapTable &map_table)
 void
 BowlFisheyeDewarp::cal_cam_world_coord (const PointFloat3 &world_coord, PointFloat3 &cam_world_coord)
 {
-    Mat4f rotation_mat = generate_rotation_matrix (degree2radian (_extr_param.roll),
-                         degree2radian (_extr_param.pitch), degree2radian (_extr_param.yaw));
-    Mat4f rotation_tran_mat = rotation_mat;
-    rotation_tran_mat (0, 3) = _extr_param.trans_x;
-    rotation_tran_mat (1, 3) = _extr_param.trans_y;
-    rotation_tran_mat (2, 3) = _extr_param.trans_z;
-
-    Mat4f world_coord_mat (Vec4f(1.0f, 0.0f, 0.0f, world_coord.x),
-                           Vec4f(0.0f, 1.0f, 0.0f, world_coord.y),
-                           Vec4f(0.0f, 0.0f, 1.0f, world_coord.z),
-                           Vec4f(0.0f, 0.0f, 0.0f, 1.0f));
-
-    Mat4f cam_world_coord_mat = rotation_tran_mat.inverse () * world_coord_mat;
-
-    cam_world_coord.x = cam_world_coord_mat (0, 3);
-    cam_world_coord.y = cam_world_coord_mat (1, 3);
-    cam_world_coord.z = cam_world_coord_mat (2, 3);
+    // last column of inverse (rotation_tran_mat) * translation (world_coord),
+    // accumulated in the same order as Mat4f multiplication
+    const Mat4f &inv = _inv_rotation_tran_mat;
+    float *coord[3] = {&cam_world_coord.x, &cam_world_coord.y, &cam_world_coord.z};
+    for (uint32_t i = 0; i < 3; ++i) {
+        float element = 0.0f;
+        element += inv (i, 0) * world_coord.x;
+        element += inv (i, 1) * world_coord.y;
+        element += inv (i, 2) * world_coord.z;
+        element += inv (i, 3) * 1.0f;
+        *coord[i] = element;
+    }
 }
 
 Mat4f
@@ -273,7 +605,7 @@ PolyBowlFisheyeDewarp::cal_img_coord (const PointFloat3 &cam_coord, PointFloat2
     float p = 1;
     float poly_sum = 0;
 
-    const IntrinsicParameter intr = get_intr_param ();
+    const IntrinsicParameter &intr = get_intr_param ();
 
     if (dist2center != 0) {
         for (uint32_t i = 0; i < intr.poly_length; i++) {
@@ -28,15 +28,24 @@
 
 namespace XCam {
 
+class DewarpRowsTask;
+
 class FisheyeDewarp
 {
+    friend class DewarpRowsTask;
+
 public:
     typedef std::vector<PointFloat2> MapTable;
 
     explicit FisheyeDewarp ();
     virtual ~FisheyeDewarp ();
 
-    virtual void gen_table (MapTable &map_table) = 0;
+    // rows of table are generated in parallel on process-wide work stealing pool
+    virtual void gen_table (MapTable &map_table);
+
+    // load table from cache file in @cache_dir keyed by dewarp parameters and sizes,
+    // generate and save it into @cache_dir on cache miss
+    void gen_table_cached (MapTable &map_table, const char *cache_dir);
 
     void set_in_size (uint32_t width, uint32_t height);
     void set_out_size (uint32_t width, uint32_t height);
@@ -47,7 +56,18 @@ protected:
     void get_out_size (uint32_t &width, uint32_t &height);
     void get_table_size (uint32_t &width, uint32_t &height);
 
+    // hash of all parameters which affect table values
+    virtual uint64_t hash_params (uint64_t hash);
+
+    // compute values shared by all table entries, called once before table rows
+    virtual void prepare_table () {}
+    // generate table rows in [@row_begin, @row_end), called concurrently
+    virtual void gen_table_rows (MapTable &map_table, uint32_t row_begin, uint32_t row_end) = 0;
+
 private:
+    bool load_table (MapTable &map_table, const char *file_name, uint64_t key);
+    bool save_table (const MapTable &map_table, const char *file_name, uint64_t key);
+
     XCAM_DEAD_COPY (FisheyeDewarp);
 
 private:
@@ -66,11 +86,14 @@ public:
     explicit SphereFisheyeDewarp () {}
     virtual ~SphereFisheyeDewarp () {}
 
-    virtual void gen_table (FisheyeDewarp::MapTable &map_table);
-
     void set_fisheye_info (const FisheyeInfo &info);
     void set_dst_range (float longitude, float latitude);
 
+protected:
+    virtual uint64_t hash_params (uint64_t hash);
+    virtual void prepare_table ();
+    virtual void gen_table_rows (FisheyeDewarp::MapTable &map_table, uint32_t row_begin, uint32_t row_end);
+
 private:
     XCAM_DEAD_COPY (SphereFisheyeDewarp);
 
@@ -78,6 +101,17 @@ private:
     FisheyeInfo        _info;
     float              _dst_longitude;
     float              _dst_latitude;
+
+    // per-table values computed in prepare_table
+    FisheyeInfo        _tbl_info;
+    PointFloat2        _radian_per_pixel;
+    PointFloat2        _tbl_center;
+    PointFloat2        _min_pos;
+    PointFloat2        _max_pos;
+    float              _cos_roll;
+    float              _sin_roll;
+    std::vector<float> _cos_longitude;
+    std::vector<float> _sin_longitude;
 };
 
 class BowlFisheyeDewarp
@@ -87,14 +121,15 @@ public:
     explicit BowlFisheyeDewarp () {}
     virtual ~BowlFisheyeDewarp () {}
 
-    virtual void gen_table (FisheyeDewarp::MapTable &map_table);
-
     void set_intr_param (const IntrinsicParameter &intr_param);
     void set_extr_param (const ExtrinsicParameter &extr_param);
     void set_bowl_config (const BowlDataConfig &bowl_cfg);
 
 protected:
     const IntrinsicParameter &get_intr_param ();
+    virtual uint64_t hash_params (uint64_t hash);
+    virtual void prepare_table ();
+    virtual void gen_table_rows (FisheyeDewarp::MapTable &map_table, uint32_t row_begin, uint32_t row_end);
 
 private:
     XCAM_DEAD_COPY (BowlFisheyeDewarp);
@@ -110,6 +145,9 @@ private:
     IntrinsicParameter        _intr_param;
     ExtrinsicParameter        _extr_param;
     BowlDataConfig            _bowl_cfg;
+
+    // inverse of rotation-translation matrix, computed in prepare_table
+    Mat4f                     _inv_rotation_tran_mat;
 };
 
 class PolyBowlFisheyeDewarp
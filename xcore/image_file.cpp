@@ -56,7 +56,12 @@ ImageFile::read_buf (const SmartPtr<VideoBuffer> &buf)
         info.get_planar_info (planar, comp);
         uint32_t row_bytes = planar.width * planar.pixel_bytes;
 
-        for (uint32_t i = 0; i < planar.height; i++) {
+        // rows without padding are read in one call
+        uint32_t rows = (info.strides [comp] == row_bytes) ? 1 : planar.height;
+        if (rows == 1)
+            row_bytes *= planar.height;
+
+        for (uint32_t i = 0; i < rows; i++) {
             if (fread (memory + info.offsets [comp] + i * info.strides [comp], 1, row_bytes, _fp) != row_bytes) {
                 XCamReturn ret = XCAM_RETURN_NO_ERROR;
                 if (end_of_file ()) {
@@ -95,7 +100,11 @@ ImageFile::write_buf (const SmartPtr<VideoBuffer> &buf)
         info.get_planar_info (planar, comp);
         uint32_t row_bytes = planar.width * planar.pixel_bytes;
 
-        for (uint32_t i = 0; i < planar.height; i++) {
+        uint32_t rows = (info.strides [comp] == row_bytes) ? 1 : planar.height;
+        if (rows == 1)
+            row_bytes *= planar.height;
+
+        for (uint32_t i = 0; i < rows; i++) {
             if (fwrite (memory + info.offsets [comp] + i * info.strides [comp], 1, row_bytes, _fp) != row_bytes) {
                 XCAM_LOG_ERROR ("ImageFile write file failed, size doesn't match");
                 buf->unmap ();
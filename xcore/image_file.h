@@ -37,7 +37,7 @@ public:
     virtual ~ImageFile ();
 
     virtual XCamReturn read_buf (const SmartPtr<VideoBuffer> &buf);
-    XCamReturn write_buf (const SmartPtr<VideoBuffer> &buf);
+    virtual XCamReturn write_buf (const SmartPtr<VideoBuffer> &buf);
 
 private:
     XCAM_DEAD_COPY (ImageFile);
@@ -27,9 +27,18 @@ ImageHandler::ImageHandler (const char* name)
     , _enable_allocator (true)
     , _buf_capacity (XCAM_DEFAULT_HANDLER_BUF_CAP)
     , _name (NULL)
+    , _buf_policy (BufferPool::AcquireBlock)
+    , _buf_grow_count (0)
+    , _buf_timeout (-1)
 {
     if (name)
         _name = strndup (name, XCAM_MAX_STR_SIZE);
+
+    std::string metric_name = MetricsRegistry::instance ().instance_name ("handler", _name);
+
+    _metric_frames = xcam_metric_counter ("handler", metric_name.c_str (), "frames");
+    _metric_errors = xcam_metric_counter ("handler", metric_name.c_str (), "errors");
+    _metric_latency_us = xcam_metric_histogram ("handler", metric_name.c_str (), "latency_us");
 }
 
 ImageHandler::~ImageHandler()
@@ -68,6 +77,30 @@ ImageHandler::need_allocator ()
     return _enable_allocator;
 }
 
+bool
+ImageHandler::set_buf_policy (BufferPool::AcquirePolicy policy, uint32_t grow_count, int32_t timeout)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, policy != BufferPool::AcquireGrow || grow_count >= _buf_capacity, false,
+        "ImageHandler(%s) set buf policy failed, grow count(%d) less than buffer capacity(%d)",
+        XCAM_STR (get_name ()), grow_count, _buf_capacity);
+
+    _buf_policy = policy;
+    _buf_grow_count = grow_count;
+    _buf_timeout = timeout;
+    if (_allocator.ptr ())
+        return _allocator->set_acquire_policy (policy, grow_count, timeout);
+    return true;
+}
+
+void
+ImageHandler::set_buf_callback (const SmartPtr<BufferPool::Callback> &callback)
+{
+    _buf_callback = callback;
+    if (_allocator.ptr ())
+        _allocator->set_callback (callback);
+}
+
 bool
 ImageHandler::set_allocator (const SmartPtr<BufferPool> &allocator)
 {
@@ -91,6 +124,9 @@ ImageHandler::configure_rest ()
         XCAM_FAIL_RETURN (
             ERROR, allocator.ptr (), XCAM_RETURN_ERROR_PARAM,
             "image_hander(%s) configure reset failed since allocator not created", XCAM_STR (get_name ()));
+        allocator->set_name (get_name ());
+        allocator->set_acquire_policy (_buf_policy, _buf_grow_count, _buf_timeout);
+        allocator->set_callback (_buf_callback);
         _allocator = allocator;
         XCamReturn ret = reserve_buffers (_out_video_info, _buf_capacity);
         XCAM_FAIL_RETURN (
@@ -111,6 +147,8 @@ ImageHandler::execute_buffer (const SmartPtr<ImageHandler::Parameters> &param, b
         ERROR, param.ptr (), XCAM_RETURN_ERROR_PARAM,
         "image_handler(%s) execute buffer failed, params is null",
         XCAM_STR (get_name ()));
+    XCAM_TRACE_STAMP (param);
+    param->start_time = MetricsRegistry::now_us ();
 
     if (_need_configure) {
         ret = configure_resource (param);
@@ -149,6 +187,7 @@ ImageHandler::execute_done (const SmartPtr<ImageHandler::Parameters> &param, XCa
     if (err < XCAM_RETURN_NO_ERROR) {
         XCAM_LOG_WARNING (
             "image_handler(%s) broken with errno %d", XCAM_STR (get_name ()), (int)err);
+        _metric_errors->add ();
         return ;
     }
 
@@ -178,6 +217,14 @@ ImageHandler::terminate ()
 void
 ImageHandler::execute_status_check (const SmartPtr<ImageHandler::Parameters> &params, const XCamReturn error)
 {
+    XCAM_TRACE_RESUME (params, "handler", get_name ());
+    if (params.ptr () && params->start_time) {
+        _metric_latency_us->record (MetricsRegistry::now_us () - params->start_time);
+        params->start_time = 0;
+    }
+    _metric_frames->add ();
+    if (error < XCAM_RETURN_NO_ERROR)
+        _metric_errors->add ();
     if (_callback.ptr ())
         _callback->execute_status (this, params, error);
 }
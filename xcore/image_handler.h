@@ -25,6 +25,8 @@
 #include <meta_data.h>
 #include <buffer_pool.h>
 #include <worker.h>
+#include <xcam_trace.h>
+#include <xcam_metrics.h>
 
 #define DECLARE_HANDLER_CALLBACK(CbClass, Next, mem_func)                \
     class CbClass : public ::XCam::ImageHandler::Callback {              \
@@ -52,12 +54,17 @@ public:
         SmartPtr<VideoBuffer> out_buf;
 
         Parameters (const SmartPtr<VideoBuffer> &in = NULL, const SmartPtr<VideoBuffer> &out = NULL)
-            : in_buf (in), out_buf (out)
+            : in_buf (in), out_buf (out), start_time (0)
         {}
         virtual ~Parameters() {}
         bool add_meta (const SmartPtr<MetaBase> &meta);
         template <typename MType> SmartPtr<MType> find_meta ();
 
+        // execution start time and frame id, handler span ends in status check
+        XCAM_TRACE_STAMP_DEFINES;
+        // in microseconds, recorded into handler latency in status check
+        uint64_t           start_time;
+
     private:
         MetaBaseList       _metas;
     };
@@ -90,6 +97,9 @@ public:
     bool set_out_video_info (const VideoBufferInfo &info);
     bool enable_allocator (bool enable, uint32_t buf_count = XCAM_DEFAULT_HANDLER_BUF_CAP);
     bool need_allocator ();
+    // acquire policy and dry callback of output buffer pool, execute_buffer fails if no output buffer got
+    bool set_buf_policy (BufferPool::AcquirePolicy policy, uint32_t grow_count = 0, int32_t timeout = -1);
+    void set_buf_callback (const SmartPtr<BufferPool::Callback> &callback);
 
     // virtual functions
     // execute_buffer params should  NOT be const
@@ -130,6 +140,14 @@ private:
     SmartPtr<BufferPool>    _allocator;
     uint32_t                _buf_capacity;
     char                   *_name;
+    BufferPool::AcquirePolicy       _buf_policy;
+    uint32_t                        _buf_grow_count;
+    int32_t                         _buf_timeout;
+    SmartPtr<BufferPool::Callback>  _buf_callback;
+
+    MetricCounter          *_metric_frames;
+    MetricCounter          *_metric_errors;
+    MetricHistogram        *_metric_latency_us;
 };
 
 inline bool
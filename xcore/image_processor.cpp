@@ -144,6 +144,12 @@ ImageProcessor::ImageProcessor (const char* name)
     if (name)
         _name = strndup (name, XCAM_MAX_STR_SIZE);
 
+    std::string metric_name = MetricsRegistry::instance ().instance_name ("processor", _name);
+
+    _metric_queued = xcam_metric_counter ("processor", metric_name.c_str (), "queued");
+    _metric_failed = xcam_metric_counter ("processor", metric_name.c_str (), "failed");
+    _metric_process_us = xcam_metric_histogram ("processor", metric_name.c_str (), "process_us");
+
     SmartPtr<ImageProcessorThread> processor_thread = new ImageProcessorThread (this);
     XCAM_ASSERT (processor_thread.ptr ());
     _processor_thread = processor_thread;
@@ -207,8 +213,10 @@ ImageProcessor::stop()
 XCamReturn
 ImageProcessor::push_buffer (SmartPtr<VideoBuffer> &buf)
 {
-    if (_video_buf_queue.push (buf))
+    if (_video_buf_queue.push (buf)) {
+        _metric_queued->set (_video_buf_queue.size ());
         return XCAM_RETURN_NO_ERROR;
+    }
 
     XCAM_LOG_DEBUG ("processor push buffer failed");
     return XCAM_RETURN_ERROR_UNKNOWN;
@@ -335,10 +343,14 @@ ImageProcessor::buffer_process_loop ()
 
     if (!buf.ptr())
         return XCAM_RETURN_ERROR_MEM;
+    _metric_queued->set (_video_buf_queue.size ());
 
+    uint64_t start_time = MetricsRegistry::now_us ();
     ret = this->process_buffer (buf, new_buf);
+    _metric_process_us->record (MetricsRegistry::now_us () - start_time);
     if (ret < XCAM_RETURN_NO_ERROR) {
         XCAM_LOG_DEBUG ("processing buffer failed");
+        _metric_failed->add ();
         notify_process_buffer_failed (buf);
         return ret;
     }
@@ -25,6 +25,7 @@
 #include <video_buffer.h>
 #include <x3a_result.h>
 #include <safe_list.h>
+#include <xcam_metrics.h>
 
 namespace XCam {
 
@@ -99,6 +100,12 @@ protected:
     SmartPtr<ImageProcessorThread>      _processor_thread;
     VideoBufQueue                       _video_buf_queue;
     SmartPtr<X3aResultsProcessThread>   _results_thread;
+
+private:
+    // "processor.<name>.*", queued is depth of buffer queue
+    MetricCounter                      *_metric_queued;
+    MetricCounter                      *_metric_failed;
+    MetricHistogram                    *_metric_process_us;
 };
 
 };
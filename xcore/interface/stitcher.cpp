@@ -22,6 +22,7 @@
 #include "stitcher.h"
 #include "xcam_utils.h"
 #include "calibration_parser.h"
+#include "xcam_trace.h"
 #include <string>
 
 // angle to position, output range [-180, 180]
@@ -103,6 +104,8 @@ Stitcher::Stitcher (uint32_t align_x, uint32_t align_y)
     , _complete_stitch (true)
     , _need_fm (false)
     , _blend_pyr_levels (2)
+    , _compact_lut (false)
+    , _inflight_frames (1)
 {
     XCAM_ASSERT (align_x >= 1);
     XCAM_ASSERT (align_y >= 1);
@@ -239,6 +242,49 @@ Stitcher::get_camera_info (uint32_t index, CameraInfo &info) const
     return true;
 }
 
+bool
+Stitcher::set_inflight_frames (uint32_t count)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, count > 0 && count <= XCAM_STITCH_MAX_INFLIGHT_FRAMES, false,
+        "stitcher: set inflight frames failed, count(%d) must be in range [1, %d]",
+        count, XCAM_STITCH_MAX_INFLIGHT_FRAMES);
+
+    _inflight_frames = count;
+    return true;
+}
+
+XCamReturn
+Stitcher::submit_buffers (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, _done_bufs.size () < _inflight_frames, XCAM_RETURN_ERROR_ORDER,
+        "stitcher: submit buffers failed, %d frames in flight, fetch buffer first", (int)_done_bufs.size ());
+
+    XCAM_TRACE_BEGIN_FRAME ();
+    XCAM_TRACE_SCOPE ("stitcher", "stitch");
+    SmartPtr<VideoBuffer> buf = out_buf;
+    XCamReturn ret = stitch_buffers (in_bufs, buf);
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), ret,
+        "stitcher: submit buffers failed in stitching");
+
+    _done_bufs.push_back (std::move (buf));
+    return ret;
+}
+
+XCamReturn
+Stitcher::fetch_buffer (SmartPtr<VideoBuffer> &out_buf)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !_done_bufs.empty (), XCAM_RETURN_ERROR_ORDER,
+        "stitcher: fetch buffer failed, no frame in flight");
+
+    out_buf = std::move (_done_bufs.front ());
+    _done_bufs.pop_front ();
+    return XCAM_RETURN_NO_ERROR;
+}
+
 bool
 Stitcher::set_viewpoints_range (const float *range)
 {
@@ -26,11 +26,14 @@
 #include <interface/data_types.h>
 #include <interface/feature_match.h>
 #include <vector>
+#include <string>
+#include <list>
 #include <video_buffer.h>
 
 #define XCAM_STITCH_FISHEYE_MAX_NUM    6
 #define XCAM_STITCH_MAX_CAMERAS XCAM_STITCH_FISHEYE_MAX_NUM
 #define XCAM_STITCH_MIN_SEAM_WIDTH 56
+#define XCAM_STITCH_MAX_INFLIGHT_FRAMES 3
 
 #define INVALID_INDEX (uint32_t)(-1)
 const float ratio = 1.0f / 3.0f;
@@ -236,12 +239,40 @@ public:
         return _blend_pyr_levels;
     }
 
+    // directory to cache generated geomap lookup tables, empty disables cache
+    void set_lut_cache_dir (const char *dir) {
+        _lut_cache_dir = dir ? dir : "";
+    }
+    const char *get_lut_cache_dir () const {
+        return _lut_cache_dir.c_str ();
+    }
+
+    // store geomap lookup tables in int16 fixed-point instead of float
+    void set_compact_lut (bool enable) {
+        _compact_lut = enable;
+    }
+    bool get_compact_lut () const {
+        return _compact_lut;
+    }
+
+    // frames stitched concurrently by submit_buffers, must be set before the first frame
+    bool set_inflight_frames (uint32_t count);
+    uint32_t get_inflight_frames () const {
+        return _inflight_frames;
+    }
+
     bool set_viewpoints_range (const float *range);
     bool set_intrinsic_names (const char *intr_names[]);
     bool set_extrinsic_names (const char *extr_names[]);
 
     virtual XCamReturn stitch_buffers (const VideoBufferList &in_bufs, SmartPtr<VideoBuffer> &out_buf) = 0;
 
+    // pipelined stitching, queue up to get_inflight_frames () frames and fetch outputs in submission order,
+    // @out_buf can be NULL to take output buffer from stitcher allocator,
+    // default implementation stitches each frame in submit_buffers
+    virtual XCamReturn submit_buffers (const VideoBufferList &in_bufs, const SmartPtr<VideoBuffer> &out_buf);
+    virtual XCamReturn fetch_buffer (SmartPtr<VideoBuffer> &out_buf);
+
 protected:
     XCamReturn init_camera_info ();
     XCamReturn estimate_round_slices ();
@@ -312,6 +343,10 @@ private:
     bool                        _need_fm;
 
     uint32_t                    _blend_pyr_levels;
+    std::string                 _lut_cache_dir;
+    bool                        _compact_lut;
+    uint32_t                    _inflight_frames;
+    std::list<SmartPtr<VideoBuffer>> _done_bufs;
 
     StitchInfo                  _stitch_info;
 };
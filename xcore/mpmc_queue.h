@@ -0,0 +1,343 @@
+/*
+ * mpmc_queue.h - bounded lock-free multi-producer multi-consumer queue
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_MPMC_QUEUE_H
+#define XCAM_MPMC_QUEUE_H
+
+#include <base/xcam_defs.h>
+#include <base/xcam_common.h>
+#include <smartptr.h>
+#include <atomic>
+#include <climits>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define XCAM_MPMC_DEFAULT_CAPACITY 4096
+#define XCAM_MPMC_SPIN_COUNT 128
+
+#ifndef XCAM_CACHE_LINE_SIZE
+#define XCAM_CACHE_LINE_SIZE 64
+#endif
+
+namespace XCam {
+
+/*
+ * ring of sequenced cells (D. Vyukov's bounded MPMC queue).
+ * capacity is rounded up to power of 2, push fails when queue is full.
+ * pop spins for a while then sleeps on a futex until push wakes it up,
+ * wait_push does the same on another futex until pop frees a cell.
+ * interface follows SafeList so they can be swapped in ThreadPool.
+ */
+template<class OBj>
+class MpmcQueue {
+public:
+    typedef SmartPtr<OBj> ObjPtr;
+
+    explicit MpmcQueue (uint32_t capacity = XCAM_MPMC_DEFAULT_CAPACITY);
+    ~MpmcQueue ();
+
+    /*
+     * timeout, -1,  wait until wakeup
+     *         >=0,  wait for @timeout microsseconds
+    */
+    inline ObjPtr pop (int32_t timeout = -1);
+    inline bool push (const ObjPtr &obj);
+    // same timeout as pop, false when timed out or push paused
+    inline bool wait_push (const ObjPtr &obj, int32_t timeout = -1);
+    inline bool try_pop (ObjPtr &obj);
+
+    uint32_t capacity () const {
+        return _mask + 1;
+    }
+    uint32_t size () const {
+        size_t tail = _tail.load (std::memory_order_relaxed);
+        size_t head = _head.load (std::memory_order_relaxed);
+        return (tail > head) ? (uint32_t)(tail - head) : 0;
+    }
+    bool is_empty () const {
+        return size () == 0;
+    }
+    void wakeup () {
+        _event.fetch_add (1);
+        futex_wake (_event, INT_MAX);
+    }
+    void pause_pop () {
+        _pop_paused = true;
+        wakeup ();
+    }
+    void resume_pop () {
+        _pop_paused = false;
+    }
+    void pause_push () {
+        _push_paused = true;
+        _space_event.fetch_add (1);
+        futex_wake (_space_event, INT_MAX);
+    }
+    void resume_push () {
+        _push_paused = false;
+    }
+    inline void clear ();
+
+private:
+    struct Cell {
+        std::atomic<size_t>   sequence;
+        ObjPtr                obj;
+    };
+
+    inline int futex_wait (std::atomic<int32_t> &word, int32_t expected, int32_t timeout);
+    inline void futex_wake (std::atomic<int32_t> &word, int32_t count);
+
+    XCAM_DEAD_COPY (MpmcQueue);
+
+private:
+    Cell                         *_cells;
+    size_t                        _mask;
+    // head and tail padded to separate cache lines to avoid false sharing
+    std::atomic<size_t>           _tail;
+    uint8_t                       _tail_pad[XCAM_CACHE_LINE_SIZE - sizeof (std::atomic<size_t>)];
+    std::atomic<size_t>           _head;
+    uint8_t                       _head_pad[XCAM_CACHE_LINE_SIZE - sizeof (std::atomic<size_t>)];
+    std::atomic<int32_t>          _event;
+    std::atomic<int32_t>          _waiters;
+    std::atomic<bool>             _pop_paused;
+    std::atomic<int32_t>          _space_event;
+    std::atomic<int32_t>          _push_waiters;
+    std::atomic<bool>             _push_paused;
+};
+
+template<class OBj>
+MpmcQueue<OBj>::MpmcQueue (uint32_t capacity)
+    : _cells (NULL)
+    , _mask (0)
+    , _tail (0)
+    , _head (0)
+    , _event (0)
+    , _waiters (0)
+    , _pop_paused (false)
+    , _space_event (0)
+    , _push_waiters (0)
+    , _push_paused (false)
+{
+    size_t count = 2;
+    while (count < capacity)
+        count <<= 1;
+
+    _cells = new Cell[count];
+    _mask = count - 1;
+    for (size_t i = 0; i < count; ++i)
+        _cells[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+template<class OBj>
+MpmcQueue<OBj>::~MpmcQueue ()
+{
+    delete [] _cells;
+}
+
+template<class OBj>
+bool
+MpmcQueue<OBj>::push (const typename MpmcQueue<OBj>::ObjPtr &obj)
+{
+    Cell *cell = NULL;
+    size_t pos = _tail.load (std::memory_order_relaxed);
+
+    while (true) {
+        cell = &_cells[pos & _mask];
+        size_t seq = cell->sequence.load (std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (_tail.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = _tail.load (std::memory_order_relaxed);
+        }
+    }
+
+    cell->obj = obj;
+    cell->sequence.store (pos + 1, std::memory_order_release);
+
+    // pairs with the fence in pop, either the waiter sees the new cell or push sees the waiter
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    if (_waiters.load (std::memory_order_relaxed) > 0) {
+        _event.fetch_add (1);
+        futex_wake (_event, 1);
+    }
+    return true;
+}
+
+template<class OBj>
+bool
+MpmcQueue<OBj>::wait_push (const typename MpmcQueue<OBj>::ObjPtr &obj, int32_t timeout)
+{
+    for (uint32_t i = 0; i < XCAM_MPMC_SPIN_COUNT; ++i) {
+        if (_push_paused)
+            return false;
+        if (push (obj))
+            return true;
+        if (i > XCAM_MPMC_SPIN_COUNT / 2)
+            sched_yield ();
+    }
+
+    while (!_push_paused) {
+        int32_t event = _space_event.load ();
+        _push_waiters.fetch_add (1);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+
+        if (push (obj)) {
+            _push_waiters.fetch_sub (1);
+            return true;
+        }
+        if (_push_paused) {
+            _push_waiters.fetch_sub (1);
+            break;
+        }
+
+        int code = futex_wait (_space_event, event, timeout);
+        _push_waiters.fetch_sub (1);
+
+        if (code == ETIMEDOUT) {
+            if (push (obj))
+                return true;
+            XCAM_LOG_DEBUG ("mpmc queue push timeout");
+            return false;
+        }
+    }
+
+    return false;
+}
+
+template<class OBj>
+bool
+MpmcQueue<OBj>::try_pop (typename MpmcQueue<OBj>::ObjPtr &obj)
+{
+    Cell *cell = NULL;
+    size_t pos = _head.load (std::memory_order_relaxed);
+
+    while (true) {
+        cell = &_cells[pos & _mask];
+        size_t seq = cell->sequence.load (std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (_head.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = _head.load (std::memory_order_relaxed);
+        }
+    }
+
+    obj = std::move (cell->obj);
+    cell->sequence.store (pos + _mask + 1, std::memory_order_release);
+
+    // pairs with the fence in wait_push, either the pusher sees the free cell or pop sees the pusher
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    if (_push_waiters.load (std::memory_order_relaxed) > 0) {
+        _space_event.fetch_add (1);
+        futex_wake (_space_event, 1);
+    }
+    return true;
+}
+
+template<class OBj>
+typename MpmcQueue<OBj>::ObjPtr
+MpmcQueue<OBj>::pop (int32_t timeout)
+{
+    ObjPtr obj;
+
+    for (uint32_t i = 0; i < XCAM_MPMC_SPIN_COUNT; ++i) {
+        if (_pop_paused)
+            return NULL;
+        if (try_pop (obj))
+            return obj;
+        if (i > XCAM_MPMC_SPIN_COUNT / 2)
+            sched_yield ();
+    }
+
+    while (!_pop_paused) {
+        int32_t event = _event.load ();
+        _waiters.fetch_add (1);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+
+        if (try_pop (obj)) {
+            _waiters.fetch_sub (1);
+            return obj;
+        }
+        if (_pop_paused) {
+            _waiters.fetch_sub (1);
+            break;
+        }
+
+        int code = futex_wait (_event, event, timeout);
+        _waiters.fetch_sub (1);
+
+        if (code == ETIMEDOUT) {
+            if (try_pop (obj))
+                return obj;
+            XCAM_LOG_DEBUG ("mpmc queue pop timeout");
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+template<class OBj>
+void
+MpmcQueue<OBj>::clear ()
+{
+    ObjPtr obj;
+    while (try_pop (obj))
+        obj.release ();
+}
+
+template<class OBj>
+int
+MpmcQueue<OBj>::futex_wait (std::atomic<int32_t> &word, int32_t expected, int32_t timeout)
+{
+    struct timespec ts;
+    struct timespec *pts = NULL;
+    if (timeout >= 0) {
+        ts.tv_sec = timeout / 1000000;
+        ts.tv_nsec = (timeout % 1000000) * 1000;
+        pts = &ts;
+    }
+
+    long ret = syscall (
+        SYS_futex, reinterpret_cast<int32_t *> (&word), FUTEX_WAIT_PRIVATE, expected, pts, NULL, 0);
+    return (ret == 0) ? 0 : errno;
+}
+
+template<class OBj>
+void
+MpmcQueue<OBj>::futex_wake (std::atomic<int32_t> &word, int32_t count)
+{
+    syscall (SYS_futex, reinterpret_cast<int32_t *> (&word), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+};
+
+#endif //XCAM_MPMC_QUEUE_H
@@ -48,6 +48,7 @@ public:
     */
     inline ObjPtr pop (int32_t timeout = -1);
     inline bool push (const ObjPtr &obj);
+    inline bool push (ObjPtr &&obj);
     inline bool erase (const ObjPtr &obj);
     inline ObjPtr front ();
     uint32_t size () {
@@ -106,7 +107,7 @@ SafeList<OBj>::pop (int32_t timeout)
         return NULL;
     }
 
-    SafeList<OBj>::ObjPtr obj = *_obj_list.begin ();
+    SafeList<OBj>::ObjPtr obj = std::move (*_obj_list.begin ());
     _obj_list.erase (_obj_list.begin ());
     return obj;
 }
@@ -121,6 +122,16 @@ SafeList<OBj>::push (const SafeList<OBj>::ObjPtr &obj)
     return true;
 }
 
+template<class OBj>
+bool
+SafeList<OBj>::push (SafeList<OBj>::ObjPtr &&obj)
+{
+    SmartLock lock (_mutex);
+    _obj_list.push_back (std::move (obj));
+    _new_obj_cond.signal ();
+    return true;
+}
+
 template<class OBj>
 bool
 SafeList<OBj>::erase (const SafeList<OBj>::ObjPtr &obj)
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <atomic>
 #include <type_traits>
+#include <utility>
 #include <base/xcam_defs.h>
 
 namespace XCam {
@@ -64,6 +65,31 @@ public:
     virtual bool is_a_object () const {
         return false;
     }
+    // object is allocated together with ref count and destroyed by it
+    virtual bool owns_object () const {
+        return false;
+    }
+};
+
+// single allocation of ref count and object, created by make_smart
+template<typename Obj>
+class RefCountObj
+    : public RefCount
+{
+public:
+    template <typename... Args>
+    explicit RefCountObj (Args&&... args)
+        : _obj (std::forward<Args> (args)...)
+    {}
+    virtual bool owns_object () const {
+        return true;
+    }
+    Obj *get_obj () {
+        return &_obj;
+    }
+
+private:
+    Obj     _obj;
 };
 
 template<typename Obj>
@@ -84,6 +110,7 @@ template <typename Obj>
 class SmartPtr {
 private:
     template<typename ObjDerive> friend class SmartPtr;
+    template<typename ObjT, typename... Args> friend SmartPtr<ObjT> make_smart_obj (std::false_type, Args&&... args);
 public:
     SmartPtr (Obj *obj = NULL)
         : _ptr (obj), _ref(NULL)
@@ -120,6 +147,22 @@ public:
         }
     }
 
+    // move from pointer, no ref count change
+    SmartPtr (SmartPtr<Obj> &&obj)
+        : _ptr(obj._ptr), _ref(obj._ref)
+    {
+        obj._ptr = NULL;
+        obj._ref = NULL;
+    }
+
+    template <typename ObjDerive>
+    SmartPtr (SmartPtr<ObjDerive> &&obj)
+        : _ptr(obj._ptr), _ref(obj._ref)
+    {
+        obj._ptr = NULL;
+        obj._ref = NULL;
+    }
+
     ~SmartPtr () {
         release();
     }
@@ -151,6 +194,21 @@ public:
         return *this;
     }
 
+    SmartPtr<Obj> & operator = (SmartPtr<Obj> &&obj) {
+        if (this != &obj) {
+            release ();
+            move_pointer (obj);
+        }
+        return *this;
+    }
+
+    template <typename ObjDerive>
+    SmartPtr<Obj> & operator = (SmartPtr<ObjDerive> &&obj) {
+        release ();
+        move_pointer (obj);
+        return *this;
+    }
+
     Obj *operator -> () const {
         return _ptr;
     }
@@ -167,11 +225,14 @@ public:
         if (!_ref->unref()) {
             if (!_ref->is_a_object ()) {
                 //XCAM_ASSERT (dynamic_cast<RefCount*>(_ref));
+                bool owns_object = static_cast<RefCount*> (_ref)->owns_object ();
                 delete _ref;
+                if (!owns_object)
+                    delete _ptr;
             } else {
                 //XCAM_ASSERT (dynamic_cast<Obj*>(_ref) == _ptr);
+                delete _ptr;
             }
-            delete _ptr;
         }
         _ptr = NULL;
         _ref = NULL;
@@ -195,6 +256,19 @@ public:
     }
 
 private:
+    // take over ref of count 1
+    SmartPtr (Obj *obj, RefObj *ref)
+        : _ptr (obj), _ref (ref)
+    {}
+
+    template <typename ObjD>
+    void move_pointer (SmartPtr<ObjD> &obj) {
+        _ptr = obj._ptr;
+        _ref = obj._ref;
+        obj._ptr = NULL;
+        obj._ref = NULL;
+    }
+
     template <typename ObjD>
     void set_pointer (ObjD *obj, RefObj *ref) {
         if (!obj)
@@ -223,5 +297,30 @@ private:
     mutable RefObj   *_ref;
 };
 
+/*
+ * make_smart<Obj> (args...), constructs Obj with args.
+ * RefObj derived Obj carries its own ref count, others are allocated together with
+ * the ref count in one block, so their ptr() must not be deleted or wrapped again.
+ */
+template<typename Obj, typename... Args>
+SmartPtr<Obj> make_smart_obj (std::true_type, Args&&... args)
+{
+    return SmartPtr<Obj> (new Obj (std::forward<Args> (args)...));
+}
+
+template<typename Obj, typename... Args>
+SmartPtr<Obj> make_smart_obj (std::false_type, Args&&... args)
+{
+    RefCountObj<Obj> *ref = new RefCountObj<Obj> (std::forward<Args> (args)...);
+    return SmartPtr<Obj> (ref->get_obj (), ref);
+}
+
+template<typename Obj, typename... Args>
+SmartPtr<Obj> make_smart (Args&&... args)
+{
+    typedef std::is_base_of<RefObj, Obj> BaseCheck;
+    return make_smart_obj<Obj> (BaseCheck (), std::forward<Args> (args)...);
+}
+
 }; // end namespace
 #endif //XCAM_SMARTPTR_H
@@ -19,6 +19,7 @@
  */
 
 #include "thread_pool.h"
+#include "xcam_numa.h"
 
 #define XCAM_POOL_MIN_THREADS 2
 #define XCAM_POOL_MAX_THREADS 1024
@@ -61,30 +62,22 @@ bool
 UserThread::loop ()
 {
     XCAM_ASSERT (_pool.ptr ());
-    {
-        SmartLock lock (_pool->_mutex);
-        if (!_pool->_running)
-            return false;
-    }
+    if (!_pool->_running)
+        return false;
 
-    SmartPtr<ThreadPool::UserData> data = _pool->_data_queue.pop ();
+    SmartPtr<ThreadPool::UserData> data = _pool->pop_data ();
     if (!data.ptr ()) {
         XCAM_LOG_DEBUG ("user thread(%s) get null data, need stop", XCAM_STR (_pool->get_name ()));
         return false;
     }
 
-    {
-        SmartLock lock (_pool->_mutex);
-        XCAM_ASSERT (_pool->_free_threads > 0);
-        --_pool->_free_threads;
-    }
+    XCAM_ASSERT (_pool->_free_threads > 0);
+    --_pool->_free_threads;
 
     bool ret = _pool->dispatch (data);
 
-    if (ret) {
-        SmartLock lock (_pool->_mutex);
+    if (ret)
         ++_pool->_free_threads;
-    }
     return ret;
 }
 
@@ -94,8 +87,13 @@ ThreadPool::dispatch (const SmartPtr<ThreadPool::UserData> &data)
     XCAM_FAIL_RETURN (
         ERROR, data.ptr(), true,
         "ThreadPool(%s) dispatch NULL data", XCAM_STR (get_name ()));
+    XCAM_TRACE_RESUME (data, "pool", "queue wait");
+    _metric_wait_us->record (MetricsRegistry::now_us () - data->queue_time);
+
+    _metric_busy->add ();
     XCamReturn err = data->run ();
     data->done (err);
+    _metric_busy->sub ();
     return true;
 }
 
@@ -106,9 +104,18 @@ ThreadPool::ThreadPool (const char *name)
     , _allocated_threads (0)
     , _free_threads (0)
     , _running (false)
+    , _fifo_priority (0)
+    , _ring_pushers (0)
 {
     if (name)
         _name = strndup (name, XCAM_MAX_STR_SIZE);
+
+    std::string metric_name = MetricsRegistry::instance ().instance_name ("thread_pool", _name);
+
+    _metric_threads = xcam_metric_counter ("thread_pool", metric_name.c_str (), "threads");
+    _metric_busy = xcam_metric_counter ("thread_pool", metric_name.c_str (), "busy");
+    _metric_queued = xcam_metric_counter ("thread_pool", metric_name.c_str (), "queued");
+    _metric_wait_us = xcam_metric_histogram ("thread_pool", metric_name.c_str (), "wait_us");
 }
 
 ThreadPool::~ThreadPool ()
@@ -138,6 +145,95 @@ ThreadPool::set_threads (uint32_t min, uint32_t max)
     return true;
 }
 
+bool
+ThreadPool::set_lock_free (bool enable, uint32_t capacity)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !_running, false,
+        "ThreadPool(%s) set lock free failed, need stop the pool first", XCAM_STR(get_name ()));
+
+    if (enable) {
+        _ring_queue = new MpmcQueue<UserData> (capacity);
+        XCAM_ASSERT (_ring_queue.ptr ());
+    } else {
+        _ring_queue.release ();
+    }
+    return true;
+}
+
+bool
+ThreadPool::set_cpus (const std::vector<uint32_t> &cpus)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !is_running (), false,
+        "ThreadPool(%s) set cpus failed, need stop the pool first", XCAM_STR(get_name ()));
+
+    _cpus = cpus;
+    return true;
+}
+
+bool
+ThreadPool::set_numa_node (uint32_t node)
+{
+    std::vector<uint32_t> cpus;
+    XCAM_FAIL_RETURN (
+        ERROR, NumaTopology::get_node_cpus (node, cpus), false,
+        "ThreadPool(%s) set numa node(%d) failed", XCAM_STR(get_name ()), node);
+
+    return set_cpus (cpus);
+}
+
+bool
+ThreadPool::set_fifo_priority (int32_t priority)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, !is_running (), false,
+        "ThreadPool(%s) set fifo priority failed, need stop the pool first", XCAM_STR(get_name ()));
+
+    _fifo_priority = priority;
+    return true;
+}
+
+void
+ThreadPool::setup_thread (Thread *thread) const
+{
+    XCAM_ASSERT (thread);
+    thread->set_cpus (_cpus);
+    thread->set_fifo_priority (_fifo_priority);
+}
+
+SmartPtr<ThreadPool::UserData>
+ThreadPool::pop_data ()
+{
+    SmartPtr<UserData> data = _ring_queue.ptr () ? _ring_queue->pop () : _data_queue.pop ();
+    if (data.ptr ())
+        _metric_queued->sub ();
+    return data;
+}
+
+bool
+ThreadPool::push_data (const SmartPtr<UserData> &data)
+{
+    data->queue_time = MetricsRegistry::now_us ();
+    if (!_ring_queue.ptr ()) {
+        if (!_data_queue.push (data))
+            return false;
+        _metric_queued->add ();
+        return true;
+    }
+
+    // running is checked after joining pushers, stop () clears it before waiting them out,
+    // so an item is either refused here or left in ring for stop () to finish
+    ++_ring_pushers;
+    // ring is bounded, wait for consumers to free a cell when full
+    bool pushed = _running && _ring_queue->wait_push (data);
+    --_ring_pushers;
+    if (!pushed)
+        return false;
+    _metric_queued->add ();
+    return true;
+}
+
 bool
 ThreadPool::is_running ()
 {
@@ -155,6 +251,10 @@ ThreadPool::start ()
     _free_threads = 0;
     _allocated_threads = 0;
     _data_queue.resume_pop ();
+    if (_ring_queue.ptr ()) {
+        _ring_queue->resume_push ();
+        _ring_queue->resume_pop ();
+    }
 
     for (uint32_t i = 0; i < _min_threads; ++i) {
         XCamReturn ret = create_user_thread_unsafe ();
@@ -191,8 +291,23 @@ ThreadPool::stop ()
     }
 
     _data_queue.pause_pop ();
+    _metric_queued->sub (_data_queue.size ());
     _data_queue.clear ();
 
+    // items pushed to ring were accepted by queue (), finish them instead of dropping
+    std::list<SmartPtr<UserData> > dropped;
+    if (_ring_queue.ptr ()) {
+        _ring_queue->pause_push ();
+        while (_ring_pushers > 0)
+            sched_yield ();
+
+        _ring_queue->pause_pop ();
+        SmartPtr<UserData> data;
+        while (_ring_queue->try_pop (data))
+            dropped.push_back (data);
+        _metric_queued->sub (dropped.size ());
+    }
+
     for (UserThreadList::iterator i = threads.begin (); i != threads.end (); ++i)
     {
         SmartPtr<UserThread> t = *i;
@@ -202,10 +317,15 @@ ThreadPool::stop ()
 
     {
         SmartLock locker(_mutex);
+        _metric_threads->sub (_allocated_threads);
         _free_threads = 0;
         _allocated_threads = 0;
     }
 
+    for (std::list<SmartPtr<UserData> >::iterator i = dropped.begin (); i != dropped.end (); ++i) {
+        (*i)->done (XCAM_RETURN_ERROR_THREAD);
+    }
+
     return XCAM_RETURN_NO_ERROR;
 }
 
@@ -213,9 +333,10 @@ XCamReturn
 ThreadPool::create_user_thread_unsafe ()
 {
     char name[256];
-    snprintf (name, 255, "%s-%d", XCAM_STR (get_name()), _allocated_threads);
+    snprintf (name, 255, "%s-%d", XCAM_STR (get_name()), _allocated_threads.load ());
     SmartPtr<UserThread> thread = new UserThread (this, name);
     XCAM_ASSERT (thread.ptr ());
+    setup_thread (thread.ptr ());
     XCAM_FAIL_RETURN (
         ERROR, thread.ptr () && thread->start (), XCAM_RETURN_ERROR_THREAD,
         "ThreadPool(%s) create user thread failed by starting error", XCAM_STR (get_name()));
@@ -224,6 +345,7 @@ ThreadPool::create_user_thread_unsafe ()
 
     ++_allocated_threads;
     ++_free_threads;
+    _metric_threads->add ();
     XCAM_ASSERT (_free_threads <= _allocated_threads);
 
     return XCAM_RETURN_NO_ERROR;
@@ -233,19 +355,25 @@ XCamReturn
 ThreadPool::queue (const SmartPtr<UserData> &data)
 {
     XCAM_ASSERT (data.ptr ());
-    {
-        SmartLock locker (_mutex);
-        if (!_running)
-            return XCAM_RETURN_ERROR_THREAD;
-    }
+    if (!_running)
+        return XCAM_RETURN_ERROR_THREAD;
 
-    if (!_data_queue.push (data))
+    XCAM_TRACE_STAMP (data);
+    if (!push_data (data))
         return XCAM_RETURN_ERROR_THREAD;
 
+    // fast path, no need to lock when pool can't grow
+    if (_allocated_threads >= _max_threads || !_free_threads)
+        return XCAM_RETURN_NO_ERROR;
+
     do {
         SmartLock locker(_mutex);
         if (!_running) {
-            _data_queue.erase (data);
+            // item in ring runs or gets finished by stop (), reporting error would count it twice
+            if (_ring_queue.ptr ())
+                return XCAM_RETURN_NO_ERROR;
+            if (_data_queue.erase (data))
+                _metric_queued->sub ();
             return XCAM_RETURN_ERROR_THREAD;
         }
 
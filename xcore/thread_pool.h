@@ -23,7 +23,10 @@
 
 #include <xcam_std.h>
 #include <safe_list.h>
+#include <mpmc_queue.h>
 #include <xcam_thread.h>
+#include <xcam_trace.h>
+#include <xcam_metrics.h>
 
 namespace XCam {
 
@@ -38,10 +41,15 @@ class ThreadPool
 public:
     class UserData {
     public:
-        UserData () {}
+        UserData () : queue_time (0) {}
         virtual ~UserData () {}
         virtual XCamReturn run () = 0;
         virtual void done (XCamReturn) {}
+
+        // queued time and frame id of queuing thread
+        XCAM_TRACE_STAMP_DEFINES;
+        // in microseconds, recorded into pool wait_us when dispatched
+        uint64_t queue_time;
     private:
         XCAM_DEAD_COPY (UserData);
     };
@@ -50,33 +58,60 @@ public:
     explicit ThreadPool (const char *name);
     virtual ~ThreadPool ();
     bool set_threads (uint32_t min, uint32_t max);
+    // dispatch items through bounded lock-free ring instead of SafeList, set before start
+    bool set_lock_free (bool enable, uint32_t capacity = XCAM_MPMC_DEFAULT_CAPACITY);
+    // pin pool threads to @cpus, set before start
+    bool set_cpus (const std::vector<uint32_t> &cpus);
+    // pin pool threads to cpus of numa @node, set before start
+    bool set_numa_node (uint32_t node);
+    // run pool threads with SCHED_FIFO for latency critical stages, 0 keeps default, set before start
+    bool set_fifo_priority (int32_t priority);
+    uint32_t get_max_threads () const {
+        return _max_threads;
+    }
     const char *get_name () const {
         return _name;
     }
-    bool is_running ();
+    virtual bool is_running ();
 
-    XCamReturn start ();
-    XCamReturn stop ();
-    XCamReturn queue (const SmartPtr<UserData> &data);
+    virtual XCamReturn start ();
+    virtual XCamReturn stop ();
+    virtual XCamReturn queue (const SmartPtr<UserData> &data);
 
 protected:
     bool dispatch (const SmartPtr<UserData> &data);
     XCamReturn create_user_thread_unsafe ();
+    SmartPtr<UserData> pop_data ();
+    bool push_data (const SmartPtr<UserData> &data);
+    void setup_thread (Thread *thread) const;
 
 private:
     XCAM_DEAD_COPY (ThreadPool);
 
+protected:
+    // "thread_pool.<name>.*", threads, busy and queued are gauges
+    MetricCounter          *_metric_threads;
+    MetricCounter          *_metric_busy;
+    MetricCounter          *_metric_queued;
+    MetricHistogram        *_metric_wait_us;
+
 private:
     char                   *_name;
     uint32_t                _min_threads;
     uint32_t                _max_threads;
-    uint32_t                _allocated_threads;
-    uint32_t                _free_threads;
-    bool                    _running;
+    std::atomic<uint32_t>   _allocated_threads;
+    std::atomic<uint32_t>   _free_threads;
+    std::atomic<bool>       _running;
     UserThreadList          _thread_list;
     Mutex                   _mutex;
 
-    SafeList<UserData>      _data_queue;
+    std::vector<uint32_t>   _cpus;
+    int32_t                 _fifo_priority;
+
+    SafeList<UserData>              _data_queue;
+    SmartPtr<MpmcQueue<UserData> >  _ring_queue;
+    // queue () calls pushing to ring, stop () waits them out before draining it
+    std::atomic<uint32_t>           _ring_pushers;
 };
 
 }
@@ -0,0 +1,420 @@
+/*
+ * work_stealing_pool.cpp - work stealing thread pool
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "work_stealing_pool.h"
+#include <unistd.h>
+#include <deque>
+
+#define XCAM_STEALING_DEFAULT_THREADS 4
+#define XCAM_STEALING_MAX_DONE_THREADS 64
+
+namespace XCam {
+
+static thread_local const WorkStealingPool *tls_pool = NULL;
+static thread_local uint32_t tls_index = 0;
+
+struct StealingDeque {
+    Mutex                                      mutex;
+    std::deque<SmartPtr<ThreadPool::UserData> > items;
+};
+
+class StealingThread
+    : public Thread
+{
+public:
+    StealingThread (WorkStealingPool *pool, uint32_t index, const char *name)
+        : Thread (name)
+        , _pool (pool)
+        , _index (index)
+    {}
+
+protected:
+    virtual bool started ();
+    virtual bool loop ();
+
+private:
+    WorkStealingPool   *_pool;
+    uint32_t            _index;
+};
+
+bool
+StealingThread::started ()
+{
+    tls_pool = _pool;
+    tls_index = _index;
+    return true;
+}
+
+bool
+StealingThread::loop ()
+{
+    SmartPtr<ThreadPool::UserData> data;
+    if (!_pool->fetch (_index, data))
+        return false;
+
+    return _pool->dispatch (data);
+}
+
+class StealingDoneThread
+    : public Thread
+{
+public:
+    StealingDoneThread (WorkStealingPool *pool, const char *name)
+        : Thread (name)
+        , _pool (pool)
+    {}
+
+protected:
+    virtual bool loop ();
+
+private:
+    WorkStealingPool   *_pool;
+};
+
+bool
+StealingDoneThread::loop ()
+{
+    SmartPtr<ThreadPool::UserData> data;
+    if (!_pool->fetch_done (data))
+        return false;
+
+    data->done (data->run ());
+    return true;
+}
+
+WorkStealingPool::WorkStealingPool (const char *name)
+    : ThreadPool (name)
+    , _deques (NULL)
+    , _deque_count (0)
+    , _running (false)
+    , _pending_items (0)
+    , _idle_threads (0)
+    , _next_deque (0)
+    , _idle_done_threads (0)
+{
+    long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+    uint32_t count = (cpus > 0) ? (uint32_t)cpus : XCAM_STEALING_DEFAULT_THREADS;
+    set_threads (count, count);
+}
+
+WorkStealingPool::~WorkStealingPool ()
+{
+    stop ();
+}
+
+static Mutex shared_mutex;
+static SmartPtr<ThreadPool> shared_pool;
+// 0 takes online cpu count
+static uint32_t shared_threads = 0;
+
+static SmartPtr<ThreadPool>
+create_shared_pool ()
+{
+    SmartPtr<ThreadPool> pool = new WorkStealingPool ("xcam-shared");
+    XCAM_ASSERT (pool.ptr ());
+    if (shared_threads)
+        pool->set_threads (shared_threads, shared_threads);
+    XCamReturn ret = pool->start ();
+    XCAM_FAIL_RETURN (
+        ERROR, xcam_ret_is_ok (ret), NULL,
+        "work stealing pool start shared pool with %d threads failed", shared_threads);
+    return pool;
+}
+
+SmartPtr<ThreadPool>
+WorkStealingPool::get_shared_pool ()
+{
+    SmartLock locker (shared_mutex);
+    if (shared_pool.ptr () && shared_pool->is_running ())
+        return shared_pool;
+
+    shared_pool = create_shared_pool ();
+    return shared_pool;
+}
+
+bool
+WorkStealingPool::set_shared_threads (uint32_t count)
+{
+    SmartLock locker (shared_mutex);
+    shared_threads = count;
+    if (!shared_pool.ptr () || !shared_pool->is_running ())
+        return true;
+
+    // swap in a new pool, holders of the old one keep it running until they release it
+    SmartPtr<ThreadPool> pool = create_shared_pool ();
+    XCAM_FAIL_RETURN (
+        ERROR, pool.ptr (), false,
+        "work stealing pool swap shared pool with %d threads failed", count);
+    shared_pool = pool;
+    return true;
+}
+
+bool
+WorkStealingPool::is_pool_thread () const
+{
+    return tls_pool == this;
+}
+
+bool
+WorkStealingPool::is_running ()
+{
+    return _running;
+}
+
+XCamReturn
+WorkStealingPool::start ()
+{
+    bool ok = true;
+    {
+        SmartLock locker (_pool_mutex);
+        if (_running)
+            return XCAM_RETURN_NO_ERROR;
+
+        XCAM_ASSERT (!_deques && _threads.empty ());
+        _deque_count = get_max_threads ();
+        _deques = new StealingDeque[_deque_count];
+        _pending_items = 0;
+        _running = true;
+
+        for (uint32_t i = 0; i < _deque_count; ++i) {
+            char name[256];
+            snprintf (name, 255, "%s-%d", XCAM_STR (get_name ()), i);
+            SmartPtr<StealingThread> thread = new StealingThread (this, i, name);
+            XCAM_ASSERT (thread.ptr ());
+            setup_thread (thread.ptr ());
+            if (!thread->start ()) {
+                XCAM_LOG_ERROR ("work stealing pool(%s) start thread(%d) failed", XCAM_STR (get_name ()), i);
+                ok = false;
+                break;
+            }
+            _threads.push_back (thread);
+            _metric_threads->add ();
+        }
+    }
+
+    if (!ok) {
+        stop ();
+        return XCAM_RETURN_ERROR_THREAD;
+    }
+
+    XCAM_LOG_DEBUG ("work stealing pool(%s) started with %d threads", XCAM_STR (get_name ()), _deque_count);
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+WorkStealingPool::stop ()
+{
+    StealingThreadList threads;
+    {
+        SmartLock locker (_pool_mutex);
+        threads.swap (_threads);
+        _running = false;
+    }
+
+    {
+        SmartLock locker (_idle_mutex);
+        _idle_cond.broadcast ();
+    }
+
+    DoneThreadList done_threads;
+    {
+        SmartLock locker (_done_mutex);
+        done_threads.swap (_done_threads);
+        _done_cond.broadcast ();
+    }
+
+    for (StealingThreadList::iterator i = threads.begin (); i != threads.end (); ++i) {
+        (*i)->emit_stop ();
+    }
+    for (DoneThreadList::iterator i = done_threads.begin (); i != done_threads.end (); ++i) {
+        (*i)->emit_stop ();
+    }
+    for (StealingThreadList::iterator i = threads.begin (); i != threads.end (); ++i) {
+        (*i)->stop ();
+    }
+    for (DoneThreadList::iterator i = done_threads.begin (); i != done_threads.end (); ++i) {
+        (*i)->stop ();
+    }
+
+    _metric_threads->sub (threads.size ());
+
+    // queue () holds pool lock, nothing is queued once running is cleared
+    std::list<SmartPtr<UserData> > dropped;
+    {
+        SmartLock locker (_pool_mutex);
+        if (_running)
+            return XCAM_RETURN_NO_ERROR;
+
+        for (uint32_t i = 0; i < _deque_count; ++i) {
+            dropped.insert (dropped.end (), _deques[i].items.begin (), _deques[i].items.end ());
+        }
+        delete [] _deques;
+        _deques = NULL;
+        _deque_count = 0;
+        _metric_queued->sub (_pending_items);
+        _pending_items = 0;
+    }
+    {
+        // queue_done () checks running under done lock
+        SmartLock locker (_done_mutex);
+        dropped.splice (dropped.end (), _done_items);
+    }
+
+    // owners count their items down in done ()
+    for (std::list<SmartPtr<UserData> >::iterator i = dropped.begin (); i != dropped.end (); ++i) {
+        (*i)->done (XCAM_RETURN_ERROR_THREAD);
+    }
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+WorkStealingPool::queue (const SmartPtr<UserData> &data)
+{
+    XCAM_ASSERT (data.ptr ());
+    {
+        // deques are freed by stop () under pool lock
+        SmartLock pool_locker (_pool_mutex);
+        if (!_running)
+            return XCAM_RETURN_ERROR_THREAD;
+
+        uint32_t index = is_pool_thread () ? tls_index : (_next_deque++ % _deque_count);
+        XCAM_TRACE_STAMP (data);
+        data->queue_time = MetricsRegistry::now_us ();
+        ++_pending_items;
+        _metric_queued->add ();
+
+        SmartLock locker (_deques[index].mutex);
+        _deques[index].items.push_back (data);
+    }
+
+    wakeup_one ();
+    return XCAM_RETURN_NO_ERROR;
+}
+
+XCamReturn
+WorkStealingPool::queue_done (const SmartPtr<UserData> &data)
+{
+    XCAM_ASSERT (data.ptr ());
+    SmartLock locker (_done_mutex);
+    if (!_running)
+        return XCAM_RETURN_ERROR_THREAD;
+
+    _done_items.push_back (data);
+    if (_done_items.size () > _idle_done_threads && _done_threads.size () < XCAM_STEALING_MAX_DONE_THREADS) {
+        char name[256];
+        snprintf (name, 255, "%s-done%d", XCAM_STR (get_name ()), (uint32_t)_done_threads.size ());
+        SmartPtr<StealingDoneThread> thread = new StealingDoneThread (this, name);
+        XCAM_ASSERT (thread.ptr ());
+        setup_thread (thread.ptr ());
+        if (thread->start ()) {
+            _done_threads.push_back (thread);
+        } else if (_done_threads.empty ()) {
+            _done_items.pop_back ();
+            XCAM_LOG_ERROR ("work stealing pool(%s) start done thread failed", XCAM_STR (get_name ()));
+            return XCAM_RETURN_ERROR_THREAD;
+        } else {
+            XCAM_LOG_WARNING ("work stealing pool(%s) start more done thread failed", XCAM_STR (get_name ()));
+        }
+    }
+    _done_cond.signal ();
+
+    return XCAM_RETURN_NO_ERROR;
+}
+
+bool
+WorkStealingPool::fetch_done (SmartPtr<UserData> &data)
+{
+    SmartLock locker (_done_mutex);
+    ++_idle_done_threads;
+    while (_running && _done_items.empty ())
+        _done_cond.wait (_done_mutex);
+    --_idle_done_threads;
+
+    // items left at stop are dropped by stop ()
+    if (!_running)
+        return false;
+
+    data = std::move (_done_items.front ());
+    _done_items.pop_front ();
+    return true;
+}
+
+void
+WorkStealingPool::wakeup_one ()
+{
+    if (!_idle_threads)
+        return;
+
+    SmartLock locker (_idle_mutex);
+    _idle_cond.signal ();
+}
+
+bool
+WorkStealingPool::pop_local (uint32_t index, SmartPtr<UserData> &data)
+{
+    StealingDeque &deque = _deques[index];
+    SmartLock locker (deque.mutex);
+    if (deque.items.empty ())
+        return false;
+
+    data = std::move (deque.items.back ());
+    deque.items.pop_back ();
+    return true;
+}
+
+bool
+WorkStealingPool::steal (uint32_t index, SmartPtr<UserData> &data)
+{
+    for (uint32_t i = 1; i < _deque_count; ++i) {
+        StealingDeque &victim = _deques[(index + i) % _deque_count];
+        SmartLock locker (victim.mutex);
+        if (victim.items.empty ())
+            continue;
+
+        data = std::move (victim.items.front ());
+        victim.items.pop_front ();
+        return true;
+    }
+    return false;
+}
+
+bool
+WorkStealingPool::fetch (uint32_t index, SmartPtr<UserData> &data)
+{
+    while (_running) {
+        if (_pending_items > 0 && (pop_local (index, data) || steal (index, data))) {
+            --_pending_items;
+            _metric_queued->sub ();
+            return true;
+        }
+
+        // idle count goes up before pending is checked, queue() checks them in reverse order
+        SmartLock locker (_idle_mutex);
+        ++_idle_threads;
+        while (_running && _pending_items <= 0)
+            _idle_cond.wait (_idle_mutex);
+        --_idle_threads;
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,105 @@
+/*
+ * work_stealing_pool.h - work stealing thread pool
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_WORK_STEALING_POOL_H
+#define XCAM_WORK_STEALING_POOL_H
+
+#include <xcam_std.h>
+#include <thread_pool.h>
+#include <list>
+
+namespace XCam {
+
+class StealingThread;
+class StealingDoneThread;
+struct StealingDeque;
+
+/*
+ * fixed number of threads, each owns a deque.
+ * items queued from a pool thread go to its own deque (LIFO for the owner),
+ * items queued from outside are spread round-robin over all deques.
+ * idle threads steal from the front of other threads' deques before sleeping.
+ * items still queued at stop are not run, their done () gets XCAM_RETURN_ERROR_THREAD.
+ *
+ * completion items of queue_done run on separate done threads, one more is started whenever
+ * all of them are busy, so a callback blocking on e.g. buffer acquisition never holds pool threads.
+ */
+class WorkStealingPool
+    : public ThreadPool
+{
+    friend class StealingThread;
+    friend class StealingDoneThread;
+    typedef std::vector<SmartPtr<StealingThread> > StealingThreadList;
+    typedef std::vector<SmartPtr<StealingDoneThread> > DoneThreadList;
+
+public:
+    // thread count defaults to online cpu count
+    explicit WorkStealingPool (const char *name);
+    virtual ~WorkStealingPool ();
+
+    // process-wide pool shared by all soft workers, started on first call
+    static SmartPtr<ThreadPool> get_shared_pool ();
+    // thread count of shared pool, 0 for online cpu count,
+    // a running shared pool is replaced by a new one, workers holding the old one
+    // keep using it until they are released, new workers take the new one
+    static bool set_shared_threads (uint32_t count);
+
+    // whether the calling thread is one of this pool's threads
+    bool is_pool_thread () const;
+
+    // derived from ThreadPool
+    virtual bool is_running ();
+    virtual XCamReturn start ();
+    virtual XCamReturn stop ();
+    virtual XCamReturn queue (const SmartPtr<UserData> &data);
+    // runs @data on a done thread, e.g. all items done callback of a worker
+    XCamReturn queue_done (const SmartPtr<UserData> &data);
+
+private:
+    bool fetch (uint32_t index, SmartPtr<UserData> &data);
+    bool fetch_done (SmartPtr<UserData> &data);
+    bool pop_local (uint32_t index, SmartPtr<UserData> &data);
+    bool steal (uint32_t index, SmartPtr<UserData> &data);
+    void wakeup_one ();
+
+    XCAM_DEAD_COPY (WorkStealingPool);
+
+private:
+    StealingDeque                 *_deques;
+    uint32_t                       _deque_count;
+    StealingThreadList             _threads;
+    std::atomic<bool>              _running;
+    std::atomic<int32_t>           _pending_items;
+    std::atomic<uint32_t>          _idle_threads;
+    std::atomic<uint32_t>          _next_deque;
+    Mutex                          _pool_mutex;
+    Mutex                          _idle_mutex;
+    Cond                           _idle_cond;
+
+    DoneThreadList                 _done_threads;
+    std::list<SmartPtr<UserData> > _done_items;
+    uint32_t                       _idle_done_threads;
+    Mutex                          _done_mutex;
+    Cond                           _done_cond;
+};
+
+}
+
+#endif // XCAM_WORK_STEALING_POOL_H
@@ -47,6 +47,14 @@ void * xcam_malloc0(size_t size)
     return ptr;
 }
 
+void * xcam_malloc_aligned(size_t size, size_t align)
+{
+    void * ptr = NULL;
+    if (posix_memalign (&ptr, align, size) != 0)
+        return NULL;
+    return ptr;
+}
+
 void xcam_free(void *ptr)
 {
     if (ptr)
@@ -0,0 +1,222 @@
+/*
+ * xcam_metrics.cpp - runtime counters and latency histograms
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "xcam_metrics.h"
+#include <time.h>
+
+namespace XCam {
+
+MetricHistogram::MetricHistogram ()
+    : _count (0)
+    , _sum (0)
+    , _min (UINT64_MAX)
+    , _max (0)
+{
+    for (uint32_t i = 0; i < XCAM_METRIC_BUCKETS; ++i)
+        _buckets[i] = 0;
+}
+
+uint32_t
+MetricHistogram::bucket_index (uint64_t value)
+{
+    if (value < XCAM_METRIC_SUB_COUNT)
+        return (uint32_t) value;
+
+    uint32_t msb = 63 - __builtin_clzll (value);
+    uint32_t shift = msb - XCAM_METRIC_SUB_BITS;
+    return (msb - XCAM_METRIC_SUB_BITS + 1) * XCAM_METRIC_SUB_COUNT +
+           (uint32_t)((value >> shift) & (XCAM_METRIC_SUB_COUNT - 1));
+}
+
+uint64_t
+MetricHistogram::bucket_upper (uint32_t index)
+{
+    if (index < XCAM_METRIC_SUB_COUNT)
+        return index;
+
+    uint32_t shift = index / XCAM_METRIC_SUB_COUNT - 1;
+    uint64_t sub = index % XCAM_METRIC_SUB_COUNT;
+    uint64_t lower = (XCAM_METRIC_SUB_COUNT + sub) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+void
+MetricHistogram::record (uint64_t value)
+{
+    _buckets[bucket_index (value)].fetch_add (1, std::memory_order_relaxed);
+    _count.fetch_add (1, std::memory_order_relaxed);
+    _sum.fetch_add (value, std::memory_order_relaxed);
+
+    uint64_t cur = _min.load (std::memory_order_relaxed);
+    while (value < cur && !_min.compare_exchange_weak (cur, value, std::memory_order_relaxed)) {}
+    cur = _max.load (std::memory_order_relaxed);
+    while (value > cur && !_max.compare_exchange_weak (cur, value, std::memory_order_relaxed)) {}
+}
+
+void
+MetricHistogram::reset ()
+{
+    for (uint32_t i = 0; i < XCAM_METRIC_BUCKETS; ++i)
+        _buckets[i].store (0, std::memory_order_relaxed);
+    _count = 0;
+    _sum = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+}
+
+uint64_t
+MetricHistogram::get_min () const
+{
+    uint64_t min = _min.load (std::memory_order_relaxed);
+    return min == UINT64_MAX ? 0 : min;
+}
+
+uint64_t
+MetricHistogram::get_percentile (double percent) const
+{
+    uint64_t count = get_count ();
+    if (!count)
+        return 0;
+
+    uint64_t target = (uint64_t)(count * XCAM_CLAMP (percent, 0.0, 100.0) / 100.0 + 0.5);
+    if (!target)
+        target = 1;
+
+    // buckets may run ahead of count under concurrent recording
+    uint64_t acc = 0;
+    for (uint32_t i = 0; i < XCAM_METRIC_BUCKETS; ++i) {
+        acc += _buckets[i].load (std::memory_order_relaxed);
+        if (acc >= target)
+            return XCAM_MIN (bucket_upper (i), get_max ());
+    }
+    return get_max ();
+}
+
+MetricsRegistry &
+MetricsRegistry::instance ()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricCounter *
+MetricsRegistry::get_counter (const char *name)
+{
+    XCAM_ASSERT (name);
+    SmartLock locker (_mutex);
+    MetricCounter *&counter = _counters[name];
+    if (!counter)
+        counter = new MetricCounter;
+    return counter;
+}
+
+MetricHistogram *
+MetricsRegistry::get_histogram (const char *name)
+{
+    XCAM_ASSERT (name);
+    SmartLock locker (_mutex);
+    MetricHistogram *&histogram = _histograms[name];
+    if (!histogram)
+        histogram = new MetricHistogram;
+    return histogram;
+}
+
+std::string
+MetricsRegistry::instance_name (const char *type, const char *name)
+{
+    XCAM_ASSERT (type);
+    std::string base = name ? name : "unnamed";
+
+    SmartLock locker (_mutex);
+    uint32_t index = _instances[std::string (type) + "." + base]++;
+    if (!index)
+        return base;
+
+    char suffix[16];
+    snprintf (suffix, sizeof (suffix), "#%u", index);
+    return base + suffix;
+}
+
+std::string
+MetricsRegistry::dump ()
+{
+    std::string text;
+    char line[XCAM_METRIC_NAME_SIZE + 256];
+
+    SmartLock locker (_mutex);
+    for (CounterMap::iterator i = _counters.begin (); i != _counters.end (); ++i) {
+        snprintf (line, sizeof (line), "%s %" PRId64 "\n", i->first.c_str (), i->second->get ());
+        text += line;
+    }
+
+    for (HistogramMap::iterator i = _histograms.begin (); i != _histograms.end (); ++i) {
+        const MetricHistogram *h = i->second;
+        uint64_t count = h->get_count ();
+        snprintf (
+            line, sizeof (line),
+            "%s count=%" PRIu64 " mean=%" PRIu64 " min=%" PRIu64 " p50=%" PRIu64
+            " p90=%" PRIu64 " p99=%" PRIu64 " max=%" PRIu64 "\n",
+            i->first.c_str (), count, count ? h->get_sum () / count : 0, h->get_min (),
+            h->get_percentile (50.0), h->get_percentile (90.0), h->get_percentile (99.0), h->get_max ());
+        text += line;
+    }
+
+    return text;
+}
+
+void
+MetricsRegistry::reset ()
+{
+    SmartLock locker (_mutex);
+    for (HistogramMap::iterator i = _histograms.begin (); i != _histograms.end (); ++i)
+        i->second->reset ();
+}
+
+uint64_t
+MetricsRegistry::now_us ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void
+build_metric_name (char *buf, const char *type, const char *name, const char *item)
+{
+    snprintf (buf, XCAM_METRIC_NAME_SIZE, "%s.%s.%s", type, name ? name : "unnamed", item);
+}
+
+MetricCounter *
+xcam_metric_counter (const char *type, const char *name, const char *item)
+{
+    char full_name[XCAM_METRIC_NAME_SIZE];
+    build_metric_name (full_name, type, name, item);
+    return MetricsRegistry::instance ().get_counter (full_name);
+}
+
+MetricHistogram *
+xcam_metric_histogram (const char *type, const char *name, const char *item)
+{
+    char full_name[XCAM_METRIC_NAME_SIZE];
+    build_metric_name (full_name, type, name, item);
+    return MetricsRegistry::instance ().get_histogram (full_name);
+}
+
+}
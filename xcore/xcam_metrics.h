@@ -0,0 +1,143 @@
+/*
+ * xcam_metrics.h - runtime counters and latency histograms
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_METRICS_H
+#define XCAM_METRICS_H
+
+#include <xcam_std.h>
+#include <xcam_mutex.h>
+#include <atomic>
+#include <map>
+#include <string>
+
+// each power of two range is split into 2^XCAM_METRIC_SUB_BITS buckets, relative error < 1/16
+#define XCAM_METRIC_SUB_BITS 4
+#define XCAM_METRIC_SUB_COUNT (1 << XCAM_METRIC_SUB_BITS)
+#define XCAM_METRIC_BUCKETS ((64 - XCAM_METRIC_SUB_BITS + 1) * XCAM_METRIC_SUB_COUNT)
+
+#define XCAM_METRIC_NAME_SIZE 128
+
+namespace XCam {
+
+// counter or gauge
+class MetricCounter {
+public:
+    MetricCounter () : _value (0) {}
+
+    void add (int64_t v = 1) {
+        _value.fetch_add (v, std::memory_order_relaxed);
+    }
+    void sub (int64_t v = 1) {
+        _value.fetch_sub (v, std::memory_order_relaxed);
+    }
+    void set (int64_t v) {
+        _value.store (v, std::memory_order_relaxed);
+    }
+    int64_t get () const {
+        return _value.load (std::memory_order_relaxed);
+    }
+
+private:
+    XCAM_DEAD_COPY (MetricCounter);
+
+private:
+    std::atomic<int64_t>    _value;
+};
+
+// log-linear buckets over full uint64 range, recording is lock-free
+class MetricHistogram {
+public:
+    MetricHistogram ();
+
+    void record (uint64_t value);
+    void reset ();
+
+    uint64_t get_count () const {
+        return _count.load (std::memory_order_relaxed);
+    }
+    uint64_t get_sum () const {
+        return _sum.load (std::memory_order_relaxed);
+    }
+    uint64_t get_min () const;
+    uint64_t get_max () const {
+        return _max.load (std::memory_order_relaxed);
+    }
+    // upper bound of the bucket where percentile falls, percent in [0, 100]
+    uint64_t get_percentile (double percent) const;
+
+    static uint32_t bucket_index (uint64_t value);
+    static uint64_t bucket_upper (uint32_t index);
+
+private:
+    XCAM_DEAD_COPY (MetricHistogram);
+
+private:
+    std::atomic<uint64_t>   _buckets[XCAM_METRIC_BUCKETS];
+    std::atomic<uint64_t>   _count;
+    std::atomic<uint64_t>   _sum;
+    std::atomic<uint64_t>   _min;
+    std::atomic<uint64_t>   _max;
+};
+
+/*
+ * process-wide registry, metrics are created on first lookup and never freed,
+ * so returned pointers can be kept and updated without lock.
+ * names are dot separated, e.g. "buffer_pool.<name>.in_use",
+ * objects sharing a name get "<name>#<n>" from instance_name so their metrics are kept apart.
+ */
+class MetricsRegistry {
+public:
+    static MetricsRegistry &instance ();
+
+    MetricCounter *get_counter (const char *name);
+    MetricHistogram *get_histogram (const char *name);
+    // unique per type, first instance keeps name, later ones get "#<n>" suffix
+    std::string instance_name (const char *type, const char *name);
+
+    // text lines of all metrics sorted by name
+    std::string dump ();
+    // clears histograms, counters are kept since gauges track live objects
+    void reset ();
+
+    // monotonic time in microseconds
+    static uint64_t now_us ();
+
+private:
+    MetricsRegistry () {}
+    XCAM_DEAD_COPY (MetricsRegistry);
+
+private:
+    typedef std::map<std::string, MetricCounter *> CounterMap;
+    typedef std::map<std::string, MetricHistogram *> HistogramMap;
+    typedef std::map<std::string, uint32_t> InstanceMap;
+
+    Mutex           _mutex;
+    CounterMap      _counters;
+    HistogramMap    _histograms;
+    InstanceMap     _instances;
+};
+
+// builds "<type>.<name>.<item>" and looks up registry, name NULL is taken as "unnamed"
+MetricCounter *xcam_metric_counter (const char *type, const char *name, const char *item);
+MetricHistogram *xcam_metric_histogram (const char *type, const char *name, const char *item);
+
+}
+
+#endif //XCAM_METRICS_H
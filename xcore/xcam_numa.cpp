@@ -0,0 +1,165 @@
+/*
+ * xcam_numa.cpp - numa topology and memory placement
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "xcam_numa.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define XCAM_NUMA_SYSFS_NODE "/sys/devices/system/node"
+#define XCAM_NUMA_SYSFS_CPU_ONLINE "/sys/devices/system/cpu/online"
+#define XCAM_NUMA_MAX_NODES 1024
+
+// from linux/mempolicy.h
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+namespace XCam {
+
+static bool
+read_sysfs_line (const char *path, char *buf, size_t size)
+{
+    FILE *fp = fopen (path, "r");
+    if (!fp)
+        return false;
+
+    bool ret = (fgets (buf, size, fp) != NULL);
+    fclose (fp);
+    return ret;
+}
+
+uint32_t
+NumaTopology::get_node_count ()
+{
+    char path[XCAM_MAX_STR_SIZE];
+    uint32_t count = 0;
+    while (count < XCAM_NUMA_MAX_NODES) {
+        snprintf (path, sizeof (path), XCAM_NUMA_SYSFS_NODE "/node%d", count);
+        if (access (path, F_OK) != 0)
+            break;
+        ++count;
+    }
+    return count ? count : 1;
+}
+
+bool
+NumaTopology::get_online_cpus (std::vector<uint32_t> &cpus)
+{
+    char list[XCAM_MAX_STR_SIZE * 4];
+    if (!read_sysfs_line (XCAM_NUMA_SYSFS_CPU_ONLINE, list, sizeof (list))) {
+        long count = sysconf (_SC_NPROCESSORS_ONLN);
+        XCAM_FAIL_RETURN (
+            ERROR, count > 0, false,
+            "numa get online cpus failed");
+        cpus.clear ();
+        for (long i = 0; i < count; ++i)
+            cpus.push_back ((uint32_t) i);
+        return true;
+    }
+    return parse_cpu_list (list, cpus);
+}
+
+bool
+NumaTopology::get_node_cpus (uint32_t node, std::vector<uint32_t> &cpus)
+{
+    char path[XCAM_MAX_STR_SIZE];
+    char list[XCAM_MAX_STR_SIZE * 4];
+    snprintf (path, sizeof (path), XCAM_NUMA_SYSFS_NODE "/node%d/cpulist", node);
+    if (read_sysfs_line (path, list, sizeof (list)))
+        return parse_cpu_list (list, cpus);
+
+    XCAM_FAIL_RETURN (
+        ERROR, node == 0, false,
+        "numa get cpus of node(%d) failed, node not found", node);
+    return get_online_cpus (cpus);
+}
+
+bool
+NumaTopology::parse_cpu_list (const char *list, std::vector<uint32_t> &cpus)
+{
+    XCAM_ASSERT (list);
+    cpus.clear ();
+
+    const char *pos = list;
+    while (*pos && *pos != '\n') {
+        char *end = NULL;
+        unsigned long first = strtoul (pos, &end, 10);
+        XCAM_FAIL_RETURN (
+            ERROR, end != pos, false,
+            "numa parse cpu list(%s) failed", list);
+
+        unsigned long last = first;
+        pos = end;
+        if (*pos == '-') {
+            ++pos;
+            last = strtoul (pos, &end, 10);
+            XCAM_FAIL_RETURN (
+                ERROR, end != pos && last >= first, false,
+                "numa parse cpu list(%s) failed", list);
+            pos = end;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu)
+            cpus.push_back ((uint32_t) cpu);
+
+        if (*pos == ',')
+            ++pos;
+    }
+
+    return !cpus.empty ();
+}
+
+bool
+NumaTopology::bind_memory (void *ptr, size_t size, uint32_t node)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, ptr && size && node < XCAM_NUMA_MAX_NODES, false,
+        "numa bind memory failed, invalid params, ptr:%p, size:%zu, node:%d", ptr, size, node);
+
+#ifdef SYS_mbind
+    size_t page_size = (size_t) sysconf (_SC_PAGESIZE);
+    uintptr_t start = XCAM_ALIGN_UP ((uintptr_t) ptr, page_size);
+    uintptr_t end = XCAM_ALIGN_DOWN ((uintptr_t) ptr + size, page_size);
+    if (start >= end)
+        return true;
+
+    const size_t bits = sizeof (unsigned long) * 8;
+    unsigned long mask[XCAM_NUMA_MAX_NODES / (sizeof (unsigned long) * 8)];
+    xcam_mem_clear (mask);
+    mask[node / bits] = 1UL << (node % bits);
+
+    long ret = syscall (
+                   SYS_mbind, (void *) start, (unsigned long)(end - start), MPOL_PREFERRED,
+                   mask, (unsigned long) XCAM_NUMA_MAX_NODES, MPOL_MF_MOVE);
+    XCAM_FAIL_RETURN (
+        WARNING, ret == 0, false,
+        "numa bind memory to node(%d) failed, %s", node, strerror (errno));
+    return true;
+#else
+    XCAM_LOG_WARNING ("numa bind memory to node(%d) not supported", node);
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+ * xcam_numa.h - numa topology and memory placement
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_NUMA_H
+#define XCAM_NUMA_H
+
+#include <xcam_std.h>
+#include <vector>
+
+namespace XCam {
+
+/*
+ * topology is read from sysfs and memory policy is set by mbind syscall, no libnuma needed.
+ * systems without numa support are taken as one node holding all online cpus.
+ */
+class NumaTopology {
+public:
+    static uint32_t get_node_count ();
+    static bool get_node_cpus (uint32_t node, std::vector<uint32_t> &cpus);
+    static bool get_online_cpus (std::vector<uint32_t> &cpus);
+
+    // parses kernel cpu list format, e.g. "0-3,8,10-11"
+    static bool parse_cpu_list (const char *list, std::vector<uint32_t> &cpus);
+
+    // prefers @node for pages of [ptr, ptr + size), pages already touched are moved,
+    // partial pages at both ends are left as they are
+    static bool bind_memory (void *ptr, size_t size, uint32_t node);
+};
+
+}
+
+#endif //XCAM_NUMA_H
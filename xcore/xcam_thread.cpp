@@ -21,6 +21,7 @@
 #include "xcam_thread.h"
 #include "xcam_mutex.h"
 #include <errno.h>
+#include <sched.h>
 
 namespace XCam {
 
@@ -29,6 +30,7 @@ Thread::Thread (const char *name)
     , _thread_id (0)
     , _started (false)
     , _stopped (true)
+    , _fifo_priority (0)
 {
     if (name)
         _name = strndup (name, XCAM_MAX_STR_SIZE);
@@ -51,6 +53,7 @@ Thread::thread_func (void *user_data)
         SmartLock locker(thread->_mutex);
         pthread_detach (pthread_self());
     }
+    thread->apply_sched ();
     ret = thread->started ();
 
     while (true) {
@@ -76,6 +79,38 @@ Thread::thread_func (void *user_data)
     return 0;
 }
 
+void
+Thread::apply_sched ()
+{
+    // failures only cost performance, thread keeps running with default settings
+#ifdef __USE_GNU
+    if (!_cpus.empty ()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO (&cpu_set);
+        for (size_t i = 0; i < _cpus.size (); ++i) {
+            if (_cpus[i] < CPU_SETSIZE)
+                CPU_SET (_cpus[i], &cpu_set);
+        }
+        int ret = pthread_setaffinity_np (pthread_self (), sizeof (cpu_set), &cpu_set);
+        if (ret != 0) {
+            XCAM_LOG_WARNING ("Thread(%s) set cpu affinity failed.(%d, %s)", XCAM_STR(_name), ret, strerror(ret));
+        }
+    }
+#endif
+
+    if (_fifo_priority > 0) {
+        struct sched_param param;
+        xcam_mem_clear (param);
+        param.sched_priority = XCAM_CLAMP (
+                                   _fifo_priority, sched_get_priority_min (SCHED_FIFO), sched_get_priority_max (SCHED_FIFO));
+        int ret = pthread_setschedparam (pthread_self (), SCHED_FIFO, &param);
+        if (ret != 0) {
+            XCAM_LOG_WARNING ("Thread(%s) set SCHED_FIFO priority(%d) failed.(%d, %s)",
+                              XCAM_STR(_name), param.sched_priority, ret, strerror(ret));
+        }
+    }
+}
+
 bool
 Thread::started ()
 {
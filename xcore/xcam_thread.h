@@ -23,6 +23,7 @@
 
 #include <xcam_std.h>
 #include <xcam_mutex.h>
+#include <vector>
 
 namespace XCam {
 
@@ -39,6 +40,16 @@ public:
         return _name;
     }
 
+    // applied by the thread itself before started (), set before start
+    // pin thread to @cpus, empty to run on any cpu
+    void set_cpus (const std::vector<uint32_t> &cpus) {
+        _cpus = cpus;
+    }
+    // run with SCHED_FIFO at @priority(1-99), 0 keeps default policy, needs CAP_SYS_NICE
+    void set_fifo_priority (int32_t priority) {
+        _fifo_priority = priority;
+    }
+
 protected:
     // return true to start loop, else the thread stopped
     virtual bool started ();
@@ -51,6 +62,7 @@ private:
 
 private:
     static int thread_func (void *user_data);
+    void apply_sched ();
 
 private:
     char           *_name;
@@ -59,6 +71,8 @@ private:
     XCam::Cond      _exit_cond;
     bool            _started;
     bool            _stopped;
+    std::vector<uint32_t>  _cpus;
+    int32_t                _fifo_priority;
 };
 
 };
@@ -0,0 +1,214 @@
+/*
+ * xcam_trace.cpp - per-stage latency tracing
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#include "xcam_trace.h"
+#include "xcam_mutex.h"
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace XCam {
+
+struct TraceEvent {
+    uint64_t     start;
+    uint64_t     end;
+    int64_t      frame_id;
+    const char  *cat;
+    char         name[XCAM_TRACE_NAME_SIZE];
+};
+
+// events and count are written by owner thread only
+struct TraceRing {
+    std::vector<TraceEvent>   events;
+    std::atomic<uint64_t>     count;
+    // count at last start, under trace_mutex, events before it are not dumped
+    uint64_t                  start;
+    int                       tid;
+    char                      thread_name[XCAM_TRACE_NAME_SIZE];
+
+    TraceRing ()
+        : events (XCAM_TRACE_RING_SIZE)
+        , count (0)
+        , start (0)
+        , tid (0)
+    {
+        xcam_mem_clear (thread_name);
+    }
+};
+
+std::atomic<bool> Trace::_enabled (false);
+
+static Mutex trace_mutex;
+// rings outlive their threads, events of stopped pools are still dumped
+static std::vector<TraceRing *> trace_rings;
+static uint64_t trace_start_time = 0;
+static std::atomic<int64_t> trace_frame_count (0);
+
+static thread_local TraceRing *tls_ring = NULL;
+static thread_local int64_t tls_frame_id = -1;
+
+static TraceRing *
+create_ring ()
+{
+    TraceRing *ring = new TraceRing;
+    ring->tid = (int) syscall (SYS_gettid);
+    if (pthread_getname_np (pthread_self (), ring->thread_name, sizeof (ring->thread_name)) != 0)
+        snprintf (ring->thread_name, sizeof (ring->thread_name), "thread-%d", ring->tid);
+
+    SmartLock locker (trace_mutex);
+    trace_rings.push_back (ring);
+    return ring;
+}
+
+void
+Trace::start ()
+{
+    SmartLock locker (trace_mutex);
+    for (size_t i = 0; i < trace_rings.size (); ++i)
+        trace_rings[i]->start = trace_rings[i]->count.load (std::memory_order_acquire);
+    trace_start_time = now ();
+    _enabled = true;
+}
+
+void
+Trace::stop ()
+{
+    _enabled = false;
+}
+
+uint64_t
+Trace::now ()
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int64_t
+Trace::begin_frame ()
+{
+    tls_frame_id = trace_frame_count++;
+    return tls_frame_id;
+}
+
+void
+Trace::set_frame_id (int64_t id)
+{
+    tls_frame_id = id;
+}
+
+int64_t
+Trace::get_frame_id ()
+{
+    return tls_frame_id;
+}
+
+void
+Trace::record (const char *cat, const char *name, uint64_t start, uint64_t end)
+{
+    if (!is_enabled ())
+        return;
+
+    TraceRing *ring = tls_ring;
+    if (!ring) {
+        ring = create_ring ();
+        tls_ring = ring;
+    }
+
+    uint64_t idx = ring->count.load (std::memory_order_relaxed);
+    TraceEvent &event = ring->events[idx % XCAM_TRACE_RING_SIZE];
+    event.start = start;
+    event.end = end;
+    event.frame_id = tls_frame_id;
+    event.cat = cat;
+    strncpy (event.name, XCAM_STR (name), XCAM_TRACE_NAME_SIZE - 1);
+    event.name[XCAM_TRACE_NAME_SIZE - 1] = '\0';
+    ring->count.store (idx + 1, std::memory_order_release);
+}
+
+static void
+write_json_string (FILE *fp, const char *str)
+{
+    fputc ('"', fp);
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\')
+            fputc ('\\', fp);
+        if ((unsigned char)*str >= 0x20)
+            fputc (*str, fp);
+    }
+    fputc ('"', fp);
+}
+
+bool
+Trace::dump (const char *file_name)
+{
+    XCAM_FAIL_RETURN (
+        ERROR, file_name, false,
+        "trace dump failed, file name is NULL");
+
+    FILE *fp = fopen (file_name, "wb");
+    XCAM_FAIL_RETURN (
+        ERROR, fp, false,
+        "trace dump failed, open file(%s) failed", file_name);
+
+    SmartLock locker (trace_mutex);
+    int pid = (int) getpid ();
+    uint64_t event_count = 0;
+    bool first = true;
+
+    fprintf (fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < trace_rings.size (); ++i) {
+        const TraceRing *ring = trace_rings[i];
+        uint64_t count = ring->count.load (std::memory_order_acquire);
+        if (count == ring->start)
+            continue;
+
+        fprintf (fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                 first ? "" : ",\n", pid, ring->tid);
+        write_json_string (fp, ring->thread_name);
+        fprintf (fp, "}}");
+        first = false;
+
+        uint64_t begin = count > XCAM_TRACE_RING_SIZE ? count - XCAM_TRACE_RING_SIZE : 0;
+        begin = XCAM_MAX (begin, ring->start);
+        for (uint64_t idx = begin; idx < count; ++idx) {
+            const TraceEvent &event = ring->events[idx % XCAM_TRACE_RING_SIZE];
+            if (event.start < trace_start_time)
+                continue;
+
+            fprintf (fp, ",\n{\"name\":");
+            write_json_string (fp, event.name);
+            fprintf (fp, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+                     "\"args\":{\"frame\":%" PRId64 "}}",
+                     event.cat, (event.start - trace_start_time) / 1000.0, (event.end - event.start) / 1000.0,
+                     pid, ring->tid, event.frame_id);
+            ++event_count;
+        }
+    }
+    fprintf (fp, "\n]}\n");
+    fclose (fp);
+
+    XCAM_LOG_INFO ("trace dumped %" PRIu64 " events of %d threads into %s",
+                   event_count, (int)trace_rings.size (), file_name);
+    return true;
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * xcam_trace.h - per-stage latency tracing
+ *
+ *  Copyright (c) 2026 agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: agent <agent@local>
+ */
+
+#ifndef XCAM_TRACE_H
+#define XCAM_TRACE_H
+
+#include <xcam_std.h>
+#include <atomic>
+
+// events kept by each thread, the oldest ones are overwritten when ring is full
+#define XCAM_TRACE_RING_SIZE (16 * 1024)
+#define XCAM_TRACE_NAME_SIZE 32
+
+namespace XCam {
+
+/*
+ * events are recorded into per-thread rings with monotonic clock and frame id of the
+ * recording thread, then dumped into chrome trace json(chrome://tracing, ui.perfetto.dev).
+ * hooks are built with --enable-trace only, recording runs between start() and stop().
+ */
+class Trace {
+public:
+    static void start ();
+    static void stop ();
+    static bool is_enabled () {
+        return _enabled.load (std::memory_order_relaxed);
+    }
+    // call after traced work is done, rings are read without lock
+    static bool dump (const char *file_name);
+
+    // monotonic time in nanoseconds
+    static uint64_t now ();
+
+    // allocates a new frame id and sets it to calling thread
+    static int64_t begin_frame ();
+    static void set_frame_id (int64_t id);
+    static int64_t get_frame_id ();
+
+    // name is copied, cat must be a string literal
+    static void record (const char *cat, const char *name, uint64_t start, uint64_t end);
+
+private:
+    static std::atomic<bool>  _enabled;
+};
+
+class TraceScope {
+public:
+    TraceScope (const char *cat, const char *name)
+        : _cat (cat)
+        , _name (name)
+        , _start (Trace::is_enabled () ? Trace::now () : 0)
+    {}
+    ~TraceScope () {
+        if (_start)
+            Trace::record (_cat, _name, _start, Trace::now ());
+    }
+
+private:
+    XCAM_DEAD_COPY (TraceScope);
+
+private:
+    const char    *_cat;
+    const char    *_name;
+    uint64_t       _start;
+};
+
+// carried by objects handed over between threads, e.g. queued items and handler params
+struct TraceStamp {
+    uint64_t     time;
+    int64_t      frame_id;
+
+    TraceStamp () : time (0), frame_id (-1) {}
+
+    void stamp () {
+        if (!Trace::is_enabled ())
+            return;
+        time = Trace::now ();
+        frame_id = Trace::get_frame_id ();
+    }
+
+    // records the span since stamp and continues its frame id on calling thread
+    void resume (const char *cat, const char *name) {
+        if (!time)
+            return;
+        Trace::set_frame_id (frame_id);
+        Trace::record (cat, name, time, Trace::now ());
+        time = 0;
+    }
+};
+
+}
+
+#if ENABLE_TRACE
+#define XCAM_TRACE_CONCAT_(a, b) a##b
+#define XCAM_TRACE_CONCAT(a, b) XCAM_TRACE_CONCAT_(a, b)
+
+#define XCAM_TRACE_SCOPE(cat, name) \
+    XCam::TraceScope XCAM_TRACE_CONCAT(xcam_trace_scope_, __LINE__) (cat, name)
+#define XCAM_TRACE_BEGIN_FRAME() XCam::Trace::begin_frame ()
+
+#define XCAM_TRACE_STAMP_DEFINES XCam::TraceStamp trace_stamp
+#define XCAM_TRACE_STAMP(obj) (obj)->trace_stamp.stamp ()
+#define XCAM_TRACE_RESUME(obj, cat, name) (obj)->trace_stamp.resume (cat, name)
+#else
+#define XCAM_TRACE_SCOPE(cat, name)
+#define XCAM_TRACE_BEGIN_FRAME()
+
+#define XCAM_TRACE_STAMP_DEFINES
+#define XCAM_TRACE_STAMP(obj)
+#define XCAM_TRACE_RESUME(obj, cat, name)
+#endif
+
+#endif //XCAM_TRACE_H